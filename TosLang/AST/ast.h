@@ -48,6 +48,7 @@ namespace TosLang
                 // Statements
                 COMPOUND_STMT,
                 IF_STMT,
+                JOIN_STMT,
                 PRINT_STMT,
                 RETURN_STMT,
                 SCAN_STMT,
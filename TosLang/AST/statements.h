@@ -223,6 +223,30 @@ namespace TosLang
             virtual ~SyncStmt() = default;
         };
 
+        /*
+        * \class JoinStmt
+        * \brief Node of the AST representing a JOIN
+        */
+        class JoinStmt : public Stmt
+        {
+        public:
+            JoinStmt() : Stmt{ NodeKind::ERROR } { }
+            JoinStmt(std::unique_ptr<Expr>&& handle, const Utils::SourceLocation& srcLoc)
+                : Stmt{ NodeKind::JOIN_STMT }
+            {
+                mSrcLoc = srcLoc;
+                AddChildNode(std::move(handle));
+            }
+            virtual ~JoinStmt() = default;
+
+            /*
+            * \fn       GetHandleExpr
+            * \brief    Gets the expression representing the handle of the thread to wait for, as given by a spawn
+            * \return   Handle expression
+            */
+            const Expr* GetHandleExpr() const { assert(mChildren.size() == 1); return GetChildNodeAs<Expr>(0); }
+        };
+
         /*
         * \class WhileStmt
         * \brief Node of the AST representing a WHILE
@@ -50,7 +50,7 @@ namespace TosLang
 
         public:
             using inst_iterator = typename std::vector<std::unique_ptr<InstT>>::iterator;
-            using inst_const_iterator = typename std::vector<std::shared_ptr<InstT>>::const_iterator;
+            using inst_const_iterator = typename std::vector<std::unique_ptr<InstT>>::const_iterator;
 
             using bb_iterator = typename BlockList<InstT>::iterator;
             using bb_const_iterator = typename BlockList<InstT>::const_iterator;
@@ -88,6 +88,14 @@ namespace TosLang
             */
             void InsertBranch(const BlockPtr<InstT>& block) { mSuccBlocks.push_back(block); }
 
+            /*
+            * \fn           InsertPredecessor
+            * \brief        Indicates that a block branches to this one. Note that this function
+            *               is not responsible for adding a branch to the predecessor.
+            * \param block  Predecessor block
+            */
+            void InsertPredecessor(const BlockPtr<InstT>& block) { mPredBlocks.push_back(block); }
+
             /*
             * \fn           InsertInstruction
             * \brief        Appends a virtual instruction to the basic block
@@ -102,6 +110,32 @@ namespace TosLang
             */
             void InsertInstruction(const InstT& inst) { mInstructions.emplace_back(std::make_unique<InstT>(inst)); }
 
+            /*
+            * \fn           InsertInstructionFront
+            * \brief        Inserts a virtual instruction at the beginning of the basic block
+            * \param inst   Instruction to be added
+            * \return       Instruction added
+            */
+            InstT* InsertInstructionFront(const InstT& inst) 
+            { 
+                mInstructions.emplace(mInstructions.begin(), std::make_unique<InstT>(inst));
+                return mInstructions.front().get();
+            }
+
+            /*
+            * \fn           RemoveInstruction
+            * \brief        Removes an instruction from the basic block
+            * \param inst   Instruction to be removed
+            */
+            void RemoveInstruction(const InstT* inst)
+            {
+                auto instIt = std::find_if(mInstructions.begin(), mInstructions.end(),
+                                           [inst](const std::unique_ptr<InstT>& blockInst) { return blockInst.get() == inst; });
+
+                if (instIt != mInstructions.end())
+                    mInstructions.erase(instIt);
+            }
+
             /*
             * \fn               ReplaceInstruction
             * \brief            Replaces an instruction in the block
@@ -157,6 +191,13 @@ namespace TosLang
             */
             InstT* GetTerminator() const { return mInstructions.back().get(); }
 
+            /*
+            * \fn       IsTerminated
+            * \brief    Indicates if the last instruction of the block transfers the control elsewhere
+            * \return   True if the block ends with a branch or a return, else false
+            */
+            bool IsTerminated() const { return !mInstructions.empty() && mInstructions.back()->IsTerminator(); }
+
         private:
             std::vector<std::unique_ptr<InstT>> mInstructions;  /*!< Instructions making up the basic block */
             BlockList<InstT> mSuccBlocks;                       /*!< List of blocks pointed to by the outgoing edges of the block */
@@ -15,9 +15,19 @@ namespace TosLang
         template <class InstT>
         class ControlFlowGraph
         {
+        public:
+            using iterator = typename BlockList<InstT>::iterator;
+            using const_iterator = typename BlockList<InstT>::const_iterator;
+
         public:
             virtual ~ControlFlowGraph() = default;
 
+        public:
+            iterator begin() { return mBlocks.begin(); }
+            iterator end() { return mBlocks.end(); }
+            const_iterator begin() const { return mBlocks.begin(); }
+            const_iterator end() const { return mBlocks.end(); }
+
         public:
             /*
             * \fn GetEntryBlock
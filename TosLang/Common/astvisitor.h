@@ -159,6 +159,12 @@ namespace TosLang
             */
             void HandleIfStmt() { }
 
+            /*
+            * \fn       HandleJoinStmt
+            * \brief    Handle a node of the JOIN_STMT kind
+            */
+            void HandleJoinStmt() { }
+
             /*
             * \fn       HandlePrintStmt
             * \brief    Handle a node of the PRINT_STMT kind
@@ -251,6 +257,9 @@ namespace TosLang
                 case FrontEnd::ASTNode::NodeKind::IF_STMT:
                     GetDerived().HandleIfStmt();
                     break;
+                case FrontEnd::ASTNode::NodeKind::JOIN_STMT:
+                    GetDerived().HandleJoinStmt();
+                    break;
                 case FrontEnd::ASTNode::NodeKind::PRINT_STMT:
                     GetDerived().HandlePrintStmt();
                     break;
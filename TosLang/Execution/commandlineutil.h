@@ -15,6 +15,7 @@ namespace Execution
         DUMP_CFG,
         DUMP_LLVM,
         INTERPRET,
+        INTERPRET_SSA,
         UNKNOWN,
     };
 
@@ -34,7 +35,9 @@ namespace Execution
                   << "  -dump-ast                   Outputs the program AST to stdout"              << std::endl
                   << "  -dump-cfg                   Outputs the program CFG to stdout"              << std::endl
                   << "  -interpret                  Executes the program through an interpreter"    << std::endl
-                  << "                              (Requires Tostitos to works)"                   << std::endl;
+                  << "                              (Requires Tostitos to works)"                   << std::endl
+                  << "  -interpret=ssa              Executes the program's SSA form through an"     << std::endl
+                  << "                              interpreter"                                    << std::endl;
     }
 
     ExecutionInfo ParseCommandLine(const std::vector<std::string>& args)
@@ -90,6 +93,10 @@ namespace Execution
         {
             return{ ExecutionCommand::INTERPRET, args.back() };
         }
+        else if (arg == "-interpret=ssa")
+        {
+            return{ ExecutionCommand::INTERPRET_SSA, args.back() };
+        }
         else
         {
             std::cout << "Unrecognized option\n";
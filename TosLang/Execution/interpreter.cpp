@@ -1,6 +1,8 @@
 #include "interpreter.h"
 
 #include "../Parse/parser.h"
+#include "../SSA/cfgbuilder.h"
+#include "../SSA/ssainterpreter.h"
 #include "../Sema/symbolcollector.h"
 #include "../Sema/symboltable.h"
 #include "../Sema/typechecker.h"
@@ -28,6 +30,44 @@ Interpreter::~Interpreter() { }   // Required because of the forward declaration
 // TODO: What about error handling?
 
 bool Interpreter::Run(const std::string& programFile)
+{
+    if (!CheckProgram(programFile))
+        return false;
+
+    // TODO: Disabled for now.
+    //Threading::CreateThread(mAST.get(), mSymTable.get());
+    
+    return true;
+}
+
+bool Interpreter::RunSSA(const std::string& programFile)
+{
+    if (!CheckProgram(programFile))
+        return false;
+
+    // TODO: The CFG builder doesn't lower global variables yet
+    for (const auto& decl : mAST->GetChildrenNodes())
+    {
+        if (decl->GetKind() == ASTNode::NodeKind::VAR_DECL)
+        {
+            std::cerr << "Global variables aren't supported by the SSA interpreter yet" << std::endl;
+            return false;
+        }
+    }
+
+    TosLang::BackEnd::CFGBuilder cfgBuilder;
+    std::unique_ptr<TosLang::BackEnd::SSAModule> module = cfgBuilder.Run(mAST, mSymTable);
+
+    TosLang::BackEnd::SSAInterpreter ssaInterpreter;
+    if (!ssaInterpreter.Load(*module))
+        return false;
+
+    ssaInterpreter.Call("main", {});
+
+    return true;
+}
+
+bool Interpreter::CheckProgram(const std::string& programFile)
 {
     // Let's start by building the AST
     mAST = mParser->ParseProgram(programFile);
@@ -55,8 +95,5 @@ bool Interpreter::Run(const std::string& programFile)
         return false;
     }
 
-    // TODO: Disabled for now.
-    //Threading::CreateThread(mAST.get(), mSymTable.get());
-    
     return true;
 }
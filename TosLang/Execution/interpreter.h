@@ -33,6 +33,17 @@ namespace Execution
         * \return               Has the program correctly terminated?
         */
         bool Run(const std::string& programFile);
+
+        /*
+        * \fn                   RunSSA
+        * \brief                Runs a TosLang program by interpreting its SSA form
+        * \param programFile    Name (including path) of the .tos file to compile
+        * \return               Has the program correctly terminated?
+        */
+        bool RunSSA(const std::string& programFile);
+
+    private:
+        bool CheckProgram(const std::string& programFile);
         
     private:
         std::unique_ptr<TosLang::FrontEnd::ASTNode> mAST;                   /*!< Symbol table for a program */
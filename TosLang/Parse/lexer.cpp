@@ -251,6 +251,8 @@ Lexer::Token Lexer::GetNextToken()
                 return Token::SLEEP;    // TODO: Test it
 			else if (mCurrentStr == "sync")
 				return Token::SYNC;
+			else if (mCurrentStr == "join")
+				return Token::JOIN;
 			else if (mCurrentStr == "return")
 				return Token::RETURN;
 			else
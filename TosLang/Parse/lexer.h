@@ -23,6 +23,7 @@ namespace TosLang
                 // Keywords
                 FUNCTION,
                 IF,
+                JOIN,
                 PRINT,
                 RETURN,
                 SCAN,
@@ -265,6 +265,7 @@ std::unique_ptr<Expr> Parser::ParseExpr()
         isSpawnedExpr = true;
         mCurrentToken = mLexer.GetNextToken();
         // TODO: the next token must be an identifier
+        node = std::make_unique<IdentifierExpr>(mLexer.GetCurrentStr(), mLexer.GetCurrentLocation());
         break;
     case Lexer::Token::STRING_LITERAL:
         node = std::make_unique<StringExpr>(mLexer.GetCurrentStr(), mLexer.GetCurrentLocation());
@@ -281,8 +282,8 @@ std::unique_ptr<Expr> Parser::ParseExpr()
     // Look at what comes next
     mCurrentToken = mLexer.GetNextToken();
 
-    const Lexer::Token exprTerminators[] = { Lexer::Token::SEMI_COLON, Lexer::Token::LEFT_BRACE, 
-                                             Lexer::Token::RIGHT_BRACE, Lexer::Token::RIGHT_PAREN, Lexer::Token::COMMA };
+    const Lexer::Token exprTerminators[] = { Lexer::Token::SEMI_COLON, Lexer::Token::LEFT_BRACE, Lexer::Token::RIGHT_BRACE,
+                                             Lexer::Token::RIGHT_BRACKET, Lexer::Token::RIGHT_PAREN, Lexer::Token::COMMA };
     const auto& terminatorsBegin = std::begin(exprTerminators);
     const auto& terminatorsEnd = std::end(exprTerminators);
 
@@ -305,15 +306,18 @@ std::unique_ptr<Expr> Parser::ParseExpr()
         {
             // TODO: Check that it really is an identifier we're trying to index, if not log an error (also unit test this)
             std::unique_ptr<Expr> identExpr{ node.release() };
-            std::unique_ptr<Expr> indexExpr = ParseExpr();
+            mCurrentToken = mLexer.GetNextToken();
             SourceLocation arraySrcLoc = mLexer.GetCurrentLocation();
+            std::unique_ptr<Expr> indexExpr = ParseExpr();
 
-            if (mCurrentToken == Lexer::Token::RIGHT_BRACKET)
+            if ((indexExpr == nullptr) || (mCurrentToken != Lexer::Token::RIGHT_BRACKET))
             {
                 // TODO: Log an error and add a test for it
                 return nullptr;
             }
 
+            // Skip the closing bracket
+            mCurrentToken = mLexer.GetNextToken();
             node.reset(new IndexedExpr(std::move(identExpr), std::move(indexExpr), arraySrcLoc));
         }
         else
@@ -481,8 +485,13 @@ std::unique_ptr<CompoundStmt> Parser::ParseCompoundStmt()
         case Lexer::Token::SLEEP:
             node.reset(ParseSleepStmt().release());
             break;
+        case Lexer::Token::JOIN:
+            node.reset(ParseJoinStmt().release());
+            break;
         case Lexer::Token::SYNC:
             node.reset(new SyncStmt(mLexer.GetCurrentLocation()));
+            // Moving on to the semicolon ending the statement, like the other statements do
+            mCurrentToken = mLexer.GetNextToken();
             break;
         case Lexer::Token::COMMENT:
         case Lexer::Token::ML_COMMENT:
@@ -592,6 +601,23 @@ std::unique_ptr<ScanStmt> Parser::ParseScanStmt()
     return sStmt;
 }
 
+std::unique_ptr<JoinStmt> Parser::ParseJoinStmt()
+{
+    std::unique_ptr<JoinStmt> jStmt = std::make_unique<JoinStmt>();
+
+    mCurrentToken = mLexer.GetNextToken();
+    const SourceLocation srcLoc = mLexer.GetCurrentLocation();
+
+    std::unique_ptr<Expr> handleExpr = ParseExpr();
+
+    if (handleExpr == nullptr)
+        ErrorLogger::PrintErrorAtLocation(ErrorLogger::ErrorType::JOIN_MISSING_HANDLE, mLexer.GetCurrentLocation());
+    else
+        jStmt.reset(new JoinStmt(std::move(handleExpr), srcLoc));
+
+    return jStmt;
+}
+
 std::unique_ptr<SleepStmt> Parser::ParseSleepStmt()
 {
     std::unique_ptr<SleepStmt> sStmt = std::make_unique<SleepStmt>();
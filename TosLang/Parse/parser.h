@@ -17,6 +17,7 @@ namespace TosLang
         class PrintStmt;
         class ReturnStmt;
         class ScanStmt;
+        class JoinStmt;
         class SleepStmt;
         class VarDecl;
         class WhileStmt;
@@ -142,6 +143,13 @@ namespace TosLang
             */
             std::unique_ptr<ScanStmt> ParseScanStmt();
 
+            /*
+            * \fn           ParseJoinStmt
+            * \brief        joinstmt ::= 'join' expr
+            * \return       A node representing a join statement
+            */
+            std::unique_ptr<JoinStmt> ParseJoinStmt();
+
             /*
             * \fn           ParseSleepStmt
             * \brief        sleepstmt ::= 'sleep' expr
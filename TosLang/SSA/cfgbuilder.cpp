@@ -1,3 +1,4 @@
+
 #include "cfgbuilder.h"
 
 #include "ssafunction.h"
@@ -17,6 +18,7 @@ std::unique_ptr<SSAModule> CFGBuilder::Run(const std::unique_ptr<ASTNode>& root,
     // Reset the state of the cfg builder
     mCurrentVarDef.clear();
     mIncompletePHIs.clear();
+    mSealedBlocks.clear();
     mMod.reset(new SSAModule{});
 
     mSymTable = symTable;
@@ -25,6 +27,22 @@ std::unique_ptr<SSAModule> CFGBuilder::Run(const std::unique_ptr<ASTNode>& root,
     return std::move(mMod);
 }
 
+std::unique_ptr<SSAModule> CFGBuilder::Run(const std::vector<const ASTNode*>& fnDecls, const std::shared_ptr<SymbolTable>& symTable)
+{
+    // Reset the state of the cfg builder
+    mCurrentVarDef.clear();
+    mIncompletePHIs.clear();
+    mSealedBlocks.clear();
+    mMod.reset(new SSAModule{});
+
+    mSymTable = symTable;
+
+    for (const ASTNode* fnDecl : fnDecls)
+        HandleFunctionDecl(fnDecl);
+
+    return std::move(mMod);
+}
+
 // Declarations
 void CFGBuilder::HandleProgramDecl(const std::unique_ptr<ASTNode>& root)
 {
@@ -34,9 +52,11 @@ void CFGBuilder::HandleProgramDecl(const std::unique_ptr<ASTNode>& root)
             HandleFunctionDecl(stmt.get());
         else if (stmt->GetKind() == ASTNode::NodeKind::VAR_DECL)
             HandleVarDecl(stmt.get());
+        else if (stmt->GetKind() == ASTNode::NodeKind::ERROR)
+            continue;   // The comments of the global scope leave empty declarations behind
         else
             // Shouldn't happen. If it does, it's because someone forgot to run the scope checker.
-            assert(false && "Unknown declaration in program");  
+            assert(false && "Unknown declaration in program");
     }
 }
 
@@ -44,14 +64,21 @@ void CFGBuilder::HandleFunctionDecl(const ASTNode* decl)
 {
     const FunctionDecl* fDecl = dynamic_cast<const FunctionDecl*>(decl);
     assert(fDecl != nullptr);
-    
+
     // New function declaration so we need to build a new control flow graph
     FuncPtr pFuncPtr = std::make_shared<SSAFunction>();
     mCurrentFunction = pFuncPtr.get();
-    mCurrentBlock = mCurrentFunction->CreateNewBlock().get();
 
     mMod->InsertFunction(fDecl->GetFunctionName(), pFuncPtr);
 
+    // Values are numbered from 0 in each function so that their IDs can be used as register indices
+    mNextID = 0;
+    mRemovedPHIs.clear();
+
+    // Nothing branches to the entry block
+    mCurrentBlock = mCurrentFunction->CreateNewBlock();
+    SealBlock(mCurrentBlock.get());
+
     // Associate each of the function argument with a SSA value
     const ParamVarDecls* paramsDecl = fDecl->GetParametersDecl();
     for (auto& param : paramsDecl->GetParameters())
@@ -65,18 +92,25 @@ void CFGBuilder::HandleFunctionDecl(const ASTNode* decl)
         // TODO: Add type info to the SSA argument
         SSAValue ssaVal{ mNextID++ };
         mCurrentFunction->AddArguments(ssaVal);
-        WriteVariable(paramSymbol, mCurrentBlock, 
-                      mCurrentFunction->GetArgument(mCurrentFunction->GetNbArguments()));
+        WriteVariable(paramSymbol, mCurrentBlock.get(),
+                      mCurrentFunction->GetArgument(mCurrentFunction->GetNbArguments() - 1));
     }
 
     HandleCompoundStmt(fDecl->GetBody());
 
+    // Reaching the end of the function's body returns from it
+    if (!mCurrentBlock->IsTerminated())
+        AddInstruction(SSAInstruction{ SSAInstruction::Operation::RET, mNextID++, mCurrentBlock.get() });
+
+    RemoveTrivialPHIs();
+    mCurrentFunction->SetNbValues(mNextID);
+
     // Removing ties to the function
     mCurrentBlock = nullptr;
     mCurrentFunction = nullptr;
 }
 
-void CFGBuilder::HandleVarDecl(const ASTNode* decl) 
+void CFGBuilder::HandleVarDecl(const ASTNode* decl)
 {
     const VarDecl* vDecl = dynamic_cast<const VarDecl*>(decl);
     assert(vDecl != nullptr);
@@ -85,6 +119,11 @@ void CFGBuilder::HandleVarDecl(const ASTNode* decl)
     if (vDecl->IsFunctionParameter())
         return;
 
+    const Symbol* varSym;
+    bool symFound;
+    std::tie(symFound, varSym) = mSymTable->TryGetSymbol(vDecl);
+    assert(symFound);
+
     // TODO: Deal with global variable
     //const bool isGlobalVar = mSymTable->IsGlobalVariable(vDecl->GetName());
     const Expr* initExpr = vDecl->GetInitExpr();
@@ -95,13 +134,16 @@ void CFGBuilder::HandleVarDecl(const ASTNode* decl)
     {
         const SSAInstruction* initInst = HandleExpr(initExpr);
 
-        const Symbol* varSym;
-        bool symFound;
-        std::tie(symFound, varSym) = mSymTable->TryGetSymbol(vDecl);
-        assert(symFound);
-
         // Generate an assignment to the SSA variable
-        WriteVariable(varSym, mCurrentBlock, initInst->GetReturnValue());
+        WriteVariable(varSym, mCurrentBlock.get(), initInst->GetReturnValue());
+    }
+    else if (mCurrentBlock != nullptr)
+    {
+        // A local variable holds 0 (or false) until it is assigned to
+        SSAInstruction ssaInst{ SSAInstruction::Operation::MOV, mNextID++, mCurrentBlock.get() };
+        ssaInst.AddOperand(SSAValue{ mNextID++, 0 });
+
+        WriteVariable(varSym, mCurrentBlock.get(), AddInstruction(ssaInst)->GetReturnValue());
     }
 }
 
@@ -117,20 +159,17 @@ const SSAInstruction* CFGBuilder::HandleExpr(const Expr* expr)
         const BooleanExpr* bExpr = dynamic_cast<const BooleanExpr*>(expr);
         assert(bExpr != nullptr);
 
-        SSAInstruction ssaInst{ SSAInstruction::Operation::MOV, mNextID++, mCurrentBlock };
+        SSAInstruction ssaInst{ SSAInstruction::Operation::MOV, mNextID++, mCurrentBlock.get() };
         ssaInst.AddOperand(SSAValue{ mNextID++, bExpr->GetValue() });
-        
+
         exprInst = AddInstruction(ssaInst);
-    }        
+    }
         break;
     case ASTNode::NodeKind::BINARY_EXPR:
         exprInst = HandleBinaryExpr(expr);
         break;
     case ASTNode::NodeKind::CALL_EXPR:
-        HandleCallExpr(expr);
-        // Since a function can't be called outside of another function, 
-        // it is safe to get the terminator of the current basic block
-        exprInst = mCurrentBlock->GetTerminator();
+        exprInst = HandleCallExpr(expr);
         break;
     case ASTNode::NodeKind::IDENTIFIER_EXPR:
     {
@@ -139,8 +178,8 @@ const SSAInstruction* CFGBuilder::HandleExpr(const Expr* expr)
         std::tie(symFound, identSym) = mSymTable->TryGetSymbol(expr);
         assert(symFound);
 
-        SSAInstruction ssaInst{ SSAInstruction::Operation::MOV, mNextID++, mCurrentBlock };
-        ssaInst.AddOperand(ReadVariable(identSym, mCurrentBlock));
+        SSAInstruction ssaInst{ SSAInstruction::Operation::MOV, mNextID++, mCurrentBlock.get() };
+        ssaInst.AddOperand(ReadVariable(identSym, mCurrentBlock.get()));
 
         exprInst = AddInstruction(ssaInst);
     }
@@ -150,9 +189,9 @@ const SSAInstruction* CFGBuilder::HandleExpr(const Expr* expr)
         const NumberExpr* nExpr = dynamic_cast<const NumberExpr*>(expr);
         assert(nExpr != nullptr);
 
-        SSAInstruction ssaInst{ SSAInstruction::Operation::MOV, mNextID++, mCurrentBlock };
+        SSAInstruction ssaInst{ SSAInstruction::Operation::MOV, mNextID++, mCurrentBlock.get() };
         ssaInst.AddOperand(SSAValue{ mNextID++, nExpr->GetValue() });
-        
+
         exprInst = AddInstruction(ssaInst);
     }
         break;
@@ -186,7 +225,19 @@ const SSAInstruction* CFGBuilder::HandleBinaryExpr(const ASTNode* expr)
     const BinaryOpExpr* bExpr = dynamic_cast<const BinaryOpExpr*>(expr);
     assert(bExpr != nullptr);
 
-    // TODO: Assignment
+    // An assignment doesn't generate anything by itself: the variable simply takes a new SSA value
+    if (bExpr->GetOperation() == Common::Operation::ASSIGNMENT)
+    {
+        const SSAInstruction* rhsInst = HandleExpr(bExpr->GetRHS());
+
+        bool symFound;
+        const Symbol* varSym;
+        std::tie(symFound, varSym) = mSymTable->TryGetSymbol(bExpr->GetLHS());
+        assert(symFound);
+
+        WriteVariable(varSym, mCurrentBlock.get(), rhsInst->GetReturnValue());
+        return rhsInst;
+    }
 
     // Choose the correct opcode
     SSAInstruction::Operation op = SSAInstruction::Operation::UNKNOWN;
@@ -196,12 +247,12 @@ const SSAInstruction* CFGBuilder::HandleBinaryExpr(const ASTNode* expr)
     case Common::Operation::AND_INT:
         op = SSAInstruction::Operation::AND;
         break;
-    case Common::Operation::ASSIGNMENT:
-        op = SSAInstruction::Operation::MOV;
-        break;
     case Common::Operation::DIVIDE:
         op = SSAInstruction::Operation::DIV;
         break;
+    case Common::Operation::EQUAL:
+        op = SSAInstruction::Operation::EQ;
+        break;
     case Common::Operation::GREATER_THAN:
         op = SSAInstruction::Operation::GT;
         break;
@@ -243,49 +294,47 @@ const SSAInstruction* CFGBuilder::HandleBinaryExpr(const ASTNode* expr)
     // Handle the expression's operands
     const SSAInstruction* lhsInst = HandleExpr(bExpr->GetLHS());
     const SSAInstruction* rhsInst = HandleExpr(bExpr->GetRHS());
-        
-    SSAInstruction ssaInst{ op, mNextID++, mCurrentBlock };
+
+    SSAInstruction ssaInst{ op, mNextID++, mCurrentBlock.get() };
     ssaInst.AddOperand(lhsInst->GetReturnValue());
     ssaInst.AddOperand(rhsInst->GetReturnValue());
 
     // Add the instruction to the program
-    return AddInstruction(ssaInst);    
+    return AddInstruction(ssaInst);
 }
 
-void CFGBuilder::HandleCallExpr(const ASTNode* expr) 
-{ 
+const SSAInstruction* CFGBuilder::HandleCallExpr(const ASTNode* expr)
+{
     const CallExpr* cExpr = dynamic_cast<const CallExpr*>(expr);
     assert(cExpr != nullptr);
 
-    // Generate a call instruction
-    SSAInstruction callInst{ SSAInstruction::Operation::CALL, mNextID++, mCurrentBlock };
+    // Generate a call instruction. The value it produces is the one returned by the callee.
+    SSAInstruction callInst{ SSAInstruction::Operation::CALL, mNextID++, mCurrentBlock.get() };
+    callInst.SetCallee(cExpr->GetCalleeName());
 
     // Add the values of its parameters
     for (const auto& arg : cExpr->GetArgs())
     {
-        const Symbol* argSym;
-        bool symFound;
-        std::tie(symFound, argSym) = mSymTable->TryGetSymbol(arg.get());
-        assert(symFound);
-        callInst.AddOperand(ReadVariable(argSym, mCurrentBlock));
+        const SSAInstruction* argInst = HandleExpr(dynamic_cast<const Expr*>(arg.get()));
+        callInst.AddOperand(argInst->GetReturnValue());
     }
 
-    // TODO: Add a last operand for the return value if necessary
-    
-    mCurrentBlock->InsertInstruction(callInst);
+    return AddInstruction(callInst);
 }
 
 // Statements
-SSABlock* CFGBuilder::HandleCompoundStmt(const CompoundStmt* cStmt)
+void CFGBuilder::HandleCompoundStmt(const CompoundStmt* cStmt)
 {
-    CreateNewCurrentBlock();
-
-    // Keeping a pointer to the first block of the compound statement.
-    // This will be helpful for any caller that wants to link the compound statement with a control structure
-    SSABlock* entryBlock = mCurrentBlock;
-
     for (auto& stmt : cStmt->GetStatements())
     {
+        // Statements following a return can't be reached. They still go in their own block so that
+        // nothing comes after the return in the current one.
+        if (mCurrentBlock->IsTerminated())
+        {
+            mCurrentBlock = mCurrentFunction->CreateNewBlock();
+            SealBlock(mCurrentBlock.get());
+        }
+
         switch (stmt->GetKind())
         {
         case ASTNode::NodeKind::BINARY_EXPR:
@@ -316,8 +365,6 @@ SSABlock* CFGBuilder::HandleCompoundStmt(const CompoundStmt* cStmt)
             break;
         }
     }
-
-    return entryBlock;
 }
 
 void CFGBuilder::HandleIfStmt(const ASTNode* stmt)
@@ -326,38 +373,34 @@ void CFGBuilder::HandleIfStmt(const ASTNode* stmt)
     assert(iStmt != nullptr);
 
     // Generating instructions for the condition expression
-    HandleExpr(iStmt->GetCondExpr());
+    const SSAValue condVal = HandleExpr(iStmt->GetCondExpr())->GetReturnValue();
+
+    // Creating the branch instruction. It goes to the body if the condition holds, else to the exit block.
+    SSABlockPtr condBlock = mCurrentBlock;
+    SSABlockPtr thenBlock = mCurrentFunction->CreateNewBlock();
+    SSABlockPtr exitBlock = mCurrentFunction->CreateNewBlock();
+
+    SSAInstruction brCondInst{ SSAInstruction::Operation::BR, mNextID++, condBlock.get() };
+    brCondInst.AddOperand(condVal);
+    AddInstruction(brCondInst);
+
+    LinkBlocks(condBlock, thenBlock);
+    LinkBlocks(condBlock, exitBlock);
+    SealBlock(thenBlock.get());
 
-    // Keeping a pointer to the condition block for later
-    SSABlock* condBlock = mCurrentBlock;
-    
     // Generating instructions for the if body
-    SSABlock* thenBeginBlock = HandleCompoundStmt(iStmt->GetBody());
-    
-    // Keep a pointer to the current block which correspond to the end of the if body
-    SSABlock* thenEndBlock = mCurrentBlock;
-
-    // Creating the exit block
-    CreateNewCurrentBlock();
-    
-    // Creating the branch instruction
-    SSAInstruction brCondThenInst{ SSAInstruction::Operation::BR, mNextID++, mCurrentBlock };
-    brCondThenInst.AddOperand(condBlock->GetTerminator()->GetReturnValue());
-    condBlock->InsertInstruction(brCondThenInst);
-
-    // Introduce branches to the condition block
-    condBlock->InsertBranch(thenBeginBlock);
-    condBlock->InsertBranch(mCurrentBlock);
-    
-    // Generating a branch instruction from the then (body) end block to the exit block
-    SSAInstruction brThenExitInst{ SSAInstruction::Operation::BR, mNextID++, mCurrentBlock };
-    brCondThenInst.AddOperand(condBlock->GetTerminator()->GetReturnValue());
-    thenEndBlock->InsertInstruction(brCondThenInst);
-
-    // Unconditional branch
-    thenEndBlock->InsertBranch(mCurrentBlock);
-
-    // TODO: Add PHIs to the join block
+    mCurrentBlock = thenBlock;
+    HandleCompoundStmt(iStmt->GetBody());
+
+    // Generating an unconditional branch from the end of the body to the exit block, unless the body returned
+    if (!mCurrentBlock->IsTerminated())
+    {
+        AddInstruction(SSAInstruction{ SSAInstruction::Operation::BR, mNextID++, mCurrentBlock.get() });
+        LinkBlocks(mCurrentBlock, exitBlock);
+    }
+
+    SealBlock(exitBlock.get());
+    mCurrentBlock = exitBlock;
 }
 
 void CFGBuilder::HandlePrintStmt(const ASTNode* stmt)
@@ -365,15 +408,31 @@ void CFGBuilder::HandlePrintStmt(const ASTNode* stmt)
     const PrintStmt* pStmt = dynamic_cast<const PrintStmt*>(stmt);
     assert(pStmt != nullptr);
 
-    // TODO
+    // A string literal is printed as is, it isn't an SSA value
+    const Expr* msgExpr = pStmt->GetMessage();
+    if (msgExpr->GetKind() == ASTNode::NodeKind::STRING_EXPR)
+    {
+        SSAInstruction printInst{ SSAInstruction::Operation::PRINT, mNextID++, mCurrentBlock.get() };
+        printInst.SetMessage(msgExpr->GetName());
+        AddInstruction(printInst);
+        return;
+    }
+
+    // TODO: Other strings aren't lowered yet
+    const SSAInstruction* msgInst = HandleExpr(msgExpr);
+    assert(msgInst != nullptr);
+
+    SSAInstruction printInst{ SSAInstruction::Operation::PRINT, mNextID++, mCurrentBlock.get() };
+    printInst.AddOperand(msgInst->GetReturnValue());
+    AddInstruction(printInst);
 }
 
-void CFGBuilder::HandleReturnStmt(const ASTNode* stmt) 
+void CFGBuilder::HandleReturnStmt(const ASTNode* stmt)
 {
     const ReturnStmt* rStmt = dynamic_cast<const ReturnStmt*>(stmt);
     assert(rStmt != nullptr);
-    
-    SSAInstruction retInst{ SSAInstruction::Operation::RET, mNextID++, mCurrentBlock };
+
+    SSAInstruction retInst{ SSAInstruction::Operation::RET, mNextID++, mCurrentBlock.get() };
 
     const Expr* rExpr = rStmt->GetReturnExpr();
     if (rExpr != nullptr)
@@ -382,7 +441,7 @@ void CFGBuilder::HandleReturnStmt(const ASTNode* stmt)
         retInst.AddOperand(ssaInst->GetReturnValue());
     }
 
-    mCurrentBlock->InsertInstruction(retInst);
+    AddInstruction(retInst);
 }
 
 void CFGBuilder::HandleScanStmt(const ASTNode* stmt)
@@ -398,35 +457,42 @@ void CFGBuilder::HandleWhileStmt(const ASTNode* stmt)
     const WhileStmt* wStmt = dynamic_cast<const WhileStmt*>(stmt);
     assert(wStmt != nullptr);
 
-    // Creating the loop header (condition block)
-    CreateNewCurrentBlock();
+    // Creating the loop header (condition block). It can't be sealed before the end of
+    // the body is known, since the body branches back to it.
+    SSABlockPtr headerBlock = mCurrentFunction->CreateNewBlock();
+    AddInstruction(SSAInstruction{ SSAInstruction::Operation::BR, mNextID++, mCurrentBlock.get() });
+    LinkBlocks(mCurrentBlock, headerBlock);
+    mCurrentBlock = headerBlock;
 
     // Generating instructions for the condition expression
-    HandleExpr(wStmt->GetCondExpr());
+    const SSAValue condVal = HandleExpr(wStmt->GetCondExpr())->GetReturnValue();
 
-    // Keeping a pointer to the header block for later
-    SSABlock* headerBlock = mCurrentBlock;
+    // Creating the branch instruction. It goes to the body if the condition holds, else to the exit block.
+    SSABlockPtr bodyBlock = mCurrentFunction->CreateNewBlock();
+    SSABlockPtr exitBlock = mCurrentFunction->CreateNewBlock();
 
-    // Generating instructions for the while body
-    SSABlock* bodyBeginBlock = HandleCompoundStmt(wStmt->GetBody());
-
-    // Keep a pointer to the current block which correspond to the end of the if body
-    SSABlock* bodyEndBlock = mCurrentBlock;
+    SSAInstruction brHeaderInst{ SSAInstruction::Operation::BR, mNextID++, headerBlock.get() };
+    brHeaderInst.AddOperand(condVal);
+    AddInstruction(brHeaderInst);
 
-    // Creating the exit block (new value of mCurrentBlock)
-    CreateNewCurrentBlock();
+    LinkBlocks(headerBlock, bodyBlock);
+    LinkBlocks(headerBlock, exitBlock);
+    SealBlock(bodyBlock.get());
 
-    // Creating the branch instruction
-    SSAInstruction brHeaderBodyInst{ SSAInstruction::Operation::BR, mNextID++, mCurrentBlock };
-    brHeaderBodyInst.AddOperand(headerBlock->GetTerminator()->GetReturnValue());
-    headerBlock->InsertInstruction(brHeaderBodyInst);
+    // Generating instructions for the while body
+    mCurrentBlock = bodyBlock;
+    HandleCompoundStmt(wStmt->GetBody());
 
-    // Inserts branches going out of the condition block
-    headerBlock->InsertBranch(bodyBeginBlock);
-    headerBlock->InsertBranch(mCurrentBlock);
+    // Going back to the header at the end of the body, unless the body returned
+    if (!mCurrentBlock->IsTerminated())
+    {
+        AddInstruction(SSAInstruction{ SSAInstruction::Operation::BR, mNextID++, mCurrentBlock.get() });
+        LinkBlocks(mCurrentBlock, headerBlock);
+    }
 
-    // Inserts a branch instruction from the body end block to the header block
-    bodyEndBlock->InsertBranch(headerBlock);
+    SealBlock(headerBlock.get());
+    SealBlock(exitBlock.get());
+    mCurrentBlock = exitBlock;
 }
 
 const SSAInstruction* CFGBuilder::AddInstruction(const SSAInstruction& inst)
@@ -442,21 +508,21 @@ const SSAInstruction* CFGBuilder::AddInstruction(const SSAInstruction& inst)
     }
 }
 
-void CFGBuilder::CreateNewCurrentBlock(SSAInstList&& insts)
+void CFGBuilder::LinkBlocks(const SSABlockPtr& from, const SSABlockPtr& to)
 {
-    // An empty block is still good to go
-    if (mCurrentBlock->GetNbInstructions() == 0)
-        return;
-    
-    // Don't create a new block when the current one isn't properly terminated i.e. there's no branch at the end
-    SSAInstruction::Operation lastInstOp = mCurrentBlock->GetTerminator()->GetOperation();
-    if (lastInstOp == SSAInstruction::Operation::BR
-        || lastInstOp == SSAInstruction::Operation::RET)
-        return;
+    from->InsertBranch(to);
+    to->InsertPredecessor(from);
+}
 
-    SSABlockPtr newBlock = mCurrentFunction->CreateNewBlock(std::move(insts));
-    mCurrentBlock->InsertBranch(newBlock);
-    mCurrentBlock = newBlock.get();
+void CFGBuilder::SealBlock(SSABlock* block)
+{
+    // Reading variables to complete the PHIs can't add new incomplete ones in this block once it's sealed
+    auto incompletePHIs = std::move(mIncompletePHIs[block]);
+    mIncompletePHIs.erase(block);
+    mSealedBlocks.insert(block);
+
+    for (auto& incompletePHI : incompletePHIs)
+        AddPHIOperands(incompletePHI.first, incompletePHI.second);
 }
 
 void CFGBuilder::WriteVariable(const Symbol* variable, const SSABlock* block, const SSAValue& value)
@@ -464,7 +530,7 @@ void CFGBuilder::WriteVariable(const Symbol* variable, const SSABlock* block, co
     mCurrentVarDef[variable][block] = value;
 }
 
-SSAValue CFGBuilder::ReadVariable(const Symbol* variable, const SSABlock* block)
+SSAValue CFGBuilder::ReadVariable(const Symbol* variable, SSABlock* block)
 {
     auto varIt = mCurrentVarDef[variable].find(block);
     if (varIt != mCurrentVarDef[variable].end())
@@ -473,31 +539,28 @@ SSAValue CFGBuilder::ReadVariable(const Symbol* variable, const SSABlock* block)
         return ReadVariableRecursive(variable, block);
 }
 
-SSAValue CFGBuilder::ReadVariableRecursive(const Symbol* variable, const SSABlock* block)
+SSAValue CFGBuilder::ReadVariableRecursive(const Symbol* variable, SSABlock* block)
 {
-    SSAInstruction* ssaInst;
     SSAValue ssaVal;
 
-    auto sealedIt = mSealedBlocks.find(block);
-    if (sealedIt != mSealedBlocks.end())
+    if (mSealedBlocks.find(block) == mSealedBlocks.end())
     {
-        // Incomplete CFG
-        mCurrentBlock->InsertInstruction(SSAInstruction{ SSAInstruction::Operation::PHI, mNextID++, mCurrentBlock });
-        ssaInst = mCurrentBlock->GetTerminator();
-        mIncompletePHIs[block][variable] = ssaInst;
+        // Incomplete CFG: the PHI will get its operands once all the predecessors of the block are known
+        SSAInstruction* phi = block->InsertInstructionFront(SSAInstruction{ SSAInstruction::Operation::PHI, mNextID++, block });
+        mIncompletePHIs[block][variable] = phi;
+        ssaVal = phi->GetReturnValue();
     }
-    else if (mCurrentBlock->GetPredecessors().size() == 1)
+    else if (block->GetPredecessors().size() == 1)
     {
         // No PHI needed for a block with a single predecessor
-        ssaVal = ReadVariable(variable, mCurrentBlock->GetPredecessors().front().get());
+        ssaVal = ReadVariable(variable, block->GetPredecessors().front().get());
     }
     else
     {
         // Break potential cycles with operandless PHI
-        mCurrentBlock->InsertInstruction(SSAInstruction{ SSAInstruction::Operation::PHI, mNextID++, mCurrentBlock });
-        ssaInst = mCurrentBlock->GetTerminator();
-        WriteVariable(variable, block, ssaVal);
-        ssaVal = AddPHIOperand(variable, ssaInst);
+        SSAInstruction* phi = block->InsertInstructionFront(SSAInstruction{ SSAInstruction::Operation::PHI, mNextID++, block });
+        WriteVariable(variable, block, phi->GetReturnValue());
+        ssaVal = AddPHIOperands(variable, phi);
     }
 
     WriteVariable(variable, block, ssaVal);
@@ -505,8 +568,9 @@ SSAValue CFGBuilder::ReadVariableRecursive(const Symbol* variable, const SSABloc
     return ssaVal;
 }
 
-SSAValue CFGBuilder::AddPHIOperand(const Symbol* variable, SSAInstruction* phi)
+SSAValue CFGBuilder::AddPHIOperands(const Symbol* variable, SSAInstruction* phi)
 {
+    // The operands are in the same order as the predecessors
     for (auto predIt = phi->GetBlock()->pred_begin(), predEnd = phi->GetBlock()->pred_end(); predIt != predEnd; ++predIt)
         phi->AddOperand(ReadVariable(variable, predIt->get()));
 
@@ -515,35 +579,90 @@ SSAValue CFGBuilder::AddPHIOperand(const Symbol* variable, SSAInstruction* phi)
 
 SSAValue CFGBuilder::TryRemoveTrivialPHI(SSAInstruction* phi)
 {
-    const SSAValue none{};
+    const SSAValue phiVal = phi->GetReturnValue();
     SSAValue same{};
+    bool foundValue = false;
 
     for (auto& op : phi->GetOperands())
     {
-        if ((op == same) || (op == phi->GetReturnValue()))
+        const SSAValue opVal = GetReplacement(op);
+        if ((foundValue && (opVal == same)) || (opVal == phiVal))
             continue;   // Unique value or self-reference
-        if (same != none)
-            return phi->GetReturnValue(); // The phi merges at least two values: not trivial
-        same = op;
+        if (foundValue)
+            return phiVal; // The phi merges at least two values: not trivial
+        same = opVal;
+        foundValue = true;
     }
 
-    // If we are here, it's because phi has been proven trivial and can be 
-    // replaced by the one value it had to decide on
-    SSAInstruction newInst{ SSAInstruction::Operation::MOV, mNextID++, mCurrentBlock };
-    newInst.AddOperand(phi->GetReturnValue());
-    
-    // Reroute all uses of phi to same 
-    for (auto& use : phi->GetUsers())
-        newInst.AddUser(use);
-    
-    // Remove phi
-    SSABlock* block = phi->GetBlock();
-    block->ReplaceInstruction(*phi, newInst);
-    
-    // Try to recursively remove all phi users, which might have become trivial
-    for (auto& use : newInst.GetUsers())
-        if (use->GetOperation() == SSAInstruction::Operation::PHI)
-            TryRemoveTrivialPHI(use);
+    // The phi is in an unreachable block or reads a variable that was never written
+    if (!foundValue)
+        return phiVal;
+
+    // If we are here, it's because phi has been proven trivial and can be replaced by the one value
+    // it had to decide on. Its uses are rerouted once the function is done since they aren't tracked.
+    mRemovedPHIs[phiVal.GetID()] = same;
 
     return same;
 }
+
+void CFGBuilder::RemoveTrivialPHIs()
+{
+    // Removing a phi can make the phis using it trivial
+    bool removedPHI = true;
+    while (removedPHI)
+    {
+        removedPHI = false;
+        for (auto& block : *mCurrentFunction)
+        {
+            for (auto instIt = block->inst_begin(), instEnd = block->inst_end(); instIt != instEnd; ++instIt)
+            {
+                SSAInstruction* inst = instIt->get();
+                if ((inst->GetOperation() == SSAInstruction::Operation::PHI)
+                    && (mRemovedPHIs.find(inst->GetReturnValue().GetID()) == mRemovedPHIs.end())
+                    && (TryRemoveTrivialPHI(inst) != inst->GetReturnValue()))
+                {
+                    removedPHI = true;
+                }
+            }
+        }
+    }
+
+    if (mRemovedPHIs.empty())
+        return;
+
+    for (auto& block : *mCurrentFunction)
+    {
+        std::vector<const SSAInstruction*> deadPHIs;
+        for (auto instIt = block->inst_begin(), instEnd = block->inst_end(); instIt != instEnd; ++instIt)
+        {
+            SSAInstruction* inst = instIt->get();
+            if ((inst->GetOperation() == SSAInstruction::Operation::PHI)
+                && (mRemovedPHIs.find(inst->GetReturnValue().GetID()) != mRemovedPHIs.end()))
+            {
+                deadPHIs.push_back(inst);
+                continue;
+            }
+
+            // Reroute the uses of the removed phis
+            const auto& operands = inst->GetOperands();
+            for (size_t iOp = 0; iOp < operands.size(); ++iOp)
+                inst->ReplaceOperand(iOp, GetReplacement(operands[iOp]));
+        }
+
+        for (const SSAInstruction* phi : deadPHIs)
+            block->RemoveInstruction(phi);
+    }
+}
+
+SSAValue CFGBuilder::GetReplacement(const SSAValue& value) const
+{
+    SSAValue replacement = value;
+
+    if (replacement.GetKind() == SSAValue::ValueKind::LITERAL)
+        return replacement;
+
+    for (auto phiIt = mRemovedPHIs.find(replacement.GetID()); phiIt != mRemovedPHIs.end(); phiIt = mRemovedPHIs.find(replacement.GetID()))
+        replacement = phiIt->second;
+
+    return replacement;
+}
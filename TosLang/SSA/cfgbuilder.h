@@ -8,6 +8,7 @@
 #include <memory>
 #include <set>
 #include <unordered_map>
+#include <vector>
 
 namespace TosLang
 {
@@ -41,13 +42,24 @@ namespace TosLang
         public:
             CFGBuilder()
                 : mNextID{ 0 }, mSymTable{ nullptr },
-                  mCurrentVarDef {}, mIncompletePHIs{}, mMod{ nullptr },
+                  mCurrentVarDef {}, mIncompletePHIs{}, mRemovedPHIs{}, mMod{ nullptr },
                   mCurrentFunction{ nullptr }, mCurrentBlock{ nullptr } { }
 
         public:
             std::unique_ptr<Module<SSAInstruction>> Run(const std::unique_ptr<FrontEnd::ASTNode>& root, 
                                                         const std::shared_ptr<FrontEnd::SymbolTable>& symTable);
 
+            /*
+            * \fn           Run
+            * \brief        Builds the CFGs of some of the functions of a program only. The functions they call
+            *               must be part of the list for the module to be complete.
+            * \param fnDecls    Declarations of the functions to build
+            * \param symTable   Symbol table of the program
+            * \return       Module made of the given functions
+            */
+            std::unique_ptr<Module<SSAInstruction>> Run(const std::vector<const FrontEnd::ASTNode*>& fnDecls,
+                                                        const std::shared_ptr<FrontEnd::SymbolTable>& symTable);
+
         protected:  // Declarations
             void HandleFunctionDecl(const FrontEnd::ASTNode* decl);
             void HandleProgramDecl(const std::unique_ptr<FrontEnd::ASTNode>& root);
@@ -56,17 +68,16 @@ namespace TosLang
         protected:  // Expressions
             const SSAInstruction* HandleExpr(const FrontEnd::Expr* expr);
             const SSAInstruction* HandleBinaryExpr(const FrontEnd::ASTNode* expr);
-            void HandleCallExpr(const FrontEnd::ASTNode* expr);
+            const SSAInstruction* HandleCallExpr(const FrontEnd::ASTNode* expr);
 
         protected:  // Statements
             /*
             * \fn           HandleCompoundStmt
-            * \brief        Creates basic blocks form a compound statement AST node. When this function is done, 
-            *               mCurrentBlock points at the last block generated.
+            * \brief        Generates the instructions of a compound statement AST node, starting in the current block. 
+            *               When this function is done, mCurrentBlock points at the last block generated.
             * \param cStmt  Compound statement AST node
-            * \return       Pointer to the first block of the statement
             */
-            SSABlock* HandleCompoundStmt(const FrontEnd::CompoundStmt* cStmt);
+            void HandleCompoundStmt(const FrontEnd::CompoundStmt* cStmt);
             
             void HandleIfStmt(const FrontEnd::ASTNode* stmt);
             void HandlePrintStmt(const FrontEnd::ASTNode* stmt);
@@ -76,46 +87,79 @@ namespace TosLang
 
         private:
             /*
-            * TODO
+            * \fn           AddInstruction
+            * \brief        Appends an instruction to the current block, or to the module's global block
+            *               when outside of a function
+            * \param inst   Instruction to be added
+            * \return       Instruction added
             */
             const SSAInstruction* AddInstruction(const SSAInstruction& inst);
 
             /*
-            * \fn           CreateNewCurrentBlock
-            * \brief        Creates a new basic block. It then adds it to the current CFG by linking it with the previous current block. 
-            *               This will change mCurrentBlock so that it will now points to the newly created block.
-            * \param insts  Instructions to be inserted in the new current block
+            * \fn           LinkBlocks
+            * \brief        Adds an edge between two blocks of the current CFG
+            * \param from   Block the edge goes out of
+            * \param to     Block the edge goes into
+            */
+            void LinkBlocks(const SSABlockPtr& from, const SSABlockPtr& to);
+
+            /*
+            * \fn           SealBlock
+            * \brief        Indicates that no other predecessors will be added to a block. This completes the PHIs
+            *               that were added to the block while its predecessors were still unknown.
+            * \param block  Block to seal
             */
-            void CreateNewCurrentBlock(SSAInstList&& insts = SSAInstList{});
+            void SealBlock(SSABlock* block);
 
             /*
-            * TODO
+            * \fn           WriteVariable
+            * \brief        Records the value a variable holds at the end of a block
+            * \param variable   Symbol of the variable
+            * \param block  Block in which the variable is written
+            * \param value  Value given to the variable
             */
-            void WriteVariable(const FrontEnd::Symbol* varNode, const SSABlock* block, const SSAValue& value);
+            void WriteVariable(const FrontEnd::Symbol* variable, const SSABlock* block, const SSAValue& value);
 
             /*
-            * TODO
+            * \fn           ReadVariable
+            * \brief        Gets the value a variable holds at the end of a block, adding PHIs if it comes from predecessors
+            * \param variable   Symbol of the variable
+            * \param block  Block in which the variable is read
+            * \return       Value of the variable
             */
-            SSAValue ReadVariable(const FrontEnd::Symbol* variable, const SSABlock* block);
+            SSAValue ReadVariable(const FrontEnd::Symbol* variable, SSABlock* block);
+
+            SSAValue ReadVariableRecursive(const FrontEnd::Symbol* variable, SSABlock* block);
+            SSAValue AddPHIOperands(const FrontEnd::Symbol* variable, SSAInstruction* phi);
 
             /*
-            * TODO
+            * \fn           TryRemoveTrivialPHI
+            * \brief        Checks if a PHI only merges a single value (besides itself). If so, the PHI is
+            *               replaced by that value.
+            * \param phi    PHI instruction
+            * \return       Value replacing the PHI, or the value of the PHI if it isn't trivial
             */
-            SSAValue ReadVariableRecursive(const FrontEnd::Symbol* variable, const SSABlock* block);
+            SSAValue TryRemoveTrivialPHI(SSAInstruction* phi);
 
             /*
-            * TODO
+            * \fn           RemoveTrivialPHIs
+            * \brief        Removes the PHIs of the current function that were found to be trivial and redirects their
+            *               uses to the values that replace them. Removing PHIs can make others trivial, so this is
+            *               repeated until there's nothing left to remove.
             */
-            SSAValue AddPHIOperand(const FrontEnd::Symbol* variable, SSAInstruction* phi);
+            void RemoveTrivialPHIs();
 
             /*
-            * TODO
+            * \fn           GetReplacement
+            * \brief        Gets the value to use in place of a value that might be a removed PHI
+            * \param value  Value to look up
+            * \return       Value to use
             */
-            SSAValue TryRemoveTrivialPHI(SSAInstruction* phi);
+            SSAValue GetReplacement(const SSAValue& value) const;
             
         private:
             using CurrentVarDef = std::unordered_map<const FrontEnd::Symbol*, std::unordered_map<const SSABlock*, SSAValue>>;
-            using PHIMapping = std::unordered_map<const SSABlock*, std::unordered_map<const FrontEnd::Symbol*, const SSAInstruction*>>;
+            using PHIMapping = std::unordered_map<const SSABlock*, std::unordered_map<const FrontEnd::Symbol*, SSAInstruction*>>;
 
             // TODO: Once experimenting is done, use more carefully chosen data structures
         private:
@@ -124,10 +168,11 @@ namespace TosLang
 
             CurrentVarDef mCurrentVarDef;                       /*!< Mapping indicating the latest value taken by a variable in a given block */
             PHIMapping mIncompletePHIs;                         /*!< Mapping indicating the incomplete phi nodes in a given block */
+            std::unordered_map<size_t, SSAValue> mRemovedPHIs;  /*!< Value of each trivial PHI of the current function to the value replacing it */
             
             std::unique_ptr<SSAModule> mMod;                    /*!< Translation unit being built out of the AST */
             SSAFunction* mCurrentFunction;                      /*!< Current function being built */
-            SSABlock* mCurrentBlock;                            /*!< Current basic block being written to */
+            SSABlockPtr mCurrentBlock;                          /*!< Current basic block being written to */
 
             std::set<const SSABlock*> mSealedBlocks;            /*!< Blocks for which no other predecessors will be added */
         };
@@ -38,6 +38,14 @@ namespace TosLang
             */
             SSAValue& GetArgument(const size_t idx) { assert(idx < mArguments.size()); return mArguments[idx]; }
 
+            /*
+            * \fn           GetArgument
+            * \brief        Fetch the argument at the given index
+            * \param idx    Index of the argument
+            * \return       Function argument
+            */
+            const SSAValue& GetArgument(const size_t idx) const { assert(idx < mArguments.size()); return mArguments[idx]; }
+
             /*
             * \fn           GetNbArguments
             * \brief        Gets the number of arguments of the function
@@ -45,8 +53,23 @@ namespace TosLang
             */
             size_t GetNbArguments() const { return mArguments.size(); }
 
+            /*
+            * \fn           GetNbValues
+            * \brief        Gets the number of values defined in the function. Value IDs go from 0 to this number.
+            * \return       Number of values defined in the function
+            */
+            size_t GetNbValues() const { return mNbValues; }
+
+            /*
+            * \fn           SetNbValues
+            * \brief        Sets the number of values defined in the function
+            * \param nb     Number of values defined in the function
+            */
+            void SetNbValues(const size_t nb) { mNbValues = nb; }
+
         private:
             std::vector<SSAValue> mArguments;   /*!< Function's arguments */
+            size_t mNbValues = 0;               /*!< Number of values defined in the function */
         };
     }
 }
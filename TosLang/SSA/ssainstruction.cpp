@@ -18,6 +18,7 @@ std::string OperationToStr(const SSAInstruction::Operation& operation)
     case SSAInstruction::Operation::SUB: return "SUB";
     case SSAInstruction::Operation::GT: return "GT";
     case SSAInstruction::Operation::LT: return "LT";
+    case SSAInstruction::Operation::EQ: return "EQ";
     case SSAInstruction::Operation::AND: return "AND";
     case SSAInstruction::Operation::OR: return "OR";
     case SSAInstruction::Operation::XOR: return "XOR";
@@ -28,6 +29,7 @@ std::string OperationToStr(const SSAInstruction::Operation& operation)
     case SSAInstruction::Operation::MOD: return "MOD";
     case SSAInstruction::Operation::NOT: return "NOT";
     case SSAInstruction::Operation::NEG: return "NEG";
+    case SSAInstruction::Operation::PRINT: return "PRINT";
     }
 
     return "UNKNOWN";
@@ -37,6 +39,12 @@ std::ostream& TosLang::BackEnd::operator<<(std::ostream& stream, const SSAInstru
 {
     stream << OperationToStr(ssaInst.mOp) << " ";
 
+    if (!ssaInst.mCallee.empty())
+        stream << ssaInst.mCallee << ", ";
+
+    if (!ssaInst.mMessage.empty())
+        stream << '"' << ssaInst.mMessage << "\", ";
+
     for (const auto& operand : ssaInst.mOperands)
         stream << operand << ", ";
 
@@ -51,5 +59,7 @@ bool TosLang::BackEnd::operator==(const SSAInstruction& lhsInst, const SSAInstru
         && lhsInst.mOp == rhsInst.mOp
         && lhsInst.mVal == rhsInst.mVal
         && lhsInst.mOperands == rhsInst.mOperands
+        && lhsInst.mCallee == rhsInst.mCallee
+        && lhsInst.mMessage == rhsInst.mMessage
         && lhsInst.mUsers == rhsInst.mUsers;
 }
@@ -4,6 +4,7 @@
 #include "ssavalue.h"
 
 #include <cassert>
+#include <string>
 #include <vector>
 
 namespace TosLang
@@ -20,7 +21,11 @@ namespace TosLang
         {
         public:
             /*
-            * TODO
+            * \enum  Operation
+            * \brief Operations an instruction can do. A BR with a condition operand goes to the first successor
+            *        of its block when the condition holds and to the second one otherwise, while a BR without
+            *        operand goes to the first successor. The operands of a PHI follow the order of the
+            *        predecessors of its block.
             */
             enum class Operation
             {
@@ -33,6 +38,7 @@ namespace TosLang
                 SUB,
                 GT,
                 LT,
+                EQ,
                 AND,
                 OR,
                 XOR,
@@ -43,6 +49,7 @@ namespace TosLang
                 MOD,
                 NOT,
                 NEG,
+                PRINT,
                 UNKNOWN,
             };
 
@@ -61,6 +68,13 @@ namespace TosLang
             */
             Operation GetOperation() const { return mOp; }
 
+            /*
+            * \fn       IsTerminator
+            * \brief    Indicates if the instruction transfers the control out of its block
+            * \return   True for branches and returns, else false
+            */
+            bool IsTerminator() const { return (mOp == Operation::BR) || (mOp == Operation::RET); }
+
             /*
             * TODO
             */
@@ -71,6 +85,14 @@ namespace TosLang
             */
             void AddOperand(SSAValue val) { mOperands.push_back(val); }
 
+            /*
+            * \fn           ReplaceOperand
+            * \brief        Replaces one of the instruction's operands
+            * \param idx    Index of the operand
+            * \param val    New value of the operand
+            */
+            void ReplaceOperand(size_t idx, SSAValue val) { assert(idx < mOperands.size()); mOperands[idx] = val; }
+
             /*
             * TODO
             */
@@ -91,12 +113,43 @@ namespace TosLang
             */
             void AddUser(SSAInstruction* user) { mUsers.push_back(user); }
 
+            /*
+            * \fn           GetCallee
+            * \brief        Gives access to the name of the function called by a CALL instruction
+            * \return       Name of the called function
+            */
+            const std::string& GetCallee() const { return mCallee; }
+
+            /*
+            * \fn           SetCallee
+            * \brief        Sets the name of the function called by a CALL instruction
+            * \param name   Name of the called function
+            */
+            void SetCallee(const std::string& name) { mCallee = name; }
+
+            /*
+            * \fn           GetMessage
+            * \brief        Gives access to the text printed by a PRINT instruction without operand
+            * \return       String literal to print
+            */
+            const std::string& GetMessage() const { return mMessage; }
+
+            /*
+            * \fn           SetMessage
+            * \brief        Sets the text printed by a PRINT instruction. String literals aren't SSA values,
+            *               the instruction carries them instead of taking an operand.
+            * \param msg    String literal to print
+            */
+            void SetMessage(const std::string& msg) { mMessage = msg; }
+
         private:
             Operation mOp;
             BasicBlock<SSAInstruction>* mBlock;     /*!< Block containing the instruction */
             std::vector<SSAValue> mOperands;        /*!< Operands of the instructions */
             std::vector<SSAInstruction*> mUsers;    /*!< Others instructions using the value produced by this instruction */
             SSAValue mVal;                          /*!< Value produced by the instruction */
+            std::string mCallee;                    /*!< Function called, for CALL instructions */
+            std::string mMessage;                   /*!< Text printed, for PRINT instructions without operand */
         };
     
         std::ostream& operator<<(std::ostream& stream, const SSAInstruction& op);
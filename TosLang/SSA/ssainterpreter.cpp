@@ -0,0 +1,188 @@
+#include "ssainterpreter.h"
+
+#include <algorithm>
+#include <cassert>
+
+using namespace TosLang::BackEnd;
+
+bool SSAInterpreter::Load(const SSAModule& module)
+{
+    mFunctions.clear();
+    mCallees.clear();
+
+    for (const auto& fn : module)
+        mFunctions[fn.first] = static_cast<const SSAFunction*>(fn.second.get());
+
+    // Calls are resolved once and for all so that executing them doesn't involve looking up the callee by name
+    for (const auto& fn : mFunctions)
+    {
+        for (const auto& block : *fn.second)
+        {
+            for (auto instIt = block->inst_begin(), instEnd = block->inst_end(); instIt != instEnd; ++instIt)
+            {
+                const SSAInstruction* inst = instIt->get();
+                if (inst->GetOperation() != SSAInstruction::Operation::CALL)
+                    continue;
+
+                auto calleeIt = mFunctions.find(inst->GetCallee());
+                if (calleeIt == mFunctions.end())
+                    return false;
+
+                mCallees[inst] = calleeIt->second;
+            }
+        }
+    }
+
+    return true;
+}
+
+int SSAInterpreter::Call(const std::string& fnName, const std::vector<int>& args)
+{
+    auto fnIt = mFunctions.find(fnName);
+    assert(fnIt != mFunctions.end());
+
+    return Execute(fnIt->second, args);
+}
+
+int SSAInterpreter::Execute(const SSAFunction* fn, const std::vector<int>& args)
+{
+    assert(args.size() == fn->GetNbArguments());
+
+    // Value IDs are dense, they directly index the function's registers
+    std::vector<int> registers(fn->GetNbValues(), 0);
+    for (size_t iArg = 0; iArg < args.size(); ++iArg)
+        registers[fn->GetArgument(iArg).GetID()] = args[iArg];
+
+    // A call whose value is directly returned takes the place of the current function, its arguments wait here
+    const SSAFunction* tailCallee = nullptr;
+    std::vector<int> tailArgs;
+
+    auto readValue = [&registers](const SSAValue& val)
+    {
+        return (val.GetKind() == SSAValue::ValueKind::LITERAL) ? val.GetLiteral() : registers[val.GetID()];
+    };
+
+    const SSABlock* block = fn->GetEntryBlock().get();
+    const SSABlock* predBlock = nullptr;
+    std::vector<int> phiValues;
+
+    while (true)
+    {
+        auto instIt = block->inst_begin();
+        const auto instEnd = block->inst_end();
+
+        // Resolve the PHIs for the edge just taken. They are all read before any of them is written
+        // since a PHI can use the value another one had when leaving the predecessor.
+        auto phiEnd = instIt;
+        while ((phiEnd != instEnd) && ((*phiEnd)->GetOperation() == SSAInstruction::Operation::PHI))
+            ++phiEnd;
+
+        if ((predBlock != nullptr) && (instIt != phiEnd))
+        {
+            const auto& preds = block->GetPredecessors();
+            auto predIt = std::find_if(preds.begin(), preds.end(), [predBlock](const SSABlockPtr& pred) { return pred.get() == predBlock; });
+            assert(predIt != preds.end());
+            const size_t predIdx = std::distance(preds.begin(), predIt);
+
+            phiValues.clear();
+            for (auto phiIt = instIt; phiIt != phiEnd; ++phiIt)
+                phiValues.push_back(readValue((*phiIt)->GetOperands()[predIdx]));
+
+            for (size_t iPhi = 0; instIt != phiEnd; ++instIt, ++iPhi)
+                registers[(*instIt)->GetReturnValue().GetID()] = phiValues[iPhi];
+        }
+        instIt = phiEnd;
+
+        const SSABlock* nextBlock = nullptr;
+        for (; (instIt != instEnd) && (nextBlock == nullptr) && (tailCallee == nullptr); ++instIt)
+        {
+            const SSAInstruction& inst = **instIt;
+            const std::vector<SSAValue>& ops = inst.GetOperands();
+            int& dest = registers[inst.GetReturnValue().GetID()];
+
+            switch (inst.GetOperation())
+            {
+            case SSAInstruction::Operation::MOV:    dest = readValue(ops[0]);                           break;
+            case SSAInstruction::Operation::ADD:    dest = readValue(ops[0]) + readValue(ops[1]);       break;
+            case SSAInstruction::Operation::SUB:    dest = readValue(ops[0]) - readValue(ops[1]);       break;
+            case SSAInstruction::Operation::MUL:    dest = readValue(ops[0]) * readValue(ops[1]);       break;
+            case SSAInstruction::Operation::DIV:    dest = readValue(ops[0]) / readValue(ops[1]);       break;
+            case SSAInstruction::Operation::MOD:    dest = readValue(ops[0]) % readValue(ops[1]);       break;
+            case SSAInstruction::Operation::GT:     dest = readValue(ops[0]) > readValue(ops[1]);       break;
+            case SSAInstruction::Operation::LT:     dest = readValue(ops[0]) < readValue(ops[1]);       break;
+            case SSAInstruction::Operation::EQ:     dest = readValue(ops[0]) == readValue(ops[1]);      break;
+            case SSAInstruction::Operation::AND:    dest = readValue(ops[0]) & readValue(ops[1]);       break;
+            case SSAInstruction::Operation::OR:     dest = readValue(ops[0]) | readValue(ops[1]);       break;
+            case SSAInstruction::Operation::XOR:    dest = readValue(ops[0]) ^ readValue(ops[1]);       break;
+            case SSAInstruction::Operation::LSHIFT: dest = readValue(ops[0]) << readValue(ops[1]);      break;
+            case SSAInstruction::Operation::RSHIFT: dest = readValue(ops[0]) >> readValue(ops[1]);      break;
+            case SSAInstruction::Operation::NOT:    dest = !readValue(ops.back());                      break;
+            case SSAInstruction::Operation::NEG:    dest = -readValue(ops[0]);                          break;
+            case SSAInstruction::Operation::CALL:
+            {
+                std::vector<int> callArgs;
+                callArgs.reserve(ops.size());
+                for (const auto& op : ops)
+                    callArgs.push_back(readValue(op));
+
+                // A tail call reuses the current registers instead of nesting on the host stack
+                auto nextIt = std::next(instIt);
+                if ((nextIt != instEnd) && ((*nextIt)->GetOperation() == SSAInstruction::Operation::RET)
+                    && !(*nextIt)->GetOperands().empty() && ((*nextIt)->GetOperands()[0] == inst.GetReturnValue()))
+                {
+                    tailCallee = mCallees.at(&inst);
+                    tailArgs = std::move(callArgs);
+                    break;
+                }
+
+                // The callee's registers are its own, dest is still valid when it returns
+                dest = Execute(mCallees.at(&inst), callArgs);
+                break;
+            }
+            case SSAInstruction::Operation::PRINT:
+                if (ops.empty())
+                    mOutput << inst.GetMessage() << std::endl;
+                else
+                    mOutput << readValue(ops[0]) << std::endl;
+                break;
+            case SSAInstruction::Operation::RET:
+                return ops.empty() ? 0 : readValue(ops[0]);
+            case SSAInstruction::Operation::BR:
+                // Without a condition, or when it holds, the branch goes to the first successor
+                if (ops.empty() || (readValue(ops[0]) != 0))
+                    nextBlock = block->GetSuccessors()[0].get();
+                else
+                    nextBlock = block->GetSuccessors()[1].get();
+                break;
+            default:
+                assert(false && "Unexpected SSA instruction");  // PHIs only appear at the beginning of a block
+                break;
+            }
+        }
+
+        if (tailCallee != nullptr)
+        {
+            fn = tailCallee;
+            registers.assign(fn->GetNbValues(), 0);
+            for (size_t iArg = 0; iArg < tailArgs.size(); ++iArg)
+                registers[fn->GetArgument(iArg).GetID()] = tailArgs[iArg];
+
+            tailCallee = nullptr;
+            predBlock = nullptr;
+            block = fn->GetEntryBlock().get();
+            continue;
+        }
+
+        // A block that isn't terminated falls through to its successor, if it has one
+        if (nextBlock == nullptr)
+        {
+            if (block->GetSuccessors().empty())
+                return 0;
+
+            nextBlock = block->GetSuccessors().front().get();
+        }
+
+        predBlock = block;
+        block = nextBlock;
+    }
+}
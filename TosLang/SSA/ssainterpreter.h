@@ -0,0 +1,61 @@
+#ifndef SSA_INTERPRETER_H__TOSTITOS
+#define SSA_INTERPRETER_H__TOSTITOS
+
+#include "cfgbuilder.h"
+
+#include <iostream>
+#include <string>
+#include <unordered_map>
+#include <vector>
+
+namespace TosLang
+{
+    namespace BackEnd
+    {
+        /*
+        * \class SSAInterpreter
+        * \brief Executes the SSA form of a program, as produced by the CFGBuilder. Every function gets a register
+        *        file indexed by the IDs of its values, which are dense. The PHIs at the beginning of a block are
+        *        resolved all at once when the control enters the block, using the operand matching the edge taken.
+        *        All values are integers, booleans being 0 or 1.
+        */
+        class SSAInterpreter
+        {
+        public:
+            /*
+            * \fn           SSAInterpreter
+            * \brief        Ctor
+            * \param output Stream on which the program prints
+            */
+            explicit SSAInterpreter(std::ostream& output = std::cout) : mOutput(output), mFunctions{}, mCallees{} { }
+
+        public:
+            /*
+            * \fn           Load
+            * \brief        Prepares the functions of a module for execution. The module must outlive the interpreter.
+            * \param module Module to execute
+            * \return       True if every called function exists in the module, else false
+            */
+            bool Load(const SSAModule& module);
+
+            /*
+            * \fn           Call
+            * \brief        Executes a function of the loaded module
+            * \param fnName Name of the function
+            * \param args   Values of the arguments
+            * \return       Value returned by the function, 0 if it doesn't return anything
+            */
+            int Call(const std::string& fnName, const std::vector<int>& args);
+
+        private:
+            int Execute(const SSAFunction* fn, const std::vector<int>& args);
+
+        private:
+            std::ostream& mOutput;                                                          /*!< Stream on which the program prints */
+            std::unordered_map<std::string, const SSAFunction*> mFunctions;                 /*!< Functions of the module */
+            std::unordered_map<const SSAInstruction*, const SSAFunction*> mCallees;         /*!< Function called by each CALL instruction */
+        };
+    }
+}
+
+#endif // SSA_INTERPRETER_H__TOSTITOS
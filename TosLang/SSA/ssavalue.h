@@ -24,9 +24,9 @@ namespace TosLang
             };
 
         public:
-            SSAValue() : mKind{ ValueKind::UNKNOWN }, mID{ 0 }, mLitVal{ 0 } { }
-            SSAValue(size_t id) : mKind{ ValueKind::ARGUMENT }, mID{ id }, mLitVal{ 0 } { }
-            SSAValue(size_t id, int constVal) : mKind{ ValueKind::LITERAL }, mID{ id }, mLitVal{ constVal } { }
+            SSAValue() : mKind{ ValueKind::UNKNOWN }, mID{ 0 }, mLitVal{ 0 }, mDef{ nullptr } { }
+            SSAValue(size_t id) : mKind{ ValueKind::ARGUMENT }, mID{ id }, mLitVal{ 0 }, mDef{ nullptr } { }
+            SSAValue(size_t id, int constVal) : mKind{ ValueKind::LITERAL }, mID{ id }, mLitVal{ constVal }, mDef{ nullptr } { }
             virtual ~SSAValue() = default;
 
         public:
@@ -34,6 +34,29 @@ namespace TosLang
             friend bool operator==(const SSAValue& lhsVal, const SSAValue& rhsVal);
             friend bool operator!=(const SSAValue& lhsVal, const SSAValue& rhsVal);
 
+        public:
+            /*
+            * \fn       GetKind
+            * \brief    Indicates what kind of value this is
+            * \return   Kind of the value
+            */
+            ValueKind GetKind() const { return mKind; }
+
+            /*
+            * \fn       GetID
+            * \brief    Gives access to the ID of the value. IDs are dense within a function, 
+            *           which makes them usable as register indices.
+            * \return   ID of the value
+            */
+            size_t GetID() const { return mID; }
+
+            /*
+            * \fn       GetLiteral
+            * \brief    Gives access to the constant held by a literal value
+            * \return   Constant value
+            */
+            int GetLiteral() const { return mLitVal; }
+
         protected:
             ValueKind mKind;
             size_t mID;
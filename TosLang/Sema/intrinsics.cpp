@@ -0,0 +1,67 @@
+#include "intrinsics.h"
+
+#include "../AST/declarations.h"
+
+#include <string>
+#include <utility>
+
+using namespace TosLang::FrontEnd;
+using namespace TosLang::Common;
+
+namespace
+{
+    struct IntrinsicSignature
+    {
+        IntrinsicID id;
+        const char* name;
+        Type returnType;
+        std::vector<std::pair<const char*, Type>> params;
+    };
+
+    const std::vector<IntrinsicSignature>& GetSignatures()
+    {
+        static const std::vector<IntrinsicSignature> Signatures
+        {
+            { IntrinsicID::VADD,        "vadd",         Type::NUMBER_ARRAY, { { "lhs", Type::NUMBER_ARRAY }, { "rhs", Type::NUMBER_ARRAY } } },
+            { IntrinsicID::VSUB,        "vsub",         Type::NUMBER_ARRAY, { { "lhs", Type::NUMBER_ARRAY }, { "rhs", Type::NUMBER_ARRAY } } },
+            { IntrinsicID::VMUL,        "vmul",         Type::NUMBER_ARRAY, { { "lhs", Type::NUMBER_ARRAY }, { "rhs", Type::NUMBER_ARRAY } } },
+            { IntrinsicID::VSUM,        "vsum",         Type::NUMBER,       { { "arr", Type::NUMBER_ARRAY } } },
+            { IntrinsicID::VMIN,        "vmin",         Type::NUMBER,       { { "arr", Type::NUMBER_ARRAY } } },
+            { IntrinsicID::VMAX,        "vmax",         Type::NUMBER,       { { "arr", Type::NUMBER_ARRAY } } },
+            { IntrinsicID::VDOT,        "vdot",         Type::NUMBER,       { { "lhs", Type::NUMBER_ARRAY }, { "rhs", Type::NUMBER_ARRAY } } },
+            { IntrinsicID::VFILL,       "vfill",        Type::NUMBER_ARRAY, { { "arr", Type::NUMBER_ARRAY }, { "val", Type::NUMBER } } },
+            { IntrinsicID::POPCOUNT,    "popcount",     Type::NUMBER,       { { "arr", Type::BOOL_ARRAY } } },
+            { IntrinsicID::FINDFIRST,   "findfirst",    Type::NUMBER,       { { "arr", Type::BOOL_ARRAY } } },
+        };
+
+        return Signatures;
+    }
+}
+
+Intrinsics::Intrinsics() : mDeclNodes{}, mDecls{}, mIDs{}
+{
+    // The declarations have no source location and an empty body, they are never visited
+    for (const IntrinsicSignature& sig : GetSignatures())
+    {
+        std::unique_ptr<ParamVarDecls> params = std::make_unique<ParamVarDecls>();
+        for (const auto& param : sig.params)
+            params->AddParameter(std::make_unique<VarDecl>(param.first, param.second, true, 0, Utils::SourceLocation{}));
+
+        mDeclNodes.push_back(std::make_unique<FunctionDecl>(sig.name, sig.returnType, std::move(params),
+                                                            std::make_unique<CompoundStmt>(), Utils::SourceLocation{}));
+        mDecls.push_back(mDeclNodes.back().get());
+        mIDs[mDeclNodes.back().get()] = sig.id;
+    }
+}
+
+Intrinsics& Intrinsics::GetInstance()
+{
+    static Intrinsics Instance;
+    return Instance;
+}
+
+IntrinsicID Intrinsics::GetID(const ASTNode* fnDecl) const
+{
+    auto idIt = mIDs.find(fnDecl);
+    return idIt != mIDs.end() ? idIt->second : IntrinsicID::NONE;
+}
@@ -0,0 +1,78 @@
+#ifndef INTRINSICS_H__TOSTITOS
+#define INTRINSICS_H__TOSTITOS
+
+#include <memory>
+#include <unordered_map>
+#include <vector>
+
+namespace TosLang
+{
+    namespace FrontEnd
+    {
+        class ASTNode;
+        class FunctionDecl;
+
+        /*
+        * \enum  IntrinsicID
+        * \brief Built-in functions working on whole arrays
+        */
+        enum class IntrinsicID
+        {
+            NONE,
+
+            // Integer arrays
+            VADD,       // fn vadd(lhs: Int[], rhs: Int[]) -> Int[]
+            VSUB,       // fn vsub(lhs: Int[], rhs: Int[]) -> Int[]
+            VMUL,       // fn vmul(lhs: Int[], rhs: Int[]) -> Int[]
+            VSUM,       // fn vsum(arr: Int[]) -> Int
+            VMIN,       // fn vmin(arr: Int[]) -> Int
+            VMAX,       // fn vmax(arr: Int[]) -> Int
+            VDOT,       // fn vdot(lhs: Int[], rhs: Int[]) -> Int
+            VFILL,      // fn vfill(arr: Int[], val: Int) -> Int[]
+
+            // Boolean arrays
+            POPCOUNT,   // fn popcount(arr: Bool[]) -> Int
+            FINDFIRST,  // fn findfirst(arr: Bool[]) -> Int
+        };
+
+        /*
+        * \class Intrinsics
+        * \brief Declarations of the built-in functions. They don't appear in the program's AST, the symbol collector
+        *        adds them to every symbol table so that calls to them go through the overload resolution like any
+        *        other call. The runtime then recognizes their declaration and runs them natively.
+        */
+        class Intrinsics
+        {
+        public:
+            static Intrinsics& GetInstance();
+
+        public:
+            /*
+            * \fn       GetDecls
+            * \brief    Gets the declarations of every built-in function
+            * \return   Declarations of the built-in functions
+            */
+            const std::vector<const FunctionDecl*>& GetDecls() const { return mDecls; }
+
+            /*
+            * \fn           GetID
+            * \brief        Gets which built-in function a function declaration is
+            * \param fnDecl Function declaration node
+            * \return       Built-in function declared, NONE if it's a function of the program
+            */
+            IntrinsicID GetID(const ASTNode* fnDecl) const;
+
+        private:
+            Intrinsics();
+            Intrinsics(const Intrinsics&) = delete;
+            void operator=(const Intrinsics&) = delete;
+
+        private:
+            std::vector<std::unique_ptr<FunctionDecl>> mDeclNodes;          /*!< Synthetic declaration nodes */
+            std::vector<const FunctionDecl*> mDecls;                        /*!< Declarations, in the same order as the nodes */
+            std::unordered_map<const ASTNode*, IntrinsicID> mIDs;           /*!< Built-in function of each declaration */
+        };
+    }
+}
+
+#endif // INTRINSICS_H__TOSTITOS
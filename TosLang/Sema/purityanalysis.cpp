@@ -0,0 +1,107 @@
+#include "purityanalysis.h"
+
+#include "intrinsics.h"
+#include "symboltable.h"
+
+#include "../AST/declarations.h"
+
+using namespace TosLang::FrontEnd;
+using namespace TosLang::Common;
+
+size_t PurityAnalysis::Run(const std::unique_ptr<ASTNode>& root, const std::shared_ptr<SymbolTable>& symTab)
+{
+    mSymbolTable = symTab;
+    mPureFunctions.clear();
+
+    if (root == nullptr)
+        return 0;
+
+    // First, we look for the functions that have no side effects of their own
+    CalleesMap fnCallees;
+    for (const auto& decl : root->GetChildrenNodes())
+    {
+        if (decl->GetKind() != ASTNode::NodeKind::FUNCTION_DECL)
+            continue;
+
+        const FunctionDecl* fDecl = static_cast<const FunctionDecl*>(decl.get());
+
+        std::vector<const ASTNode*> callees;
+        if (CollectCallees(fDecl->GetBody(), callees))
+        {
+            mPureFunctions.insert(fDecl);
+            fnCallees[fDecl] = std::move(callees);
+        }
+    }
+
+    // Then, we remove the functions calling an impure function until nothing changes. Starting from the 
+    // optimistic assumption that every candidate is pure is what allows recursive functions to be proven pure.
+    bool changed = true;
+    while (changed)
+    {
+        changed = false;
+        for (const auto& fnCallee : fnCallees)
+        {
+            if (!IsPure(fnCallee.first))
+                continue;
+
+            for (const ASTNode* callee : fnCallee.second)
+            {
+                if (!IsPure(callee))
+                {
+                    mPureFunctions.erase(fnCallee.first);
+                    changed = true;
+                    break;
+                }
+            }
+        }
+    }
+
+    return mPureFunctions.size();
+}
+
+bool PurityAnalysis::CollectCallees(const ASTNode* node, std::vector<const ASTNode*>& callees) const
+{
+    if (node == nullptr)
+        return true;
+
+    switch (node->GetKind())
+    {
+    case ASTNode::NodeKind::JOIN_STMT:
+    case ASTNode::NodeKind::PRINT_STMT:
+    case ASTNode::NodeKind::SCAN_STMT:
+    case ASTNode::NodeKind::SLEEP_STMT:
+    case ASTNode::NodeKind::SPAWN_EXPR:
+    case ASTNode::NodeKind::SYNC_STMT:
+        return false;
+    case ASTNode::NodeKind::CALL_EXPR:
+    {
+        // An unresolved call can't be trusted
+        bool fnFound;
+        std::tie(fnFound, std::ignore) = mSymbolTable->TryGetSymbol(node);
+        if (!fnFound)
+            return false;
+
+        // The built-in functions have no side effects
+        const ASTNode* callee = mSymbolTable->GetFunctionDecl(node);
+        if (Intrinsics::GetInstance().GetID(callee) == IntrinsicID::NONE)
+            callees.push_back(callee);
+        break;
+    }
+    case ASTNode::NodeKind::IDENTIFIER_EXPR:
+        // Reading a global variable is as bad as writing one since another 
+        // function could have modified it between two calls
+        if (mSymbolTable->IsGlobalVariable(node))
+            return false;
+        break;
+    default:
+        break;
+    }
+
+    for (const auto& child : node->GetChildrenNodes())
+    {
+        if (!CollectCallees(child.get(), callees))
+            return false;
+    }
+
+    return true;
+}
@@ -0,0 +1,63 @@
+#ifndef PURITY_ANALYSIS_H__TOSTITOS
+#define PURITY_ANALYSIS_H__TOSTITOS
+
+#include <memory>
+#include <unordered_map>
+#include <unordered_set>
+#include <vector>
+
+namespace TosLang
+{
+    namespace FrontEnd
+    {
+        class ASTNode;
+        class SymbolTable;
+
+        /*
+        * \class PurityAnalysis
+        * \brief AST pass that finds the functions whose result only depends on the values of their arguments.
+        *        A function is pure when it doesn't do any IO (print, scan), doesn't touch global variables,
+        *        doesn't deal with threads (spawn, sleep, sync) and only calls other pure functions.
+        *        It is assumed that the type checker has been run beforehand so that every call is tied to its callee.
+        */
+        class PurityAnalysis
+        {
+        public:
+            /*
+            * \fn           Run
+            * \brief        Walk the functions of the program rooted at root to find the pure ones
+            * \param root   Root of the program's AST
+            * \param symTab Symbol table associated with the given AST
+            * \return       Number of pure functions found
+            */
+            size_t Run(const std::unique_ptr<ASTNode>& root, const std::shared_ptr<SymbolTable>& symTab);
+
+            /*
+            * \fn           IsPure
+            * \brief        Indicates if a function was proven pure by the last run of the analysis
+            * \param fnDecl Function declaration node
+            * \return       True if the function is pure, else false
+            */
+            bool IsPure(const ASTNode* fnDecl) const { return mPureFunctions.find(fnDecl) != mPureFunctions.end(); }
+
+        private:
+            /*
+            * \fn           CollectCallees
+            * \brief        Walks a function's body to gather the functions it calls
+            * \param node   Root of the subtree to walk
+            * \param callees Functions called within the subtree
+            * \return       False if the subtree contains an operation with side effects, else true
+            */
+            bool CollectCallees(const ASTNode* node, std::vector<const ASTNode*>& callees) const;
+
+        private:
+            using CalleesMap = std::unordered_map<const ASTNode*, std::vector<const ASTNode*>>;
+
+        private:
+            std::shared_ptr<SymbolTable> mSymbolTable;          /*!< Symbol table of the program being analyzed */
+            std::unordered_set<const ASTNode*> mPureFunctions;  /*!< Functions proven pure */
+        };
+    }
+}
+
+#endif // PURITY_ANALYSIS_H__TOSTITOS
@@ -1,5 +1,7 @@
 #include "symbolcollector.h"
 
+#include "intrinsics.h"
+
 #include "../AST/declarations.h"
 #include "../AST/expressions.h"
 #include "../Utils/errorlogger.h"
@@ -57,6 +59,16 @@ size_t SymbolCollector::Run(const std::unique_ptr<ASTNode>& root)
     mSymbolTable->Clear();
     mCurrentScopeID = 0;
 
+    // The built-in functions are declared first, in the global scope, so that any call can resolve to them
+    for (const FunctionDecl* intrinsic : Intrinsics::GetInstance().GetDecls())
+    {
+        std::vector<Type> fnType{ intrinsic->GetReturnType() };
+        for (const auto& param : intrinsic->GetParametersDecl()->GetParameters())
+            fnType.push_back(static_cast<const VarDecl*>(param.get())->GetVarType());
+
+        mSymbolTable->AddSymbol(intrinsic, { fnType, intrinsic->GetName() });
+    }
+
     this->VisitPreOrder(root);
 
     assert(mCurrentFunc == nullptr);
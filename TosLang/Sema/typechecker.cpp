@@ -199,6 +199,7 @@ void TypeChecker::HandleVarDecl()
             ++mErrorCount;
             break;
         case ASTNode::NodeKind::BINARY_EXPR:
+        case ASTNode::NodeKind::SPAWN_EXPR:
             ErrorLogger::PrintErrorAtLocation(ErrorLogger::ErrorType::WRONG_EXPR_TYPE, initExpr->GetSourceLocation());
             ++mErrorCount;
             break;
@@ -277,34 +278,47 @@ void TypeChecker::HandleBinaryExpr()
         return;
     }
 
-    Type operandTypes[2];
+    // The operands were visited first, so only the calls don't have a type yet: their overload resolution
+    // isn't done. Neither does a binary expression containing such a call.
+    Type operandTypes[2] = { Type::UNKNOWN, Type::UNKNOWN };
     for (int i = 0; i < 2; ++i)
     {
-        switch (children[i]->GetKind())
-        {
-        case ASTNode::NodeKind::BINARY_EXPR:
-            operandTypes[i] = mNodeTypes.at(children[i].get());
-            break;
-        case ASTNode::NodeKind::BOOLEAN_EXPR:
-            operandTypes[i] = Type::BOOL;
-            break;
-        case ASTNode::NodeKind::IDENTIFIER_EXPR:
+        auto typeIt = mNodeTypes.find(children[i].get());
+        if (typeIt != mNodeTypes.end())
+            operandTypes[i] = typeIt->second;
+    }
+
+    // A call operand must evaluate to the type of the other operand. When that one is also undecided,
+    // the call can still be resolved if all of its candidates return the same type.
+    for (int i = 0; i < 2; ++i)
+    {
+        if (children[i]->GetKind() != ASTNode::NodeKind::CALL_EXPR)
+            continue;
+
+        Type callType = operandTypes[1 - i];
+        if (callType == Type::UNKNOWN)
         {
-            const IdentifierExpr* iExpr = static_cast<const IdentifierExpr*>(children[i].get());
-            // It is assumed that the scope checker has been run before the type checker
-            const Symbol* varSym;
-            bool symFound;
-            std::tie(symFound, varSym) = mSymbolTable->TryGetSymbol(iExpr);
-            assert(symFound);
-            operandTypes[i] = varSym->GetVariableType();
-        }
-            break;
-        case ASTNode::NodeKind::NUMBER_EXPR:
-            operandTypes[i] = Type::NUMBER;
-            break;
+            auto oSetIt = mOverloadMap.find(children[i].get());
+            if ((oSetIt == mOverloadMap.end()) || oSetIt->second.empty())
+                return;
+
+            const std::vector<const Symbol*>& overloadSet = oSetIt->second;
+            callType = overloadSet.front()->GetFunctionReturnType();
+            if (std::any_of(overloadSet.begin(), overloadSet.end(),
+                            [&callType](const Symbol* sym) { return sym->GetFunctionReturnType() != callType; }))
+                continue;
         }
+
+        // When no candidate returns that type, the error is reported right away. The expression still gets
+        // the type it should have had so that the node making use of it doesn't report the same error again.
+        CheckExprEvaluateToType(static_cast<const Expr*>(children[i].get()), callType);
+        operandTypes[i] = callType;
     }
 
+    // The expression's type will be decided by the node making use of it
+    if ((operandTypes[0] == Type::UNKNOWN) || (operandTypes[1] == Type::UNKNOWN))
+        return;
+
     // Check if the operands' types match
     if (operandTypes[0] != operandTypes[1])
     {
@@ -382,12 +396,12 @@ void TypeChecker::HandleCallExpr()
 
             // Remove candidates that don't require one of the possible types at iArg index
             overloadCandidates.erase(std::remove_if(overloadCandidates.begin(), overloadCandidates.end(),
-                                     [&possibleTypes](const Symbol* fnSym)
+                                     [&possibleTypes, &iArg](const Symbol* fnSym)
                                      {
-                                         const Common::Type fnRType = fnSym->GetFunctionReturnType();
+                                         const Common::Type paramType = fnSym->GetFunctionParamTypeAt(iArg);
 
                                          return std::none_of(possibleTypes.begin(), possibleTypes.end(), 
-                                                             [&fnRType](const Common::Type ty) { return fnRType == ty; });
+                                                             [&paramType](const Common::Type ty) { return paramType == ty; });
                                      }), overloadCandidates.end());
         }
     }
@@ -463,6 +477,11 @@ void TypeChecker::HandleSpawnExpr()
     {
         ++mErrorCount;
     }
+    else
+    {
+        // Whatever the function returns, the spawn gives back the handle of the new thread (see JoinStmt)
+        mNodeTypes[sExpr] = Type::NUMBER;
+    }
 }
 
 void TypeChecker::HandleIfStmt()
@@ -477,6 +496,18 @@ void TypeChecker::HandleIfStmt()
     }
 }
 
+void TypeChecker::HandleJoinStmt()
+{
+    const JoinStmt* jStmt = static_cast<const JoinStmt*>(this->mCurrentNode);
+    assert(jStmt != nullptr);
+
+    if (!CheckExprEvaluateToType(jStmt->GetHandleExpr(), Type::NUMBER))
+    {
+        ErrorLogger::PrintErrorAtLocation(ErrorLogger::ErrorType::WRONG_HANDLE_EXPR_TYPE, jStmt->GetHandleExpr()->GetSourceLocation());
+        ++mErrorCount;
+    }
+}
+
 void TosLang::FrontEnd::TypeChecker::HandleReturnStmt()
 {
     const ReturnStmt* rStmt = static_cast<const ReturnStmt*>(this->mCurrentNode);
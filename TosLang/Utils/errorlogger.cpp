@@ -52,6 +52,9 @@ std::unordered_map<ErrorLogger::ErrorType, std::string, ErrorLogger::ErrorTypeHa
     { ErrorType::IF_MISSING_BODY,               "IF ERROR: Missing if body" },
     { ErrorType::IF_MISSING_COND,               "IF ERROR: Missing if condition" },
 
+    // Join
+    { ErrorType::JOIN_MISSING_HANDLE,           "JOIN ERROR: Missing handle of the thread to join" },
+
     // IO
     { ErrorType::PRINT_WRONG_INPUT_TYPE,        "PRINT ERROR: Cannot print given expression" },
     { ErrorType::SCAN_MISSING_INPUT_VAR,        "SCAN ERROR: Missing input variable" },
@@ -80,6 +83,7 @@ std::unordered_map<ErrorLogger::ErrorType, std::string, ErrorLogger::ErrorTypeHa
     { ErrorType::WRONG_BIN_EXPR_TYPE,           "TYPE ERROR: Mismatch between binary expression operands type" },
     { ErrorType::WRONG_COND_EXPR_TYPE,          "TYPE ERROR: Conditional expression must evaluate to a boolean value" },
     { ErrorType::WRONG_EXPR_TYPE,               "TYPE ERROR: Trying to instantiate variable with an expression of the wrong type" },
+    { ErrorType::WRONG_HANDLE_EXPR_TYPE,        "TYPE ERROR: Handle expression must evaluate to an Int given by a spawn" },
     { ErrorType::WRONG_INIT_ARRAY_SCALAR,       "TYPE ERROR: Trying to instantiate an array variable with a scalar value" },
     { ErrorType::WRONG_INIT_SCALAR_ARRAY,       "TYPE ERROR: Trying to instantiate a scalar variable with an array expression" },
     { ErrorType::WRONG_LITERAL_TYPE,            "TYPE ERROR: Trying to instantiate variable with a literal of the wrong type" },
@@ -66,6 +66,9 @@ namespace TosLang
                 IF_MISSING_BODY,
                 IF_MISSING_COND,
 
+                // Join
+                JOIN_MISSING_HANDLE,
+
                 // IO
                 PRINT_WRONG_INPUT_TYPE,
                 SCAN_MISSING_INPUT_VAR,
@@ -89,6 +92,7 @@ namespace TosLang
                 WRONG_BIN_EXPR_TYPE,
                 WRONG_COND_EXPR_TYPE,
                 WRONG_EXPR_TYPE,
+                WRONG_HANDLE_EXPR_TYPE,
                 WRONG_INIT_ARRAY_SCALAR,
                 WRONG_INIT_SCALAR_ARRAY,
                 WRONG_LITERAL_TYPE,
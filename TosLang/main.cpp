@@ -31,6 +31,8 @@ int main(int argc, char** argv)
     case Execution::ExecutionCommand::INTERPRET:
         interpreter.Run(info.programFile);
         break;
+    case Execution::ExecutionCommand::INTERPRET_SSA:
+        return interpreter.RunSSA(info.programFile) ? 0 : 1;
     default:
         return 1;
     }
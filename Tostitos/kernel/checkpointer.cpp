@@ -0,0 +1,144 @@
+#include "checkpointer.h"
+
+#include "../threading/globalstore.h"
+#include "../threading/thread.h"
+
+#include <cassert>
+#include <cstdio>
+#include <fstream>
+#include <iterator>
+#include <unordered_map>
+
+using namespace KernelSpace;
+using namespace Threading;
+using namespace Threading::impl;
+using namespace TosLang::FrontEnd;
+
+namespace
+{
+    const char MAGIC[] = "TOSCKPT";
+    const uint64_t FORMAT_VERSION = 3;   // 2: time left to sleep in milliseconds, 3: parent of each thread
+}
+
+void Checkpointer::Reset(const ASTNode* root, const SymbolTable* symTab, GlobalStore* globals)
+{
+    mIndex.Build(root, symTab);
+    mSymTable = symTab;
+    mGlobals = globals;
+    mThreadStates.clear();
+    mGlobalsState.reset();
+}
+
+bool Checkpointer::Save(const std::string& fileName, const std::vector<std::unique_ptr<Thread>>& threads)
+{
+    // Encoding the globals again only if one of them was written since the last checkpoint
+    assert(mGlobals != nullptr);
+    const GlobalStore& globals = *mGlobals;
+    if ((mGlobalsState == nullptr) || (mGlobalsState->version != globals.GetVersion()))
+    {
+        CheckpointWriter globalsWriter{ mIndex };
+        globals.Save(globalsWriter);
+        mGlobalsState.reset(new EncodedState{ globals.GetVersion(), globalsWriter.TakeBytes() });
+    }
+
+    CheckpointWriter writer{ mIndex };
+    writer.WriteString(MAGIC);
+    writer.WriteUInt(FORMAT_VERSION);
+    writer.WriteUInt(mIndex.GetNodeCount());
+    writer.WriteUInt(mIndex.GetFingerprint());
+    writer.WriteBytes(mGlobalsState->bytes);
+
+    // A thread refers to its parent by its position among the saved threads, starting from 1 (0 is no parent)
+    std::unordered_map<const Thread*, size_t> threadNumbers;
+    for (const auto& thread : threads)
+    {
+        if (!thread->HasFinished())
+            threadNumbers.emplace(thread.get(), threadNumbers.size() + 1);
+    }
+
+    writer.WriteUInt(threadNumbers.size());
+    for (const auto& thread : threads)
+    {
+        if (thread->HasFinished())
+        {
+            mThreadStates.erase(thread.get());
+            continue;
+        }
+
+        auto parentIt = threadNumbers.find(thread->GetParent());
+        writer.WriteUInt((parentIt != threadNumbers.end()) ? parentIt->second : 0);
+        thread->SaveSchedulingState(writer);
+
+        // Same thing for the threads, one that didn't run since the last checkpoint is where it was
+        auto stateIt = mThreadStates.find(thread.get());
+        if ((stateIt == mThreadStates.end()) || (stateIt->second.version != thread->GetVersion()))
+        {
+            CheckpointWriter threadWriter{ mIndex };
+            thread->SaveExecutionState(threadWriter);
+            EncodedState& state = mThreadStates[thread.get()];
+            state.version = thread->GetVersion();
+            state.bytes = threadWriter.TakeBytes();
+            writer.WriteBytes(state.bytes);
+        }
+        else
+            writer.WriteBytes(stateIt->second.bytes);
+    }
+
+    // Written next to the previous checkpoint then moved over it, so that there is always a whole checkpoint to restore
+    const std::string tempFileName = fileName + ".tmp";
+    {
+        std::ofstream file{ tempFileName, std::ios::binary | std::ios::trunc };
+        file.write(writer.GetBytes().data(), writer.GetBytes().size());
+        if (!file)
+            return false;
+    }
+
+#if defined(_MSC_VER)
+    // Unlike POSIX, Windows doesn't replace an existing file when renaming
+    std::remove(fileName.c_str());
+#endif
+    return std::rename(tempFileName.c_str(), fileName.c_str()) == 0;
+}
+
+bool Checkpointer::Load(const std::string& fileName, const CompiledProgram* program, std::vector<std::unique_ptr<Thread>>& threads)
+{
+    std::ifstream file{ fileName, std::ios::binary };
+    if (!file)
+        return false;
+
+    const std::string bytes{ std::istreambuf_iterator<char>(file), std::istreambuf_iterator<char>() };
+    CheckpointReader reader{ mIndex, bytes.data(), bytes.size() };
+
+    if ((reader.ReadString() != MAGIC)
+        || (reader.ReadUInt() != FORMAT_VERSION)
+        || (reader.ReadUInt() != mIndex.GetNodeCount())
+        || (reader.ReadUInt() != mIndex.GetFingerprint()))
+    {
+        return false;
+    }
+
+    mGlobals->Load(reader);
+
+    std::vector<std::unique_ptr<Thread>> restoredThreads;
+    for (uint64_t iThread = reader.ReadUInt(); (iThread > 0) && !reader.HasFailed(); --iThread)
+    {
+        // A parent always comes before its children, it was spawned first
+        const uint64_t parentNumber = reader.ReadUInt();
+        if (parentNumber > restoredThreads.size())
+            reader.Fail();
+
+        std::unique_ptr<Thread> thread = Thread::Restore(reader, mSymTable, program);
+        if (thread == nullptr)
+            continue;
+
+        if (parentNumber != 0)
+            thread->AttachToParent(restoredThreads[parentNumber - 1].get());
+        restoredThreads.push_back(std::move(thread));
+    }
+
+    if (reader.HasFailed() || !reader.IsAtEnd())
+        return false;
+
+    threads = std::move(restoredThreads);
+    return true;
+}
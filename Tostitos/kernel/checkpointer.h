@@ -0,0 +1,102 @@
+#ifndef CHECKPOINTER_H__TOSTITOS
+#define CHECKPOINTER_H__TOSTITOS
+
+#include "../threading/checkpoint.h"
+
+#include <cstddef>
+#include <memory>
+#include <string>
+#include <unordered_map>
+#include <vector>
+
+namespace Threading
+{
+    class Thread;
+
+    namespace impl
+    {
+        class CompiledProgram;
+        class GlobalStore;
+    }
+}
+
+namespace TosLang
+{
+    namespace FrontEnd
+    {
+        class ASTNode;
+        class SymbolTable;
+    }
+}
+
+namespace KernelSpace
+{
+    /*
+    * \class Checkpointer
+    * \brief Saves the state of the running program to a file and restores it in another process. A checkpoint holds
+    *        the global variables along with the scheduling and execution state of every thread still running.
+    *        It is only valid for the program it was taken from, which is checked when it is loaded.
+    *
+    *        Checkpoints are incremental: the encoded state of each thread and of the global variables is kept
+    *        from one checkpoint to the next, and only the parts that changed in between are encoded again.
+    *        Threads that are sleeping or waiting on a sync then cost next to nothing to save periodically.
+    */
+    class Checkpointer
+    {
+    public:
+        /*
+        * \fn           Reset
+        * \brief        Prepares the checkpoints of a new program, forgetting what was saved for the previous one
+        * \param root   Root of the program's AST
+        * \param symTab Symbol table of the program
+        * \param globals  Global variables of the program
+        */
+        void Reset(const TosLang::FrontEnd::ASTNode* root, const TosLang::FrontEnd::SymbolTable* symTab, Threading::impl::GlobalStore* globals);
+
+        /*
+        * \fn           Save
+        * \brief        Writes a checkpoint. The file is replaced in one go, a crash while saving leaves the previous one intact.
+        * \param fileName   File to write
+        * \param threads    Threads of the program, those that have finished aren't saved
+        * \return       True if the file could be written
+        */
+        bool Save(const std::string& fileName, const std::vector<std::unique_ptr<Threading::Thread>>& threads);
+
+        /*
+        * \fn           Load
+        * \brief        Restores the global variables and threads of a checkpoint
+        * \param fileName   File to read
+        * \param program    Program compiled to closures, nullptr if it runs on the AST walker
+        * \param threads    Restored threads
+        * \return       False if the file couldn't be read or doesn't come from the current program
+        */
+        bool Load(const std::string& fileName, const Threading::impl::CompiledProgram* program, std::vector<std::unique_ptr<Threading::Thread>>& threads);
+
+        /*
+        * \fn           ForgetThread
+        * \brief        Drops what was encoded for a thread that is going away, another thread might reuse its storage
+        * \param thread Thread going away
+        */
+        void ForgetThread(const Threading::Thread* thread) { mThreadStates.erase(thread); }
+
+    private:
+        /*
+        * \struct EncodedState
+        * \brief  State encoded by the last checkpoint, along with the version it was encoded at
+        */
+        struct EncodedState
+        {
+            size_t version;
+            std::string bytes;
+        };
+
+    private:
+        Threading::impl::NodeIndex mIndex;                                         /*!< Identifiers of the AST nodes */
+        const TosLang::FrontEnd::SymbolTable* mSymTable = nullptr;
+        Threading::impl::GlobalStore* mGlobals = nullptr;
+        std::unordered_map<const Threading::Thread*, EncodedState> mThreadStates;   /*!< Execution state of each thread */
+        std::unique_ptr<EncodedState> mGlobalsState;                                /*!< Values of the global variables */
+    };
+}
+
+#endif // CHECKPOINTER_H__TOSTITOS
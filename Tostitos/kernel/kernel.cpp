@@ -1,16 +1,42 @@
 #include "kernel.h"
 
 #include "scheduler.h"
+#include "../threading/callsitecache.h"
+#include "../threading/closurecompiler.h"
+#include "../threading/closureexecutor.h"
+#ifdef USE_COROUTINES
+#include "../threading/coroutineexecutor.h"
+#endif
 #include "../threading/executor.h"
+#include "../threading/functioncache.h"
+#include "../threading/globalstore.h"
+#include "../threading/inputbuffer.h"
+#include "../threading/outputbuffer.h"
+#include "../threading/quickenedops.h"
+#include "../threading/sleepclock.h"
+#include "../threading/stringpool.h"
 #include "../threading/thread.h"
+#include "../threading/tierupmanager.h"
 
-#include "../../TosLang/AST/ast.h"
+#include "../../TosLang/AST/declarations.h"
 #include "../../TosLang/Execution/compiler.h"
+#include "../../TosLang/Sema/purityanalysis.h"
+
+#include <algorithm>
+#include <cassert>
+#include <cstdio>
+#include <iostream>
+#include <thread>
+#include <unordered_set>
 
 using namespace KernelSpace;
 using namespace Threading;
+using namespace TosLang::FrontEnd;
 
-Kernel::Kernel() = default;
+Kernel::Kernel()
+    : mThreads{}, mThreadsMutex{}, mReclaimedThreads{}, mFreeThreads{}, mNextThreadID{ 0 }, mMetrics{}, mScheduler{}, mWorkerPool{}, mWorkerCount{ 1 }, mQuantum{ DEFAULT_QUANTUM }, mUseVirtualTime{ false }, mTier{ ExecutionTier::AST_WALKER }, 
+      mOutputFlushSize{ impl::OutputBuffer::DEFAULT_FLUSH_SIZE }, mCheckpointer{}, mCheckpointName{}, mCheckpointInterval{ 0 },
+      mProcesses{}, mFinishedProcesses{} { }
 Kernel::~Kernel() = default;
 
 Kernel& Kernel::GetInstance()
@@ -19,58 +45,513 @@ Kernel& Kernel::GetInstance()
     return Instance;
 }
 
-void Kernel::RunProgram(const std::string& programName)
+bool Kernel::RunProgram(const std::string& programName)
+{
+    if (LoadProcess(programName) == nullptr)
+        return false;
+
+    RunProcesses();
+    return true;
+}
+
+Process* Kernel::LoadProcess(const std::string& programName, const ProcessQuotas& quotas)
+{
+    return LoadProgram(programName, quotas, false);
+}
+
+void Kernel::RunProcesses()
+{
+    PrepareWorkers();
+
+    for (auto& process : mProcesses)
+        StartProcess(*process);
+
+    Run();
+}
+
+bool Kernel::ResumeProgram(const std::string& programName, const std::string& checkpointName)
 {
+    // A checkpoint holds a single program, which can't join the processes already loaded
+    if (!mProcesses.empty())
+        return false;
+
+    // The checkpoint refers to the program's AST, which must be the same as when it was taken
+    Process* process = LoadProgram(programName, ProcessQuotas{}, true);
+    if (process == nullptr)
+        return false;
+
+    PrepareWorkers();
+
+    std::vector<std::unique_ptr<Thread>> threads;
+    if (!mCheckpointer.Load(checkpointName, process->GetCompiledProgram(), threads))
+    {
+        mWorkerPool.reset();
+        mFinishedProcesses = std::move(mProcesses);
+        mProcesses.clear();
+        return false;
+    }
+
+    for (auto& thread : threads)
+    {
+        thread->SetProcess(process);
+        AddThread(std::move(thread));
+    }
+
+    Run();
+    return true;
+}
+
+bool Kernel::Checkpoint(const std::string& checkpointName)
+{
+    // A checkpoint holds a single program
+    if (mProcesses.size() != 1)
+        return false;
+
+#ifdef USE_COROUTINES
+    // The coroutine frames are laid out by the compiler, there is no way to write them down
+    if (mProcesses.front()->GetCoroutineProgram() != nullptr)
+        return false;
+#endif
+
+    // Once restored, the threads won't print again what they printed before the checkpoint. It must then be out.
+    for (auto& thread : mThreads)
+        thread->GetOutput().Flush();
+
+    return mCheckpointer.Save(checkpointName, mThreads);
+}
+
+void Kernel::SetCheckpointing(const std::string& checkpointName, size_t interval)
+{
+    mCheckpointName = checkpointName;
+    mCheckpointInterval = interval;
+}
+
+Process* Kernel::LoadProgram(const std::string& programName, const ProcessQuotas& quotas, bool isResuming)
+{
+    // The first process of a run starts from a clean slate
+    if (mProcesses.empty())
+    {
+        // Background compilations read the AST of the previous processes, they must be done before it goes away
+        impl::TierUpManager::GetInstance().Reset();
+
+        // The call sites, specialized nodes, memoized results and literals of the previous program images are gone
+        impl::CallSiteCache::GetInstance().Invalidate();
+        impl::QuickenedOps::GetInstance().Invalidate();
+        impl::FunctionCache::GetInstance().Reset();
+        impl::StringPool::GetInstance().Reset();
+
+        mFinishedProcesses.clear();
+
+        mMetrics.Reset();
+        mNextThreadID = 0;
+
+        // Each run starts at the beginning of the virtual time
+        SleepClock::GetInstance().UseVirtualTime(mUseVirtualTime);
+    }
+
     Execution::Compiler compiler;
 
-    mRoot = compiler.ParseProgram(programName);
+    std::unique_ptr<ASTNode> root = compiler.ParseProgram(programName);
+    if (root == nullptr)
+        return nullptr;
 
-    if (mRoot != nullptr)
+    // Not every semantic error is logged, the program is at least named
+    const std::shared_ptr<SymbolTable> symTab = compiler.GetSymbolTable(root);
+    if (symTab == nullptr)
     {
-        mSymTable = compiler.GetSymbolTable(mRoot);
+        std::cerr << "Couldn't load " << programName << ", it has semantic errors" << std::endl;
+        return nullptr;
+    }
+
+    mProcesses.emplace_back(std::make_unique<Process>(mProcesses.size(), programName, std::move(root), symTab, quotas));
+    Process& process = *mProcesses.back();
+
+    // String literals are interned once and for all, evaluating one is then only a reference copy
+    impl::StringPool::GetInstance().InternLiterals(process.GetRoot().get());
 
-        Threading::impl::Executor mainExec{ mRoot.get(), mSymTable.get() };
+    // The variables are resolved to the slots of the process' own global variables
+    impl::GlobalStore::SetCurrent(&process.GetGlobals());
 
-        auto mainThread = std::make_unique<Thread>(std::move(mainExec));
+    bool useClosures = (mTier == ExecutionTier::CLOSURES);
+#ifdef USE_COROUTINES
+    // Threads run as coroutines can't be checkpointed, a program that is or was checkpointed runs as closures instead
+    if ((mTier == ExecutionTier::COROUTINES) && (mCheckpointInterval == 0) && !isResuming)
+        process.SetCoroutineProgram(impl::CoroutineProgram::Build(process.GetRoot().get(), symTab.get()));
 
-        mScheduler.ScheduleThread(mThreads.back().get());
+    useClosures = useClosures || ((mTier == ExecutionTier::COROUTINES) && !process.IsCompiled());
+#else
+    (void)isResuming;
+#endif
+
+    if (useClosures)
+    {
+        impl::ClosureCompiler closureCompiler;
+        process.SetCompiledProgram(closureCompiler.Compile(process.GetRoot().get(), symTab.get()));
     }
 
-    Run();
+    impl::GlobalStore::SetCurrent(nullptr);
+
+    if (!process.IsCompiled())
+    {
+        PurityAnalysis purityAnalysis;
+        purityAnalysis.Run(process.GetRoot(), symTab);
+
+        RegisterMemoizedFunctions(process, purityAnalysis);
+        impl::TierUpManager::GetInstance().RegisterCandidates(process.GetRoot().get(), symTab, purityAnalysis);
+    }
+
+    // Only a run made of a single process can be checkpointed
+    if (mProcesses.size() == 1)
+        mCheckpointer.Reset(process.GetRoot().get(), symTab.get(), &process.GetGlobals());
+
+    return &process;
+}
+
+void Kernel::StartProcess(Process& process)
+{
+    std::unique_ptr<Thread> mainThread;
+#ifdef USE_COROUTINES
+    if (process.GetCoroutineProgram() != nullptr)
+    {
+        mainThread = std::make_unique<Thread>(impl::CoroutineExecutor{ process.GetCoroutineProgram() });
+    }
+    else
+#endif
+    if (process.GetCompiledProgram() != nullptr)
+    {
+        mainThread = std::make_unique<Thread>(impl::ClosureExecutor{ process.GetCompiledProgram() });
+    }
+    else
+    {
+        mainThread = std::make_unique<Thread>(impl::Executor{ process.GetRoot().get(), process.GetSymbolTable().get() });
+    }
+
+    mainThread->SetProcess(&process);
+    AddThread(std::move(mainThread));
+}
+
+bool Kernel::SetInputFile(const std::string& fileName)
+{
+    // The programs scan the standard input unless told otherwise
+    impl::InputBuffer& input = impl::InputBuffer::GetInstance();
+    if (fileName.empty())
+    {
+        input.UseStandardInput();
+        return true;
+    }
+
+    return input.OpenFile(fileName);
+}
+
+void Kernel::PrepareWorkers()
+{
+    // The AST walker's caches (CallSiteCache, QuickenedOps, FunctionCache, TierUpManager) have no locks and rely on
+    // every walker thread running on a single host thread: putting the walker on the pool would make them race.
+    // A periodic checkpoint needs every thread stopped between two statements and the virtual clock only moves when
+    // the single scheduler runs out of threads to run. All of them run the single-threaded loop.
+    size_t workerCount = mWorkerCount;
+    if (workerCount == 0)
+        workerCount = std::max(std::thread::hardware_concurrency(), 1u);
+
+    const bool isCompiled = !mProcesses.empty()
+                            && std::all_of(mProcesses.begin(), mProcesses.end(), [](const std::unique_ptr<Process>& process) { return process->IsCompiled(); });
+
+    if ((workerCount > 1) && isCompiled && !IsCheckpointing() && !mUseVirtualTime)
+        mWorkerPool = std::make_unique<WorkerPool>(workerCount, mQuantum, mMetrics);
+    else
+        mWorkerPool.reset();
+}
+
+bool Kernel::IsCheckpointing() const
+{
+    return (mCheckpointInterval != 0) && (mProcesses.size() == 1);
+}
+
+void Kernel::RegisterMemoizedFunctions(const Process& process, const PurityAnalysis& purityAnalysis)
+{
+    impl::FunctionCache& fnCache = impl::FunctionCache::GetInstance();
+
+    for (const auto& decl : process.GetRoot()->GetChildrenNodes())
+    {
+        // A function that doesn't return anything has nothing worth remembering
+        if ((decl->GetKind() == ASTNode::NodeKind::FUNCTION_DECL)
+            && (static_cast<const FunctionDecl*>(decl.get())->GetReturnType() != TosLang::Common::Type::VOID)
+            && purityAnalysis.IsPure(decl.get()))
+        {
+            fnCache.RegisterFunction(decl.get());
+        }
+    }
 }
 
 void Kernel::AddThread(std::unique_ptr<Thread>&& thread)
 {
+    thread->GetOutput().SetFlushSize(mOutputFlushSize);
+    Thread* newThread = thread.get();
+
+    // A thread spawned by another one is one more child for its sync to wait for, and belongs to the same process
+    if (Thread* parent = Thread::GetCurrent())
+    {
+        newThread->AttachToParent(parent);
+        newThread->SetProcess(parent->GetProcess());
+    }
+    assert(newThread->GetProcess() != nullptr);
+
     // Take ownership of the thread
-    mThreads.emplace_back(std::move(thread));
+    bool isAdmitted;
+    {
+        std::lock_guard<std::mutex> lock{ mThreadsMutex };
+        newThread->SetThreadID(mNextThreadID++);
+        mThreads.emplace_back(std::move(thread));
+        isAdmitted = newThread->GetProcess()->AdmitThread(newThread);
+    }
+
+    // A thread past the quota of its process is scheduled once another one of the process finishes (see ReleaseThread)
+    if (!isAdmitted)
+        return;
 
     // And then schedule it to run
-    mScheduler.ScheduleThread(mThreads.back().get());
+    if (mWorkerPool != nullptr)
+        mWorkerPool->ScheduleThread(newThread);
+    else
+        mScheduler.ScheduleThread(newThread);
+}
+
+int Kernel::SpawnThread(const ASTNode* root, const SymbolTable* symTab, impl::CallStack&& stack)
+{
+    std::unique_ptr<Thread> thread = TakeFreeThread();
+    if (thread != nullptr)
+        thread->Reset(root, symTab, std::move(stack));
+    else
+        thread = std::make_unique<Thread>(impl::Executor{ root, symTab, std::move(stack) });
+
+    // Taken before the thread is scheduled, another worker could be done with it by the time AddThread returns
+    JoinHandle handle = thread->GetJoinHandle();
+    AddThread(std::move(thread));
+    return KeepJoinHandle(handle);
+}
+
+int Kernel::SpawnThread(const impl::CompiledFunction* fn, std::vector<impl::InterpretedValue>&& args)
+{
+    std::unique_ptr<Thread> thread = TakeFreeThread();
+    if (thread != nullptr)
+        thread->Reset(fn, std::move(args));
+    else
+        thread = std::make_unique<Thread>(impl::ClosureExecutor{ fn, std::move(args) });
+
+    JoinHandle handle = thread->GetJoinHandle();
+    AddThread(std::move(thread));
+    return KeepJoinHandle(handle);
+}
+
+#ifdef USE_COROUTINES
+int Kernel::SpawnThread(const impl::CoroutineFunction* fn, std::vector<impl::InterpretedValue>&& args)
+{
+    std::unique_ptr<Thread> thread = TakeFreeThread();
+    if (thread != nullptr)
+        thread->Reset(fn, std::move(args));
+    else
+        thread = std::make_unique<Thread>(impl::CoroutineExecutor{ fn, std::move(args) });
+
+    JoinHandle handle = thread->GetJoinHandle();
+    AddThread(std::move(thread));
+    return KeepJoinHandle(handle);
+}
+#endif
+
+int Kernel::KeepJoinHandle(const JoinHandle& handle)
+{
+    // Only the spawning thread can join the new one, the handle stays with it
+    Thread* parent = Thread::GetCurrent();
+    assert(parent != nullptr);
+    return parent->KeepChildHandle(handle);
+}
+
+Kernel::ReleasedThreads Kernel::ReleaseThread(Thread* thread)
+{
+    mMetrics.AddFinishedThread(thread->GetMetrics());
+
+    // The result must be out before the thread can be reclaimed and given another function
+    Thread* joiner = thread->CompleteJoin();
+    Thread* parent = thread->ReleaseParent();
+
+    // Once reclaimed, the thread can go away or be handed to another process at any time
+    Process* process = thread->GetProcess();
+
+    // The children still running refer to their parent, the last one to finish will release it
+    if (!thread->Block())
+        ReclaimThread(thread);
+
+    // This thread might have been that last child
+    if ((parent != nullptr) && parent->HasFinished())
+    {
+        ReclaimThread(parent);
+        parent = nullptr;
+    }
+
+    // The finished thread's slot goes to a thread of its process waiting for one, the released ones take theirs back
+    Thread* admitted;
+    {
+        std::lock_guard<std::mutex> lock{ mThreadsMutex };
+        admitted = process->ReleaseSlot();
+        if (parent != nullptr)
+            parent->GetProcess()->ReclaimSlot();
+        if (joiner != nullptr)
+            joiner->GetProcess()->ReclaimSlot();
+    }
+
+    return ReleasedThreads{ parent, joiner, admitted };
+}
+
+Thread* Kernel::BlockThread(Thread* thread)
+{
+    // A thread waiting on others doesn't hold a slot of its process, they might be waiting for that very slot
+    std::lock_guard<std::mutex> lock{ mThreadsMutex };
+    return thread->GetProcess()->ReleaseSlot();
+}
+
+std::unique_ptr<Thread> Kernel::TakeFreeThread()
+{
+    std::lock_guard<std::mutex> lock{ mThreadsMutex };
+    if (mFreeThreads.empty())
+        return nullptr;
+
+    std::unique_ptr<Thread> thread = std::move(mFreeThreads.back());
+    mFreeThreads.pop_back();
+    return thread;
+}
+
+void Kernel::ReclaimThread(Thread* thread)
+{
+    std::lock_guard<std::mutex> lock{ mThreadsMutex };
+    mReclaimedThreads.push_back(thread);
+
+    // Taking the finished threads out in batches keeps the cost per thread constant and the other threads in order
+    if ((mReclaimedThreads.size() >= RECLAIM_BATCH_SIZE) && (mReclaimedThreads.size() >= mThreads.size() / 2))
+        CompactThreads();
+}
+
+void Kernel::CompactThreads()
+{
+    const std::unordered_set<Thread*> reclaimedThreads{ mReclaimedThreads.begin(), mReclaimedThreads.end() };
+    mReclaimedThreads.clear();
+
+    size_t keptCount = 0;
+    for (auto& thread : mThreads)
+    {
+        if (reclaimedThreads.count(thread.get()) == 0)
+        {
+            if (&mThreads[keptCount] != &thread)
+                mThreads[keptCount] = std::move(thread);
+            ++keptCount;
+            continue;
+        }
+
+        mCheckpointer.ForgetThread(thread.get());
+        if (mFreeThreads.size() < MAX_FREE_THREADS)
+            mFreeThreads.push_back(std::move(thread));
+    }
+
+    mThreads.resize(keptCount);
+}
+
+std::vector<ThreadMetrics> Kernel::GetLiveThreadMetrics()
+{
+    std::lock_guard<std::mutex> lock{ mThreadsMutex };
+
+    std::vector<ThreadMetrics> liveMetrics;
+    for (const auto& thread : mThreads)
+    {
+        if (!thread->HasFinished())
+            liveMetrics.push_back(thread->GetMetrics());
+    }
+
+    return liveMetrics;
+}
+
+void Kernel::DumpMetrics(std::ostream& out)
+{
+    mMetrics.WriteJSON(out, GetLiveThreadMetrics());
+}
+
+void Kernel::SetQuantum(size_t stepCount)
+{
+    assert(stepCount > 0);
+    mQuantum = stepCount;
 }
 
 void Kernel::SleepFor(size_t nbSecs)
 {
-    mCurrentThread->Sleep(nbSecs);
+    Thread::GetCurrent()->Sleep(nbSecs);
 }
 
 void Kernel::Sync()
 {
-    mCurrentThread->Barrier();
+    Thread::GetCurrent()->Barrier();
+}
+
+void Kernel::Join(int handleID)
+{
+    assert(Thread::GetCurrent() != nullptr);
+    Thread::GetCurrent()->Join(handleID);
+}
+
+impl::OutputBuffer& Kernel::GetCurrentThreadOutput()
+{
+    assert(Thread::GetCurrent() != nullptr);
+    return Thread::GetCurrent()->GetOutput();
 }
 
 void Kernel::Run()
 {
-    mCurrentThread = mScheduler.FindNextThreadToRun(mCurrentThread);
+    if (mWorkerPool != nullptr)
+    {
+        mWorkerPool->Run();
+        mWorkerPool.reset();
+    }
+
+    Thread* currentThread = mScheduler.FindNextThreadToRun(nullptr);
 
-    while (!mCurrentThread->HasFinished())
+    // Keep going until the scheduler runs out of threads
+    const bool isCheckpointing = IsCheckpointing();
+    size_t stepsSinceCheckpoint = 0;
+    while (currentThread != nullptr)
     {
-        mCurrentThread->ExecuteOne();
+        // The quantum is cut short when a checkpoint is due, so that checkpoints still come every interval steps
+        size_t quantum = mQuantum;
+        if (isCheckpointing)
+            quantum = std::min(quantum, mCheckpointInterval - stepsSinceCheckpoint);
+
+        Thread::SetCurrent(currentThread);
+        if (!currentThread->IsSleeping() && !currentThread->IsWaitingForChildren())
+        {
+            stepsSinceCheckpoint += currentThread->Execute(quantum);
+            mMetrics.RecordLatency(currentThread->GetMetrics().lastReadyLatency);
+        }
 
-        if (mCurrentThread->IsSleeping() || mCurrentThread->IsWaitingForChildren())
+        // Every thread is between two statements, it is the only point where the program can be saved. Once the
+        // process is stopped, its threads finish one after the other: the last checkpoint is the one to resume from.
+        if (isCheckpointing && (stepsSinceCheckpoint == mCheckpointInterval) && !mProcesses.front()->IsStopped())
         {
-            mCurrentThread = mScheduler.FindNextThreadToRun(mCurrentThread);
+            Checkpoint(mCheckpointName);
+            stepsSinceCheckpoint = 0;
         }
+
+        currentThread = mScheduler.FindNextThreadToRun(currentThread);
     }
+    Thread::SetCurrent(nullptr);
+
+    // A program that ran to completion has nothing left to resume, unlike one stopped by its step quota
+    if (isCheckpointing && !mProcesses.front()->IsStopped())
+        std::remove(mCheckpointName.c_str());
+
+    // The programs are over, everything they printed must be out
+    for (auto& thread : mThreads)
+        thread->GetOutput().Flush();
+
+    mThreads.clear();
+    mReclaimedThreads.clear();
 
-    // TODO: Clean up the rest of the threads?
+    // The next process loaded starts another run
+    mFinishedProcesses = std::move(mProcesses);
+    mProcesses.clear();
 }
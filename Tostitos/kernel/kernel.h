@@ -3,12 +3,32 @@
 
 // TODO: Comments
 
+#include "checkpointer.h"
+#include "process.h"
 #include "scheduler.h"
+#include "schedulermetrics.h"
+#include "workerpool.h"
+#include "../threading/joinhandle.h"
+#include <iosfwd>
 #include <memory>
+#include <mutex>
+#include <string>
+#include <vector>
 
 namespace Threading
 {
     class Thread;
+
+    namespace impl
+    {
+        class CallStack;
+        class CompiledFunction;
+        class InterpretedValue;
+        class OutputBuffer;
+#ifdef USE_COROUTINES
+        struct CoroutineFunction;
+#endif
+    }
 }
 
 namespace TosLang
@@ -16,6 +36,7 @@ namespace TosLang
     namespace FrontEnd
     {
         class ASTNode;
+        class PurityAnalysis;
         class SymbolTable;
     }
 }
@@ -24,6 +45,31 @@ namespace KernelSpace
 {
 	class Kernel
 	{
+    public:
+        /*
+        * \enum  ExecutionTier
+        * \brief How the programs run by the kernel are executed
+        */
+        enum class ExecutionTier
+        {
+            AST_WALKER, /*!< Walk the AST of the program */
+            CLOSURES,   /*!< Compile the program to closures first, falling back to the AST walker if it can't be compiled */
+#ifdef USE_COROUTINES
+            COROUTINES, /*!< Run the program as coroutines, falling back to the closures when it must be checkpointed or isn't supported */
+#endif
+        };
+
+        /*
+        * \struct ReleasedThreads
+        * \brief  Threads a finished thread was holding up, which must be scheduled again
+        */
+        struct ReleasedThreads
+        {
+            Threading::Thread* parent;      /*!< Parent blocked on a sync, if this was its last child */
+            Threading::Thread* joiner;      /*!< Thread joining the finished one, if any */
+            Threading::Thread* admitted;    /*!< Thread of the same process that was waiting for a slot, if any */
+        };
+
     public:
         ~Kernel();
 
@@ -31,12 +77,48 @@ namespace KernelSpace
         static Kernel& GetInstance();
 
 	public:
-        void RunProgram(const std::string& programName);
+        bool RunProgram(const std::string& programName);     // False if the program couldn't be loaded
+        bool ResumeProgram(const std::string& programName, const std::string& checkpointName);
+        bool Checkpoint(const std::string& checkpointName);
+        void SetCheckpointing(const std::string& checkpointName, size_t interval);
+        void SetExecutionTier(ExecutionTier tier) { mTier = tier; }
+        void SetOutputFlushSize(size_t size) { mOutputFlushSize = size; }
+        void SetWorkerCount(size_t count) { mWorkerCount = count; }   // 0 for one worker per hardware thread
+        void SetQuantum(size_t stepCount);
+        void SetVirtualTime(bool isVirtual) { mUseVirtualTime = isVirtual; }   // Sleeps end as soon as only sleepers are left
+        bool SetInputFile(const std::string& fileName);
+
+    public:
+        // The processes loaded one after the other run together, on the same scheduler or worker pool, with RunProcesses.
+        // A program that doesn't parse or type check isn't loaded, nullptr is returned instead.
+        Process* LoadProcess(const std::string& programName, const ProcessQuotas& quotas = ProcessQuotas{});
+        void RunProcesses();
+
+    public:
+        const SchedulerMetrics& GetMetrics() const { return mMetrics; }
+        std::vector<Threading::ThreadMetrics> GetLiveThreadMetrics();
+        void DumpMetrics(std::ostream& out);    // As JSON
 
     public:
         void AddThread(std::unique_ptr<Threading::Thread>&& thread);
+        // Spawned by the current thread, which keeps the new thread's handle. The index of the handle is returned (see Join).
+        int SpawnThread(const TosLang::FrontEnd::ASTNode* root, const TosLang::FrontEnd::SymbolTable* symTab,
+                        Threading::impl::CallStack&& stack);
+        int SpawnThread(const Threading::impl::CompiledFunction* fn, std::vector<Threading::impl::InterpretedValue>&& args);
+#ifdef USE_COROUTINES
+        int SpawnThread(const Threading::impl::CoroutineFunction* fn, std::vector<Threading::impl::InterpretedValue>&& args);
+#endif
+        ReleasedThreads ReleaseThread(Threading::Thread* thread);
+        Threading::Thread* BlockThread(Threading::Thread* thread);     // Blocked on a sync or a join, returns a thread to schedule in its place
         void SleepFor(size_t nbSecs);
         void Sync();
+        void Join(int handleID);        // Waits for the child behind the handle alone
+        Threading::impl::OutputBuffer& GetCurrentThreadOutput();
+
+    public:
+        static const size_t DEFAULT_QUANTUM = 256;  // Nodes (AST walker) or statements (closures) run by a thread before the next one's turn
+        static const size_t MAX_FREE_THREADS = 64;  // Finished threads kept around for the next spawns
+        static const size_t RECLAIM_BATCH_SIZE = 64;    // Finished threads taken out of the thread list at once, at least
 
     private:
         Kernel();
@@ -44,16 +126,36 @@ namespace KernelSpace
         void operator=(const Kernel&) = delete;
 
     private:
+        Process* LoadProgram(const std::string& programName, const ProcessQuotas& quotas, bool isResuming);
+        void StartProcess(Process& process);
+        void PrepareWorkers();
+        bool IsCheckpointing() const;
+        void RegisterMemoizedFunctions(const Process& process, const TosLang::FrontEnd::PurityAnalysis& purityAnalysis);
         void Run();
+        std::unique_ptr<Threading::Thread> TakeFreeThread();
+        int KeepJoinHandle(const Threading::JoinHandle& handle);
+        void ReclaimThread(Threading::Thread* thread);
+        void CompactThreads();
 
     private:
-        Threading::Thread* mCurrentThread;
         std::vector<std::unique_ptr<Threading::Thread>> mThreads;
+        std::mutex mThreadsMutex;           // Threads can be added from several workers at once
+        std::vector<Threading::Thread*> mReclaimedThreads;              // Finished threads still in the thread list
+        std::vector<std::unique_ptr<Threading::Thread>> mFreeThreads;   // Finished threads waiting to be reused
+        size_t mNextThreadID;
+        SchedulerMetrics mMetrics;
         Scheduler mScheduler;
-
-    private:    // TODO: Temporarily put there.
-        std::unique_ptr<TosLang::FrontEnd::ASTNode> mRoot;
-        std::shared_ptr<TosLang::FrontEnd::SymbolTable> mSymTable;
+        std::unique_ptr<WorkerPool> mWorkerPool;    // Only there while a program runs on several workers
+        size_t mWorkerCount;
+        size_t mQuantum;
+        bool mUseVirtualTime;
+        ExecutionTier mTier;
+        size_t mOutputFlushSize;
+        Checkpointer mCheckpointer;
+        std::string mCheckpointName;        // File the periodic checkpoints go to
+        size_t mCheckpointInterval;         // Number of statements executed between two checkpoints, 0 if there are none
+        std::vector<std::unique_ptr<Process>> mProcesses;           // Processes loaded for the next run, or running
+        std::vector<std::unique_ptr<Process>> mFinishedProcesses;   // Processes of the last run, the caches and metrics still refer to them
 	};
 }
 
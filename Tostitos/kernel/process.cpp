@@ -0,0 +1,82 @@
+#include "process.h"
+
+#include "../threading/closurecompiler.h"
+#ifdef USE_COROUTINES
+#include "../threading/coroutineexecutor.h"
+#endif
+
+#include "../../TosLang/AST/ast.h"
+#include "../../TosLang/Sema/symboltable.h"
+
+using namespace KernelSpace;
+using namespace Threading;
+using namespace TosLang::FrontEnd;
+
+Process::Process(size_t id, const std::string& name, std::unique_ptr<ASTNode>&& root,
+                 const std::shared_ptr<SymbolTable>& symTab, const ProcessQuotas& quotas)
+    : mID{ id }, mName{ name }, mRoot{ std::move(root) }, mSymTable{ symTab }, mCompiledProgram{ },
+#ifdef USE_COROUTINES
+      mCoroutineProgram{ },
+#endif
+      mGlobals{ }, mQuotas(quotas), mRunningCount{ 0 }, mWaitingThreads{ }, mStepCount{ 0 }, mIsStopped{ false }
+{
+    // Every thread of the program reads and writes the same global variables
+    mGlobals.Reset(mRoot.get(), mSymTable.get());
+}
+
+Process::~Process() = default;
+
+void Process::SetCompiledProgram(std::unique_ptr<impl::CompiledProgram>&& program)
+{
+    mCompiledProgram = std::move(program);
+}
+
+#ifdef USE_COROUTINES
+void Process::SetCoroutineProgram(std::unique_ptr<impl::CoroutineProgram>&& program)
+{
+    mCoroutineProgram = std::move(program);
+}
+#endif
+
+bool Process::IsCompiled() const
+{
+#ifdef USE_COROUTINES
+    if (mCoroutineProgram != nullptr)
+        return true;
+#endif
+
+    return mCompiledProgram != nullptr;
+}
+
+bool Process::AdmitThread(Thread* thread)
+{
+    if ((mQuotas.maxThreads != 0) && (mRunningCount >= mQuotas.maxThreads))
+    {
+        mWaitingThreads.push_back(thread);
+        return false;
+    }
+
+    ++mRunningCount;
+    return true;
+}
+
+Thread* Process::ReleaseSlot()
+{
+    // The first thread waiting takes the slot over
+    if (!mWaitingThreads.empty())
+    {
+        Thread* thread = mWaitingThreads.front();
+        mWaitingThreads.pop_front();
+        return thread;
+    }
+
+    --mRunningCount;
+    return nullptr;
+}
+
+void Process::ChargeSteps(size_t stepCount)
+{
+    const size_t totalCount = mStepCount.fetch_add(stepCount, std::memory_order_relaxed) + stepCount;
+    if ((mQuotas.maxSteps != 0) && (totalCount >= mQuotas.maxSteps))
+        mIsStopped.store(true, std::memory_order_relaxed);
+}
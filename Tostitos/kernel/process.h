@@ -0,0 +1,151 @@
+#ifndef PROCESS_H__TOSTITOS
+#define PROCESS_H__TOSTITOS
+
+#include "../threading/globalstore.h"
+
+#include <atomic>
+#include <cstddef>
+#include <deque>
+#include <memory>
+#include <string>
+
+namespace Threading
+{
+    class Thread;
+
+    namespace impl
+    {
+        class CompiledProgram;
+#ifdef USE_COROUTINES
+        class CoroutineProgram;
+#endif
+    }
+}
+
+namespace TosLang
+{
+    namespace FrontEnd
+    {
+        class ASTNode;
+        class SymbolTable;
+    }
+}
+
+namespace KernelSpace
+{
+    /*
+    * \struct ProcessQuotas
+    * \brief  Resources a process can use, 0 meaning there is no limit
+    */
+    struct ProcessQuotas
+    {
+        size_t maxThreads = 0;  /*!< Threads of the process running at once, those blocked on a sync or a join aside. The threads spawned past it wait for a slot. */
+        size_t maxSteps = 0;    /*!< Nodes (AST walker) or statements run by all the threads of the process before it is stopped */
+    };
+
+    /*
+    * \class Process
+    * \brief Program loaded in the kernel, along with everything that belongs to it alone: its AST, symbol table,
+    *        compiled forms, global variables and threads. The processes loaded together run side by side on the
+    *        same scheduler or worker pool, and the finished threads kept for reuse go to any of them.
+    *
+    *        A process that used up its steps is stopped: each of its threads finishes at the start of its next
+    *        turn, so that the threads blocked on it are released the usual way. A sleeping thread only stops once
+    *        it wakes up.
+    */
+    class Process
+    {
+    public:
+        /*
+        * \fn           Process
+        * \brief        Creates the process of a parsed program. Its global variables have no value yet.
+        * \param id     Identifier of the process, unique among the processes loaded together
+        * \param name   Name of the program
+        * \param root   Root of the program's AST
+        * \param symTab Symbol table of the program
+        * \param quotas Resources the process can use
+        */
+        Process(size_t id, const std::string& name, std::unique_ptr<TosLang::FrontEnd::ASTNode>&& root,
+                const std::shared_ptr<TosLang::FrontEnd::SymbolTable>& symTab, const ProcessQuotas& quotas);
+        ~Process();
+
+        Process(const Process&) = delete;
+        void operator=(const Process&) = delete;
+
+    public:
+        size_t GetID() const { return mID; }
+        const std::string& GetName() const { return mName; }
+        const std::unique_ptr<TosLang::FrontEnd::ASTNode>& GetRoot() const { return mRoot; }
+        const std::shared_ptr<TosLang::FrontEnd::SymbolTable>& GetSymbolTable() const { return mSymTable; }
+        Threading::impl::GlobalStore& GetGlobals() { return mGlobals; }
+        const ProcessQuotas& GetQuotas() const { return mQuotas; }
+
+        const Threading::impl::CompiledProgram* GetCompiledProgram() const { return mCompiledProgram.get(); }
+        void SetCompiledProgram(std::unique_ptr<Threading::impl::CompiledProgram>&& program);
+#ifdef USE_COROUTINES
+        const Threading::impl::CoroutineProgram* GetCoroutineProgram() const { return mCoroutineProgram.get(); }
+        void SetCoroutineProgram(std::unique_ptr<Threading::impl::CoroutineProgram>&& program);
+#endif
+
+        // Was the program compiled (closures, coroutines) rather than left to the AST walker?
+        bool IsCompiled() const;
+
+    public:
+        /*
+        * \fn           AdmitThread
+        * \brief        Counts a new thread of the process. Only called with the kernel's thread list locked.
+        * \param thread New thread
+        * \return       False if the process already runs as many threads as its quota allows. The thread then
+        *               waits for a slot instead of being scheduled.
+        */
+        bool AdmitThread(Threading::Thread* thread);
+
+        /*
+        * \fn           ReleaseSlot
+        * \brief        Counts a thread of the process that finished or blocked on a sync or a join.
+        *               Only called with the kernel's thread list locked.
+        * \return       Thread that was waiting for a slot and must now be scheduled, if any
+        */
+        Threading::Thread* ReleaseSlot();
+
+        /*
+        * \fn           ReclaimSlot
+        * \brief        Counts a thread of the process released from a sync or a join. It runs again right away,
+        *               even if that goes past the quota until another thread of the process releases its slot.
+        *               Only called with the kernel's thread list locked.
+        */
+        void ReclaimSlot() { ++mRunningCount; }
+
+        /*
+        * \fn           ChargeSteps
+        * \brief        Counts the steps run by one of the threads of the process, stopping it once its quota is used up
+        * \param stepCount  Steps run during the thread's turn
+        */
+        void ChargeSteps(size_t stepCount);
+
+        bool IsStopped() const { return mIsStopped.load(std::memory_order_relaxed); }
+        size_t GetStepCount() const { return mStepCount.load(std::memory_order_relaxed); }
+
+        // Would running that many more steps, on top of those already charged, use up the quota?
+        bool IsOverQuota(size_t stepCount) const { return (mQuotas.maxSteps != 0) && (GetStepCount() + stepCount >= mQuotas.maxSteps); }
+
+    private:
+        size_t mID;
+        std::string mName;
+        std::unique_ptr<TosLang::FrontEnd::ASTNode> mRoot;
+        std::shared_ptr<TosLang::FrontEnd::SymbolTable> mSymTable;
+        std::unique_ptr<Threading::impl::CompiledProgram> mCompiledProgram;
+#ifdef USE_COROUTINES
+        std::unique_ptr<Threading::impl::CoroutineProgram> mCoroutineProgram;
+#endif
+        Threading::impl::GlobalStore mGlobals;
+        ProcessQuotas mQuotas;
+
+        size_t mRunningCount;                           /*!< Threads holding a slot: admitted, neither finished nor blocked */
+        std::deque<Threading::Thread*> mWaitingThreads; /*!< Threads waiting for a slot, in spawn order */
+        std::atomic<size_t> mStepCount;                 /*!< Steps run so far, by all the threads */
+        std::atomic<bool> mIsStopped;                   /*!< Did the process use up its steps? */
+    };
+}
+
+#endif // PROCESS_H__TOSTITOS
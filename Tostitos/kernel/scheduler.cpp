@@ -1,8 +1,10 @@
 #include "scheduler.h"
 
-#include "../threading/thread.h"
+#include "kernel.h"
 
-#include <algorithm>
+#include "../threading/sleepclock.h"
+
+#include <thread>
 
 using namespace KernelSpace;
 using namespace Threading;
@@ -11,34 +13,66 @@ Thread* Scheduler::FindNextThreadToRun(Thread* runningThread)
 {
     if (runningThread != nullptr)
     {
-        // If it's not done and not stopped, keep going
-        if (!runningThread->HasFinished() &&
-            !runningThread->IsWaitingForChildren() &&
-            !runningThread->IsSleeping())
-        {
-            return runningThread;
-        }
-
-        // If it's done, remove it from the list
+        // A thread that can't go on is filed away until it can, otherwise it waits for its next turn
         if (runningThread->HasFinished())
+            TerminateThread(runningThread);
+        else if (runningThread->IsSleeping())
+            mSleepingThreads.push({ runningThread->GetWakeUpTime(), mSleepOrder++, runningThread });
+        else if (!runningThread->IsWaitingForChildren() || !runningThread->Block())
+            mReadyQueue.push_back(runningThread);
+        else if (Thread* admitted = Kernel::GetInstance().BlockThread(runningThread))
+            mReadyQueue.push_back(admitted);
+    }
+
+    for (;;)
+    {
+        WakeUpSleepingThreads();
+
+        if (!mReadyQueue.empty())
         {
-            mThreadList.erase(std::find(mThreadList.begin(), mThreadList.end(), runningThread));
+            Thread* nextThread = mReadyQueue.front();
+            mReadyQueue.pop_front();
+            return nextThread;
         }
-    }
 
-    // The next thread to run will simply be the first one in our list
-	if (!mThreadList.empty())
-        return mThreadList.front();
-	else
-		return nullptr;
+        if (mSleepingThreads.empty())
+            return nullptr;
+
+        // Only sleepers are left, no point in polling them until the first one wakes up. A virtual clock doesn't even have to wait.
+        SleepClock& clock = SleepClock::GetInstance();
+        if (clock.IsVirtual())
+            clock.AdvanceTo(mSleepingThreads.top().wakeUpTime);
+        else
+            std::this_thread::sleep_until(mSleepingThreads.top().wakeUpTime);
+    }
 }
 
 void Scheduler::ScheduleThread(Thread* thread)
 {
-	mThreadList.push_back(thread);
+    mReadyQueue.push_back(thread);
 }
 
 void Scheduler::TerminateThread(Thread* thread)
 {
-    mThreadList.erase(std::remove(mThreadList.begin(), mThreadList.end(), thread));
+    const Kernel::ReleasedThreads released = Kernel::GetInstance().ReleaseThread(thread);
+    if (released.parent != nullptr)
+        mReadyQueue.push_back(released.parent);
+    if (released.joiner != nullptr)
+        mReadyQueue.push_back(released.joiner);
+    if (released.admitted != nullptr)
+        mReadyQueue.push_back(released.admitted);
+}
+
+void Scheduler::WakeUpSleepingThreads()
+{
+    // The clock is only read when someone is sleeping
+    if (mSleepingThreads.empty())
+        return;
+
+    const Thread::Clock::time_point now = SleepClock::GetInstance().Now();
+    while (!mSleepingThreads.empty() && (mSleepingThreads.top().wakeUpTime <= now))
+    {
+        mReadyQueue.push_back(mSleepingThreads.top().thread);
+        mSleepingThreads.pop();
+    }
 }
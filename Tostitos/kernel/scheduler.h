@@ -1,27 +1,81 @@
 #ifndef SCHEDULER_H__TOSTITOS
 #define SCHEDULER_H__TOSTITOS
 
-// TODO: Comments
+#include "../threading/thread.h"
 
+#include <cstddef>
+#include <deque>
+#include <functional>
+#include <queue>
 #include <vector>
 
-namespace Threading
-{
-    class Thread;
-}
-
 namespace KernelSpace
 {
+    /*
+    * \class Scheduler
+    * \brief Picks the thread the kernel runs next. Threads that can run wait their turn in a FIFO ready queue, a
+    *        thread that used up its quantum goes back at the end of it.
+    *        Sleeping threads are kept in a min-heap ordered by wake-up time, so they aren't looked at again until
+    *        they wake up. A thread blocked on a sync isn't kept anywhere, its last child hands it back when done.
+    */
 	class Scheduler
 	{
-	private:
-		std::vector<Threading::Thread*> mThreadList;
-        
     public:
-		Threading::Thread* FindNextThreadToRun(Threading::Thread* RunningThread);
-		void ScheduleThread(Threading::Thread* T);
-		void TerminateThread(Threading::Thread* T);
+        Scheduler() : mReadyQueue{}, mSleepingThreads{}, mSleepOrder{ 0 } { }
+
+        Scheduler(const Scheduler&) = delete;
+        void operator=(const Scheduler&) = delete;
+
+    public:
+        /*
+        * \fn                   FindNextThreadToRun
+        * \brief                Files the thread that just ran according to its state and finds the next thread to run.
+        *                       Blocks the calling host thread if every remaining thread is asleep.
+        * \param runningThread  Thread that just ran its quantum, nullptr if none
+        * \return               Thread to run, nullptr when no thread can ever run again
+        */
+		Threading::Thread* FindNextThreadToRun(Threading::Thread* runningThread);
+
+        /*
+        * \fn           ScheduleThread
+        * \brief        Adds a thread at the back of the ready queue
+        * \param thread Thread to schedule
+        */
+		void ScheduleThread(Threading::Thread* thread);
+
+        /*
+        * \fn           TerminateThread
+        * \brief        Forgets about a thread that has finished, scheduling its parent again if it was the last child it waited for
+        * \param thread Finished thread
+        */
+		void TerminateThread(Threading::Thread* thread);
+
+    private:
+        /*
+        * \struct SleepingThread
+        * \brief  Entry of the sleepers heap. Threads waking up at the same time wake up in the order they fell asleep.
+        */
+        struct SleepingThread
+        {
+            Threading::Thread::Clock::time_point wakeUpTime;
+            size_t order;
+            Threading::Thread* thread;
+
+            bool operator>(const SleepingThread& other) const
+            {
+                return (wakeUpTime != other.wakeUpTime) ? (wakeUpTime > other.wakeUpTime) : (order > other.order);
+            }
+        };
+
+    private:
+        void WakeUpSleepingThreads();
+
+    private:
+        std::deque<Threading::Thread*> mReadyQueue;                                 /*!< Threads that can run, in turn order */
+        std::priority_queue<SleepingThread, std::vector<SleepingThread>,
+                            std::greater<SleepingThread>> mSleepingThreads;         /*!< Sleeping threads, earliest wake-up on top */
+        size_t mSleepOrder;                                                         /*!< Number of threads put to sleep so far */
 	};
 }
 
-#endif
\ No newline at end of file
+#endif // SCHEDULER_H__TOSTITOS
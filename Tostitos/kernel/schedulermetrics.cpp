@@ -0,0 +1,117 @@
+#include "schedulermetrics.h"
+
+#include <ostream>
+
+using namespace KernelSpace;
+using namespace Threading;
+
+namespace chr = std::chrono;
+
+namespace
+{
+    uint64_t ToMicroseconds(ThreadMetrics::Duration duration)
+    {
+        return static_cast<uint64_t>(chr::duration_cast<chr::microseconds>(duration).count());
+    }
+
+    void WriteThreadFields(std::ostream& out, const ThreadMetrics& metrics)
+    {
+        out << "\"cpuTimeUs\": " << ToMicroseconds(metrics.cpuTime)
+            << ", \"steps\": " << metrics.stepCount
+            << ", \"contextSwitches\": " << metrics.switchCount
+            << ", \"readyTimeUs\": " << ToMicroseconds(metrics.readyTime)
+            << ", \"sleepTimeUs\": " << ToMicroseconds(metrics.sleepTime)
+            << ", \"blockedTimeUs\": " << ToMicroseconds(metrics.blockedTime);
+    }
+}
+
+SchedulerMetrics::SchedulerMetrics() : mLatencyBuckets{}, mTotalsMutex{}, mFinishedTotals{}, mFinishedCount{ 0 }
+{
+    Reset();
+}
+
+void SchedulerMetrics::Reset()
+{
+    for (auto& bucket : mLatencyBuckets)
+        bucket.store(0, std::memory_order_relaxed);
+
+    std::lock_guard<std::mutex> lock{ mTotalsMutex };
+    mFinishedTotals = {};
+    mFinishedCount = 0;
+}
+
+void SchedulerMetrics::RecordLatency(ThreadMetrics::Duration latency)
+{
+    // The bucket is the number of bits of the latency in microseconds
+    uint64_t microseconds = ToMicroseconds(latency);
+    size_t bucket = 0;
+    while ((microseconds != 0) && (bucket < BUCKET_COUNT - 1))
+    {
+        microseconds >>= 1;
+        ++bucket;
+    }
+
+    mLatencyBuckets[bucket].fetch_add(1, std::memory_order_relaxed);
+}
+
+void SchedulerMetrics::AddFinishedThread(const ThreadMetrics& metrics)
+{
+    std::lock_guard<std::mutex> lock{ mTotalsMutex };
+    mFinishedTotals.Add(metrics);
+    ++mFinishedCount;
+}
+
+ThreadMetrics SchedulerMetrics::GetFinishedTotals() const
+{
+    std::lock_guard<std::mutex> lock{ mTotalsMutex };
+    return mFinishedTotals;
+}
+
+size_t SchedulerMetrics::GetFinishedCount() const
+{
+    std::lock_guard<std::mutex> lock{ mTotalsMutex };
+    return mFinishedCount;
+}
+
+std::array<uint64_t, SchedulerMetrics::BUCKET_COUNT> SchedulerMetrics::GetLatencyHistogram() const
+{
+    std::array<uint64_t, BUCKET_COUNT> histogram;
+    for (size_t iBucket = 0; iBucket < BUCKET_COUNT; ++iBucket)
+        histogram[iBucket] = mLatencyBuckets[iBucket].load(std::memory_order_relaxed);
+
+    return histogram;
+}
+
+void SchedulerMetrics::WriteJSON(std::ostream& out, const std::vector<ThreadMetrics>& liveThreads) const
+{
+    out << "{\n  \"finishedThreads\": { \"count\": " << GetFinishedCount() << ", ";
+    WriteThreadFields(out, GetFinishedTotals());
+    out << " },\n";
+
+    out << "  \"liveThreads\": [";
+    for (size_t iThread = 0; iThread < liveThreads.size(); ++iThread)
+    {
+        out << (iThread == 0 ? "\n" : ",\n") << "    { \"id\": " << liveThreads[iThread].threadID << ", ";
+        WriteThreadFields(out, liveThreads[iThread]);
+        out << " }";
+    }
+    out << (liveThreads.empty() ? "],\n" : "\n  ],\n");
+
+    // Only the buckets up to the last one used are written, each with its upper bound
+    const std::array<uint64_t, BUCKET_COUNT> histogram = GetLatencyHistogram();
+    size_t bucketCount = BUCKET_COUNT;
+    while ((bucketCount > 0) && (histogram[bucketCount - 1] == 0))
+        --bucketCount;
+
+    out << "  \"schedulingLatencyUs\": [";
+    for (size_t iBucket = 0; iBucket < bucketCount; ++iBucket)
+    {
+        out << (iBucket == 0 ? "\n" : ",\n") << "    { \"below\": ";
+        if (iBucket == BUCKET_COUNT - 1)
+            out << "null";
+        else
+            out << (static_cast<uint64_t>(1) << iBucket);
+        out << ", \"count\": " << histogram[iBucket] << " }";
+    }
+    out << (bucketCount == 0 ? "]\n" : "\n  ]\n") << "}\n";
+}
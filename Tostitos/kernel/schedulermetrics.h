@@ -0,0 +1,75 @@
+#ifndef SCHEDULER_METRICS_H__TOSTITOS
+#define SCHEDULER_METRICS_H__TOSTITOS
+
+#include "../threading/threadmetrics.h"
+
+#include <array>
+#include <atomic>
+#include <cstddef>
+#include <cstdint>
+#include <iosfwd>
+#include <mutex>
+#include <vector>
+
+namespace KernelSpace
+{
+    /*
+    * \class SchedulerMetrics
+    * \brief Metrics of the threads of a program. A finished thread's metrics are added to the totals, so the memory
+    *        used doesn't depend on how many threads the program spawns. The latency of every turn given to a thread
+    *        (how long it waited while able to run) goes to a histogram. Can be fed from several workers at once.
+    */
+    class SchedulerMetrics
+    {
+    public:
+        static const size_t BUCKET_COUNT = 32;  /*!< Bucket i counts latencies under 2^i microseconds, the last one counts the rest */
+
+    public:
+        SchedulerMetrics();
+
+        SchedulerMetrics(const SchedulerMetrics&) = delete;
+        void operator=(const SchedulerMetrics&) = delete;
+
+    public:
+        /*
+        * \fn           Reset
+        * \brief        Forgets everything recorded so far
+        */
+        void Reset();
+
+        /*
+        * \fn           RecordLatency
+        * \brief        Adds the latency of a turn to the histogram
+        * \param latency    Time the thread waited to run
+        */
+        void RecordLatency(Threading::ThreadMetrics::Duration latency);
+
+        /*
+        * \fn           AddFinishedThread
+        * \brief        Adds the metrics of a thread that has finished to the totals
+        * \param metrics    Metrics of the thread
+        */
+        void AddFinishedThread(const Threading::ThreadMetrics& metrics);
+
+        /*
+        * \fn           WriteJSON
+        * \brief        Writes the metrics as a JSON object
+        * \param out    Stream to write to
+        * \param liveThreads    Metrics of the threads that haven't finished yet
+        */
+        void WriteJSON(std::ostream& out, const std::vector<Threading::ThreadMetrics>& liveThreads) const;
+
+    public:
+        Threading::ThreadMetrics GetFinishedTotals() const;
+        size_t GetFinishedCount() const;
+        std::array<uint64_t, BUCKET_COUNT> GetLatencyHistogram() const;
+
+    private:
+        std::array<std::atomic<uint64_t>, BUCKET_COUNT> mLatencyBuckets;
+        mutable std::mutex mTotalsMutex;
+        Threading::ThreadMetrics mFinishedTotals;   /*!< Sum of the metrics of the finished threads */
+        size_t mFinishedCount;
+    };
+}
+
+#endif // SCHEDULER_METRICS_H__TOSTITOS
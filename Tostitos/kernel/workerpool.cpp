@@ -0,0 +1,202 @@
+#include "workerpool.h"
+
+#include "kernel.h"
+
+#include "../threading/thread.h"
+
+#include <cassert>
+#include <chrono>
+
+using namespace KernelSpace;
+using namespace Threading;
+
+thread_local WorkerPool::Worker* WorkerPool::CurrentWorker = nullptr;
+
+namespace
+{
+    bool IsRunnable(Thread* thread)
+    {
+        return !thread->HasFinished() && !thread->IsSleeping() && !thread->IsWaitingForChildren();
+    }
+}
+
+WorkerPool::WorkerPool(size_t workerCount, size_t quantum, SchedulerMetrics& metrics)
+    : mWorkers{}, mQuantum{ quantum }, mMetrics(metrics), mLiveThreadCount{ 0 }, mParkedMutex{}, mParkedThreads{}, mParkedCount{ 0 }
+{
+    assert(workerCount > 0);
+    assert(quantum > 0);
+
+    for (size_t iWorker = 0; iWorker < workerCount; ++iWorker)
+    {
+        mWorkers.emplace_back(new Worker{});
+        mWorkers.back()->pool = this;
+        mWorkers.back()->victimSeed = static_cast<unsigned>(iWorker) * 2654435761u + 1;
+    }
+}
+
+WorkerPool::~WorkerPool() = default;
+
+void WorkerPool::ScheduleThread(Thread* thread)
+{
+    mLiveThreadCount.fetch_add(1, std::memory_order_relaxed);
+
+    // Only the owner of a deque can push to it. A thread coming from outside the workers
+    // (e.g. the main thread, before the pool runs) goes through the parked list instead.
+    if ((CurrentWorker != nullptr) && (CurrentWorker->pool == this))
+        CurrentWorker->ready.Push(thread);
+    else
+        ParkThread(thread);
+}
+
+void WorkerPool::Run()
+{
+    std::vector<std::thread> hostThreads;
+    for (size_t iWorker = 1; iWorker < mWorkers.size(); ++iWorker)
+    {
+        Worker& worker = *mWorkers[iWorker];
+        hostThreads.emplace_back([this, &worker]() { RunWorker(worker); });
+    }
+
+    RunWorker(*mWorkers.front());
+
+    for (std::thread& hostThread : hostThreads)
+        hostThread.join();
+}
+
+void WorkerPool::RunWorker(Worker& worker)
+{
+    Worker* previousWorker = CurrentWorker;
+    CurrentWorker = &worker;
+
+    bool wasPreempted = false;
+    size_t idleRounds = 0;
+    for (;;)
+    {
+        Thread* thread = FindThread(worker, wasPreempted);
+        if (thread == nullptr)
+        {
+            if (mLiveThreadCount.load(std::memory_order_acquire) == 0)
+                break;
+
+            if (WakeParkedThreads(worker))
+                continue;
+
+            // Nothing to do until a parked thread wakes up or a busy worker spawns something. Spinning
+            // a little catches the spawns quickly, but sleeping threads can take seconds to wake up.
+            if (++idleRounds < 64)
+                std::this_thread::yield();
+            else
+                std::this_thread::sleep_for(std::chrono::milliseconds(1));
+            continue;
+        }
+
+        idleRounds = 0;
+
+        Thread::SetCurrent(thread);
+        if (IsRunnable(thread))
+        {
+            thread->Execute(mQuantum);
+            mMetrics.RecordLatency(thread->GetMetrics().lastReadyLatency);
+        }
+        Thread::SetCurrent(nullptr);
+
+        wasPreempted = false;
+        if (thread->HasFinished())
+        {
+            const Kernel::ReleasedThreads released = Kernel::GetInstance().ReleaseThread(thread);
+            if (released.parent != nullptr)
+                worker.ready.Push(released.parent);
+            if (released.joiner != nullptr)
+                worker.ready.Push(released.joiner);
+            if (released.admitted != nullptr)
+                ScheduleThread(released.admitted);
+
+            mLiveThreadCount.fetch_sub(1, std::memory_order_acq_rel);
+        }
+        else if (thread->IsSleeping())
+            ParkThread(thread);
+        else if (!thread->IsWaitingForChildren() || !thread->Block())
+        {
+            // Used its whole quantum, the other threads of the deque get their turn. A thread that did block on
+            // its children is left alone, another worker might even be running it already if they just finished.
+            worker.ready.Push(thread);
+            wasPreempted = true;
+        }
+        else if (Thread* admitted = Kernel::GetInstance().BlockThread(thread))
+            ScheduleThread(admitted);
+
+        // A worker that is never idle must still wake the parked threads
+        if (mParkedCount.load(std::memory_order_relaxed) != 0)
+            WakeParkedThreads(worker);
+    }
+
+    CurrentWorker = previousWorker;
+}
+
+Thread* WorkerPool::FindThread(Worker& worker, bool wasPreempted)
+{
+    // The newest thread is usually the one that was just spawned, its data is still in the cache. After a preemption
+    // though, the newest is the thread that was just stopped and the oldest one is taken instead to rotate fairly.
+    Thread* thread = wasPreempted ? worker.ready.Steal() : worker.ready.Pop();
+    if (thread == nullptr)
+        thread = worker.ready.Pop();
+
+    return (thread != nullptr) ? thread : StealThread(worker);
+}
+
+Thread* WorkerPool::StealThread(Worker& worker)
+{
+    if (mWorkers.size() == 1)
+        return nullptr;
+
+    // Starting from a random victim so that the idle workers don't all go after the same one
+    worker.victimSeed = worker.victimSeed * 1103515245u + 12345u;
+    const size_t firstVictim = (worker.victimSeed >> 16) % mWorkers.size();
+
+    for (size_t iVictim = 0; iVictim < mWorkers.size(); ++iVictim)
+    {
+        Worker& victim = *mWorkers[(firstVictim + iVictim) % mWorkers.size()];
+        if (&victim == &worker)
+            continue;
+
+        if (Thread* thread = victim.ready.Steal())
+            return thread;
+    }
+
+    return nullptr;
+}
+
+void WorkerPool::ParkThread(Thread* thread)
+{
+    std::lock_guard<std::mutex> lock{ mParkedMutex };
+    mParkedThreads.push_back(thread);
+    mParkedCount.store(mParkedThreads.size(), std::memory_order_relaxed);
+}
+
+bool WorkerPool::WakeParkedThreads(Worker& worker)
+{
+    // Another worker already looking at the list will do just as well
+    std::unique_lock<std::mutex> lock{ mParkedMutex, std::try_to_lock };
+    if (!lock.owns_lock())
+        return false;
+
+    bool hasWoken = false;
+    for (size_t iThread = 0; iThread < mParkedThreads.size();)
+    {
+        Thread* thread = mParkedThreads[iThread];
+        if (thread->IsSleeping())
+        {
+            ++iThread;
+            continue;
+        }
+
+        worker.ready.Push(thread);
+        hasWoken = true;
+
+        mParkedThreads[iThread] = mParkedThreads.back();
+        mParkedThreads.pop_back();
+    }
+
+    mParkedCount.store(mParkedThreads.size(), std::memory_order_relaxed);
+    return hasWoken;
+}
@@ -0,0 +1,97 @@
+#ifndef WORKER_POOL_H__TOSTITOS
+#define WORKER_POOL_H__TOSTITOS
+
+#include "schedulermetrics.h"
+#include "workstealingdeque.h"
+
+#include <atomic>
+#include <cstddef>
+#include <memory>
+#include <mutex>
+#include <thread>
+#include <vector>
+
+namespace Threading
+{
+    class Thread;
+}
+
+namespace KernelSpace
+{
+    /*
+    * \class WorkerPool
+    * \brief Runs the threads of a program on several host threads (M:N). Each worker has its own deque of ready
+    *        threads, a thread spawned by a worker goes to that worker's deque. A worker runs a thread for its quantum
+    *        then moves on to the oldest thread of its deque, and a worker whose deque is empty
+    *        steals the oldest thread of another one. Sleeping threads are parked in a list shared by all
+    *        workers, which put them back in their deque once they wake up. A thread blocked on a sync goes back
+    *        to the deque of the worker that runs its last child, once that child is done.
+    *
+    *        The calling host thread is one of the workers, so a pool of N workers only starts N - 1 host threads.
+    */
+    class WorkerPool
+    {
+    public:
+        /*
+        * \fn           WorkerPool
+        * \brief        Ctor
+        * \param workerCount    Number of workers, at least 1
+        * \param quantum        Number of steps a thread runs before another one gets a turn, at least 1
+        * \param metrics        Where the latency of each turn is recorded
+        */
+        WorkerPool(size_t workerCount, size_t quantum, SchedulerMetrics& metrics);
+        ~WorkerPool();
+
+        WorkerPool(const WorkerPool&) = delete;
+        void operator=(const WorkerPool&) = delete;
+
+    public:
+        /*
+        * \fn           ScheduleThread
+        * \brief        Adds a new thread to the pool. From a worker, the thread goes to that worker's deque.
+        * \param thread Thread to run
+        */
+        void ScheduleThread(Threading::Thread* thread);
+
+        /*
+        * \fn           Run
+        * \brief        Runs the threads until all of them have finished
+        */
+        void Run();
+
+    public:
+        size_t GetWorkerCount() const { return mWorkers.size(); }
+
+    private:
+        /*
+        * \struct Worker
+        * \brief  Host thread running threads of the pool
+        */
+        struct Worker
+        {
+            WorkStealingDeque<Threading::Thread> ready;     /*!< Threads ready to run, stolen from the top */
+            WorkerPool* pool;                               /*!< Pool the worker belongs to */
+            unsigned victimSeed;                            /*!< State of the generator picking the workers to steal from */
+        };
+
+    private:
+        void RunWorker(Worker& worker);
+        Threading::Thread* FindThread(Worker& worker, bool wasPreempted);
+        Threading::Thread* StealThread(Worker& worker);
+        void ParkThread(Threading::Thread* thread);
+        bool WakeParkedThreads(Worker& worker);
+
+    private:
+        static thread_local Worker* CurrentWorker;
+
+        std::vector<std::unique_ptr<Worker>> mWorkers;
+        size_t mQuantum;
+        SchedulerMetrics& mMetrics;
+        std::atomic<size_t> mLiveThreadCount;           /*!< Threads that haven't finished yet */
+        std::mutex mParkedMutex;
+        std::vector<Threading::Thread*> mParkedThreads; /*!< Threads that were sleeping when last run */
+        std::atomic<size_t> mParkedCount;               /*!< Size of the parked list, readable without the lock */
+    };
+}
+
+#endif // WORKER_POOL_H__TOSTITOS
@@ -0,0 +1,147 @@
+#ifndef WORK_STEALING_DEQUE_H__TOSTITOS
+#define WORK_STEALING_DEQUE_H__TOSTITOS
+
+#include <atomic>
+#include <cstddef>
+#include <cstdint>
+#include <memory>
+#include <vector>
+
+namespace KernelSpace
+{
+    /*
+    * \class WorkStealingDeque
+    * \brief Chase-Lev work-stealing deque of pointers. The owner pushes and pops at the bottom without ever
+    *        taking a lock, while any other host thread can steal from the top. Only taking the last item
+    *        makes the owner race with the thieves, which is settled by a compare-and-swap on the top index.
+    *        The circular buffer grows when full. The smaller buffers it replaces can still be read by a thief
+    *        that loaded them before the swap, so they are only released along with the deque.
+    */
+    template <typename T>
+    class WorkStealingDeque
+    {
+    public:
+        explicit WorkStealingDeque(size_t capacity = 64) : mTop{ 0 }, mBottom{ 0 }, mBuffer{ nullptr }, mBuffers{}
+        {
+            // The capacity must be a power of two so that indices wrap around with a mask
+            size_t powerOfTwo = 1;
+            while (powerOfTwo < capacity)
+                powerOfTwo *= 2;
+
+            mBuffers.emplace_back(new Buffer{ powerOfTwo });
+            mBuffer.store(mBuffers.back().get(), std::memory_order_relaxed);
+        }
+
+        WorkStealingDeque(const WorkStealingDeque&) = delete;
+        void operator=(const WorkStealingDeque&) = delete;
+
+    public:
+        /*
+        * \fn           Push
+        * \brief        Adds an item at the bottom. Only the owner can push.
+        * \param item   Item to add
+        */
+        void Push(T* item)
+        {
+            const int64_t bottom = mBottom.load(std::memory_order_relaxed);
+            const int64_t top = mTop.load(std::memory_order_acquire);
+            Buffer* buffer = mBuffer.load(std::memory_order_relaxed);
+
+            if (bottom - top > static_cast<int64_t>(buffer->capacity) - 1)
+                buffer = Grow(buffer, top, bottom);
+
+            // Releasing the item along with the new bottom, a thief seeing the bottom also sees what the item points to
+            buffer->Put(bottom, item);
+            mBottom.store(bottom + 1, std::memory_order_release);
+        }
+
+        /*
+        * \fn           Pop
+        * \brief        Takes the item at the bottom, the one pushed last. Only the owner can pop.
+        * \return       Item taken, nullptr if the deque is empty
+        */
+        T* Pop()
+        {
+            const int64_t bottom = mBottom.load(std::memory_order_relaxed) - 1;
+            Buffer* buffer = mBuffer.load(std::memory_order_relaxed);
+            mBottom.store(bottom, std::memory_order_relaxed);
+            std::atomic_thread_fence(std::memory_order_seq_cst);
+            int64_t top = mTop.load(std::memory_order_relaxed);
+
+            if (top > bottom)
+            {
+                // Empty, putting the bottom back where it was
+                mBottom.store(bottom + 1, std::memory_order_relaxed);
+                return nullptr;
+            }
+
+            T* item = buffer->Get(bottom);
+            if (top == bottom)
+            {
+                // Last item, a thief might be taking it at the same time
+                if (!mTop.compare_exchange_strong(top, top + 1, std::memory_order_seq_cst, std::memory_order_relaxed))
+                    item = nullptr;
+
+                mBottom.store(bottom + 1, std::memory_order_relaxed);
+            }
+
+            return item;
+        }
+
+        /*
+        * \fn           Steal
+        * \brief        Takes the item at the top, the one pushed first. Any host thread can steal.
+        * \return       Item taken, nullptr if the deque is empty or another host thread took the item first
+        */
+        T* Steal()
+        {
+            int64_t top = mTop.load(std::memory_order_acquire);
+            std::atomic_thread_fence(std::memory_order_seq_cst);
+            const int64_t bottom = mBottom.load(std::memory_order_acquire);
+
+            if (top >= bottom)
+                return nullptr;
+
+            T* item = mBuffer.load(std::memory_order_acquire)->Get(top);
+            if (!mTop.compare_exchange_strong(top, top + 1, std::memory_order_seq_cst, std::memory_order_relaxed))
+                return nullptr;
+
+            return item;
+        }
+
+    private:
+        /*
+        * \struct Buffer
+        * \brief  Circular array holding the items
+        */
+        struct Buffer
+        {
+            explicit Buffer(size_t cap) : capacity{ cap }, items{ new std::atomic<T*>[cap] } { }
+
+            T* Get(int64_t idx) const { return items[static_cast<size_t>(idx) & (capacity - 1)].load(std::memory_order_relaxed); }
+            void Put(int64_t idx, T* item) { items[static_cast<size_t>(idx) & (capacity - 1)].store(item, std::memory_order_relaxed); }
+
+            size_t capacity;
+            std::unique_ptr<std::atomic<T*>[]> items;
+        };
+
+        Buffer* Grow(Buffer* buffer, int64_t top, int64_t bottom)
+        {
+            mBuffers.emplace_back(new Buffer{ buffer->capacity * 2 });
+            Buffer* newBuffer = mBuffers.back().get();
+            for (int64_t idx = top; idx < bottom; ++idx)
+                newBuffer->Put(idx, buffer->Get(idx));
+
+            mBuffer.store(newBuffer, std::memory_order_release);
+            return newBuffer;
+        }
+
+    private:
+        std::atomic<int64_t> mTop;                      /*!< Index of the next item to steal */
+        std::atomic<int64_t> mBottom;                   /*!< Index of the next item to push */
+        std::atomic<Buffer*> mBuffer;                   /*!< Buffer currently holding the items */
+        std::vector<std::unique_ptr<Buffer>> mBuffers;  /*!< Every buffer used so far, only touched by the owner */
+    };
+}
+
+#endif // WORK_STEALING_DEQUE_H__TOSTITOS
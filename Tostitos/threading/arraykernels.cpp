@@ -0,0 +1,133 @@
+#include "arraykernels.h"
+
+#include <algorithm>
+#include <cassert>
+#include <climits>
+
+using namespace TosLang::FrontEnd;
+
+namespace
+{
+    using namespace Threading::impl;
+
+    // The kernels take raw pointers and a count: without any bounds checking or aliasing
+    // through vector accessors in the way, their loops are simple enough to be vectorized.
+
+    template <typename Op>
+    std::vector<int> ElementWise(const std::vector<int>& lhs, const std::vector<int>& rhs, Op op)
+    {
+        const size_t count = std::min(lhs.size(), rhs.size());
+        std::vector<int> result(count);
+
+        const int* lhsElems = lhs.data();
+        const int* rhsElems = rhs.data();
+        int* resultElems = result.data();
+        for (size_t iElem = 0; iElem < count; ++iElem)
+            resultElems[iElem] = op(lhsElems[iElem], rhsElems[iElem]);
+
+        return result;
+    }
+
+    int Sum(const int* elems, size_t count)
+    {
+        int sum = 0;
+        for (size_t iElem = 0; iElem < count; ++iElem)
+            sum += elems[iElem];
+
+        return sum;
+    }
+
+    int Min(const int* elems, size_t count)
+    {
+        if (count == 0)
+            return 0;
+
+        int min = INT_MAX;
+        for (size_t iElem = 0; iElem < count; ++iElem)
+            min = std::min(min, elems[iElem]);
+
+        return min;
+    }
+
+    int Max(const int* elems, size_t count)
+    {
+        if (count == 0)
+            return 0;
+
+        int max = INT_MIN;
+        for (size_t iElem = 0; iElem < count; ++iElem)
+            max = std::max(max, elems[iElem]);
+
+        return max;
+    }
+
+    int Dot(const int* lhsElems, const int* rhsElems, size_t count)
+    {
+        int dot = 0;
+        for (size_t iElem = 0; iElem < count; ++iElem)
+            dot += lhsElems[iElem] * rhsElems[iElem];
+
+        return dot;
+    }
+
+    void Fill(int* elems, size_t count, int val)
+    {
+        for (size_t iElem = 0; iElem < count; ++iElem)
+            elems[iElem] = val;
+    }
+}
+
+namespace Threading
+{
+    namespace impl
+    {
+        InterpretedValue CallIntrinsic(IntrinsicID id, const CallArgs& args)
+        {
+            switch (id)
+            {
+            case IntrinsicID::VADD:
+                return InterpretedValue{ ElementWise(args[0].GetIntArrayVal(), args[1].GetIntArrayVal(), [](int lhs, int rhs) { return lhs + rhs; }) };
+            case IntrinsicID::VSUB:
+                return InterpretedValue{ ElementWise(args[0].GetIntArrayVal(), args[1].GetIntArrayVal(), [](int lhs, int rhs) { return lhs - rhs; }) };
+            case IntrinsicID::VMUL:
+                return InterpretedValue{ ElementWise(args[0].GetIntArrayVal(), args[1].GetIntArrayVal(), [](int lhs, int rhs) { return lhs * rhs; }) };
+            case IntrinsicID::VSUM:
+            {
+                const std::vector<int>& arr = args[0].GetIntArrayVal();
+                return InterpretedValue{ Sum(arr.data(), arr.size()) };
+            }
+            case IntrinsicID::VMIN:
+            {
+                const std::vector<int>& arr = args[0].GetIntArrayVal();
+                return InterpretedValue{ Min(arr.data(), arr.size()) };
+            }
+            case IntrinsicID::VMAX:
+            {
+                const std::vector<int>& arr = args[0].GetIntArrayVal();
+                return InterpretedValue{ Max(arr.data(), arr.size()) };
+            }
+            case IntrinsicID::VDOT:
+            {
+                const std::vector<int>& lhs = args[0].GetIntArrayVal();
+                const std::vector<int>& rhs = args[1].GetIntArrayVal();
+                return InterpretedValue{ Dot(lhs.data(), rhs.data(), std::min(lhs.size(), rhs.size())) };
+            }
+            case IntrinsicID::VFILL:
+            {
+                // The argument is a copy, writing to it detaches it from the caller's array
+                InterpretedValue result{ args[0] };
+                std::vector<int>& arr = result.GetMutableIntArrayVal();
+                Fill(arr.data(), arr.size(), args[1].GetIntVal());
+                return result;
+            }
+            case IntrinsicID::POPCOUNT:
+                return InterpretedValue{ static_cast<int>(args[0].GetBoolArrayVal().PopCount()) };
+            case IntrinsicID::FINDFIRST:
+                return InterpretedValue{ static_cast<int>(args[0].GetBoolArrayVal().FindFirstSet()) };
+            default:
+                assert(false); // Not a built-in function
+                return {};
+            }
+        }
+    }   // namespace impl
+}   // namespace Threading
@@ -0,0 +1,26 @@
+#ifndef ARRAY_KERNELS_H__TOSTITOS
+#define ARRAY_KERNELS_H__TOSTITOS
+
+#include "functioncache.h"
+#include "interpretedvalue.h"
+
+#include "../../TosLang/Sema/intrinsics.h"
+
+namespace Threading
+{
+    namespace impl
+    {
+        /*
+        * \fn           CallIntrinsic
+        * \brief        Runs a built-in function. The array ones go over the contiguous storage of their operands
+        *               in plain loops that the compiler turns into SIMD code. The element-wise operations on arrays
+        *               of different sizes work up to the shortest one. The minimum and maximum of an empty array are 0.
+        * \param id     Built-in function to run
+        * \param args   Values of the call's arguments
+        * \return       Value returned by the built-in function
+        */
+        InterpretedValue CallIntrinsic(TosLang::FrontEnd::IntrinsicID id, const CallArgs& args);
+    }   // namespace impl
+}   // namespace Threading
+
+#endif // ARRAY_KERNELS_H__TOSTITOS
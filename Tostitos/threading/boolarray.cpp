@@ -0,0 +1,115 @@
+#include "boolarray.h"
+
+#include <algorithm>
+#include <bitset>
+
+#if defined(_MSC_VER)
+#include <intrin.h>
+#endif
+
+using namespace Threading::impl;
+
+static size_t GetNbWords(size_t size)
+{
+    return (size + BoolArray::WORD_BITS - 1) / BoolArray::WORD_BITS;
+}
+
+static size_t CountTrailingZeros(BoolArray::Word word)
+{
+#if defined(__GNUC__) || defined(__clang__)
+    return static_cast<size_t>(__builtin_ctzll(word));
+#elif defined(_MSC_VER) && defined(_M_X64)
+    unsigned long idx;
+    _BitScanForward64(&idx, word);
+    return static_cast<size_t>(idx);
+#else
+    size_t idx = 0;
+    while ((word & 1) == 0)
+    {
+        word >>= 1;
+        ++idx;
+    }
+    return idx;
+#endif
+}
+
+BoolArray::BoolArray(size_t size, bool val) : mWords(GetNbWords(size), val ? ~Word{ 0 } : Word{ 0 }), mSize{ size }
+{
+    // Clearing the bits past the last element
+    if (val && (mSize % WORD_BITS != 0))
+        mWords.back() = (Word{ 1 } << (mSize % WORD_BITS)) - 1;
+}
+
+BoolArray::BoolArray(const std::vector<bool>& vals) : mWords(GetNbWords(vals.size()), 0), mSize{ vals.size() }
+{
+    for (size_t iVal = 0; iVal < vals.size(); ++iVal)
+    {
+        if (vals[iVal])
+            mWords[iVal / WORD_BITS] |= Word{ 1 } << (iVal % WORD_BITS);
+    }
+}
+
+namespace Threading
+{
+    namespace impl
+    {
+        std::ostream& operator<<(std::ostream& stream, const BoolArray& arr)
+        {
+            for (size_t iElem = 0; iElem < arr.GetSize(); ++iElem)
+                stream << arr.Get(iElem) << ",";
+
+            return stream;
+        }
+    }
+}
+
+BoolArray BoolArray::And(const BoolArray& rhs) const
+{
+    return Combine(rhs, [](Word lhsWord, Word rhsWord) { return lhsWord & rhsWord; });
+}
+
+BoolArray BoolArray::Or(const BoolArray& rhs) const
+{
+    return Combine(rhs, [](Word lhsWord, Word rhsWord) { return lhsWord | rhsWord; });
+}
+
+size_t BoolArray::PopCount() const
+{
+    size_t count = 0;
+    for (Word word : mWords)
+        count += std::bitset<WORD_BITS>{ word }.count();
+
+    return count;
+}
+
+size_t BoolArray::FindFirstSet() const
+{
+    for (size_t iWord = 0; iWord < mWords.size(); ++iWord)
+    {
+        if (mWords[iWord] != 0)
+            return iWord * WORD_BITS + CountTrailingZeros(mWords[iWord]);
+    }
+
+    return mSize;
+}
+
+template <typename Op>
+BoolArray BoolArray::Combine(const BoolArray& rhs, Op op) const
+{
+    BoolArray result;
+    result.mSize = std::min(mSize, rhs.mSize);
+    result.mWords.resize(GetNbWords(result.mSize));
+
+    // Plain loop over contiguous words, simple enough for the compiler to vectorize
+    const Word* lhsWords = mWords.data();
+    const Word* rhsWords = rhs.mWords.data();
+    Word* resultWords = result.mWords.data();
+    for (size_t iWord = 0; iWord < result.mWords.size(); ++iWord)
+        resultWords[iWord] = op(lhsWords[iWord], rhsWords[iWord]);
+
+    // The longer operand may have had elements set past the end of the result in its last shared word
+    if ((result.mSize % WORD_BITS) != 0)
+        result.mWords.back() &= (Word{ 1 } << (result.mSize % WORD_BITS)) - 1;
+
+    return result;
+}
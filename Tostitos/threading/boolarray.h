@@ -0,0 +1,112 @@
+#ifndef BOOL_ARRAY_H__TOSTITOS
+#define BOOL_ARRAY_H__TOSTITOS
+
+#include <cstddef>
+#include <cstdint>
+#include <ostream>
+#include <stdexcept>
+#include <vector>
+
+namespace Threading
+{
+    namespace impl
+    {
+        /*
+        * \class BoolArray
+        * \brief Boolean array packing its elements in 64-bit words. The bulk operations work a word at a time,
+        *        which lets the compiler vectorize them. The bits past the last element are always 0 so that the
+        *        words can be compared and counted without masking the last one.
+        */
+        class BoolArray
+        {
+        public:
+            using Word = uint64_t;
+            static const size_t WORD_BITS = 64;
+
+        public:
+            BoolArray() : mWords{}, mSize{ 0 } { }
+
+            /*
+            * \fn           BoolArray
+            * \brief        Ctor
+            * \param size   Number of elements
+            * \param val    Value of every element
+            */
+            explicit BoolArray(size_t size, bool val = false);
+
+            /*
+            * \fn           BoolArray
+            * \brief        Ctor
+            * \param vals   Value of each element
+            */
+            explicit BoolArray(const std::vector<bool>& vals);
+
+        public:
+            friend bool operator==(const BoolArray& lhs, const BoolArray& rhs) { return (lhs.mSize == rhs.mSize) && (lhs.mWords == rhs.mWords); }
+            friend bool operator!=(const BoolArray& lhs, const BoolArray& rhs) { return !(lhs == rhs); }
+            friend std::ostream& operator<<(std::ostream& stream, const BoolArray& arr);
+
+        public:
+            size_t GetSize() const { return mSize; }
+
+            bool Get(size_t idx) const
+            {
+                if (idx >= mSize)
+                    throw std::out_of_range{ "BoolArray index out of range" };
+
+                return ((mWords[idx / WORD_BITS] >> (idx % WORD_BITS)) & 1) != 0;
+            }
+
+            void Set(size_t idx, bool val)
+            {
+                if (idx >= mSize)
+                    throw std::out_of_range{ "BoolArray index out of range" };
+
+                const Word mask = Word{ 1 } << (idx % WORD_BITS);
+                if (val)
+                    mWords[idx / WORD_BITS] |= mask;
+                else
+                    mWords[idx / WORD_BITS] &= ~mask;
+            }
+
+        public:
+            /*
+            * \fn           And
+            * \brief        Element-wise logical and. Arrays of different sizes are combined up to the shortest one.
+            * \param rhs    Other operand
+            * \return       Resulting array
+            */
+            BoolArray And(const BoolArray& rhs) const;
+
+            /*
+            * \fn           Or
+            * \brief        Element-wise logical or. Arrays of different sizes are combined up to the shortest one.
+            * \param rhs    Other operand
+            * \return       Resulting array
+            */
+            BoolArray Or(const BoolArray& rhs) const;
+
+            /*
+            * \fn           PopCount
+            * \return       Number of elements that are true
+            */
+            size_t PopCount() const;
+
+            /*
+            * \fn           FindFirstSet
+            * \return       Index of the first element that is true, or the size of the array if there's none
+            */
+            size_t FindFirstSet() const;
+
+        private:
+            template <typename Op>
+            BoolArray Combine(const BoolArray& rhs, Op op) const;
+
+        private:
+            std::vector<Word> mWords;   /*!< Elements, the first one being the least significant bit of the first word */
+            size_t mSize;               /*!< Number of elements */
+        };
+    }   // namespace impl
+}   // namespace Threading
+
+#endif // BOOL_ARRAY_H__TOSTITOS
@@ -0,0 +1,45 @@
+#include "callsitecache.h"
+
+#include "../../TosLang/AST/declarations.h"
+#include "../../TosLang/Sema/symboltable.h"
+
+#include <cassert>
+
+using namespace Threading::impl;
+using namespace TosLang::FrontEnd;
+
+CallSiteCache& CallSiteCache::GetInstance()
+{
+    static CallSiteCache Instance;
+    return Instance;
+}
+
+const CallTarget& CallSiteCache::GetTarget(const CallExpr* call, const SymbolTable* symTab)
+{
+    auto targetIt = mTargets.find(call);
+    if (targetIt != mTargets.end())
+        return targetIt->second;
+
+    // First time this call site is executed, we need to resolve it
+    CallTarget target;
+    target.fnDecl = dynamic_cast<const FunctionDecl*>(symTab->GetFunctionDecl(call));
+    assert(target.fnDecl != nullptr);
+
+    // The parameters of a built-in function have no symbol
+    target.intrinsic = Intrinsics::GetInstance().GetID(target.fnDecl);
+    if (target.intrinsic != IntrinsicID::NONE)
+        return mTargets.emplace(call, std::move(target)).first->second;
+
+    for (const auto& param : target.fnDecl->GetParametersDecl()->GetParameters())
+    {
+        const Symbol* paramSym;
+        bool symFound;
+        std::tie(symFound, paramSym) = symTab->TryGetSymbol(param.get());
+        assert(symFound);
+
+        target.paramSyms.push_back(paramSym);
+    }
+
+    // References to the elements of an unordered_map stay valid when it grows
+    return mTargets.emplace(call, std::move(target)).first->second;
+}
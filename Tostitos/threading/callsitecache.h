@@ -0,0 +1,79 @@
+#ifndef CALL_SITE_CACHE_H__TOSTITOS
+#define CALL_SITE_CACHE_H__TOSTITOS
+
+#include "../../TosLang/Sema/intrinsics.h"
+
+#include <cstddef>
+#include <unordered_map>
+#include <vector>
+
+namespace TosLang
+{
+    namespace FrontEnd
+    {
+        class CallExpr;
+        class FunctionDecl;
+        class Symbol;
+        class SymbolTable;
+    }
+}
+
+namespace Threading
+{
+    namespace impl
+    {
+        /*
+        * \struct CallTarget
+        * \brief  What a call site needs to know about its callee to set up a new stack frame
+        */
+        struct CallTarget
+        {
+            const TosLang::FrontEnd::FunctionDecl* fnDecl;              /*!< Function chosen by the overload resolution */
+            std::vector<const TosLang::FrontEnd::Symbol*> paramSyms;    /*!< Symbols of the function's parameters, in order */
+            TosLang::FrontEnd::IntrinsicID intrinsic;                   /*!< Built-in function called, run without any stack frame */
+        };
+
+        /*
+        * \class CallSiteCache
+        * \brief Monomorphic inline cache for every call site of the program. TosLang calls are resolved statically,
+        *        so a call site always goes to the same function. The first execution of a call records the resolved
+        *        function along with its frame layout. The following ones reuse it instead of going through the
+        *        symbol table. The cache stays valid as long as the same program image is loaded.
+        *        It isn't synchronized. Only the AST walker goes through it, and the walker always runs
+        *        on a single host thread since the worker pool only takes compiled programs (see Kernel::PrepareWorkers).
+        */
+        class CallSiteCache
+        {
+        public:
+            static CallSiteCache& GetInstance();
+
+        public:
+            /*
+            * \fn           GetTarget
+            * \brief        Gets the function called by a call site, resolving it on the first call
+            * \param call   Call site
+            * \param symTab Symbol table of the program containing the call site
+            * \return       Call target of the call site
+            */
+            const CallTarget& GetTarget(const TosLang::FrontEnd::CallExpr* call, const TosLang::FrontEnd::SymbolTable* symTab);
+
+            /*
+            * \fn           Invalidate
+            * \brief        Forgets every call target. Must be called when a new program image is loaded.
+            */
+            void Invalidate() { mTargets.clear(); }
+
+            size_t GetSize() const { return mTargets.size(); }
+
+        private:
+            CallSiteCache() = default;
+            CallSiteCache(const CallSiteCache&) = delete;
+            void operator=(const CallSiteCache&) = delete;
+
+        private:
+            std::unordered_map<const TosLang::FrontEnd::CallExpr*, CallTarget> mTargets;
+        };
+    }   // namespace impl
+}   // namespace Threading
+
+#endif // CALL_SITE_CACHE_H__TOSTITOS
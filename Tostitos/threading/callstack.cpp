@@ -1,5 +1,8 @@
 #include "callstack.h"
 
+#include "checkpoint.h"
+#include "globalstore.h"
+
 #include <algorithm>
 
 using namespace Threading::impl;
@@ -7,7 +10,7 @@ using namespace TosLang;
 
 ////////// Stack Frame //////////
 
-size_t StackFrame::mCount = 0;
+std::atomic<size_t> StackFrame::mCount{ 0 };
 
 void StackFrame::AddOrUpdateSymbolValue(const FrontEnd::Symbol* sym, const InterpretedValue& value)
 {
@@ -41,11 +44,83 @@ bool StackFrame::TryGetExprValue(const FrontEnd::ASTNode* expr, InterpretedValue
     return found;
 }
 
+void StackFrame::Save(CheckpointWriter& writer) const
+{
+    writer.WriteUInt(mID);
+    writer.WriteNode(mCaller);
+    writer.WriteValue(mReturnValue);
+    writer.WriteUInt(mNodeDepth);
+
+    writer.WriteUInt(mCurrentSymbolVals.size());
+    for (const auto& symVal : mCurrentSymbolVals)
+    {
+        writer.WriteSymbol(symVal.first);
+        writer.WriteValue(symVal.second);
+    }
+
+    writer.WriteUInt(mExprVals.size());
+    for (const auto& exprVal : mExprVals)
+    {
+        writer.WriteNode(exprVal.first);
+        writer.WriteValue(exprVal.second);
+    }
+
+    writer.WriteUInt(mPendingResults.size());
+    for (const PendingResult& pending : mPendingResults)
+    {
+        writer.WriteNode(pending.fnDecl);
+        writer.WriteUInt(pending.args.size());
+        for (const InterpretedValue& arg : pending.args)
+            writer.WriteValue(arg);
+    }
+}
+
+void StackFrame::Load(CheckpointReader& reader)
+{
+    // The frame keeps its identifier since the threads it spawned refer to it.
+    // Frames created from now on must then be numbered after it.
+    mID = static_cast<size_t>(reader.ReadUInt());
+    size_t count = mCount.load();
+    while ((count <= mID) && !mCount.compare_exchange_weak(count, mID + 1)) { }
+
+    mCaller = reader.ReadNode();
+    mReturnValue = reader.ReadValue();
+    mNodeDepth = static_cast<size_t>(reader.ReadUInt());
+
+    mCurrentSymbolVals.clear();
+    for (uint64_t iVal = reader.ReadUInt(); (iVal > 0) && !reader.HasFailed(); --iVal)
+    {
+        const FrontEnd::Symbol* sym = reader.ReadSymbol();
+        mCurrentSymbolVals[sym] = reader.ReadValue();
+    }
+
+    mExprVals.clear();
+    for (uint64_t iVal = reader.ReadUInt(); (iVal > 0) && !reader.HasFailed(); --iVal)
+    {
+        const FrontEnd::ASTNode* expr = reader.ReadNode();
+        mExprVals[expr] = reader.ReadValue();
+    }
+
+    mPendingResults.clear();
+    for (uint64_t iPending = reader.ReadUInt(); (iPending > 0) && !reader.HasFailed(); --iPending)
+    {
+        PendingResult pending;
+        pending.fnDecl = reader.ReadNode();
+        for (uint64_t iArg = reader.ReadUInt(); (iArg > 0) && !reader.HasFailed(); --iArg)
+            pending.args.push_back(reader.ReadValue());
+        mPendingResults.push_back(std::move(pending));
+    }
+}
+
 ////////// Call Stack //////////
 void CallStack::AddOrUpdateSymbolValue(const FrontEnd::Symbol* sym, const InterpretedValue& value, bool isGlobalSymol)
 {
+    // The global variables are shared by all threads, they don't live in any call stack
     if (isGlobalSymol)
-        mFrames.front().AddOrUpdateSymbolValue(sym, value);
+    {
+        GlobalStore& globals = GlobalStore::GetCurrent();
+        globals.Store(globals.GetSlot(sym), value);
+    }
     else
         mFrames.back().AddOrUpdateSymbolValue(sym, value);
 }
@@ -68,10 +143,34 @@ void CallStack::PushFrame(StackFrame&& frame)
     mFrames.emplace_back(frame);
 }
 
+void CallStack::ReplaceCurrentFrame(StackFrame&& frame)
+{
+    assert(!Empty());
+
+    // The new frame takes the place of the current one. This means it will return to 
+    // the current frame's caller and unwind the executor to the same point it would have.
+    frame.SetCaller(mFrames.back().GetCaller());
+    frame.SetNodeDepth(mFrames.back().GetNodeDepth());
+
+    // Whatever the new frame returns is also the result of the calls that were waiting on the current one.
+    // They are moved rather than copied, a chain of memoized tail calls would otherwise copy them over and over.
+    std::vector<PendingResult> pendings = mFrames.back().TakePendingResults();
+    for (const PendingResult& pending : frame.GetPendingResults())
+        pendings.push_back(pending);
+
+    frame.SetPendingResults(std::move(pendings));
+
+    mFrames.back() = std::move(frame);
+}
+
 bool CallStack::TryGetSymbolValue(const FrontEnd::Symbol* sym, InterpretedValue& value, bool isGlobalSymol)
 {
     if (isGlobalSymol)
-        return mFrames.front().TryGetSymbolValue(sym, value);
+    {
+        const GlobalStore& globals = GlobalStore::GetCurrent();
+        value = globals.Load(globals.GetSlot(sym));
+        return value.GetType() != InterpretedValue::ValueType::UNKNOWN;
+    }
     else
         return mFrames.back().TryGetSymbolValue(sym, value);
 }
@@ -80,3 +179,20 @@ bool CallStack::TryGetExprValue(const FrontEnd::ASTNode* expr, InterpretedValue&
 {
     return mFrames.back().TryGetExprValue(expr, value);
 }
+
+void CallStack::Save(CheckpointWriter& writer) const
+{
+    writer.WriteUInt(mFrames.size());
+    for (const StackFrame& frame : mFrames)
+        frame.Save(writer);
+}
+
+void CallStack::Load(CheckpointReader& reader)
+{
+    mFrames.clear();
+    for (uint64_t iFrame = reader.ReadUInt(); (iFrame > 0) && !reader.HasFailed(); --iFrame)
+    {
+        mFrames.emplace_back();
+        mFrames.back().Load(reader);
+    }
+}
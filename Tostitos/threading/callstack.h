@@ -1,8 +1,10 @@
 #ifndef CALL_STACK_H__TOSTITOS
 #define CALL_STACK_H__TOSTITOS
 
+#include "functioncache.h"
 #include "interpretedvalue.h"
 
+#include <atomic>
 #include <deque>
 #include <unordered_map>
 
@@ -22,29 +24,46 @@ namespace Threading
 {
     namespace impl
     {
+        class CheckpointReader;
+        class CheckpointWriter;
+
         class StackFrame
         {
         public:
-            StackFrame() : mCaller{ nullptr }, mReturnValue{}, mCurrentSymbolVals{}, mID{ mCount++ } { }
-            explicit StackFrame(const TosLang::FrontEnd::ASTNode* caller) : mCaller{ caller }, mCurrentSymbolVals{} { }
+            StackFrame() : mID{ mCount++ }, mCaller{ nullptr }, mReturnValue{}, mCurrentSymbolVals{}, mNodeDepth{ 0 } { }
+            explicit StackFrame(const TosLang::FrontEnd::ASTNode* caller) 
+                : mID{ mCount++ }, mCaller{ caller }, mCurrentSymbolVals{}, mNodeDepth{ 0 } { }
 
         public:
             void AddOrUpdateSymbolValue(const TosLang::FrontEnd::Symbol* sym, const InterpretedValue& value);
             void SetExprValue(const TosLang::FrontEnd::ASTNode* expr, const InterpretedValue& value);
             bool TryGetSymbolValue(const TosLang::FrontEnd::Symbol* sym, InterpretedValue& value);
             bool TryGetExprValue(const TosLang::FrontEnd::ASTNode* node, InterpretedValue& value);
+            void EraseExprValue(const TosLang::FrontEnd::ASTNode* expr) { mExprVals.erase(expr); }
             const TosLang::FrontEnd::ASTNode* GetCaller() const { return mCaller; }
+            void SetCaller(const TosLang::FrontEnd::ASTNode* caller) { mCaller = caller; }
+            size_t GetNodeDepth() const { return mNodeDepth; }
+            void SetNodeDepth(size_t depth) { mNodeDepth = depth; }
+            const std::vector<PendingResult>& GetPendingResults() const { return mPendingResults; }
+            void AddPendingResult(const PendingResult& pending) { mPendingResults.push_back(pending); }
+            std::vector<PendingResult> TakePendingResults() { return std::move(mPendingResults); }
+            void SetPendingResults(std::vector<PendingResult>&& pendings) { mPendingResults = std::move(pendings); }
             const InterpretedValue& GetReturnValue() const { return mReturnValue; }
             void SetReturnValue(const InterpretedValue& val) { mReturnValue = val; }
             size_t GetID() const { return mID; }
 
+            void Save(CheckpointWriter& writer) const;
+            void Load(CheckpointReader& reader);
+
         private:
-            static size_t mCount;
+            static std::atomic<size_t> mCount;  // Frames are created by the threads of every worker
             size_t mID;
             const TosLang::FrontEnd::ASTNode* mCaller;
             InterpretedValue mReturnValue;
             std::unordered_map<const TosLang::FrontEnd::Symbol*, InterpretedValue> mCurrentSymbolVals;
             std::unordered_map<const TosLang::FrontEnd::ASTNode*, InterpretedValue> mExprVals;
+            size_t mNodeDepth;  // Number of node queues the executor had when the function owning the frame was entered
+            std::vector<PendingResult> mPendingResults; // Memoized calls that will get their result when the frame returns
         };
 
         class CallStack
@@ -54,21 +73,30 @@ namespace Threading
             void SetExprValue(const TosLang::FrontEnd::ASTNode* expr, const InterpretedValue& value, size_t frameID);
             bool TryGetSymbolValue(const TosLang::FrontEnd::Symbol* sym, InterpretedValue& value, bool isGlobalSymol);
             bool TryGetExprValue(const TosLang::FrontEnd::ASTNode* expr, InterpretedValue& value);
+            void EraseExprValue(const TosLang::FrontEnd::ASTNode* expr) { mFrames.back().EraseExprValue(expr); }
 
             void PushFrame(const StackFrame& frame);
             void PushFrame(StackFrame&& frame);
+            void ReplaceCurrentFrame(StackFrame&& frame);
             void ExitCurrentFrame() { mFrames.pop_back(); }
 
             void Clear() { mFrames.clear(); }
             const std::deque<StackFrame>& Dump() const { return mFrames; }
             const TosLang::FrontEnd::ASTNode* GetCurrentFrameCaller() const { return mFrames.back().GetCaller(); }
+            size_t GetCurrentFrameNodeDepth() const { return mFrames.back().GetNodeDepth(); }
+            void SetCurrentFrameNodeDepth(size_t depth) { mFrames.back().SetNodeDepth(depth); }
+            const std::vector<PendingResult>& GetCurrentFramePendingResults() const { return mFrames.back().GetPendingResults(); }
             const InterpretedValue& GetReturnValue() const { return mFrames.back().GetReturnValue(); }
             void SetReturnValue(const InterpretedValue& val) { mFrames.back().SetReturnValue(val); }
             bool Empty() const { return mFrames.empty(); }
+            size_t GetFrameCount() const { return mFrames.size(); }
             const StackFrame& GetGlobalFrame() const { assert(!Empty()); return mFrames.front(); }
 
             size_t GetCurrentFrameID() const { assert(!Empty()); return mFrames.back().GetID(); }
 
+            void Save(CheckpointWriter& writer) const;
+            void Load(CheckpointReader& reader);
+
         private:
             std::deque<StackFrame> mFrames;
         };
@@ -0,0 +1,306 @@
+#include "checkpoint.h"
+
+#include "../../TosLang/AST/ast.h"
+#include "../../TosLang/Sema/symboltable.h"
+
+#include <cassert>
+#include <tuple>
+#include <utility>
+
+using namespace Threading::impl;
+using namespace TosLang::FrontEnd;
+
+////////// Node Index //////////
+
+void NodeIndex::Build(const ASTNode* root, const SymbolTable* symTab)
+{
+    mNodes.assign(1, nullptr);
+    mNodeIDs.clear();
+    mSymbolIDs.clear();
+    mSymbols.clear();
+
+    // FNV-1a offset basis
+    mFingerprint = 14695981039346656037ULL;
+
+    if (root != nullptr)
+        AddNode(root, symTab);
+}
+
+size_t NodeIndex::GetNodeID(const ASTNode* node) const
+{
+    if (node == nullptr)
+        return NO_NODE;
+
+    auto idIt = mNodeIDs.find(node);
+    assert(idIt != mNodeIDs.end());
+    return idIt->second;
+}
+
+size_t NodeIndex::GetSymbolID(const Symbol* sym) const
+{
+    auto idIt = mSymbolIDs.find(sym);
+    assert(idIt != mSymbolIDs.end());
+    return idIt->second;
+}
+
+const Symbol* NodeIndex::GetSymbol(size_t id) const
+{
+    auto symIt = mSymbols.find(id);
+    return (symIt != mSymbols.end()) ? symIt->second : nullptr;
+}
+
+void NodeIndex::AddNode(const ASTNode* node, const SymbolTable* symTab)
+{
+    const size_t id = mNodes.size();
+    mNodes.push_back(node);
+    mNodeIDs[node] = id;
+
+    const Symbol* sym;
+    bool symFound;
+    std::tie(symFound, sym) = symTab->TryGetSymbol(node);
+    if (symFound)
+    {
+        mSymbolIDs[sym] = id;
+        mSymbols[id] = sym;
+    }
+
+    // A checkpoint is only valid for the program it was taken from. The kind and number of children of each
+    // node are enough to tell a different program apart, the names and literals don't change the numbering.
+    const uint64_t shape[] = { static_cast<uint64_t>(node->GetKind()), node->GetChildrenNodes().size() };
+    for (uint64_t val : shape)
+    {
+        mFingerprint ^= val;
+        mFingerprint *= 1099511628211ULL;   // FNV-1a prime
+    }
+
+    for (const auto& child : node->GetChildrenNodes())
+    {
+        if (child != nullptr)
+            AddNode(child.get(), symTab);
+    }
+}
+
+////////// Checkpoint Writer //////////
+
+void CheckpointWriter::WriteUInt(uint64_t val)
+{
+    // 7 bits per byte, the high bit telling if more bytes follow
+    while (val >= 0x80)
+    {
+        mBytes.push_back(static_cast<char>((val & 0x7F) | 0x80));
+        val >>= 7;
+    }
+    mBytes.push_back(static_cast<char>(val));
+}
+
+void CheckpointWriter::WriteInt(int val)
+{
+    // Zigzag encoding so that small negative numbers stay small
+    const int64_t wideVal = val;
+    WriteUInt((static_cast<uint64_t>(wideVal) << 1) ^ static_cast<uint64_t>(wideVal >> 63));
+}
+
+void CheckpointWriter::WriteString(const std::string& val)
+{
+    WriteUInt(val.size());
+    mBytes.append(val);
+}
+
+void CheckpointWriter::WriteValue(const InterpretedValue& val)
+{
+    WriteUInt(static_cast<uint64_t>(val.GetType()));
+    WriteBool(val.IsReady());
+
+    switch (val.GetType())
+    {
+    case InterpretedValue::ValueType::BOOLEAN:
+        WriteBool(val.GetBoolVal());
+        break;
+    case InterpretedValue::ValueType::BOOLEAN_ARRAY:
+    {
+        // Eight elements per byte
+        const BoolArray& arr = val.GetBoolArrayVal();
+        WriteUInt(arr.GetSize());
+        for (size_t iByte = 0; iByte < (arr.GetSize() + 7) / 8; ++iByte)
+        {
+            unsigned char bits = 0;
+            for (size_t iBit = 0; (iBit < 8) && (iByte * 8 + iBit < arr.GetSize()); ++iBit)
+                bits |= (arr.Get(iByte * 8 + iBit) ? 1 : 0) << iBit;
+            mBytes.push_back(static_cast<char>(bits));
+        }
+        break;
+    }
+    case InterpretedValue::ValueType::INTEGER:
+        WriteInt(val.GetIntVal());
+        break;
+    case InterpretedValue::ValueType::INTEGER_ARRAY:
+        WriteUInt(val.GetIntArrayVal().size());
+        for (int elem : val.GetIntArrayVal())
+            WriteInt(elem);
+        break;
+    case InterpretedValue::ValueType::STRING:
+        WriteString(val.GetStrVal().Get());
+        break;
+    case InterpretedValue::ValueType::STRING_ARRAY:
+        WriteUInt(val.GetStrArrayVal().size());
+        for (const InternedString& elem : val.GetStrArrayVal())
+            WriteString(elem.Get());
+        break;
+    case InterpretedValue::ValueType::VOID:
+    case InterpretedValue::ValueType::UNKNOWN:
+        break;
+    default:
+        assert(false);  // Should never happen
+    }
+}
+
+////////// Checkpoint Reader //////////
+
+uint64_t CheckpointReader::ReadUInt()
+{
+    uint64_t val = 0;
+    for (unsigned shift = 0; shift < 64; shift += 7)
+    {
+        if (mPos == mSize)
+            break;
+
+        const unsigned char byte = static_cast<unsigned char>(mData[mPos++]);
+        val |= static_cast<uint64_t>(byte & 0x7F) << shift;
+        if ((byte & 0x80) == 0)
+            return val;
+    }
+
+    mFailed = true;
+    return 0;
+}
+
+int CheckpointReader::ReadInt()
+{
+    const uint64_t val = ReadUInt();
+    return static_cast<int>(static_cast<int64_t>(val >> 1) ^ -static_cast<int64_t>(val & 1));
+}
+
+bool CheckpointReader::ReadBool()
+{
+    const char* byte = ReadBytes(1);
+    return (byte != nullptr) && (*byte != 0);
+}
+
+std::string CheckpointReader::ReadString()
+{
+    const size_t size = static_cast<size_t>(ReadUInt());
+    const char* str = ReadBytes(size);
+    return (str != nullptr) ? std::string(str, size) : std::string{};
+}
+
+const ASTNode* CheckpointReader::ReadNode()
+{
+    const size_t id = static_cast<size_t>(ReadUInt());
+    const ASTNode* node = mIndex.GetNode(id);
+    if ((node == nullptr) && (id != NodeIndex::NO_NODE))
+        mFailed = true;
+
+    return node;
+}
+
+const Symbol* CheckpointReader::ReadSymbol()
+{
+    const Symbol* sym = mIndex.GetSymbol(static_cast<size_t>(ReadUInt()));
+    if (sym == nullptr)
+        mFailed = true;
+
+    return sym;
+}
+
+InterpretedValue CheckpointReader::ReadValue()
+{
+    const uint64_t type = ReadUInt();
+    const bool isReady = ReadBool();
+
+    InterpretedValue val;
+    switch (static_cast<InterpretedValue::ValueType>(type))
+    {
+    case InterpretedValue::ValueType::BOOLEAN:
+        val = InterpretedValue{ ReadBool() };
+        break;
+    case InterpretedValue::ValueType::BOOLEAN_ARRAY:
+    {
+        const size_t size = static_cast<size_t>(ReadUInt());
+        const char* bits = ReadBytes((size + 7) / 8);
+        if (bits == nullptr)
+            break;
+
+        BoolArray arr(size);
+        for (size_t iElem = 0; iElem < size; ++iElem)
+            arr.Set(iElem, ((static_cast<unsigned char>(bits[iElem / 8]) >> (iElem % 8)) & 1) != 0);
+        val = InterpretedValue{ std::move(arr) };
+        break;
+    }
+    case InterpretedValue::ValueType::INTEGER:
+        val = InterpretedValue{ ReadInt() };
+        break;
+    case InterpretedValue::ValueType::INTEGER_ARRAY:
+    {
+        // Every element takes at least a byte, a bigger size can only come from a corrupted checkpoint
+        const size_t size = static_cast<size_t>(ReadUInt());
+        if (size > mSize - mPos)
+        {
+            mFailed = true;
+            break;
+        }
+
+        std::vector<int> elems(size);
+        for (int& elem : elems)
+            elem = ReadInt();
+        val = InterpretedValue{ std::move(elems) };
+        break;
+    }
+    case InterpretedValue::ValueType::STRING:
+        val = InterpretedValue{ ReadString() };
+        break;
+    case InterpretedValue::ValueType::STRING_ARRAY:
+    {
+        const size_t size = static_cast<size_t>(ReadUInt());
+        if (size > mSize - mPos)
+        {
+            mFailed = true;
+            break;
+        }
+
+        StringPool& stringPool = StringPool::GetInstance();
+        std::vector<InternedString> elems;
+        elems.reserve(size);
+        for (size_t iElem = 0; iElem < size; ++iElem)
+            elems.push_back(stringPool.Intern(ReadString()));
+        val = InterpretedValue{ elems };
+        break;
+    }
+    case InterpretedValue::ValueType::VOID:
+        val = InterpretedValue::CreateVoidValue();
+        break;
+    case InterpretedValue::ValueType::UNKNOWN:
+        break;
+    default:
+        mFailed = true;
+        break;
+    }
+
+    if (isReady)
+        val.SetReady();
+
+    return val;
+}
+
+const char* CheckpointReader::ReadBytes(size_t size)
+{
+    if (size > mSize - mPos)
+    {
+        mFailed = true;
+        mPos = mSize;
+        return nullptr;
+    }
+
+    const char* bytes = mData + mPos;
+    mPos += size;
+    return bytes;
+}
@@ -0,0 +1,140 @@
+#ifndef CHECKPOINT_H__TOSTITOS
+#define CHECKPOINT_H__TOSTITOS
+
+#include "interpretedvalue.h"
+
+#include <cstddef>
+#include <cstdint>
+#include <string>
+#include <unordered_map>
+#include <vector>
+
+namespace TosLang
+{
+    namespace FrontEnd
+    {
+        class ASTNode;
+        class Symbol;
+        class SymbolTable;
+    }
+}
+
+namespace Threading
+{
+    namespace impl
+    {
+        /*
+        * \class NodeIndex
+        * \brief Stable identifiers of the nodes of a program's AST, used to refer to the AST in a checkpoint.
+        *        The nodes are numbered in preorder starting at 1, 0 standing for no node, so the same program
+        *        gets the same identifiers every time it is parsed. A symbol is identified by its declaration.
+        */
+        class NodeIndex
+        {
+        public:
+            static const size_t NO_NODE = 0;
+
+        public:
+            /*
+            * \fn           Build
+            * \brief        Numbers the nodes of a program
+            * \param root   Root of the program's AST
+            * \param symTab Symbol table of the program
+            */
+            void Build(const TosLang::FrontEnd::ASTNode* root, const TosLang::FrontEnd::SymbolTable* symTab);
+
+            size_t GetNodeID(const TosLang::FrontEnd::ASTNode* node) const;
+            const TosLang::FrontEnd::ASTNode* GetNode(size_t id) const { return (id < mNodes.size()) ? mNodes[id] : nullptr; }
+            size_t GetSymbolID(const TosLang::FrontEnd::Symbol* sym) const;
+            const TosLang::FrontEnd::Symbol* GetSymbol(size_t id) const;
+
+        public:
+            size_t GetNodeCount() const { return mNodes.size() - 1; }
+            uint64_t GetFingerprint() const { return mFingerprint; }
+
+        private:
+            void AddNode(const TosLang::FrontEnd::ASTNode* node, const TosLang::FrontEnd::SymbolTable* symTab);
+
+        private:
+            std::vector<const TosLang::FrontEnd::ASTNode*> mNodes;                              /*!< Node of each identifier */
+            std::unordered_map<const TosLang::FrontEnd::ASTNode*, size_t> mNodeIDs;             /*!< Identifier of each node */
+            std::unordered_map<const TosLang::FrontEnd::Symbol*, size_t> mSymbolIDs;            /*!< Declaration identifier of each symbol */
+            std::unordered_map<size_t, const TosLang::FrontEnd::Symbol*> mSymbols;              /*!< Symbol of each declaration identifier */
+            uint64_t mFingerprint = 0;                                                          /*!< Hash of the shape of the AST */
+        };
+
+        /*
+        * \class CheckpointWriter
+        * \brief Encodes the state of a program in a compact binary form. Integers are written as variable length
+        *        quantities, AST nodes and symbols by their identifier in the node index.
+        */
+        class CheckpointWriter
+        {
+        public:
+            explicit CheckpointWriter(const NodeIndex& index) : mIndex(index), mBytes{} { }
+
+        public:
+            void WriteUInt(uint64_t val);
+            void WriteInt(int val);
+            void WriteBool(bool val) { mBytes.push_back(val ? 1 : 0); }
+            void WriteString(const std::string& val);
+            void WriteNode(const TosLang::FrontEnd::ASTNode* node) { WriteUInt(mIndex.GetNodeID(node)); }
+            void WriteSymbol(const TosLang::FrontEnd::Symbol* sym) { WriteUInt(mIndex.GetSymbolID(sym)); }
+            void WriteValue(const InterpretedValue& val);
+            void WriteBytes(const std::string& bytes) { mBytes.append(bytes); }
+
+        public:
+            const std::string& GetBytes() const { return mBytes; }
+            std::string TakeBytes() { return std::move(mBytes); }
+
+        private:
+            const NodeIndex& mIndex;
+            std::string mBytes;
+        };
+
+        /*
+        * \class CheckpointReader
+        * \brief Decodes what a checkpoint writer encoded. Reading past the end or reading something that can't
+        *        be valid (e.g. an unknown node) marks the reader as failed, the values read from then on are
+        *        meaningless and must be thrown away.
+        */
+        class CheckpointReader
+        {
+        public:
+            CheckpointReader(const NodeIndex& index, const char* data, size_t size)
+                : mIndex(index), mData{ data }, mSize{ size }, mPos{ 0 }, mFailed{ false } { }
+
+        public:
+            uint64_t ReadUInt();
+            int ReadInt();
+            bool ReadBool();
+            std::string ReadString();
+            const TosLang::FrontEnd::ASTNode* ReadNode();
+            const TosLang::FrontEnd::Symbol* ReadSymbol();
+            InterpretedValue ReadValue();
+
+            /*
+            * \fn           ReadBytes
+            * \brief        Reads a block of bytes, which stays in the reader's buffer
+            * \param size   Number of bytes to read
+            * \return       Start of the block, nullptr if there isn't enough left
+            */
+            const char* ReadBytes(size_t size);
+
+            void Fail() { mFailed = true; }
+
+        public:
+            bool HasFailed() const { return mFailed; }
+            bool IsAtEnd() const { return mPos == mSize; }
+
+        private:
+            const NodeIndex& mIndex;
+            const char* mData;
+            size_t mSize;
+            size_t mPos;
+            bool mFailed;
+        };
+    }   // namespace impl
+}   // namespace Threading
+
+#endif // CHECKPOINT_H__TOSTITOS
@@ -0,0 +1,840 @@
+#include "closurecompiler.h"
+
+#include "arraykernels.h"
+#include "closureexecutor.h"
+#include "globalstore.h"
+#include "inputbuffer.h"
+#include "outputbuffer.h"
+#include "quickenedops.h"
+#include "stringpool.h"
+#include "threadutil.h"
+
+#include "../../TosLang/AST/declarations.h"
+#include "../../TosLang/Common/opcodes.h"
+#include "../../TosLang/Common/type.h"
+#include "../../TosLang/Sema/intrinsics.h"
+#include "../../TosLang/Sema/symboltable.h"
+
+#include <cassert>
+
+using namespace Threading::impl;
+using namespace TosLang::Common;
+using namespace TosLang::FrontEnd;
+
+namespace Threading
+{
+    namespace impl
+    {
+        InterpretedValue GetDefaultValue(const VarDecl* vDecl)
+        {
+            const size_t size = vDecl->GetVarSize() > 0 ? static_cast<size_t>(vDecl->GetVarSize()) : 0;
+
+            switch (vDecl->GetVarType())
+            {
+            case Type::BOOL:            return InterpretedValue{ false };
+            case Type::NUMBER:          return InterpretedValue{ 0 };
+            case Type::STRING:          return InterpretedValue{ InternedString{} };
+            case Type::BOOL_ARRAY:      return InterpretedValue{ BoolArray(size) };
+            case Type::NUMBER_ARRAY:    return InterpretedValue{ std::vector<int>(size, 0) };
+            case Type::STRING_ARRAY:    return InterpretedValue{ std::vector<InternedString>(size, InternedString{}) };
+            default:
+                assert(false); // What is this variable?
+                return {};
+            }
+        }
+
+        InterpretedValue MakeArray(const std::vector<InterpretedValue>& elems)
+        {
+            assert(!elems.empty());
+
+            switch (elems.front().GetType())
+            {
+            case InterpretedValue::ValueType::BOOLEAN:
+            {
+                std::vector<bool> vals;
+                for (const auto& elem : elems)
+                    vals.push_back(elem.GetBoolVal());
+                return InterpretedValue{ vals };
+            }
+            case InterpretedValue::ValueType::INTEGER:
+            {
+                std::vector<int> vals;
+                for (const auto& elem : elems)
+                    vals.push_back(elem.GetIntVal());
+                return InterpretedValue{ vals };
+            }
+            case InterpretedValue::ValueType::STRING:
+            {
+                std::vector<InternedString> vals;
+                for (const auto& elem : elems)
+                    vals.push_back(elem.GetStrVal());
+                return InterpretedValue{ vals };
+            }
+            default:
+                assert(false);  // Arrays of arrays don't exist
+                return {};
+            }
+        }
+    }   // namespace impl
+}   // namespace Threading
+
+namespace
+{
+    // Number of statements a function run to completion executes between two reports to its thread
+    const size_t INVOKE_STEP_BATCH = 64;
+
+    InterpretedValue::ValueType GetValueType(const Type type)
+    {
+        switch (type)
+        {
+        case Type::BOOL:            return InterpretedValue::ValueType::BOOLEAN;
+        case Type::NUMBER:          return InterpretedValue::ValueType::INTEGER;
+        case Type::STRING:          return InterpretedValue::ValueType::STRING;
+        case Type::BOOL_ARRAY:      return InterpretedValue::ValueType::BOOLEAN_ARRAY;
+        case Type::NUMBER_ARRAY:    return InterpretedValue::ValueType::INTEGER_ARRAY;
+        case Type::STRING_ARRAY:    return InterpretedValue::ValueType::STRING_ARRAY;
+        case Type::VOID:            return InterpretedValue::ValueType::VOID;
+        default:                    return InterpretedValue::ValueType::UNKNOWN;
+        }
+    }
+
+    Type GetElementType(const Type type)
+    {
+        switch (type)
+        {
+        case Type::BOOL_ARRAY:      return Type::BOOL;
+        case Type::NUMBER_ARRAY:    return Type::NUMBER;
+        case Type::STRING_ARRAY:    return Type::STRING;
+        default:                    return Type::UNKNOWN;
+        }
+    }
+
+    // Type checking guarantees the type of every expression, which we find back from the declarations it uses
+    Type GetExprType(const ASTNode* expr, const SymbolTable* symTab)
+    {
+        switch (expr->GetKind())
+        {
+        case ASTNode::NodeKind::ARRAY_EXPR:
+        {
+            const ChildrenNodes& elems = expr->GetChildrenNodes();
+            return elems.empty() ? Type::UNKNOWN : GetArrayVersion(GetExprType(elems.front().get(), symTab));
+        }
+        case ASTNode::NodeKind::BINARY_EXPR:
+        {
+            const BinaryOpExpr* bExpr = static_cast<const BinaryOpExpr*>(expr);
+            switch (bExpr->GetOperation())
+            {
+            case Operation::EQUAL:
+            case Operation::GREATER_THAN:
+            case Operation::LESS_THAN:
+                return Type::BOOL;
+            default:
+                // The other operations give back the type of their operands, boolean arrays included
+                return GetExprType(bExpr->GetLHS(), symTab);
+            }
+        }
+        case ASTNode::NodeKind::BOOLEAN_EXPR:
+            return Type::BOOL;
+        case ASTNode::NodeKind::CALL_EXPR:
+            return static_cast<const FunctionDecl*>(symTab->GetFunctionDecl(expr))->GetReturnType();
+        case ASTNode::NodeKind::IDENTIFIER_EXPR:
+            return static_cast<const VarDecl*>(symTab->GetVarDecl(expr))->GetVarType();
+        case ASTNode::NodeKind::INDEX_EXPR:
+            return GetElementType(GetExprType(static_cast<const IndexedExpr*>(expr)->GetIdentifier(), symTab));
+        case ASTNode::NodeKind::NUMBER_EXPR:
+        case ASTNode::NodeKind::SPAWN_EXPR:     // Handle of the new thread
+            return Type::NUMBER;
+        case ASTNode::NodeKind::STRING_EXPR:
+            return Type::STRING;
+        default:
+            return Type::UNKNOWN;
+        }
+    }
+
+    std::vector<InterpretedValue> EvaluateArgs(const std::vector<ExprClosure>& args, Activation& act)
+    {
+        std::vector<InterpretedValue> vals;
+        vals.reserve(args.size());
+        for (const auto& arg : args)
+            vals.push_back(arg(act));
+
+        return vals;
+    }
+}
+
+////////// Compiled Function //////////
+
+Activation CompiledFunction::CreateActivation(std::vector<InterpretedValue>&& args) const
+{
+    assert(args.size() == paramCount);
+
+    Activation act{};
+    act.fn = this;
+    act.pc = 0;
+    act.locals = std::move(args);
+    act.locals.resize(slotCount);
+    act.returnValue = InterpretedValue::CreateVoidValue();
+    act.returnKind = SlotKind::NONE;
+    act.returnSlot = 0;
+    act.hasPendingCall = false;
+
+    return act;
+}
+
+InterpretedValue CompiledFunction::Invoke(std::vector<InterpretedValue>&& args) const
+{
+    assert(!mayYield);
+
+    // The calls made by the statements get their own activation, like they do on a thread's stack
+    ClosureExecutor exec{ this, std::move(args) };
+
+    // The statements still count toward the thread's quantum and quota, in batches to keep the overhead low
+    size_t stepCount = 0;
+    while (exec.ExecuteOne())
+    {
+        if (++stepCount == INVOKE_STEP_BATCH)
+        {
+            CurrentThreadCountSteps(stepCount);
+            stepCount = 0;
+        }
+    }
+
+    CurrentThreadCountSteps(stepCount);
+    return exec.GetResult();
+}
+
+////////// Compiled Program //////////
+
+const CompiledFunction* CompiledProgram::GetFunction(const ASTNode* fnDecl) const
+{
+    auto fnIt = mFunctions.find(fnDecl);
+    return fnIt != mFunctions.end() ? fnIt->second.get() : nullptr;
+}
+
+////////// Closure Compiler //////////
+
+std::unique_ptr<CompiledProgram> ClosureCompiler::Compile(const ASTNode* root, const SymbolTable* symTab)
+{
+    assert(root != nullptr);
+    assert(symTab != nullptr);
+
+    auto program = std::make_unique<CompiledProgram>();
+    mProgram = program.get();
+    mSymTable = symTab;
+    mIsSupported = true;
+    mLocalSlots.clear();
+
+    FindYieldingFunctions(root);
+
+    // Every function is known before anything is compiled, a call can go to a function that hasn't been compiled yet
+    program->mMainFunction = nullptr;
+    for (const auto& decl : root->GetChildrenNodes())
+    {
+        if (decl->GetKind() != ASTNode::NodeKind::FUNCTION_DECL)
+            continue;
+
+        const FunctionDecl* fDecl = static_cast<const FunctionDecl*>(decl.get());
+        auto fn = std::make_unique<CompiledFunction>();
+        fn->fnDecl = fDecl;
+        fn->mayYield = mYieldingFunctions[fDecl];
+
+        if ((fDecl->GetFunctionName() == "main") && (fDecl->GetParametersSize() == 0))
+            program->mMainFunction = fn.get();
+
+        program->mFunctions[fDecl] = std::move(fn);
+    }
+
+    for (auto& fn : program->mFunctions)
+        CompileFunction(fn.second->fnDecl, *fn.second);
+
+    // Whatever lives in the global scope is run, in order, before the main function
+    mLocalSlots.clear();
+    CompiledFunction& globalInit = program->mGlobalInit;
+    globalInit.fnDecl = nullptr;
+    globalInit.paramCount = 0;
+    globalInit.slotCount = 0;
+    globalInit.mayYield = true;
+    for (const auto& decl : root->GetChildrenNodes())
+    {
+        // The comments of the global scope leave empty declarations behind, there is nothing to run for them
+        const ASTNode::NodeKind kind = decl->GetKind();
+        if ((kind != ASTNode::NodeKind::FUNCTION_DECL) && (kind != ASTNode::NodeKind::ERROR))
+            CompileStmt(decl.get(), globalInit.stmts);
+    }
+
+    if (!mIsSupported)
+        return nullptr;
+
+    return program;
+}
+
+void ClosureCompiler::FindYieldingFunctions(const ASTNode* root)
+{
+    mYieldingFunctions.clear();
+
+    std::unordered_map<const ASTNode*, std::vector<const ASTNode*>> fnCallees;
+    for (const auto& decl : root->GetChildrenNodes())
+    {
+        if (decl->GetKind() != ASTNode::NodeKind::FUNCTION_DECL)
+            continue;
+
+        const FunctionDecl* fDecl = static_cast<const FunctionDecl*>(decl.get());
+        mYieldingFunctions[fDecl] = FindYieldPoints(fDecl->GetBody(), fnCallees[fDecl]);
+    }
+
+    // A function calling a function that can yield can yield as well
+    bool changed = true;
+    while (changed)
+    {
+        changed = false;
+        for (const auto& fnCallee : fnCallees)
+        {
+            if (mYieldingFunctions[fnCallee.first])
+                continue;
+
+            for (const ASTNode* callee : fnCallee.second)
+            {
+                if (mYieldingFunctions[callee])
+                {
+                    mYieldingFunctions[fnCallee.first] = true;
+                    changed = true;
+                    break;
+                }
+            }
+        }
+    }
+}
+
+bool ClosureCompiler::FindYieldPoints(const ASTNode* node, std::vector<const ASTNode*>& callees) const
+{
+    if (node == nullptr)
+        return false;
+
+    switch (node->GetKind())
+    {
+    case ASTNode::NodeKind::JOIN_STMT:
+    case ASTNode::NodeKind::SLEEP_STMT:
+    case ASTNode::NodeKind::SYNC_STMT:
+        return true;
+    case ASTNode::NodeKind::CALL_EXPR:
+        callees.push_back(mSymTable->GetFunctionDecl(node));
+        break;
+    default:
+        break;
+    }
+
+    bool yields = false;
+    for (const auto& child : node->GetChildrenNodes())
+        yields |= FindYieldPoints(child.get(), callees);
+
+    return yields;
+}
+
+void ClosureCompiler::CompileFunction(const FunctionDecl* fDecl, CompiledFunction& fn)
+{
+    // The parameters take the first slots, in order, so that the arguments can directly become the locals
+    mLocalSlots.clear();
+    size_t slotCount = 0;
+    for (const auto& param : fDecl->GetParametersDecl()->GetParameters())
+        mLocalSlots[param.get()] = slotCount++;
+
+    fn.paramCount = slotCount;
+
+    AssignLocalSlots(fDecl->GetBody(), slotCount);
+    fn.slotCount = slotCount;
+
+    CompileCompoundStmt(fDecl->GetBody(), fn.stmts);
+}
+
+void ClosureCompiler::AssignLocalSlots(const ASTNode* node, size_t& slotCount)
+{
+    if (node->GetKind() == ASTNode::NodeKind::VAR_DECL)
+        mLocalSlots[node] = slotCount++;
+
+    for (const auto& child : node->GetChildrenNodes())
+        AssignLocalSlots(child.get(), slotCount);
+}
+
+////////// Statements //////////
+
+void ClosureCompiler::CompileStmt(const ASTNode* stmt, std::vector<StmtClosure>& stmts)
+{
+    switch (stmt->GetKind())
+    {
+    case ASTNode::NodeKind::COMPOUND_STMT:
+        CompileCompoundStmt(static_cast<const CompoundStmt*>(stmt), stmts);
+        break;
+    case ASTNode::NodeKind::VAR_DECL:
+        CompileVarDecl(static_cast<const VarDecl*>(stmt), stmts);
+        break;
+    case ASTNode::NodeKind::IF_STMT:
+    {
+        const IfStmt* iStmt = static_cast<const IfStmt*>(stmt);
+        ExprClosure cond = CompileExpr(iStmt->GetCondExpr());
+
+        // The condition jumps over the body when false. Its target is only known once the body is compiled.
+        const size_t condIdx = stmts.size();
+        stmts.emplace_back();
+        CompileCompoundStmt(iStmt->GetBody(), stmts);
+        const size_t endIdx = stmts.size();
+
+        stmts[condIdx] = [cond, condIdx, endIdx](Activation& act) { return cond(act).GetBoolVal() ? condIdx + 1 : endIdx; };
+        break;
+    }
+    case ASTNode::NodeKind::WHILE_STMT:
+    {
+        const WhileStmt* wStmt = static_cast<const WhileStmt*>(stmt);
+        ExprClosure cond = CompileExpr(wStmt->GetCondExpr());
+
+        const size_t condIdx = stmts.size();
+        stmts.emplace_back();
+        CompileCompoundStmt(wStmt->GetBody(), stmts);
+        stmts.push_back([condIdx](Activation&) { return condIdx; });
+        const size_t endIdx = stmts.size();
+
+        stmts[condIdx] = [cond, condIdx, endIdx](Activation& act) { return cond(act).GetBoolVal() ? condIdx + 1 : endIdx; };
+        break;
+    }
+    case ASTNode::NodeKind::PRINT_STMT:
+    {
+        const PrintStmt* pStmt = static_cast<const PrintStmt*>(stmt);
+        const size_t next = stmts.size() + 1;
+        if (pStmt->GetMessage() != nullptr)
+        {
+            ExprClosure msg = CompileExpr(pStmt->GetMessage());
+            stmts.push_back([msg, next](Activation& act) { CurrentThreadOutput().PrintLine(msg(act)); return next; });
+        }
+        else
+        {
+            // Printing a newline
+            stmts.push_back([next](Activation&) { CurrentThreadOutput().PrintLine(); return next; });
+        }
+        break;
+    }
+    case ASTNode::NodeKind::RETURN_STMT:
+    {
+        const Expr* rExpr = static_cast<const ReturnStmt*>(stmt)->GetReturnExpr();
+        if (rExpr == nullptr)
+        {
+            stmts.push_back([](Activation& act) { act.returnValue = InterpretedValue::CreateVoidValue(); return RETURN_PC; });
+        }
+        else if (IsTosLangCall(rExpr))
+        {
+            // The callee replaces the caller, which doesn't have to stay on the stack until it returns
+            CompileYieldingCall(static_cast<const CallExpr*>(rExpr), SlotKind::NONE, 0, true, stmts);
+        }
+        else
+        {
+            ExprClosure ret = CompileExpr(rExpr);
+            stmts.push_back([ret](Activation& act) { act.returnValue = ret(act); return RETURN_PC; });
+        }
+        break;
+    }
+    case ASTNode::NodeKind::SCAN_STMT:
+    {
+        SlotKind kind;
+        size_t slot;
+        if (!TryGetSlot(mSymTable->GetVarDecl(static_cast<const ScanStmt*>(stmt)->GetInput()), kind, slot))
+        {
+            Unsupported();
+            break;
+        }
+
+        // The value read takes the type of the variable it goes into
+        const size_t next = stmts.size() + 1;
+        stmts.push_back([kind, slot, next](Activation& act)
+        {
+            // A prompt printed before the scan must show up before the program waits for its input
+            CurrentThreadOutput().Flush();
+
+            GlobalStore& globals = GlobalStore::GetCurrent();
+            InterpretedValue input = (kind == SlotKind::LOCAL) ? act.locals[slot] : globals.Load(slot);
+            switch (input.GetType())
+            {
+            case InterpretedValue::ValueType::BOOLEAN:
+            {
+                bool val;
+                InputBuffer::GetInstance().ReadBool(val);
+                input = InterpretedValue{ val };
+                break;
+            }
+            case InterpretedValue::ValueType::INTEGER:
+            {
+                int val;
+                InputBuffer::GetInstance().ReadInt(val);
+                input = InterpretedValue{ val };
+                break;
+            }
+            default:
+            {
+                std::string val;
+                InputBuffer::GetInstance().ReadString(val);
+                input = InterpretedValue{ val };
+                break;
+            }
+            }
+
+            if (kind == SlotKind::LOCAL)
+                act.locals[slot] = input;
+            else
+                globals.Store(slot, input);
+
+            return next;
+        });
+        break;
+    }
+    case ASTNode::NodeKind::SLEEP_STMT:
+    {
+        ExprClosure count = CompileExpr(static_cast<const SleepStmt*>(stmt)->GetCountExpr());
+        const size_t next = stmts.size() + 1;
+        stmts.push_back([count, next](Activation& act) { Threading::CurrentThreadSleepFor(count(act).GetIntVal()); return next; });
+        break;
+    }
+    case ASTNode::NodeKind::SYNC_STMT:
+    {
+        const size_t next = stmts.size() + 1;
+        stmts.push_back([next](Activation&) { Threading::CurrentThreadSync(); return next; });
+        break;
+    }
+    case ASTNode::NodeKind::JOIN_STMT:
+    {
+        ExprClosure handle = CompileExpr(static_cast<const JoinStmt*>(stmt)->GetHandleExpr());
+        const size_t next = stmts.size() + 1;
+        stmts.push_back([handle, next](Activation& act) { Threading::CurrentThreadJoin(handle(act).GetIntVal()); return next; });
+        break;
+    }
+    case ASTNode::NodeKind::CALL_EXPR:
+    {
+        if (IsTosLangCall(stmt))
+        {
+            CompileYieldingCall(static_cast<const CallExpr*>(stmt), SlotKind::NONE, 0, false, stmts);
+        }
+        else
+        {
+            ExprClosure call = CompileExpr(stmt);
+            const size_t next = stmts.size() + 1;
+            stmts.push_back([call, next](Activation& act) { call(act); return next; });
+        }
+        break;
+    }
+    case ASTNode::NodeKind::BINARY_EXPR:
+    case ASTNode::NodeKind::SPAWN_EXPR:
+    {
+        const BinaryOpExpr* bExpr = dynamic_cast<const BinaryOpExpr*>(stmt);
+        if ((bExpr != nullptr) && (bExpr->GetOperation() == Operation::ASSIGNMENT) && IsTosLangCall(bExpr->GetRHS()))
+        {
+            // Assigning the result of a call. The value will be stored when the callee returns.
+            SlotKind kind;
+            size_t slot;
+            if ((bExpr->GetLHS()->GetKind() == ASTNode::NodeKind::IDENTIFIER_EXPR)
+                && TryGetSlot(mSymTable->GetVarDecl(bExpr->GetLHS()), kind, slot))
+                CompileYieldingCall(static_cast<const CallExpr*>(bExpr->GetRHS()), kind, slot, false, stmts);
+            else
+                Unsupported();
+        }
+        else
+        {
+            ExprClosure expr = CompileExpr(stmt);
+            const size_t next = stmts.size() + 1;
+            stmts.push_back([expr, next](Activation& act) { expr(act); return next; });
+        }
+        break;
+    }
+    default:
+        Unsupported();
+        break;
+    }
+}
+
+void ClosureCompiler::CompileCompoundStmt(const CompoundStmt* cStmt, std::vector<StmtClosure>& stmts)
+{
+    for (const auto& stmt : cStmt->GetStatements())
+        CompileStmt(stmt.get(), stmts);
+}
+
+void ClosureCompiler::CompileVarDecl(const VarDecl* vDecl, std::vector<StmtClosure>& stmts)
+{
+    const Expr* initExpr = vDecl->GetInitExpr();
+    if ((initExpr != nullptr) && IsTosLangCall(initExpr))
+    {
+        SlotKind kind;
+        size_t slot;
+        if (TryGetSlot(vDecl, kind, slot))
+            CompileYieldingCall(static_cast<const CallExpr*>(initExpr), kind, slot, false, stmts);
+        else
+            Unsupported();
+
+        return;
+    }
+
+    ExprClosure init;
+    if (initExpr != nullptr)
+    {
+        init = CompileExpr(initExpr);
+    }
+    else
+    {
+        const InterpretedValue defaultVal = GetDefaultValue(vDecl);
+        init = [defaultVal](Activation&) { return defaultVal; };
+    }
+
+    ExprClosure store = CompileStore(vDecl, init);
+    const size_t next = stmts.size() + 1;
+    stmts.push_back([store, next](Activation& act) { store(act); return next; });
+}
+
+void ClosureCompiler::CompileYieldingCall(const CallExpr* call, SlotKind destKind, size_t destSlot, bool isTailCall, std::vector<StmtClosure>& stmts)
+{
+    const CompiledFunction* callee = mProgram->GetFunction(mSymTable->GetFunctionDecl(call));
+    assert(callee != nullptr);
+
+    std::vector<ExprClosure> args = CompileArgs(call);
+    const size_t next = stmts.size() + 1;
+
+    // The closure executor makes the call once the statement is done
+    stmts.push_back([callee, args, destKind, destSlot, isTailCall, next](Activation& act)
+    {
+        act.pendingCall.callee = callee;
+        act.pendingCall.args = EvaluateArgs(args, act);
+        act.pendingCall.destKind = destKind;
+        act.pendingCall.destSlot = destSlot;
+        act.pendingCall.isTailCall = isTailCall;
+        act.hasPendingCall = true;
+
+        return isTailCall ? RETURN_PC : next;
+    });
+}
+
+////////// Expressions //////////
+
+ExprClosure ClosureCompiler::CompileExpr(const ASTNode* expr)
+{
+    switch (expr->GetKind())
+    {
+    case ASTNode::NodeKind::ARRAY_EXPR:
+    {
+        std::vector<ExprClosure> elems;
+        for (const auto& elem : expr->GetChildrenNodes())
+            elems.push_back(CompileExpr(elem.get()));
+
+        if (elems.empty())
+            return Unsupported();
+
+        return [elems](Activation& act) { return MakeArray(EvaluateArgs(elems, act)); };
+    }
+    case ASTNode::NodeKind::BINARY_EXPR:
+    {
+        const BinaryOpExpr* bExpr = static_cast<const BinaryOpExpr*>(expr);
+        if (IsYieldingCall(bExpr->GetLHS()) || IsYieldingCall(bExpr->GetRHS()))
+            return Unsupported();
+
+        const Operation op = bExpr->GetOperation();
+        if (op == Operation::ASSIGNMENT)
+        {
+            if (bExpr->GetLHS()->GetKind() != ASTNode::NodeKind::IDENTIFIER_EXPR)
+                return Unsupported();
+
+            const GlobalStore::GlobalUpdate* update = GlobalStore::GetCurrent().FindUpdate(bExpr);
+            if (update != nullptr)
+                return CompileUpdate(*update, GetValueType(GetExprType(bExpr->GetLHS(), mSymTable)));
+
+            return CompileStore(mSymTable->GetVarDecl(bExpr->GetLHS()), CompileExpr(bExpr->GetRHS()));
+        }
+
+        ExprClosure lhs = CompileExpr(bExpr->GetLHS());
+        ExprClosure rhs = CompileExpr(bExpr->GetRHS());
+
+        // The operation and its operand types are known ahead of time, so we can directly go to the specialized handler
+        const InterpretedValue::ValueType lhsType = GetValueType(GetExprType(bExpr->GetLHS(), mSymTable));
+        const InterpretedValue::ValueType rhsType = GetValueType(GetExprType(bExpr->GetRHS(), mSymTable));
+        BinaryOpHandler handler = GetSpecializedHandler(op, lhsType, rhsType);
+        if (handler != nullptr)
+        {
+            return [lhs, rhs, handler](Activation& act)
+            {
+                const InterpretedValue lhsVal = lhs(act);
+                return handler(lhsVal, rhs(act));
+            };
+        }
+
+        return [lhs, rhs, op](Activation& act)
+        {
+            const InterpretedValue lhsVal = lhs(act);
+            return EvaluateBinaryOp(op, lhsVal, rhs(act));
+        };
+    }
+    case ASTNode::NodeKind::BOOLEAN_EXPR:
+    {
+        const InterpretedValue val{ static_cast<const BooleanExpr*>(expr)->GetValue() };
+        return [val](Activation&) { return val; };
+    }
+    case ASTNode::NodeKind::CALL_EXPR:
+    {
+        if (IsYieldingCall(expr))
+            return Unsupported();
+
+        std::vector<ExprClosure> args = CompileArgs(static_cast<const CallExpr*>(expr));
+
+        // The built-in functions never yield and run natively
+        const IntrinsicID intrinsic = Intrinsics::GetInstance().GetID(mSymTable->GetFunctionDecl(expr));
+        if (intrinsic != IntrinsicID::NONE)
+            return [intrinsic, args](Activation& act) { return CallIntrinsic(intrinsic, EvaluateArgs(args, act)); };
+
+        const CompiledFunction* callee = mProgram->GetFunction(mSymTable->GetFunctionDecl(expr));
+        assert(callee != nullptr);
+
+        // The callee can't yield, it can then run to completion right away. It isn't suspended at the end of the quantum,
+        // but its statements are counted and it stops once the quota is used up.
+        return [callee, args](Activation& act) { return callee->Invoke(EvaluateArgs(args, act)); };
+    }
+    case ASTNode::NodeKind::IDENTIFIER_EXPR:
+    {
+        SlotKind kind;
+        size_t slot;
+        if (!TryGetSlot(mSymTable->GetVarDecl(expr), kind, slot))
+            return Unsupported();
+
+        if (kind == SlotKind::LOCAL)
+            return [slot](Activation& act) { return act.locals[slot]; };
+        else
+            return [slot](Activation&) { return GlobalStore::GetCurrent().Load(slot); };
+    }
+    case ASTNode::NodeKind::INDEX_EXPR:
+    {
+        const IndexedExpr* iExpr = static_cast<const IndexedExpr*>(expr);
+        ExprClosure array = CompileExpr(iExpr->GetIdentifier());
+        ExprClosure index = CompileExpr(iExpr->GetIndex());
+
+        // Indexing checks the bounds, an index outside of the array throws std::out_of_range and ends the thread
+        return [array, index](Activation& act) { return array(act)[index(act).GetIntVal()]; };
+    }
+    case ASTNode::NodeKind::NUMBER_EXPR:
+    {
+        const InterpretedValue val{ static_cast<const NumberExpr*>(expr)->GetValue() };
+        return [val](Activation&) { return val; };
+    }
+    case ASTNode::NodeKind::SPAWN_EXPR:
+    {
+        const CallExpr* call = static_cast<const SpawnExpr*>(expr)->GetCall();
+        if (Intrinsics::GetInstance().GetID(mSymTable->GetFunctionDecl(call)) != IntrinsicID::NONE)
+            return Unsupported();
+
+        const CompiledFunction* callee = mProgram->GetFunction(mSymTable->GetFunctionDecl(call));
+        assert(callee != nullptr);
+
+        // The new thread shares the global variables of the current one through the global store
+        std::vector<ExprClosure> args = CompileArgs(call);
+        return [callee, args](Activation& act) { return InterpretedValue{ Threading::CreateThread(callee, EvaluateArgs(args, act)) }; };
+    }
+    case ASTNode::NodeKind::STRING_EXPR:
+    {
+        const InterpretedValue val{ StringPool::GetInstance().GetLiteral(expr) };
+        return [val](Activation&) { return val; };
+    }
+    default:
+        return Unsupported();
+    }
+}
+
+std::vector<ExprClosure> ClosureCompiler::CompileArgs(const CallExpr* call)
+{
+    std::vector<ExprClosure> args;
+    for (const auto& arg : call->GetArgs())
+        args.push_back(CompileExpr(arg.get()));
+
+    return args;
+}
+
+ExprClosure ClosureCompiler::CompileStore(const ASTNode* varDecl, ExprClosure valueExpr)
+{
+    SlotKind kind;
+    size_t slot;
+    if (!TryGetSlot(varDecl, kind, slot))
+        return Unsupported();
+
+    if (kind == SlotKind::LOCAL)
+        return [slot, valueExpr](Activation& act) { return act.locals[slot] = valueExpr(act); };
+    else
+    {
+        return [slot, valueExpr](Activation& act)
+        {
+            const InterpretedValue value = valueExpr(act);
+            GlobalStore::GetCurrent().Store(slot, value);
+            return value;
+        };
+    }
+}
+
+ExprClosure ClosureCompiler::CompileUpdate(const GlobalStore::GlobalUpdate& update, InterpretedValue::ValueType varType)
+{
+    ExprClosure operand = CompileExpr(update.operand);
+    const InterpretedValue::ValueType operandType = GetValueType(GetExprType(update.operand, mSymTable));
+    const size_t slot = update.slot;
+    const bool isVarLHS = update.isVarLHS;
+
+    // The operand is evaluated before taking the variable's lock, which is only held for the operation itself
+    BinaryOpHandler handler = isVarLHS ? GetSpecializedHandler(update.op, varType, operandType)
+                                       : GetSpecializedHandler(update.op, operandType, varType);
+    if (handler != nullptr)
+    {
+        return [operand, slot, isVarLHS, handler](Activation& act)
+        {
+            const InterpretedValue operandVal = operand(act);
+            return GlobalStore::GetCurrent().Update(slot, [&operandVal, isVarLHS, handler](const InterpretedValue& varVal)
+            {
+                return isVarLHS ? handler(varVal, operandVal) : handler(operandVal, varVal);
+            });
+        };
+    }
+
+    const Operation op = update.op;
+    return [operand, slot, isVarLHS, op](Activation& act)
+    {
+        const InterpretedValue operandVal = operand(act);
+        return GlobalStore::GetCurrent().Update(slot, [&operandVal, isVarLHS, op](const InterpretedValue& varVal)
+        {
+            return isVarLHS ? EvaluateBinaryOp(op, varVal, operandVal) : EvaluateBinaryOp(op, operandVal, varVal);
+        });
+    };
+}
+
+bool ClosureCompiler::IsYieldingCall(const ASTNode* expr) const
+{
+    if (expr->GetKind() != ASTNode::NodeKind::CALL_EXPR)
+        return false;
+
+    auto fnIt = mYieldingFunctions.find(mSymTable->GetFunctionDecl(expr));
+    return (fnIt != mYieldingFunctions.end()) && fnIt->second;
+}
+
+bool ClosureCompiler::IsTosLangCall(const ASTNode* expr) const
+{
+    // The built-in functions run natively, without any activation
+    return (expr->GetKind() == ASTNode::NodeKind::CALL_EXPR)
+        && (Intrinsics::GetInstance().GetID(mSymTable->GetFunctionDecl(expr)) == IntrinsicID::NONE);
+}
+
+bool ClosureCompiler::TryGetSlot(const ASTNode* varDecl, SlotKind& kind, size_t& slot) const
+{
+    auto slotIt = mLocalSlots.find(varDecl);
+    if (slotIt != mLocalSlots.end())
+    {
+        kind = SlotKind::LOCAL;
+        slot = slotIt->second;
+        return true;
+    }
+
+    if (GlobalStore::GetCurrent().TryGetSlot(varDecl, slot))
+    {
+        kind = SlotKind::GLOBAL;
+        return true;
+    }
+
+    return false;
+}
+
+ExprClosure ClosureCompiler::Unsupported()
+{
+    mIsSupported = false;
+    return [](Activation&) { return InterpretedValue{}; };
+}
@@ -0,0 +1,210 @@
+#ifndef CLOSURE_COMPILER_H__TOSTITOS
+#define CLOSURE_COMPILER_H__TOSTITOS
+
+#include "globalstore.h"
+#include "interpretedvalue.h"
+
+#include <cstddef>
+#include <functional>
+#include <limits>
+#include <memory>
+#include <unordered_map>
+#include <vector>
+
+namespace TosLang
+{
+    namespace FrontEnd
+    {
+        class ASTNode;
+        class CallExpr;
+        class CompoundStmt;
+        class Expr;
+        class FunctionDecl;
+        class SymbolTable;
+        class VarDecl;
+    }
+}
+
+namespace Threading
+{
+    namespace impl
+    {
+        struct Activation;
+        struct CompiledFunction;
+
+        using ExprClosure = std::function<InterpretedValue(Activation&)>;
+
+        // A statement closure executes its statement then gives back the index of the next statement to execute
+        using StmtClosure = std::function<size_t(Activation&)>;
+
+        // Index of the next statement signaling that the function returned
+        static const size_t RETURN_PC = std::numeric_limits<size_t>::max();
+
+        /*
+        * \enum  SlotKind
+        * \brief Kind of storage a variable lives in
+        */
+        enum class SlotKind
+        {
+            NONE,
+            LOCAL,
+            GLOBAL,
+        };
+
+        /*
+        * \fn           GetDefaultValue
+        * \brief        Gets the value of a variable declared without an initialization expression
+        * \param vDecl  Variable declaration
+        * \return       Default value for the type (and size) of the variable
+        */
+        InterpretedValue GetDefaultValue(const TosLang::FrontEnd::VarDecl* vDecl);
+
+        /*
+        * \fn           MakeArray
+        * \brief        Gathers the values of the elements of an array expression
+        * \param elems  Values of the elements, at least one
+        * \return       Array holding the elements
+        */
+        InterpretedValue MakeArray(const std::vector<InterpretedValue>& elems);
+
+        /*
+        * \struct PendingCall
+        * \brief  Call made by a statement. Such a call isn't made directly from a closure, it is left to
+        *         the closure executor so that the callee runs one statement at a time as well.
+        *         Tail calls are also left to the caller's loop, which replaces the caller's activation with the callee's.
+        */
+        struct PendingCall
+        {
+            const CompiledFunction* callee;     /*!< Function to call */
+            std::vector<InterpretedValue> args; /*!< Values of the arguments */
+            SlotKind destKind;                  /*!< Kind of slot receiving the returned value, if any */
+            size_t destSlot;                    /*!< Slot receiving the returned value */
+            bool isTailCall;                    /*!< Is the caller returning the callee's result? */
+        };
+
+        /*
+        * \struct Activation
+        * \brief  Execution state of a compiled function
+        */
+        struct Activation
+        {
+            const CompiledFunction* fn;                 /*!< Function being executed */
+            size_t pc;                                  /*!< Index of the next statement to execute */
+            std::vector<InterpretedValue> locals;       /*!< Parameters and local variables, indexed by slot */
+            InterpretedValue returnValue;               /*!< Value returned by the function */
+            SlotKind returnKind;                        /*!< Kind of caller slot receiving the returned value, if any */
+            size_t returnSlot;                          /*!< Caller slot receiving the returned value */
+            bool hasPendingCall;                        /*!< Did the last statement request a call? */
+            PendingCall pendingCall;                    /*!< Call requested by the last statement */
+        };
+
+        /*
+        * \struct CompiledFunction
+        * \brief  Function whose statements were compiled into closures. Control flow statements are
+        *         flattened into jumps so that a function can be suspended between any two statements.
+        */
+        struct CompiledFunction
+        {
+            const TosLang::FrontEnd::FunctionDecl* fnDecl;  /*!< Function declaration, nullptr for the global initialization */
+            size_t paramCount;                              /*!< Number of parameters, which take the first slots */
+            size_t slotCount;                               /*!< Number of slots needed for the parameters and local variables */
+            bool mayYield;                                  /*!< Can the function give the processor back to the kernel (sleep, sync)? */
+            std::vector<StmtClosure> stmts;                 /*!< Compiled statements */
+
+            /*
+            * \fn           CreateActivation
+            * \brief        Prepares the execution of the function
+            * \param args   Values of the function's arguments
+            * \return       New activation for the function
+            */
+            Activation CreateActivation(std::vector<InterpretedValue>&& args) const;
+
+            /*
+            * \fn           Invoke
+            * \brief        Executes the function without interruption. Only valid for functions that can't yield.
+            *               The calls it makes don't nest on the host stack. The statements executed are
+            *               counted against the current thread (see Thread::CountNestedSteps).
+            * \param args   Values of the function's arguments
+            * \return       Value returned by the function
+            */
+            InterpretedValue Invoke(std::vector<InterpretedValue>&& args) const;
+        };
+
+        /*
+        * \class CompiledProgram
+        * \brief TosLang program compiled to closures. The closures keep pointers to the AST and the symbol
+        *        table, which must then outlive the compiled program.
+        */
+        class CompiledProgram
+        {
+        public:
+            const CompiledFunction* GetFunction(const TosLang::FrontEnd::ASTNode* fnDecl) const;
+            const CompiledFunction* GetMainFunction() const { return mMainFunction; }
+            const CompiledFunction* GetGlobalInit() const { return &mGlobalInit; }
+
+        private:
+            friend class ClosureCompiler;
+
+            std::unordered_map<const TosLang::FrontEnd::ASTNode*, std::unique_ptr<CompiledFunction>> mFunctions;
+            CompiledFunction mGlobalInit;           /*!< Initialization of the global variables, run before main */
+            const CompiledFunction* mMainFunction;
+        };
+
+        /*
+        * \class ClosureCompiler
+        * \brief Compiles a type checked program to a tree of pre-bound closures. Variables are resolved to slots,
+        *        calls to their compiled callee and literals to constants ahead of time, so executing the program
+        *        doesn't require the symbol table nor any kind of lookup. The global variables are resolved to their
+        *        slot in the current global store, which must then be the program's and have been reset before it is compiled.
+        *
+        *        Calls to functions that can yield (directly or not) must be suspendable. They are only supported
+        *        when they are the whole statement, the initialization of a variable, the right hand side of an
+        *        assignment or the returned value. Programs using them anywhere else aren't compiled.
+        *        Calls in those positions are always left to the closure executor (see PendingCall), whether the callee
+        *        can yield or not, so that the callee runs one statement at a time on the thread's own stack and
+        *        tail recursion runs in constant space. Only the calls nested in an expression run to completion.
+        */
+        class ClosureCompiler
+        {
+        public:
+            /*
+            * \fn           Compile
+            * \brief        Compiles a program
+            * \param root   Root of the program's AST
+            * \param symTab Symbol table of the program
+            * \return       Compiled program, or nullptr if the program uses constructs the closure tier doesn't handle
+            */
+            std::unique_ptr<CompiledProgram> Compile(const TosLang::FrontEnd::ASTNode* root, const TosLang::FrontEnd::SymbolTable* symTab);
+
+        private:
+            void FindYieldingFunctions(const TosLang::FrontEnd::ASTNode* root);
+            bool FindYieldPoints(const TosLang::FrontEnd::ASTNode* node, std::vector<const TosLang::FrontEnd::ASTNode*>& callees) const;
+
+            void CompileFunction(const TosLang::FrontEnd::FunctionDecl* fDecl, CompiledFunction& fn);
+            void AssignLocalSlots(const TosLang::FrontEnd::ASTNode* node, size_t& slotCount);
+
+            void CompileStmt(const TosLang::FrontEnd::ASTNode* stmt, std::vector<StmtClosure>& stmts);
+            void CompileCompoundStmt(const TosLang::FrontEnd::CompoundStmt* cStmt, std::vector<StmtClosure>& stmts);
+            void CompileVarDecl(const TosLang::FrontEnd::VarDecl* vDecl, std::vector<StmtClosure>& stmts);
+            void CompileYieldingCall(const TosLang::FrontEnd::CallExpr* call, SlotKind destKind, size_t destSlot, bool isTailCall, std::vector<StmtClosure>& stmts);
+            ExprClosure CompileExpr(const TosLang::FrontEnd::ASTNode* expr);
+            std::vector<ExprClosure> CompileArgs(const TosLang::FrontEnd::CallExpr* call);
+
+            bool IsYieldingCall(const TosLang::FrontEnd::ASTNode* expr) const;
+            bool IsTosLangCall(const TosLang::FrontEnd::ASTNode* expr) const;  // Is it a call to a function other than a built-in one?
+            bool TryGetSlot(const TosLang::FrontEnd::ASTNode* varDecl, SlotKind& kind, size_t& slot) const;
+            ExprClosure CompileStore(const TosLang::FrontEnd::ASTNode* varDecl, ExprClosure valueExpr);
+            ExprClosure CompileUpdate(const GlobalStore::GlobalUpdate& update, InterpretedValue::ValueType varType);   // Atomic update of a global variable
+            ExprClosure Unsupported();
+
+        private:
+            const TosLang::FrontEnd::SymbolTable* mSymTable;
+            CompiledProgram* mProgram;
+            bool mIsSupported;                                                          /*!< Was every construct seen so far handled? */
+            std::unordered_map<const TosLang::FrontEnd::ASTNode*, bool> mYieldingFunctions;
+            std::unordered_map<const TosLang::FrontEnd::ASTNode*, size_t> mLocalSlots;  /*!< Local variable declaration to slot, for the function being compiled */
+        };
+    }   // namespace impl
+}   // namespace Threading
+
+#endif // CLOSURE_COMPILER_H__TOSTITOS
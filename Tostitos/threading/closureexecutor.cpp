@@ -0,0 +1,159 @@
+#include "closureexecutor.h"
+
+#include "checkpoint.h"
+#include "globalstore.h"
+
+#include "../../TosLang/AST/declarations.h"
+
+#include <cassert>
+
+using namespace Threading::impl;
+
+ClosureExecutor::ClosureExecutor(const CompiledProgram* program)
+    : mActivations{}
+{
+    // The global scope runs first since it sits on top of the main function
+    if (program->GetMainFunction() != nullptr)
+        mActivations.push_back(program->GetMainFunction()->CreateActivation({}));
+
+    mActivations.push_back(program->GetGlobalInit()->CreateActivation({}));
+}
+
+ClosureExecutor::ClosureExecutor(const CompiledFunction* fn, std::vector<InterpretedValue>&& args)
+    : mActivations{}
+{
+    mActivations.push_back(fn->CreateActivation(std::move(args)));
+}
+
+void ClosureExecutor::Reset(const CompiledFunction* fn, std::vector<InterpretedValue>&& args)
+{
+    // The activations of the previous function are all gone by now, only the storage of the call stack is left
+    mActivations.clear();
+    mActivations.push_back(fn->CreateActivation(std::move(args)));
+    mResult = InterpretedValue::CreateVoidValue();
+
+    // Still moving forward, a state cached for the previous function must not pass for the new one's
+    ++mVersion;
+}
+
+bool ClosureExecutor::ExecuteOne()
+{
+    if (mActivations.empty())
+        return false;
+
+    ++mVersion;
+
+    Activation& act = mActivations.back();
+    if (act.pc < act.fn->stmts.size())
+        act.pc = act.fn->stmts[act.pc](act);
+
+    if (act.hasPendingCall)
+        MakePendingCall();
+    else if (act.pc >= act.fn->stmts.size())
+        ReturnFromCurrentActivation();
+
+    return true;
+}
+
+void ClosureExecutor::MakePendingCall()
+{
+    Activation& caller = mActivations.back();
+    caller.hasPendingCall = false;
+
+    PendingCall& call = caller.pendingCall;
+    Activation calleeAct = call.callee->CreateActivation(std::move(call.args));
+
+    if (call.isTailCall)
+    {
+        // Nothing in the caller is needed anymore, the callee takes its place and returns to its caller
+        calleeAct.returnKind = caller.returnKind;
+        calleeAct.returnSlot = caller.returnSlot;
+        caller = std::move(calleeAct);
+    }
+    else
+    {
+        calleeAct.returnKind = call.destKind;
+        calleeAct.returnSlot = call.destSlot;
+        mActivations.push_back(std::move(calleeAct));
+    }
+}
+
+void ClosureExecutor::ReturnFromCurrentActivation()
+{
+    const InterpretedValue returnValue = mActivations.back().returnValue;
+    const SlotKind returnKind = mActivations.back().returnKind;
+    const size_t returnSlot = mActivations.back().returnSlot;
+    mActivations.pop_back();
+
+    switch (returnKind)
+    {
+    case SlotKind::LOCAL:
+        assert(!mActivations.empty());
+        mActivations.back().locals[returnSlot] = returnValue;
+        break;
+    case SlotKind::GLOBAL:
+        GlobalStore::GetCurrent().Store(returnSlot, returnValue);
+        break;
+    case SlotKind::NONE:
+        // The bottom activation returns to no one, what it returns is the result of the thread
+        if (mActivations.empty())
+            mResult = returnValue;
+        break;
+    }
+}
+
+void ClosureExecutor::Save(CheckpointWriter& writer) const
+{
+    writer.WriteUInt(mActivations.size());
+    for (const Activation& act : mActivations)
+    {
+        // A pending call is always made right after the statement requesting it, there is never one between two statements
+        assert(!act.hasPendingCall);
+
+        // The global initialization has no declaration, it is written as no node
+        writer.WriteNode(act.fn->fnDecl);
+        writer.WriteUInt(act.pc);
+        writer.WriteUInt(act.locals.size());
+        for (const InterpretedValue& local : act.locals)
+            writer.WriteValue(local);
+        writer.WriteValue(act.returnValue);
+        writer.WriteUInt(static_cast<uint64_t>(act.returnKind));
+        writer.WriteUInt(act.returnSlot);
+    }
+}
+
+void ClosureExecutor::Load(CheckpointReader& reader, const CompiledProgram* program)
+{
+    mActivations.clear();
+    for (uint64_t iAct = reader.ReadUInt(); (iAct > 0) && !reader.HasFailed(); --iAct)
+    {
+        const TosLang::FrontEnd::ASTNode* fnDecl = reader.ReadNode();
+        const CompiledFunction* fn = (fnDecl != nullptr) ? program->GetFunction(fnDecl) : program->GetGlobalInit();
+        if (fn == nullptr)
+        {
+            reader.Fail();
+            return;
+        }
+
+        Activation act{};
+        act.fn = fn;
+        act.pc = static_cast<size_t>(reader.ReadUInt());
+        act.hasPendingCall = false;
+
+        // A function compiled with another number of slots doesn't come from the same program
+        if (reader.ReadUInt() != fn->slotCount)
+        {
+            reader.Fail();
+            return;
+        }
+
+        act.locals.resize(fn->slotCount);
+        for (InterpretedValue& local : act.locals)
+            local = reader.ReadValue();
+        act.returnValue = reader.ReadValue();
+        act.returnKind = static_cast<SlotKind>(reader.ReadUInt());
+        act.returnSlot = static_cast<size_t>(reader.ReadUInt());
+
+        mActivations.push_back(std::move(act));
+    }
+}
@@ -0,0 +1,87 @@
+#ifndef CLOSURE_EXECUTOR_H__TOSTITOS
+#define CLOSURE_EXECUTOR_H__TOSTITOS
+
+#include "closurecompiler.h"
+
+#include <vector>
+
+namespace Threading
+{
+    namespace impl
+    {
+        class CheckpointReader;
+        class CheckpointWriter;
+
+        /*
+        * \class ClosureExecutor
+        * \brief Execution agent running a program compiled to closures. Like the AST executor, it runs one
+        *        statement at a time so that the kernel can switch threads at every statement boundary.
+        */
+        class ClosureExecutor
+        {
+        public:
+            /*
+            * \fn           ClosureExecutor
+            * \brief        Prepares the main thread of a program: the global scope is run, then the main function
+            * \param program Compiled program
+            */
+            explicit ClosureExecutor(const CompiledProgram* program);
+
+            /*
+            * \fn           ClosureExecutor
+            * \brief        Prepares a spawned thread
+            * \param fn     Function run by the thread
+            * \param args   Values of the function's arguments
+            */
+            ClosureExecutor(const CompiledFunction* fn, std::vector<InterpretedValue>&& args);
+
+            /*
+            * \fn           Reset
+            * \brief        Prepares the executor of a finished thread to run another function, keeping its storage
+            * \param fn     Function run by the thread
+            * \param args   Values of the function's arguments
+            */
+            void Reset(const CompiledFunction* fn, std::vector<InterpretedValue>&& args);
+
+        public:
+            /*
+            * \fn           ExecuteOne
+            * \brief        Executes the next statement
+            * \return       False if there was nothing left to execute, else true
+            */
+            bool ExecuteOne();
+
+            /*
+            * \fn           Save
+            * \brief        Writes the state of the executor: the activations of the thread's call stack
+            * \param writer Checkpoint being written
+            */
+            void Save(CheckpointWriter& writer) const;
+
+            /*
+            * \fn           Load
+            * \brief        Restores the state written by Save
+            * \param reader Checkpoint being read
+            * \param program    Program the executor runs, compiled the same way it was when the state was saved
+            */
+            void Load(CheckpointReader& reader, const CompiledProgram* program);
+
+            // Changes every time the state of the executor does
+            size_t GetVersion() const { return mVersion; }
+
+            // Value returned by the function the thread was spawned for, once it has returned
+            const InterpretedValue& GetResult() const { return mResult; }
+
+        private:
+            void MakePendingCall();
+            void ReturnFromCurrentActivation();
+
+        private:
+            std::vector<Activation> mActivations;   /*!< Call stack of the thread */
+            size_t mVersion = 0;                    /*!< Number of statements executed */
+            InterpretedValue mResult;               /*!< Value returned by the bottom activation */
+        };
+    }   // namespace impl
+}   // namespace Threading
+
+#endif // CLOSURE_EXECUTOR_H__TOSTITOS
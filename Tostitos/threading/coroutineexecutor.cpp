@@ -0,0 +1,819 @@
+#include "coroutineexecutor.h"
+
+#include "arraykernels.h"
+#include "globalstore.h"
+#include "inputbuffer.h"
+#include "outputbuffer.h"
+#include "quickenedops.h"
+#include "stringpool.h"
+#include "threadutil.h"
+
+#include "../../TosLang/AST/declarations.h"
+#include "../../TosLang/Common/opcodes.h"
+#include "../../TosLang/Sema/symboltable.h"
+
+#include <algorithm>
+#include <cassert>
+#include <utility>
+
+using namespace Threading::impl;
+using namespace TosLang::Common;
+using namespace TosLang::FrontEnd;
+
+////////// Coroutine Program //////////
+
+std::unique_ptr<CoroutineProgram> CoroutineProgram::Build(const ASTNode* root, const SymbolTable* symTab)
+{
+    assert(root != nullptr);
+    assert(symTab != nullptr);
+
+    auto program = std::make_unique<CoroutineProgram>();
+    program->mRoot = root;
+    program->mSymTable = symTab;
+    program->mIsSupported = true;
+    program->mMainFunction = nullptr;
+
+    // Every function is known before anything is resolved, a call can go to a function declared further down
+    for (const auto& decl : root->GetChildrenNodes())
+    {
+        if (decl->GetKind() != ASTNode::NodeKind::FUNCTION_DECL)
+            continue;
+
+        const FunctionDecl* fDecl = static_cast<const FunctionDecl*>(decl.get());
+        auto fn = std::make_unique<CoroutineFunction>();
+        fn->program = program.get();
+        fn->fnDecl = fDecl;
+        fn->paramCount = 0;
+        fn->slotCount = 0;
+        fn->mayYield = false;
+
+        if ((fDecl->GetFunctionName() == "main") && (fDecl->GetParametersSize() == 0))
+            program->mMainFunction = fn.get();
+
+        program->mFunctions[fDecl] = std::move(fn);
+    }
+
+    for (auto& fnIt : program->mFunctions)
+    {
+        CoroutineFunction& fn = *fnIt.second;
+
+        // The parameters take the first slots, in order, so that the arguments can directly become the locals
+        std::unordered_map<const ASTNode*, size_t> localSlots;
+        size_t slotCount = 0;
+        for (const auto& param : fn.fnDecl->GetParametersDecl()->GetParameters())
+        {
+            program->mSlots[param.get()] = CoroutineSlot{ SlotKind::LOCAL, slotCount };
+            localSlots[param.get()] = slotCount++;
+        }
+
+        fn.paramCount = slotCount;
+        program->Resolve(fn.fnDecl->GetBody(), &localSlots, slotCount);
+        fn.slotCount = slotCount;
+    }
+
+    // The variables of the global scope all live in the global store
+    size_t globalSlotCount = 0;
+    for (const auto& decl : root->GetChildrenNodes())
+    {
+        if (decl->GetKind() != ASTNode::NodeKind::FUNCTION_DECL)
+            program->Resolve(decl.get(), nullptr, globalSlotCount);
+    }
+
+    if (!program->mIsSupported)
+        return nullptr;
+
+    program->FindYieldingFunctions();
+    return program;
+}
+
+const CoroutineCallTarget& CoroutineProgram::GetCallTarget(const ASTNode* callExpr) const
+{
+    auto targetIt = mCallTargets.find(callExpr);
+    assert(targetIt != mCallTargets.end());
+    return targetIt->second;
+}
+
+const CoroutineSlot& CoroutineProgram::GetSlot(const ASTNode* varNode) const
+{
+    auto slotIt = mSlots.find(varNode);
+    assert(slotIt != mSlots.end());
+    return slotIt->second;
+}
+
+void CoroutineProgram::Resolve(const ASTNode* node, std::unordered_map<const ASTNode*, size_t>* localSlots, size_t& slotCount)
+{
+    switch (node->GetKind())
+    {
+    case ASTNode::NodeKind::VAR_DECL:
+    {
+        // A local variable gets its slot when it is declared, it can't be used before that
+        size_t slot;
+        if (localSlots != nullptr)
+        {
+            (*localSlots)[node] = slotCount;
+            mSlots[node] = CoroutineSlot{ SlotKind::LOCAL, slotCount++ };
+        }
+        else if (GlobalStore::GetCurrent().TryGetSlot(node, slot))
+            mSlots[node] = CoroutineSlot{ SlotKind::GLOBAL, slot };
+        else
+            mIsSupported = false;
+        break;
+    }
+    case ASTNode::NodeKind::IDENTIFIER_EXPR:
+    {
+        const ASTNode* varDecl = mSymTable->GetVarDecl(node);
+        size_t slot;
+        if ((localSlots != nullptr) && (localSlots->count(varDecl) != 0))
+            mSlots[node] = CoroutineSlot{ SlotKind::LOCAL, localSlots->at(varDecl) };
+        else if (GlobalStore::GetCurrent().TryGetSlot(varDecl, slot))
+            mSlots[node] = CoroutineSlot{ SlotKind::GLOBAL, slot };
+        else
+            mIsSupported = false;
+        break;
+    }
+    case ASTNode::NodeKind::CALL_EXPR:
+    {
+        const ASTNode* fnDecl = mSymTable->GetFunctionDecl(node);
+        const IntrinsicID intrinsic = Intrinsics::GetInstance().GetID(fnDecl);
+        auto fnIt = mFunctions.find(fnDecl);
+        if (intrinsic != IntrinsicID::NONE)
+            mCallTargets[node] = CoroutineCallTarget{ nullptr, intrinsic };
+        else if (fnIt != mFunctions.end())
+            mCallTargets[node] = CoroutineCallTarget{ fnIt->second.get(), IntrinsicID::NONE };
+        else
+            mIsSupported = false;
+        break;
+    }
+    case ASTNode::NodeKind::SPAWN_EXPR:
+        // The built-in functions don't run on threads of their own
+        if (Intrinsics::GetInstance().GetID(mSymTable->GetFunctionDecl(static_cast<const SpawnExpr*>(node)->GetCall())) != IntrinsicID::NONE)
+            mIsSupported = false;
+        break;
+    case ASTNode::NodeKind::BINARY_EXPR:
+    {
+        const BinaryOpExpr* bExpr = static_cast<const BinaryOpExpr*>(node);
+        if ((bExpr->GetOperation() == Operation::ASSIGNMENT) && (bExpr->GetLHS()->GetKind() != ASTNode::NodeKind::IDENTIFIER_EXPR))
+            mIsSupported = false;
+        break;
+    }
+    case ASTNode::NodeKind::ARRAY_EXPR:
+        if (node->GetChildrenNodes().empty())
+            mIsSupported = false;
+        break;
+    default:
+        break;
+    }
+
+    for (const auto& child : node->GetChildrenNodes())
+        Resolve(child.get(), localSlots, slotCount);
+}
+
+void CoroutineProgram::FindYieldingFunctions()
+{
+    std::unordered_map<CoroutineFunction*, std::vector<const CoroutineFunction*>> fnCallees;
+    for (auto& fnIt : mFunctions)
+        fnIt.second->mayYield = FindYieldPoints(fnIt.second->fnDecl->GetBody(), fnCallees[fnIt.second.get()]);
+
+    // A function calling a function that can yield can yield as well
+    bool changed = true;
+    while (changed)
+    {
+        changed = false;
+        for (const auto& fnCallee : fnCallees)
+        {
+            if (fnCallee.first->mayYield)
+                continue;
+
+            const auto& callees = fnCallee.second;
+            if (std::any_of(callees.begin(), callees.end(), [](const CoroutineFunction* callee) { return callee->mayYield; }))
+            {
+                fnCallee.first->mayYield = true;
+                changed = true;
+            }
+        }
+    }
+
+    mYieldingNodes.clear();
+    for (const auto& decl : mRoot->GetChildrenNodes())
+        MarkYieldingNodes(decl.get());
+}
+
+bool CoroutineProgram::FindYieldPoints(const ASTNode* node, std::vector<const CoroutineFunction*>& callees) const
+{
+    switch (node->GetKind())
+    {
+    case ASTNode::NodeKind::JOIN_STMT:
+    case ASTNode::NodeKind::SLEEP_STMT:
+    case ASTNode::NodeKind::SYNC_STMT:
+        return true;
+    case ASTNode::NodeKind::CALL_EXPR:
+        if (const CoroutineFunction* callee = GetCallTarget(node).fn)
+            callees.push_back(callee);
+        break;
+    case ASTNode::NodeKind::SPAWN_EXPR:
+    {
+        // The spawned function runs on another thread, only the evaluation of its arguments is done by this one
+        bool yields = false;
+        for (const auto& arg : static_cast<const SpawnExpr*>(node)->GetCall()->GetArgs())
+            yields |= FindYieldPoints(arg.get(), callees);
+        return yields;
+    }
+    default:
+        break;
+    }
+
+    bool yields = false;
+    for (const auto& child : node->GetChildrenNodes())
+        yields |= FindYieldPoints(child.get(), callees);
+
+    return yields;
+}
+
+bool CoroutineProgram::MarkYieldingNodes(const ASTNode* node)
+{
+    bool yields = false;
+    switch (node->GetKind())
+    {
+    case ASTNode::NodeKind::JOIN_STMT:
+    case ASTNode::NodeKind::SLEEP_STMT:
+    case ASTNode::NodeKind::SYNC_STMT:
+        yields = true;
+        break;
+    case ASTNode::NodeKind::CALL_EXPR:
+    {
+        const CoroutineFunction* callee = GetCallTarget(node).fn;
+        yields = (callee != nullptr) && callee->mayYield;
+        break;
+    }
+    default:
+        break;
+    }
+
+    const ASTNode* parent = (node->GetKind() == ASTNode::NodeKind::SPAWN_EXPR) ? static_cast<const SpawnExpr*>(node)->GetCall() : node;
+    for (const auto& child : parent->GetChildrenNodes())
+        yields |= MarkYieldingNodes(child.get());
+
+    if (yields)
+        mYieldingNodes.insert(node);
+
+    return yields;
+}
+
+////////// Coroutine Executor //////////
+
+CoroutineExecutor::CoroutineExecutor(const CoroutineProgram* program)
+    : mProgram{ program }, mFunction{ nullptr }, mArgs{}, mHasStarted{ false }, mTask{}, mResumePoint{}, mStepsLeft{ 0 }, mOverdueSteps{ 0 },
+      mResult{ InterpretedValue::CreateVoidValue() } { }
+
+CoroutineExecutor::CoroutineExecutor(const CoroutineFunction* fn, std::vector<InterpretedValue>&& args)
+    : mProgram{ fn->program }, mFunction{ fn }, mArgs{ std::move(args) }, mHasStarted{ false }, mTask{}, mResumePoint{}, mStepsLeft{ 0 }, mOverdueSteps{ 0 },
+      mResult{ InterpretedValue::CreateVoidValue() } { }
+
+void CoroutineExecutor::Reset(const CoroutineFunction* fn, std::vector<InterpretedValue>&& args)
+{
+    assert(HasFinished());
+
+    mProgram = fn->program;
+    mFunction = fn;
+    mArgs = std::move(args);
+    mHasStarted = false;
+    mResult = InterpretedValue::CreateVoidValue();
+
+    // Still moving forward, a state cached for the previous function must not pass for the new one's
+    ++mVersion;
+}
+
+size_t CoroutineExecutor::Execute(size_t quantum)
+{
+    assert(quantum > 0);
+    assert(!HasFinished());
+
+    // The coroutines are only created now, they keep a pointer to the executor which doesn't move anymore
+    if (!mHasStarted)
+    {
+        mTask = (mFunction != nullptr) ? RunFunctionAsync(mFunction, std::move(mArgs)) : RunMain(mProgram);
+        mResumePoint = mTask.GetHandle();
+        mHasStarted = true;
+    }
+
+    mStepsLeft = quantum;
+    std::exchange(mResumePoint, nullptr).resume();
+    ++mVersion;
+
+    // The frames go back to the host thread that ran the thread last rather than waiting for the executor to be reused
+    if (mTask.IsDone())
+    {
+        // A coroutine that threw ended all those awaiting it, the exception is raised again for the thread to handle
+        const std::exception_ptr error = mTask.GetException();
+        if (!error)
+            mResult = mTask.GetValue();
+        mTask = Task<InterpretedValue>{};
+
+        if (error)
+        {
+            mOverdueSteps = 0;
+            std::rethrow_exception(error);
+        }
+    }
+
+    // The plain statements run once the quantum was used up and not reported to the thread yet
+    return quantum - mStepsLeft + std::exchange(mOverdueSteps, 0);
+}
+
+////////// Coroutines //////////
+
+Task<InterpretedValue> CoroutineExecutor::RunMain(const CoroutineProgram* program)
+{
+    // The global scope has no local variable of its own
+    Locals noLocals;
+    InterpretedValue returnValue = InterpretedValue::CreateVoidValue();
+    co_await ExecStmtsAsync(program->GetRoot()->GetChildrenNodes(), noLocals, returnValue);
+
+    if (program->GetMainFunction() == nullptr)
+        co_return returnValue;
+
+    co_return co_await RunFunctionAsync(program->GetMainFunction(), Locals{});
+}
+
+Task<InterpretedValue> CoroutineExecutor::RunFunctionAsync(const CoroutineFunction* fn, Locals locals)
+{
+    assert(locals.size() == fn->paramCount);
+    locals.resize(fn->slotCount);
+
+    InterpretedValue returnValue = InterpretedValue::CreateVoidValue();
+    co_await ExecStmtsAsync(fn->fnDecl->GetBody()->GetStatements(), locals, returnValue);
+    co_return returnValue;
+}
+
+Task<bool> CoroutineExecutor::ExecStmtsAsync(const Stmts& stmts, Locals& locals, InterpretedValue& returnValue)
+{
+    for (const auto& stmtNode : stmts)
+    {
+        const ASTNode* stmt = stmtNode.get();
+
+        // The global scope also holds the function declarations, which aren't statements,
+        // and the empty declarations left behind by its comments
+        if ((stmt->GetKind() == ASTNode::NodeKind::FUNCTION_DECL) || (stmt->GetKind() == ASTNode::NodeKind::ERROR))
+            continue;
+
+        co_await Step();
+
+        switch (stmt->GetKind())
+        {
+        case ASTNode::NodeKind::COMPOUND_STMT:
+            if (co_await ExecStmtsAsync(stmt->GetChildrenNodes(), locals, returnValue))
+                co_return true;
+            break;
+        case ASTNode::NodeKind::IF_STMT:
+        {
+            const IfStmt* iStmt = static_cast<const IfStmt*>(stmt);
+            InterpretedValue cond;
+            if (mProgram->MayYield(iStmt->GetCondExpr()))
+                cond = co_await EvalAsync(iStmt->GetCondExpr(), locals);
+            else
+                cond = Eval(iStmt->GetCondExpr(), locals);
+
+            if (cond.GetBoolVal())
+            {
+                if (co_await ExecStmtsAsync(iStmt->GetBody()->GetStatements(), locals, returnValue))
+                    co_return true;
+            }
+            break;
+        }
+        case ASTNode::NodeKind::WHILE_STMT:
+        {
+            // Every check of the condition is a step, a loop with an empty body can still be preempted
+            const WhileStmt* wStmt = static_cast<const WhileStmt*>(stmt);
+            for (;;)
+            {
+                InterpretedValue cond;
+                if (mProgram->MayYield(wStmt->GetCondExpr()))
+                    cond = co_await EvalAsync(wStmt->GetCondExpr(), locals);
+                else
+                    cond = Eval(wStmt->GetCondExpr(), locals);
+
+                if (!cond.GetBoolVal())
+                    break;
+
+                if (co_await ExecStmtsAsync(wStmt->GetBody()->GetStatements(), locals, returnValue))
+                    co_return true;
+
+                co_await Step();
+            }
+            break;
+        }
+        case ASTNode::NodeKind::SLEEP_STMT:
+        {
+            const Expr* countExpr = static_cast<const SleepStmt*>(stmt)->GetCountExpr();
+            InterpretedValue count;
+            if (mProgram->MayYield(countExpr))
+                count = co_await EvalAsync(countExpr, locals);
+            else
+                count = Eval(countExpr, locals);
+
+            Threading::CurrentThreadSleepFor(count.GetIntVal());
+            co_await Suspend();
+            break;
+        }
+        case ASTNode::NodeKind::SYNC_STMT:
+            Threading::CurrentThreadSync();
+            co_await Suspend();
+            break;
+        case ASTNode::NodeKind::JOIN_STMT:
+        {
+            const Expr* handleExpr = static_cast<const JoinStmt*>(stmt)->GetHandleExpr();
+            InterpretedValue handle;
+            if (mProgram->MayYield(handleExpr))
+                handle = co_await EvalAsync(handleExpr, locals);
+            else
+                handle = Eval(handleExpr, locals);
+
+            Threading::CurrentThreadJoin(handle.GetIntVal());
+            co_await Suspend();
+            break;
+        }
+        default:
+        {
+            if (!mProgram->MayYield(stmt))
+            {
+                if (ExecStmt(stmt, locals, returnValue))
+                    co_return true;
+                break;
+            }
+
+            // The expression of the statement is what can yield, the rest is done once it is evaluated
+            const ASTNode* expr = stmt;
+            if (stmt->GetKind() == ASTNode::NodeKind::VAR_DECL)
+                expr = static_cast<const VarDecl*>(stmt)->GetInitExpr();
+            else if (stmt->GetKind() == ASTNode::NodeKind::PRINT_STMT)
+                expr = static_cast<const PrintStmt*>(stmt)->GetMessage();
+            else if (stmt->GetKind() == ASTNode::NodeKind::RETURN_STMT)
+                expr = static_cast<const ReturnStmt*>(stmt)->GetReturnExpr();
+
+            const InterpretedValue value = co_await EvalAsync(expr, locals);
+
+            if (stmt->GetKind() == ASTNode::NodeKind::VAR_DECL)
+                Store(stmt, value, locals);
+            else if (stmt->GetKind() == ASTNode::NodeKind::PRINT_STMT)
+                CurrentThreadOutput().PrintLine(value);
+            else if (stmt->GetKind() == ASTNode::NodeKind::RETURN_STMT)
+            {
+                returnValue = value;
+                co_return true;
+            }
+            break;
+        }
+        }
+    }
+
+    co_return false;
+}
+
+Task<InterpretedValue> CoroutineExecutor::EvalAsync(const ASTNode* expr, Locals& locals)
+{
+    assert(mProgram->MayYield(expr));
+
+    switch (expr->GetKind())
+    {
+    case ASTNode::NodeKind::ARRAY_EXPR:
+    {
+        Locals elems;
+        for (const auto& elem : expr->GetChildrenNodes())
+        {
+            if (mProgram->MayYield(elem.get()))
+                elems.push_back(co_await EvalAsync(elem.get(), locals));
+            else
+                elems.push_back(Eval(elem.get(), locals));
+        }
+
+        co_return MakeArray(elems);
+    }
+    case ASTNode::NodeKind::BINARY_EXPR:
+    {
+        const BinaryOpExpr* bExpr = static_cast<const BinaryOpExpr*>(expr);
+        if (bExpr->GetOperation() == Operation::ASSIGNMENT)
+        {
+            // Only identifiers are assigned to, the value is what yields
+            const InterpretedValue value = co_await EvalAsync(bExpr->GetRHS(), locals);
+            Store(bExpr->GetLHS(), value, locals);
+            co_return value;
+        }
+
+        InterpretedValue lhs;
+        if (mProgram->MayYield(bExpr->GetLHS()))
+            lhs = co_await EvalAsync(bExpr->GetLHS(), locals);
+        else
+            lhs = Eval(bExpr->GetLHS(), locals);
+
+        InterpretedValue rhs;
+        if (mProgram->MayYield(bExpr->GetRHS()))
+            rhs = co_await EvalAsync(bExpr->GetRHS(), locals);
+        else
+            rhs = Eval(bExpr->GetRHS(), locals);
+
+        co_return EvaluateBinaryOp(bExpr->GetOperation(), lhs, rhs);
+    }
+    case ASTNode::NodeKind::CALL_EXPR:
+    {
+        Locals args;
+        if (MayArgsYield(expr))
+            args = co_await EvalArgsAsync(expr, locals);
+        else
+            args = EvalArgs(expr, locals);
+
+        // The callee might not yield itself, only its arguments
+        const CoroutineCallTarget& target = mProgram->GetCallTarget(expr);
+        if ((target.fn != nullptr) && target.fn->mayYield)
+            co_return co_await RunFunctionAsync(target.fn, std::move(args));
+
+        co_return Call(expr, std::move(args));
+    }
+    case ASTNode::NodeKind::INDEX_EXPR:
+    {
+        const IndexedExpr* iExpr = static_cast<const IndexedExpr*>(expr);
+        InterpretedValue array;
+        if (mProgram->MayYield(iExpr->GetIdentifier()))
+            array = co_await EvalAsync(iExpr->GetIdentifier(), locals);
+        else
+            array = Eval(iExpr->GetIdentifier(), locals);
+
+        InterpretedValue index;
+        if (mProgram->MayYield(iExpr->GetIndex()))
+            index = co_await EvalAsync(iExpr->GetIndex(), locals);
+        else
+            index = Eval(iExpr->GetIndex(), locals);
+
+        // TODO: bounds checking
+        co_return array[index.GetIntVal()];
+    }
+    case ASTNode::NodeKind::SPAWN_EXPR:
+    {
+        // Only the arguments can yield, the spawned function runs on its own thread
+        Locals args = co_await EvalArgsAsync(static_cast<const SpawnExpr*>(expr)->GetCall(), locals);
+        co_return Spawn(expr, std::move(args));
+    }
+    default:
+        assert(false);  // Nothing else contains a call
+        co_return InterpretedValue{};
+    }
+}
+
+Task<CoroutineExecutor::Locals> CoroutineExecutor::EvalArgsAsync(const ASTNode* callExpr, Locals& locals)
+{
+    Locals args;
+    for (const auto& arg : callExpr->GetChildrenNodes())
+    {
+        if (mProgram->MayYield(arg.get()))
+            args.push_back(co_await EvalAsync(arg.get(), locals));
+        else
+            args.push_back(Eval(arg.get(), locals));
+    }
+
+    co_return args;
+}
+
+bool CoroutineExecutor::MayArgsYield(const ASTNode* callExpr) const
+{
+    const auto& args = callExpr->GetChildrenNodes();
+    return std::any_of(args.begin(), args.end(), [this](const std::unique_ptr<ASTNode>& arg) { return mProgram->MayYield(arg.get()); });
+}
+
+////////// Plain Functions //////////
+
+void CoroutineExecutor::ChargePlainStep()
+{
+    // A plain statement can't suspend. Past the end of the quantum, it is still reported to the thread,
+    // in batches, which stops it once its process used up its steps.
+    if (mStepsLeft != 0)
+    {
+        --mStepsLeft;
+    }
+    else if (++mOverdueSteps == OVERDUE_STEP_BATCH)
+    {
+        mOverdueSteps = 0;
+        Threading::CurrentThreadCountSteps(OVERDUE_STEP_BATCH);
+    }
+}
+
+InterpretedValue CoroutineExecutor::RunFunction(const CoroutineFunction* fn, Locals&& locals)
+{
+    assert(!fn->mayYield);
+    assert(locals.size() == fn->paramCount);
+    locals.resize(fn->slotCount);
+
+    InterpretedValue returnValue = InterpretedValue::CreateVoidValue();
+    ExecStmts(fn->fnDecl->GetBody()->GetStatements(), locals, returnValue);
+    return returnValue;
+}
+
+bool CoroutineExecutor::ExecStmts(const Stmts& stmts, Locals& locals, InterpretedValue& returnValue)
+{
+    for (const auto& stmt : stmts)
+    {
+        ChargePlainStep();
+        if (ExecStmt(stmt.get(), locals, returnValue))
+            return true;
+    }
+
+    return false;
+}
+
+bool CoroutineExecutor::ExecStmt(const ASTNode* stmt, Locals& locals, InterpretedValue& returnValue)
+{
+    switch (stmt->GetKind())
+    {
+    case ASTNode::NodeKind::COMPOUND_STMT:
+        return ExecStmts(stmt->GetChildrenNodes(), locals, returnValue);
+    case ASTNode::NodeKind::VAR_DECL:
+    {
+        const VarDecl* vDecl = static_cast<const VarDecl*>(stmt);
+        Store(vDecl, (vDecl->GetInitExpr() != nullptr) ? Eval(vDecl->GetInitExpr(), locals) : GetDefaultValue(vDecl), locals);
+        return false;
+    }
+    case ASTNode::NodeKind::IF_STMT:
+    {
+        const IfStmt* iStmt = static_cast<const IfStmt*>(stmt);
+        return Eval(iStmt->GetCondExpr(), locals).GetBoolVal() && ExecStmts(iStmt->GetBody()->GetStatements(), locals, returnValue);
+    }
+    case ASTNode::NodeKind::WHILE_STMT:
+    {
+        const WhileStmt* wStmt = static_cast<const WhileStmt*>(stmt);
+        while (Eval(wStmt->GetCondExpr(), locals).GetBoolVal())
+        {
+            if (ExecStmts(wStmt->GetBody()->GetStatements(), locals, returnValue))
+                return true;
+
+            ChargePlainStep();
+        }
+        return false;
+    }
+    case ASTNode::NodeKind::PRINT_STMT:
+    {
+        const PrintStmt* pStmt = static_cast<const PrintStmt*>(stmt);
+        if (pStmt->GetMessage() != nullptr)
+            CurrentThreadOutput().PrintLine(Eval(pStmt->GetMessage(), locals));
+        else
+            CurrentThreadOutput().PrintLine();
+        return false;
+    }
+    case ASTNode::NodeKind::RETURN_STMT:
+    {
+        const Expr* rExpr = static_cast<const ReturnStmt*>(stmt)->GetReturnExpr();
+        returnValue = (rExpr != nullptr) ? Eval(rExpr, locals) : InterpretedValue::CreateVoidValue();
+        return true;
+    }
+    case ASTNode::NodeKind::SCAN_STMT:
+        Scan(stmt, locals);
+        return false;
+    case ASTNode::NodeKind::JOIN_STMT:
+    case ASTNode::NodeKind::SLEEP_STMT:
+    case ASTNode::NodeKind::SYNC_STMT:
+        assert(false);  // Always yields, only the coroutines handle it
+        return false;
+    default:
+        // Calls, assignments and spawns are evaluated for their effects
+        Eval(stmt, locals);
+        return false;
+    }
+}
+
+InterpretedValue CoroutineExecutor::Eval(const ASTNode* expr, Locals& locals)
+{
+    switch (expr->GetKind())
+    {
+    case ASTNode::NodeKind::ARRAY_EXPR:
+    {
+        Locals elems;
+        for (const auto& elem : expr->GetChildrenNodes())
+            elems.push_back(Eval(elem.get(), locals));
+
+        return MakeArray(elems);
+    }
+    case ASTNode::NodeKind::BINARY_EXPR:
+    {
+        const BinaryOpExpr* bExpr = static_cast<const BinaryOpExpr*>(expr);
+        if (bExpr->GetOperation() == Operation::ASSIGNMENT)
+        {
+            // A global variable combined with an operand is read and written back under its lock
+            GlobalStore& globals = GlobalStore::GetCurrent();
+            const GlobalStore::GlobalUpdate* update = globals.FindUpdate(bExpr);
+            if (update != nullptr)
+            {
+                const InterpretedValue operand = Eval(update->operand, locals);
+                return globals.Update(update->slot, [update, &operand](const InterpretedValue& varVal)
+                {
+                    return update->isVarLHS ? EvaluateBinaryOp(update->op, varVal, operand) : EvaluateBinaryOp(update->op, operand, varVal);
+                });
+            }
+
+            const InterpretedValue value = Eval(bExpr->GetRHS(), locals);
+            Store(bExpr->GetLHS(), value, locals);
+            return value;
+        }
+
+        const InterpretedValue lhs = Eval(bExpr->GetLHS(), locals);
+        return EvaluateBinaryOp(bExpr->GetOperation(), lhs, Eval(bExpr->GetRHS(), locals));
+    }
+    case ASTNode::NodeKind::BOOLEAN_EXPR:
+        return InterpretedValue{ static_cast<const BooleanExpr*>(expr)->GetValue() };
+    case ASTNode::NodeKind::CALL_EXPR:
+        return Call(expr, EvalArgs(expr, locals));
+    case ASTNode::NodeKind::IDENTIFIER_EXPR:
+        return Load(expr, locals);
+    case ASTNode::NodeKind::INDEX_EXPR:
+    {
+        const IndexedExpr* iExpr = static_cast<const IndexedExpr*>(expr);
+        const InterpretedValue array = Eval(iExpr->GetIdentifier(), locals);
+
+        // Indexing checks the bounds, an index outside of the array throws std::out_of_range and ends the thread
+        return array[Eval(iExpr->GetIndex(), locals).GetIntVal()];
+    }
+    case ASTNode::NodeKind::NUMBER_EXPR:
+        return InterpretedValue{ static_cast<const NumberExpr*>(expr)->GetValue() };
+    case ASTNode::NodeKind::SPAWN_EXPR:
+        return Spawn(expr, EvalArgs(static_cast<const SpawnExpr*>(expr)->GetCall(), locals));
+    case ASTNode::NodeKind::STRING_EXPR:
+        return InterpretedValue{ StringPool::GetInstance().GetLiteral(expr) };
+    default:
+        assert(false);  // What is this expression?
+        return {};
+    }
+}
+
+CoroutineExecutor::Locals CoroutineExecutor::EvalArgs(const ASTNode* callExpr, Locals& locals)
+{
+    Locals args;
+    args.reserve(callExpr->GetChildrenNodes().size());
+    for (const auto& arg : callExpr->GetChildrenNodes())
+        args.push_back(Eval(arg.get(), locals));
+
+    return args;
+}
+
+InterpretedValue CoroutineExecutor::Call(const ASTNode* callExpr, Locals&& args)
+{
+    // The built-in functions never yield and run natively
+    const CoroutineCallTarget& target = mProgram->GetCallTarget(callExpr);
+    if (target.intrinsic != IntrinsicID::NONE)
+        return CallIntrinsic(target.intrinsic, args);
+
+    return RunFunction(target.fn, std::move(args));
+}
+
+InterpretedValue CoroutineExecutor::Spawn(const ASTNode* spawnExpr, Locals&& args)
+{
+    // The new thread shares the global variables of the current one through the global store
+    const CoroutineCallTarget& target = mProgram->GetCallTarget(static_cast<const SpawnExpr*>(spawnExpr)->GetCall());
+    return InterpretedValue{ Threading::CreateThread(target.fn, std::move(args)) };
+}
+
+InterpretedValue CoroutineExecutor::Load(const ASTNode* varNode, const Locals& locals) const
+{
+    const CoroutineSlot& slot = mProgram->GetSlot(varNode);
+    return (slot.kind == SlotKind::LOCAL) ? locals[slot.index] : GlobalStore::GetCurrent().Load(slot.index);
+}
+
+void CoroutineExecutor::Store(const ASTNode* varNode, const InterpretedValue& value, Locals& locals) const
+{
+    const CoroutineSlot& slot = mProgram->GetSlot(varNode);
+    if (slot.kind == SlotKind::LOCAL)
+        locals[slot.index] = value;
+    else
+        GlobalStore::GetCurrent().Store(slot.index, value);
+}
+
+void CoroutineExecutor::Scan(const ASTNode* scanStmt, Locals& locals) const
+{
+    // A prompt printed before the scan must show up before the program waits for its input
+    CurrentThreadOutput().Flush();
+
+    // The value read takes the type of the variable it goes into
+    const IdentifierExpr* input = static_cast<const ScanStmt*>(scanStmt)->GetInput();
+    InterpretedValue value = Load(input, locals);
+    switch (value.GetType())
+    {
+    case InterpretedValue::ValueType::BOOLEAN:
+    {
+        bool val;
+        InputBuffer::GetInstance().ReadBool(val);
+        value = InterpretedValue{ val };
+        break;
+    }
+    case InterpretedValue::ValueType::INTEGER:
+    {
+        int val;
+        InputBuffer::GetInstance().ReadInt(val);
+        value = InterpretedValue{ val };
+        break;
+    }
+    default:
+    {
+        std::string val;
+        InputBuffer::GetInstance().ReadString(val);
+        value = InterpretedValue{ val };
+        break;
+    }
+    }
+
+    Store(input, value, locals);
+}
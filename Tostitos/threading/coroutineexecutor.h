@@ -0,0 +1,224 @@
+#ifndef COROUTINE_EXECUTOR_H__TOSTITOS
+#define COROUTINE_EXECUTOR_H__TOSTITOS
+
+#include "closurecompiler.h"
+#include "coroutinetask.h"
+#include "interpretedvalue.h"
+
+#include "../../TosLang/Sema/intrinsics.h"
+
+#include <cstddef>
+#include <memory>
+#include <unordered_map>
+#include <unordered_set>
+#include <vector>
+
+namespace TosLang
+{
+    namespace FrontEnd
+    {
+        class ASTNode;
+        class FunctionDecl;
+        class SymbolTable;
+    }
+}
+
+namespace Threading
+{
+    namespace impl
+    {
+        class CoroutineProgram;
+
+        /*
+        * \struct CoroutineFunction
+        * \brief  Function of a program run by the coroutine executor
+        */
+        struct CoroutineFunction
+        {
+            const CoroutineProgram* program;                /*!< Program the function belongs to */
+            const TosLang::FrontEnd::FunctionDecl* fnDecl;  /*!< Function declaration */
+            size_t paramCount;                              /*!< Number of parameters, which take the first slots */
+            size_t slotCount;                               /*!< Number of slots needed for the parameters and local variables */
+            bool mayYield;                                  /*!< Can the function give the processor back to the kernel (sleep, sync)? */
+        };
+
+        /*
+        * \struct CoroutineCallTarget
+        * \brief  What a call expression calls
+        */
+        struct CoroutineCallTarget
+        {
+            const CoroutineFunction* fn;            /*!< Function called, nullptr for a built-in function */
+            TosLang::FrontEnd::IntrinsicID intrinsic;
+        };
+
+        /*
+        * \struct CoroutineSlot
+        * \brief  Where a variable lives
+        */
+        struct CoroutineSlot
+        {
+            SlotKind kind;
+            size_t index;
+        };
+
+        /*
+        * \class CoroutineProgram
+        * \brief TosLang program prepared for the coroutine executor. Everything the executor would otherwise look up
+        *        in the symbol table is resolved ahead of time: variables to slots (the same ones the closure tier
+        *        uses), calls to their target. The nodes that can make the running thread yield are marked as well,
+        *        everything else is evaluated by plain recursive functions without ever creating a coroutine.
+        */
+        class CoroutineProgram
+        {
+        public:
+            /*
+            * \fn           Build
+            * \brief        Prepares a program. The current global store must be the program's, reset beforehand.
+            * \param root   Root of the program's AST
+            * \param symTab Symbol table of the program
+            * \return       Prepared program, or nullptr if the program uses constructs the executor doesn't handle
+            */
+            static std::unique_ptr<CoroutineProgram> Build(const TosLang::FrontEnd::ASTNode* root, const TosLang::FrontEnd::SymbolTable* symTab);
+
+        public:
+            const TosLang::FrontEnd::ASTNode* GetRoot() const { return mRoot; }
+            const CoroutineFunction* GetMainFunction() const { return mMainFunction; }
+            const CoroutineCallTarget& GetCallTarget(const TosLang::FrontEnd::ASTNode* callExpr) const;
+            const CoroutineSlot& GetSlot(const TosLang::FrontEnd::ASTNode* varNode) const;  // Of a variable declaration or identifier
+            bool MayYield(const TosLang::FrontEnd::ASTNode* node) const { return mYieldingNodes.count(node) != 0; }
+
+        private:
+            void Resolve(const TosLang::FrontEnd::ASTNode* node, std::unordered_map<const TosLang::FrontEnd::ASTNode*, size_t>* localSlots, size_t& slotCount);
+            void FindYieldingFunctions();
+            bool FindYieldPoints(const TosLang::FrontEnd::ASTNode* node, std::vector<const CoroutineFunction*>& callees) const;
+            bool MarkYieldingNodes(const TosLang::FrontEnd::ASTNode* node);
+
+        private:
+            const TosLang::FrontEnd::ASTNode* mRoot;
+            const TosLang::FrontEnd::SymbolTable* mSymTable;
+            bool mIsSupported;                                                              /*!< Was every construct seen so far handled? */
+            std::unordered_map<const TosLang::FrontEnd::ASTNode*, std::unique_ptr<CoroutineFunction>> mFunctions;
+            const CoroutineFunction* mMainFunction;
+            std::unordered_map<const TosLang::FrontEnd::ASTNode*, CoroutineCallTarget> mCallTargets;
+            std::unordered_map<const TosLang::FrontEnd::ASTNode*, CoroutineSlot> mSlots;
+            std::unordered_set<const TosLang::FrontEnd::ASTNode*> mYieldingNodes;          /*!< Nodes containing a sleep, a sync or a call that can yield */
+        };
+
+        /*
+        * \class CoroutineExecutor
+        * \brief Execution agent running a program as C++ coroutines. The program is evaluated by straight-line
+        *        recursive code, the compiler keeps the state of a suspended thread in the coroutine frames. Only the
+        *        functions that can yield run as coroutines, and a thread only suspends at a sleep, at a sync or when
+        *        its quantum is used up. Everything else, non-yielding functions included, runs as plain calls.
+        *
+        *        The coroutines hold a pointer to their executor, which can then only be moved until it first runs.
+        *        Their frames can't be saved either: threads run by this executor can't be checkpointed.
+        */
+        class CoroutineExecutor
+        {
+        public:
+            /*
+            * \fn           CoroutineExecutor
+            * \brief        Prepares the main thread of a program: the global scope is run, then the main function
+            * \param program Prepared program
+            */
+            explicit CoroutineExecutor(const CoroutineProgram* program);
+
+            /*
+            * \fn           CoroutineExecutor
+            * \brief        Prepares a spawned thread
+            * \param fn     Function run by the thread
+            * \param args   Values of the function's arguments
+            */
+            CoroutineExecutor(const CoroutineFunction* fn, std::vector<InterpretedValue>&& args);
+
+            CoroutineExecutor(CoroutineExecutor&& exec) = default;
+
+            /*
+            * \fn           Reset
+            * \brief        Prepares the executor of a finished thread to run another function
+            * \param fn     Function run by the thread
+            * \param args   Values of the function's arguments
+            */
+            void Reset(const CoroutineFunction* fn, std::vector<InterpretedValue>&& args);
+
+        public:
+            /*
+            * \fn           Execute
+            * \brief        Runs the thread until it suspends: its quantum is used up, it sleeps, syncs or is done
+            * \param quantum    Number of statements the thread can run, at least 1
+            * \return       Number of statements run. The functions that can't yield can't be suspended either,
+            *               what they run past the end of the quantum is counted as well.
+            */
+            size_t Execute(size_t quantum);
+
+            bool HasFinished() const { return mHasStarted && !mTask.IsValid(); }
+
+            // Changes every time the state of the executor does
+            size_t GetVersion() const { return mVersion; }
+
+            // Value returned by the function the thread was spawned for, once it has returned
+            const InterpretedValue& GetResult() const { return mResult; }
+
+        private:
+            using Locals = std::vector<InterpretedValue>;
+            using Stmts = std::vector<std::unique_ptr<TosLang::FrontEnd::ASTNode>>;
+
+            /*
+            * \struct SuspendAwaiter
+            * \brief  Suspends the running coroutine, Execute then returns. With a budget, only once the quantum is used up.
+            */
+            struct SuspendAwaiter
+            {
+                bool await_ready() const noexcept { return isStep && (exec->mStepsLeft != 0); }
+                void await_suspend(std::coroutine_handle<> handle) noexcept { exec->mResumePoint = handle; }
+                void await_resume() const noexcept { if (isStep) --exec->mStepsLeft; }
+
+                CoroutineExecutor* exec;
+                bool isStep;    /*!< Is the suspension only there to end the quantum? */
+            };
+
+        private:    // Coroutines, for what can yield
+            Task<InterpretedValue> RunMain(const CoroutineProgram* program);
+            Task<InterpretedValue> RunFunctionAsync(const CoroutineFunction* fn, Locals locals);
+            Task<bool> ExecStmtsAsync(const Stmts& stmts, Locals& locals, InterpretedValue& returnValue);
+            Task<InterpretedValue> EvalAsync(const TosLang::FrontEnd::ASTNode* expr, Locals& locals);
+            Task<Locals> EvalArgsAsync(const TosLang::FrontEnd::ASTNode* callExpr, Locals& locals);
+            bool MayArgsYield(const TosLang::FrontEnd::ASTNode* callExpr) const;
+
+            SuspendAwaiter Step() { return SuspendAwaiter{ this, true }; }
+            SuspendAwaiter Suspend() { return SuspendAwaiter{ this, false }; }
+
+        private:    // Plain functions, for everything else
+            void ChargePlainStep();     // Counts a statement against the quantum, or the process quota once it is used up
+            InterpretedValue RunFunction(const CoroutineFunction* fn, Locals&& locals);
+            bool ExecStmts(const Stmts& stmts, Locals& locals, InterpretedValue& returnValue);
+            bool ExecStmt(const TosLang::FrontEnd::ASTNode* stmt, Locals& locals, InterpretedValue& returnValue);
+            InterpretedValue Eval(const TosLang::FrontEnd::ASTNode* expr, Locals& locals);
+            Locals EvalArgs(const TosLang::FrontEnd::ASTNode* callExpr, Locals& locals);
+
+            InterpretedValue Call(const TosLang::FrontEnd::ASTNode* callExpr, Locals&& args);
+            InterpretedValue Spawn(const TosLang::FrontEnd::ASTNode* spawnExpr, Locals&& args);   // Returns the handle of the new thread
+            InterpretedValue Load(const TosLang::FrontEnd::ASTNode* varNode, const Locals& locals) const;
+            void Store(const TosLang::FrontEnd::ASTNode* varNode, const InterpretedValue& value, Locals& locals) const;
+            void Scan(const TosLang::FrontEnd::ASTNode* scanStmt, Locals& locals) const;
+
+        private:
+            static const size_t OVERDUE_STEP_BATCH = 64;   // Plain statements run past the quantum between two reports to the thread
+
+            const CoroutineProgram* mProgram;
+            const CoroutineFunction* mFunction;     /*!< Function the thread was spawned for, nullptr for the main thread */
+            Locals mArgs;                           /*!< Its arguments, until the thread first runs */
+            bool mHasStarted;
+            Task<InterpretedValue> mTask;           /*!< Outermost coroutine of the thread, released once done */
+            std::coroutine_handle<> mResumePoint;   /*!< Innermost suspended coroutine */
+            size_t mStepsLeft;                      /*!< Statements left in the current quantum */
+            size_t mOverdueSteps;                   /*!< Plain statements run past the quantum, not reported to the thread yet */
+            size_t mVersion = 0;                    /*!< Number of turns run */
+            InterpretedValue mResult;               /*!< Value returned by the thread's function */
+        };
+    }   // namespace impl
+}   // namespace Threading
+
+#endif // COROUTINE_EXECUTOR_H__TOSTITOS
@@ -0,0 +1,64 @@
+#include "coroutinetask.h"
+
+#include <new>
+#include <vector>
+
+using namespace Threading::impl;
+
+namespace
+{
+    /*
+    * \struct FreeFrames
+    * \brief  Frames waiting to be reused by a host thread, by size class
+    */
+    struct FreeFrames
+    {
+        ~FreeFrames()
+        {
+            for (auto& frames : bySize)
+            {
+                for (void* frame : frames)
+                    ::operator delete(frame);
+            }
+        }
+
+        std::vector<void*> bySize[CoroutineFrameAllocator::MAX_POOLED_SIZE / CoroutineFrameAllocator::SIZE_CLASS];
+    };
+
+    thread_local FreeFrames CurrentFreeFrames;
+
+    size_t GetSizeClass(size_t size)
+    {
+        return (size + CoroutineFrameAllocator::SIZE_CLASS - 1) / CoroutineFrameAllocator::SIZE_CLASS - 1;
+    }
+}
+
+void* CoroutineFrameAllocator::Allocate(size_t size)
+{
+    if (size > MAX_POOLED_SIZE)
+        return ::operator new(size);
+
+    const size_t sizeClass = GetSizeClass(size);
+    std::vector<void*>& frames = CurrentFreeFrames.bySize[sizeClass];
+    if (frames.empty())
+        return ::operator new((sizeClass + 1) * SIZE_CLASS);
+
+    void* frame = frames.back();
+    frames.pop_back();
+    return frame;
+}
+
+void CoroutineFrameAllocator::Deallocate(void* frame, size_t size)
+{
+    if (size > MAX_POOLED_SIZE)
+    {
+        ::operator delete(frame);
+        return;
+    }
+
+    std::vector<void*>& frames = CurrentFreeFrames.bySize[GetSizeClass(size)];
+    if (frames.size() < MAX_POOLED_FRAMES)
+        frames.push_back(frame);
+    else
+        ::operator delete(frame);
+}
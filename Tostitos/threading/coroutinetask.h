@@ -0,0 +1,127 @@
+#ifndef COROUTINE_TASK_H__TOSTITOS
+#define COROUTINE_TASK_H__TOSTITOS
+
+#include <coroutine>
+#include <cstddef>
+#include <exception>
+#include <utility>
+
+namespace Threading
+{
+    namespace impl
+    {
+        /*
+        * \class CoroutineFrameAllocator
+        * \brief Allocates the frames of the coroutines run by the coroutine executor. A TosLang thread keeps calling
+        *        the same few functions and entering the same few blocks, so the frames are kept by size once done and
+        *        handed out again instead of going back to the heap. Each host thread has its own frames, a frame
+        *        allocated by one worker and freed by another simply changes hands.
+        */
+        class CoroutineFrameAllocator
+        {
+        public:
+            static void* Allocate(size_t size);
+            static void Deallocate(void* frame, size_t size);
+
+        public:
+            static const size_t SIZE_CLASS = 64;            // Frame sizes are rounded up to a multiple of this
+            static const size_t MAX_POOLED_SIZE = 2048;     // Bigger frames go straight to the heap
+            static const size_t MAX_POOLED_FRAMES = 256;    // Free frames kept per size, per host thread
+        };
+
+        /*
+        * \class Task
+        * \brief Coroutine returning a value to the coroutine awaiting it. A task only starts when it is awaited,
+        *        and once done it resumes its caller directly (symmetric transfer), so a chain of calls suspended
+        *        deep down doesn't hold any native stack: resuming it only resumes its innermost coroutine.
+        */
+        template <typename T>
+        class Task
+        {
+        public:
+            struct promise_type;
+            using Handle = std::coroutine_handle<promise_type>;
+
+            /*
+            * \struct FinalAwaiter
+            * \brief  Gives the processor back to the awaiting coroutine, or to whoever resumed the task if there is none
+            */
+            struct FinalAwaiter
+            {
+                bool await_ready() const noexcept { return false; }
+                std::coroutine_handle<> await_suspend(Handle handle) noexcept
+                {
+                    const std::coroutine_handle<> continuation = handle.promise().continuation;
+                    return continuation ? continuation : std::noop_coroutine();
+                }
+                void await_resume() const noexcept { }
+            };
+
+            struct promise_type
+            {
+                Task get_return_object() { return Task{ Handle::from_promise(*this) }; }
+                std::suspend_always initial_suspend() const noexcept { return {}; }
+                FinalAwaiter final_suspend() const noexcept { return {}; }
+                void return_value(T val) { value = std::move(val); }
+                void unhandled_exception() { exception = std::current_exception(); }
+
+                static void* operator new(size_t size) { return CoroutineFrameAllocator::Allocate(size); }
+                static void operator delete(void* frame, size_t size) { CoroutineFrameAllocator::Deallocate(frame, size); }
+
+                T value;                                /*!< Value given by co_return */
+                std::coroutine_handle<> continuation;   /*!< Coroutine awaiting the task */
+                std::exception_ptr exception;           /*!< Exception that ended the task, passed on to the awaiting coroutine */
+            };
+
+        public:
+            Task() : mHandle{ nullptr } { }
+            explicit Task(Handle handle) : mHandle{ handle } { }
+            Task(Task&& task) noexcept : mHandle{ std::exchange(task.mHandle, nullptr) } { }
+            ~Task() { if (mHandle) mHandle.destroy(); }
+
+            Task& operator=(Task&& task) noexcept
+            {
+                if (&task != this)
+                {
+                    if (mHandle)
+                        mHandle.destroy();
+                    mHandle = std::exchange(task.mHandle, nullptr);
+                }
+
+                return *this;
+            }
+
+            Task(const Task&) = delete;
+            void operator=(const Task&) = delete;
+
+        public:
+            bool await_ready() const noexcept { return false; }
+            std::coroutine_handle<> await_suspend(std::coroutine_handle<> caller) noexcept
+            {
+                mHandle.promise().continuation = caller;
+                return mHandle;
+            }
+            T await_resume()
+            {
+                if (mHandle.promise().exception)
+                    std::rethrow_exception(mHandle.promise().exception);
+
+                return std::move(mHandle.promise().value);
+            }
+
+        public:
+            bool IsValid() const { return static_cast<bool>(mHandle); }
+            bool IsDone() const { return mHandle.done(); }
+            std::coroutine_handle<> GetHandle() const { return mHandle; }
+
+            // Only once done
+            const T& GetValue() const { return mHandle.promise().value; }
+            const std::exception_ptr& GetException() const { return mHandle.promise().exception; }
+
+        private:
+            Handle mHandle;
+        };
+    }   // namespace impl
+}   // namespace Threading
+
+#endif // COROUTINE_TASK_H__TOSTITOS
@@ -5,11 +5,20 @@
 #include "../../TosLang/Common/type.h"
 #include "../../TosLang/Sema/symboltable.h"
 
+#include "arraykernels.h"
+#include "checkpoint.h"
+#include "closurecompiler.h"
+#include "globalstore.h"
+#include "inputbuffer.h"
+#include "outputbuffer.h"
+#include "quickenedops.h"
+#include "stringpool.h"
 #include "threadutil.h"
+#include "tierupmanager.h"
 
+#include <algorithm>
 #include <cassert>
 #include <exception>    // TODO: Should we develop our own exception mechanism for Tostitos?
-#include <iostream>     // TODO: Printing to standard IO for now. Should this be redirected to Tostitos later on?
 
 using namespace Threading::impl;
 using namespace TosLang;
@@ -31,26 +40,122 @@ Executor::Executor(const TosLang::FrontEnd::ASTNode* root,
 
 Executor::Executor(const TosLang::FrontEnd::ASTNode* root,
                    const TosLang::FrontEnd::SymbolTable* symTab,
-                   CallStack&& stack,
-                   std::function<void(InterpretedValue)>&& callback)
-    : mSymTable { symTab }, mCallStack{ stack }, mCallback{ callback }
+                   CallStack&& stack)
+    : mSymTable { symTab }, mCallStack{ std::move(stack) }, mResult{ InterpretedValue::CreateVoidValue() }
 {
     mNextNodesToRun.push({});
     mNextNodesToRun.top().push_back(root);
 }
 
+void Executor::Reset(const TosLang::FrontEnd::ASTNode* root,
+                     const TosLang::FrontEnd::SymbolTable* symTab,
+                     CallStack&& stack)
+{
+    // The bottom node queue is emptied rather than replaced so that it keeps its storage
+    while (mNextNodesToRun.size() > 1)
+        mNextNodesToRun.pop();
+
+    if (mNextNodesToRun.empty())
+        mNextNodesToRun.push({});
+
+    mNextNodesToRun.top().clear();
+    mNextNodesToRun.top().push_back(root);
+
+    mSymTable = symTab;
+    mCallStack = std::move(stack);
+    mResult = InterpretedValue::CreateVoidValue();
+
+    // Still moving forward, a state cached for the previous function must not pass for the new one's
+    ++mVersion;
+}
+
 bool Executor::ExecuteOne()
 {
+    // Scopes that ran out of nodes are done
+    while (!mNextNodesToRun.empty() && mNextNodesToRun.top().empty())
+    {
+        // A function whose body ran out of statements returns nothing. The global frame has no function.
+        if ((mCallStack.GetFrameCount() > 1) && (mNextNodesToRun.size() == mCallStack.GetCurrentFrameNodeDepth() + 1))
+            ReturnFromCurrentFrame(InterpretedValue::CreateVoidValue());
+        else
+            mNextNodesToRun.pop();
+    }
+
     if (mNextNodesToRun.empty())
     {
         return false;
     }
 
+    ++mVersion;
     DispatchNode(mNextNodesToRun.top().front());
     return true;
 }
 
+void Executor::Save(CheckpointWriter& writer) const
+{
+    // A stack can only be walked from the top, the node queues are taken out of a copy and written from the bottom up
+    std::stack<std::deque<const ASTNode*>> nodesToRun{ mNextNodesToRun };
+    std::vector<std::deque<const ASTNode*>> queues;
+    for (; !nodesToRun.empty(); nodesToRun.pop())
+        queues.push_back(std::move(nodesToRun.top()));
+
+    writer.WriteUInt(queues.size());
+    for (auto queueIt = queues.rbegin(); queueIt != queues.rend(); ++queueIt)
+    {
+        writer.WriteUInt(queueIt->size());
+        for (const ASTNode* node : *queueIt)
+            writer.WriteNode(node);
+    }
+
+    mCallStack.Save(writer);
+}
+
+void Executor::Load(CheckpointReader& reader, const SymbolTable* symTab)
+{
+    mSymTable = symTab;
+    mResult = InterpretedValue::CreateVoidValue();
+    mNextNodesToRun = {};
+
+    for (uint64_t iQueue = reader.ReadUInt(); (iQueue > 0) && !reader.HasFailed(); --iQueue)
+    {
+        mNextNodesToRun.push({});
+        for (uint64_t iNode = reader.ReadUInt(); (iNode > 0) && !reader.HasFailed(); --iNode)
+            mNextNodesToRun.top().push_back(reader.ReadNode());
+    }
+
+    mCallStack.Load(reader);
+}
+
 ////////// Declarations //////////
+void Executor::HandleProgramDecl(const FrontEnd::ASTNode* node)
+{
+    // Popping the program node
+    mNextNodesToRun.top().pop_front();
+
+    // The program runs its main function, which has no caller to return to
+    const auto& decls = node->GetChildrenNodes();
+    auto mainIt = std::find_if(decls.begin(), decls.end(), [](const std::unique_ptr<ASTNode>& decl)
+    {
+        return (decl->GetKind() == ASTNode::NodeKind::FUNCTION_DECL)
+            && (static_cast<const FunctionDecl*>(decl.get())->GetFunctionName() == "main")
+            && (static_cast<const FunctionDecl*>(decl.get())->GetParametersSize() == 0);
+    });
+    if (mainIt != decls.end())
+    {
+        mCallStack.PushFrame(StackFrame{ nullptr });
+        mNextNodesToRun.top().push_front(mainIt->get());
+    }
+
+    // Whatever lives in the global scope is run, in order, before the main function.
+    // The comments of the global scope leave empty declarations behind, there is nothing to run for them.
+    for (auto declIt = decls.rbegin(); declIt != decls.rend(); ++declIt)
+    {
+        const ASTNode::NodeKind kind = (*declIt)->GetKind();
+        if ((kind != ASTNode::NodeKind::FUNCTION_DECL) && (kind != ASTNode::NodeKind::ERROR))
+            mNextNodesToRun.top().push_front(declIt->get());
+    }
+}
+
 void Executor::HandleFunction(const FrontEnd::ASTNode* node)
 {
     const FunctionDecl* fDecl = dynamic_cast<const FunctionDecl*>(node);
@@ -59,6 +164,9 @@ void Executor::HandleFunction(const FrontEnd::ASTNode* node)
     // Popping the function node
     mNextNodesToRun.top().pop_front();
 
+    // Remember where the caller's nodes are so that a return can unwind every scope opened by the function
+    mCallStack.SetCurrentFrameNodeDepth(mNextNodesToRun.size());
+
     // Fill it up with the content of the compound statement
     HandleCompoundStmt(fDecl->GetBody());
 }
@@ -92,24 +200,12 @@ void Executor::HandleVarDecl(const FrontEnd::ASTNode* node)
             mNextNodesToRun.top().push_front(initExpr);
             return;
         }
+
+        mCallStack.EraseExprValue(initExpr);
     }
     else
     {
-        switch (varSym->GetVariableType())
-        {
-        case Type::BOOL:
-            initVal = InterpretedValue{ false };
-            break;
-        case Type::NUMBER:
-            initVal = InterpretedValue{ 0 };
-            break;
-        case Type::STRING:
-            initVal = InterpretedValue{ "" };
-            break;
-        default:
-            assert(false); // What is this variable?
-            break;
-        }
+        initVal = GetDefaultValue(vDecl);
     }
 
     mCallStack.AddOrUpdateSymbolValue(varSym, initVal, varSym->IsGlobal());
@@ -122,8 +218,11 @@ void Executor::HandleArrayExpr(const FrontEnd::ASTNode* node)
     const ArrayExpr* aExpr = dynamic_cast<const ArrayExpr*>(node);
     assert(aExpr != nullptr);
 
-    // TODO
-    //aExpr->
+    if (!EvaluateExprs(aExpr->GetChildrenNodes()))
+        return;
+
+    mNextNodesToRun.top().pop_front();
+    mCallStack.SetExprValue(aExpr, MakeArray(GetExprValues(aExpr->GetChildrenNodes())), mCallStack.GetCurrentFrameID());
 }
 
 void Executor::HandleBinaryExpr(const FrontEnd::ASTNode* node)
@@ -131,55 +230,75 @@ void Executor::HandleBinaryExpr(const FrontEnd::ASTNode* node)
     const BinaryOpExpr* bExpr = dynamic_cast<const BinaryOpExpr*>(node);
     assert(bExpr != nullptr);
     
+    // The left hand side of an assignment is only where the value goes, it isn't evaluated
+    const bool isAssignment = bExpr->GetOperation() == Operation::ASSIGNMENT;
+
+    // A global variable combined with an operand is read and written back under its lock, once it has a value.
+    // Only the operand is evaluated beforehand.
+    GlobalStore& globals = GlobalStore::GetCurrent();
+    const GlobalStore::GlobalUpdate* update = isAssignment ? globals.FindUpdate(bExpr) : nullptr;
+    if ((update != nullptr) && (globals.Load(update->slot).GetType() != InterpretedValue::ValueType::UNKNOWN))
+    {
+        InterpretedValue operand;
+        if (!mCallStack.TryGetExprValue(update->operand, operand))
+        {
+            mNextNodesToRun.top().push_front(update->operand);
+            return;
+        }
+
+        mCallStack.EraseExprValue(update->operand);
+        const InterpretedValue binValue = globals.Update(update->slot, [update, &operand](const InterpretedValue& varVal)
+        {
+            return update->isVarLHS ? EvaluateBinaryOp(update->op, varVal, operand) : EvaluateBinaryOp(update->op, operand, varVal);
+        });
+
+        mNextNodesToRun.top().pop_front();
+        mCallStack.SetExprValue(bExpr, binValue, mCallStack.GetCurrentFrameID());
+        return;
+    }
+
     InterpretedValue lhsval;
-    if (!mCallStack.TryGetExprValue(bExpr->GetLHS(), lhsval))
+    if (!isAssignment && !mCallStack.TryGetExprValue(bExpr->GetLHS(), lhsval))
     {
         mNextNodesToRun.top().push_front(bExpr->GetLHS());
         return;
     }
 
     InterpretedValue rhsval;
-    if (!mCallStack.TryGetExprValue(bExpr->GetRHS(), lhsval))
+    if (!mCallStack.TryGetExprValue(bExpr->GetRHS(), rhsval))
     {
         mNextNodesToRun.top().push_front(bExpr->GetRHS());
         return;
     }
 
-    // Both values must be usable at this point, if not, then there's a serious runtime error
-    if (!lhsval.IsReady() || !rhsval.IsReady())
-    {
-        mNextNodesToRun.pop();
-        return;
-    }
+    // The operands are used up, the next evaluation of the expression (in a loop for example) computes them again
+    mCallStack.EraseExprValue(bExpr->GetLHS());
+    mCallStack.EraseExprValue(bExpr->GetRHS());
     
-    // Since type checking has been performed beforehand, we can assume that 
-    // a certain operation only works with a certain type
     InterpretedValue binValue;
-    switch (bExpr->GetOperation())
-    {
-    case Operation::ASSIGNMENT:
+    if (isAssignment)
     {
         // Fetch the identifier symbol
-        const Symbol* identSym = GetSymbol(bExpr->GetLHS());;
+        const Symbol* identSym = GetSymbol(bExpr->GetLHS());
 
         mCallStack.AddOrUpdateSymbolValue(identSym, rhsval, identSym->IsGlobal());
+        binValue = rhsval;
     }
-    case Operation::AND_BOOL:       binValue = InterpretedValue{ lhsval.GetBoolVal() && rhsval.GetBoolVal() }; break;
-    case Operation::AND_INT:        binValue = InterpretedValue{ lhsval.GetIntVal() & rhsval.GetIntVal() }; break;
-    case Operation::DIVIDE:         binValue = InterpretedValue{ lhsval.GetIntVal() / rhsval.GetIntVal() }; break;
-    case Operation::EQUAL:          binValue = InterpretedValue{ lhsval.GetIntVal() == rhsval.GetIntVal() }; break;
-    case Operation::GREATER_THAN:   binValue = InterpretedValue{ lhsval.GetIntVal() > rhsval.GetIntVal() }; break;
-    case Operation::LEFT_SHIFT:     binValue = InterpretedValue{ lhsval.GetIntVal() << rhsval.GetIntVal() }; break;
-    case Operation::LESS_THAN:      binValue = InterpretedValue{ lhsval.GetIntVal() < rhsval.GetIntVal() }; break;
-    case Operation::MINUS:          binValue = InterpretedValue{ lhsval.GetIntVal() - rhsval.GetIntVal() }; break;
-    case Operation::MODULO:         binValue = InterpretedValue{ lhsval.GetIntVal() % rhsval.GetIntVal() }; break;
-    case Operation::MULT:           binValue = InterpretedValue{ lhsval.GetIntVal() && rhsval.GetIntVal() }; break;
-    //TODO: case Operation::NOT:    binValue = InterpretedValue{ lhsval.GetBoolVal() && rhsval.GetBoolVal() }; break;
-    case Operation::OR_BOOL:        binValue = InterpretedValue{ lhsval.GetBoolVal() || rhsval.GetBoolVal() }; break;
-    case Operation::OR_INT:         binValue = InterpretedValue{ lhsval.GetIntVal() | rhsval.GetIntVal() }; break;
-    case Operation::PLUS:           binValue = InterpretedValue{ lhsval.GetIntVal() + rhsval.GetIntVal() }; break;
-    case Operation::RIGHT_SHIFT:    binValue = InterpretedValue{ lhsval.GetIntVal() >> rhsval.GetIntVal() }; break;
-    default:                        binValue = {}; break;
+    else
+    {
+        // Once an expression has been evaluated, it goes straight to the handler specialized for its operation 
+        // and operand types. If the operands ever stop matching, it falls back on the generic evaluation.
+        QuickenedOps& quickenedOps = QuickenedOps::GetInstance();
+        const QuickenedBinaryOp* quickOp = quickenedOps.Find(bExpr);
+        if ((quickOp != nullptr) && quickOp->Guard(lhsval, rhsval))
+        {
+            binValue = quickOp->handler(lhsval, rhsval);
+        }
+        else
+        {
+            binValue = EvaluateBinaryOp(bExpr->GetOperation(), lhsval, rhsval);
+            quickenedOps.Quicken(bExpr, lhsval, rhsval);
+        }
     }
 
     mNextNodesToRun.top().pop_front();
@@ -202,41 +321,61 @@ void Executor::HandleCallExpr(const FrontEnd::ASTNode* node)
     const CallExpr* cExpr = dynamic_cast<const CallExpr*>(node);
     assert(cExpr != nullptr);
 
-    const auto& args = cExpr->GetArgs();
-    if (!args.empty())
+    InterpretedValue callValue;
+    if (mCallStack.TryGetExprValue(cExpr, callValue))
     {
-        InterpretedValue argValue;
+        // The callee returned. Its value was put in our frame when it did.
+        mNextNodesToRun.top().pop_front();
+        return;
+    }
 
-        if (!mCallStack.TryGetExprValue(args.front().get(), argValue))
-        {
-            for (const auto& arg : args)
-                mNextNodesToRun.top().push_front(arg.get());
+    if (!EvaluateExprs(cExpr->GetArgs()))
+        return;
 
-            return;
-        }
-        else
-        {
-            // Pushing a new frame on the call stack for the function call we're about to make
-            mCallStack.PushFrame(PrepareNewFrame(cExpr));
-        }
-    }
+    const CallTarget& target = CallSiteCache::GetInstance().GetTarget(cExpr, mSymTable);
+    const FunctionDecl* fDecl = target.fnDecl;
 
-    InterpretedValue callValue;
-    if (!mCallStack.TryGetExprValue(cExpr, callValue))
+    const CallArgs callVals = GetArgValues(cExpr);
+
+    // A built-in function runs natively over its whole arguments, in a single step
+    if (target.intrinsic != IntrinsicID::NONE)
     {
-        const ASTNode* fnNode = mSymTable->GetFunctionDecl(cExpr);
-        const FunctionDecl* fDecl = dynamic_cast<const FunctionDecl*>(fnNode);
-        assert(fDecl != nullptr);
+        mNextNodesToRun.top().pop_front();
+        mCallStack.SetExprValue(cExpr, CallIntrinsic(target.intrinsic, callVals), mCallStack.GetCurrentFrameID());
+        return;
+    }
 
-        // Setting up the function for execution
+    // A pure function called with the same arguments will return the same value, no need to run it again
+    FunctionCache& fnCache = FunctionCache::GetInstance();
+    const bool isMemoized = fnCache.IsMemoized(fDecl);
+    if (isMemoized && fnCache.TryGetResult(fDecl, callVals, callValue))
+    {
         mNextNodesToRun.top().pop_front();
-        mNextNodesToRun.top().push_front(fDecl);
+        mCallStack.SetExprValue(cExpr, callValue, mCallStack.GetCurrentFrameID());
+        return;
     }
-    else
+
+    // A hot function that was compiled runs to completion, there's no need for a new frame
+    if (TierUpManager::GetInstance().TryCallCompiled(fDecl, callVals, callValue))
     {
-        mCallStack.SetExprValue(cExpr, mCallStack.GetReturnValue(), mCallStack.GetCurrentFrameID());
+        if (isMemoized)
+            fnCache.AddResult(fDecl, callVals, callValue);
+
         mNextNodesToRun.top().pop_front();
+        mCallStack.SetExprValue(cExpr, callValue, mCallStack.GetCurrentFrameID());
+        return;
     }
+
+    // Pushing a new frame on the call stack for the function call we're about to make. 
+    // The call node is left in place so that it can pick up the return value.
+    StackFrame frame = PrepareNewFrame(cExpr, target, callVals);
+    if (isMemoized)
+        frame.AddPendingResult({ fDecl, callVals });
+
+    mCallStack.PushFrame(std::move(frame));
+
+    // Setting up the function for execution
+    mNextNodesToRun.top().push_front(fDecl);
 }
 
 void Executor::HandleIdentifierExpr(const FrontEnd::ASTNode* node)
@@ -256,6 +395,7 @@ void Executor::HandleIdentifierExpr(const FrontEnd::ASTNode* node)
         return;
     }
 
+    mNextNodesToRun.top().pop_front();
     mCallStack.SetExprValue(node, identVal, mCallStack.GetCurrentFrameID());
 }
 
@@ -266,24 +406,28 @@ void Executor::HandleIndexedExpr(const FrontEnd::ASTNode* node)
 
     // Get the index value
     InterpretedValue idxValue;
-    if(mCallStack.TryGetExprValue(iExpr->GetIndex(), idxValue))
+    if (!mCallStack.TryGetExprValue(iExpr->GetIndex(), idxValue))
     {
         mNextNodesToRun.top().push_front(iExpr->GetIndex());
         return;
     }
     
-    const int idx = idxValue.GetIntVal();;
+    const int idx = idxValue.GetIntVal();
 
     // Get the array to index
     InterpretedValue arrayValue;
-    if (mCallStack.TryGetExprValue(iExpr->GetIdentifier(), arrayValue))
+    if (!mCallStack.TryGetExprValue(iExpr->GetIdentifier(), arrayValue))
     {
         mNextNodesToRun.top().push_front(iExpr->GetIdentifier());
         return;
     }
 
-    // We might have a runtime error if the index value doesn't fit in [0, array length[
-    // TODO: bounds checking
+    mCallStack.EraseExprValue(iExpr->GetIndex());
+    mCallStack.EraseExprValue(iExpr->GetIdentifier());
+
+    // We might have a runtime error if the index value doesn't fit in [0, array length[.
+    // Indexing then throws std::out_of_range, which ends the thread.
+    mNextNodesToRun.top().pop_front();
     mCallStack.SetExprValue(iExpr, arrayValue[idx], mCallStack.GetCurrentFrameID());
 }
 
@@ -301,21 +445,26 @@ void Executor::HandleSpawnExpr(const FrontEnd::ASTNode* node)
     const SpawnExpr* sExpr = dynamic_cast<const SpawnExpr*>(node);
     assert(sExpr != nullptr);
 
+    if (!EvaluateExprs(sExpr->GetCall()->GetArgs()))
+        return;
+
     // The call stack for a thread will contain two things:
-    // 1- The global frame
+    // 1- A global frame of its own. The global variables are shared through the global store, nothing is copied.
     // 2- The frame of the function being called
     CallStack stack;
-    stack.PushFrame(mCallStack.GetGlobalFrame());
-    stack.PushFrame(PrepareNewFrame(sExpr->GetCall()));
+    stack.PushFrame({});
 
-    // We need to find the function that is being called
-    const ASTNode* fnNode = mSymTable->GetFunctionDecl(sExpr->GetCall());
-    const FunctionDecl* fDecl = dynamic_cast<const FunctionDecl*>(fnNode);
-    assert(fDecl != nullptr);
+    // The spawned function is the root of the new thread. It has no caller to return to, its value goes through its join handle.
+    const CallTarget& target = CallSiteCache::GetInstance().GetTarget(sExpr->GetCall(), mSymTable);
+    StackFrame threadFrame = PrepareNewFrame(sExpr->GetCall(), target, GetArgValues(sExpr->GetCall()));
+    threadFrame.SetCaller(nullptr);
+    stack.PushFrame(std::move(threadFrame));
 
-    const size_t currentFrameID = mCallStack.GetCurrentFrameID();
+    const int handle = CreateThread(target.fnDecl, mSymTable, std::move(stack));
 
-    CreateThread(fDecl, mSymTable, [this, node, currentFrameID](const InterpretedValue& value) { mCallStack.SetExprValue(node, value, currentFrameID); });
+    // The spawning thread goes on right away, with the handle of the new thread to join it later
+    mCallStack.SetExprValue(sExpr, InterpretedValue{ handle }, mCallStack.GetCurrentFrameID());
+    mNextNodesToRun.top().pop_front();
 }
 
 void Executor::HandleStringExpr(const FrontEnd::ASTNode* node)
@@ -323,7 +472,7 @@ void Executor::HandleStringExpr(const FrontEnd::ASTNode* node)
     const StringExpr* sExpr = dynamic_cast<const StringExpr*>(node);
     assert(sExpr != nullptr);
 
-    mCallStack.SetExprValue(sExpr, InterpretedValue{ sExpr->GetName() }, mCallStack.GetCurrentFrameID());
+    mCallStack.SetExprValue(sExpr, InterpretedValue{ StringPool::GetInstance().GetLiteral(sExpr) }, mCallStack.GetCurrentFrameID());
     mNextNodesToRun.top().pop_front();
 }
 
@@ -336,8 +485,13 @@ void Executor::HandleCompoundStmt(const FrontEnd::ASTNode* node)
     // New queue for the new scope
     mNextNodesToRun.push({});
 
+    // The value of an expression used as a statement (a call, an assignment) is never used. It is thrown
+    // away before the statement runs again, otherwise the statement would look like it already ran.
     for (const auto& stmt : cStmt->GetStatements())
+    {
+        mCallStack.EraseExprValue(stmt.get());
         mNextNodesToRun.top().push_back(stmt.get());
+    }
 }
 
 void Executor::HandleIfStmt(const FrontEnd::ASTNode* node)
@@ -348,14 +502,13 @@ void Executor::HandleIfStmt(const FrontEnd::ASTNode* node)
     const Expr* condExpr = iStmt->GetCondExpr();
 
     InterpretedValue condValue;
-    assert(mCallStack.TryGetExprValue(condExpr, condValue));
-
-    if (!condValue.IsReady())
+    if (!mCallStack.TryGetExprValue(condExpr, condValue))
     {
-        mNextNodesToRun.pop();
+        mNextNodesToRun.top().push_front(condExpr);
         return;
     }
 
+    mCallStack.EraseExprValue(condExpr);
     mNextNodesToRun.top().pop_front();
 
     if (condValue.GetBoolVal())
@@ -371,24 +524,19 @@ void Executor::HandlePrintStmt(const FrontEnd::ASTNode* node)
     if (msgExpr != nullptr)
     {
         InterpretedValue printValue;
-        if (mCallStack.TryGetExprValue(msgExpr, printValue))
+        if (!mCallStack.TryGetExprValue(msgExpr, printValue))
         {
             mNextNodesToRun.top().push_front(msgExpr);
             return;
         }
 
-        if (!printValue.IsReady())
-        {
-            mNextNodesToRun.pop();
-            return;
-        }
-
-        std::cout << printValue << std::endl;
+        mCallStack.EraseExprValue(msgExpr);
+        CurrentThreadOutput().PrintLine(printValue);
     }
     else
     {
         // Printing a newline
-        std::cout << std::endl;
+        CurrentThreadOutput().PrintLine();
     }
 
     mNextNodesToRun.top().pop_front();
@@ -401,28 +549,30 @@ void Executor::HandleReturnStmt(const FrontEnd::ASTNode* node)
 
     // There might be a return value
     const Expr* rExpr = rStmt->GetReturnExpr();
-    InterpretedValue returnValue;
-    if (!mCallStack.TryGetExprValue(rExpr, returnValue))
+    InterpretedValue returnValue = InterpretedValue::CreateVoidValue();
+    if (rExpr != nullptr)
     {
-        returnValue = InterpretedValue::CreateVoidValue();
-    }
+        // Returning the result of a call means that nothing in the current frame will be needed 
+        // once the callee is entered. The callee can then take over the current frame.
+        if (rExpr->GetKind() == ASTNode::NodeKind::CALL_EXPR)
+        {
+            const CallExpr* cExpr = static_cast<const CallExpr*>(rExpr);
+            if (EvaluateExprs(cExpr->GetArgs()))
+                HandleTailCall(cExpr);
 
-    // If we can, we place the return value in the caller's stack frame.
-    // We can't do this when returning from the main function, since no function can call it.
-    mCallStack.ExitCurrentFrame();
-    if (!mCallStack.Empty() && rExpr != nullptr)
-        mCallStack.SetReturnValue(returnValue);
+            return;
+        }
 
-    if (mCallback)
-    {
-        mCallback(mCallStack.GetReturnValue());
-    }
+        if (!mCallStack.TryGetExprValue(rExpr, returnValue))
+        {
+            mNextNodesToRun.top().push_front(rExpr);
+            return;
+        }
 
-    // Popping the return node
-    mNextNodesToRun.top().pop_front();
+        mCallStack.EraseExprValue(rExpr);
+    }
 
-    // Popping the function node
-    mNextNodesToRun.top().pop_front();
+    ReturnFromCurrentFrame(returnValue);
 }
 
 void Executor::HandleScanStmt(const FrontEnd::ASTNode* node)
@@ -430,7 +580,56 @@ void Executor::HandleScanStmt(const FrontEnd::ASTNode* node)
     const ScanStmt* sStmt = dynamic_cast<const ScanStmt*>(node);
     assert(sStmt != nullptr);
 
-    // TODO
+    // A prompt printed before the scan must show up before the program waits for its input
+    CurrentThreadOutput().Flush();
+
+    // The value read takes the type of the variable it goes into
+    const Symbol* inputSym = GetSymbol(sStmt->GetInput());
+    InterpretedValue inputValue;
+    switch (inputSym->GetVariableType())
+    {
+    case Type::BOOL:
+    {
+        bool val;
+        InputBuffer::GetInstance().ReadBool(val);
+        inputValue = InterpretedValue{ val };
+        break;
+    }
+    case Type::NUMBER:
+    {
+        int val;
+        InputBuffer::GetInstance().ReadInt(val);
+        inputValue = InterpretedValue{ val };
+        break;
+    }
+    default:
+    {
+        std::string val;
+        InputBuffer::GetInstance().ReadString(val);
+        inputValue = InterpretedValue{ val };
+        break;
+    }
+    }
+
+    mCallStack.AddOrUpdateSymbolValue(inputSym, inputValue, inputSym->IsGlobal());
+    mNextNodesToRun.top().pop_front();
+}
+
+void Executor::HandleJoinStmt(const FrontEnd::ASTNode* node)
+{
+    const JoinStmt* jStmt = dynamic_cast<const JoinStmt*>(node);
+    assert(jStmt != nullptr);
+
+    InterpretedValue handleValue;
+    if (!mCallStack.TryGetExprValue(jStmt->GetHandleExpr(), handleValue))
+    {
+        mNextNodesToRun.top().push_front(jStmt->GetHandleExpr());
+        return;
+    }
+
+    mCallStack.EraseExprValue(jStmt->GetHandleExpr());
+    CurrentThreadJoin(handleValue.GetIntVal());
+    mNextNodesToRun.top().pop_front();
 }
 
 void Executor::HandleSleepStmt(const FrontEnd::ASTNode* node)
@@ -439,14 +638,13 @@ void Executor::HandleSleepStmt(const FrontEnd::ASTNode* node)
     assert(sStmt != nullptr);
 
     InterpretedValue sleepValue;
-    assert(mCallStack.TryGetExprValue(sStmt->GetCountExpr(), sleepValue));
-
-    if (!sleepValue.IsReady())
+    if (!mCallStack.TryGetExprValue(sStmt->GetCountExpr(), sleepValue))
     {
-        mNextNodesToRun.pop();
+        mNextNodesToRun.top().push_front(sStmt->GetCountExpr());
         return;
     }
 
+    mCallStack.EraseExprValue(sStmt->GetCountExpr());
     CurrentThreadSleepFor(sleepValue.GetIntVal());
     mNextNodesToRun.top().pop_front();
 }
@@ -472,8 +670,11 @@ void Executor::HandleWhileStmt(const FrontEnd::ASTNode* node)
         return;
     }
 
+    mCallStack.EraseExprValue(wStmt->GetCondExpr());
     if (condValue.GetBoolVal())
     {
+        TierUpManager::GetInstance().RecordBackEdge(wStmt);
+
         // Push the condition node
         mNextNodesToRun.top().push_front(wStmt->GetCondExpr());
 
@@ -493,25 +694,71 @@ void Executor::DispatchNode(const ASTNode* node)
 
     switch (node->GetKind())
     {
-    case ASTNode::NodeKind::BINARY_EXPR:        HandleBinaryExpr(node);
-    case ASTNode::NodeKind::BOOLEAN_EXPR:       HandleBooleanExpr(node);
-    case ASTNode::NodeKind::CALL_EXPR:          HandleCallExpr(node);
-    case ASTNode::NodeKind::COMPOUND_STMT:      HandleCompoundStmt(node);
-    case ASTNode::NodeKind::FUNCTION_DECL:      HandleFunction(node);
-    case ASTNode::NodeKind::IDENTIFIER_EXPR:    HandleIdentifierExpr(node);
-    case ASTNode::NodeKind::IF_STMT:            HandleIfStmt(node);
-    case ASTNode::NodeKind::NUMBER_EXPR:        HandleNumberExpr(node);
-    case ASTNode::NodeKind::PRINT_STMT:         HandlePrintStmt(node);
-    case ASTNode::NodeKind::RETURN_STMT:        HandleReturnStmt(node);
-    case ASTNode::NodeKind::SCAN_STMT:          HandleScanStmt(node);
-    case ASTNode::NodeKind::STRING_EXPR:        HandleStringExpr(node);
-    case ASTNode::NodeKind::VAR_DECL:           HandleVarDecl(node);
-    case ASTNode::NodeKind::WHILE_STMT:         HandleWhileStmt(node);
+    case ASTNode::NodeKind::ARRAY_EXPR:         HandleArrayExpr(node);      break;
+    case ASTNode::NodeKind::BINARY_EXPR:        HandleBinaryExpr(node);     break;
+    case ASTNode::NodeKind::BOOLEAN_EXPR:       HandleBooleanExpr(node);    break;
+    case ASTNode::NodeKind::CALL_EXPR:          HandleCallExpr(node);       break;
+    case ASTNode::NodeKind::COMPOUND_STMT:      HandleCompoundStmt(node);   break;
+    case ASTNode::NodeKind::FUNCTION_DECL:      HandleFunction(node);       break;
+    case ASTNode::NodeKind::IDENTIFIER_EXPR:    HandleIdentifierExpr(node); break;
+    case ASTNode::NodeKind::IF_STMT:            HandleIfStmt(node);         break;
+    case ASTNode::NodeKind::JOIN_STMT:          HandleJoinStmt(node);       break;
+    case ASTNode::NodeKind::INDEX_EXPR:         HandleIndexedExpr(node);    break;
+    case ASTNode::NodeKind::NUMBER_EXPR:        HandleNumberExpr(node);     break;
+    case ASTNode::NodeKind::PRINT_STMT:         HandlePrintStmt(node);      break;
+    case ASTNode::NodeKind::PROGRAM_DECL:       HandleProgramDecl(node);    break;
+    case ASTNode::NodeKind::RETURN_STMT:        HandleReturnStmt(node);     break;
+    case ASTNode::NodeKind::SCAN_STMT:          HandleScanStmt(node);       break;
+    case ASTNode::NodeKind::SLEEP_STMT:         HandleSleepStmt(node);      break;
+    case ASTNode::NodeKind::SPAWN_EXPR:         HandleSpawnExpr(node);      break;
+    case ASTNode::NodeKind::STRING_EXPR:        HandleStringExpr(node);     break;
+    case ASTNode::NodeKind::SYNC_STMT:          HandleSyncStmt(node);       break;
+    case ASTNode::NodeKind::VAR_DECL:           HandleVarDecl(node);        break;
+    case ASTNode::NodeKind::WHILE_STMT:         HandleWhileStmt(node);      break;
     default:
         assert(false); // TODO: Log an error instead?
     }
 }
 
+bool Executor::EvaluateExprs(const ChildrenNodes& exprs)
+{
+    if (exprs.empty())
+        return true;
+
+    // The expressions are pushed in order at the front of the queue, which means 
+    // the first one will be the last to be evaluated. If it has a value, they all do.
+    InterpretedValue exprValue;
+    if (mCallStack.TryGetExprValue(exprs.front().get(), exprValue))
+        return true;
+
+    for (const auto& expr : exprs)
+        mNextNodesToRun.top().push_front(expr.get());
+
+    return false;
+}
+
+std::vector<InterpretedValue> Executor::GetExprValues(const ChildrenNodes& exprs)
+{
+    std::vector<InterpretedValue> values;
+    for (const auto& expr : exprs)
+    {
+        InterpretedValue exprVal;
+        const bool exprFound = mCallStack.TryGetExprValue(expr.get(), exprVal);
+        assert(exprFound);
+
+        // The value is used up, the next evaluation of the expression computes it again
+        mCallStack.EraseExprValue(expr.get());
+        values.push_back(exprVal);
+    }
+
+    return values;
+}
+
+CallArgs Executor::GetArgValues(const CallExpr* call)
+{
+    return GetExprValues(call->GetArgs());
+}
+
 const Symbol* Executor::GetSymbol(const ASTNode* node) const
 {
     const Symbol* varSym;
@@ -521,33 +768,91 @@ const Symbol* Executor::GetSymbol(const ASTNode* node) const
     return varSym;
 }
 
-StackFrame Executor::PrepareNewFrame(const TosLang::FrontEnd::CallExpr* call)
+void Executor::HandleTailCall(const CallExpr* call)
 {
-    // Setting the arguments
-    std::vector<InterpretedValue> callVals;
-    for (const auto& arg : call->GetArgs())
+    const CallTarget& target = CallSiteCache::GetInstance().GetTarget(call, mSymTable);
+    const FunctionDecl* fDecl = target.fnDecl;
+
+    const CallArgs callVals = GetArgValues(call);
+
+    if (target.intrinsic != IntrinsicID::NONE)
     {
-        InterpretedValue argVal;
-        assert(mCallStack.TryGetExprValue(arg.get(), argVal));
+        ReturnFromCurrentFrame(CallIntrinsic(target.intrinsic, callVals));
+        return;
+    }
 
-        callVals.push_back(argVal);
+    // On a cache hit, the callee's result is directly the current function's result
+    FunctionCache& fnCache = FunctionCache::GetInstance();
+    const bool isMemoized = fnCache.IsMemoized(fDecl);
+    InterpretedValue cachedValue;
+    if (isMemoized && fnCache.TryGetResult(fDecl, callVals, cachedValue))
+    {
+        ReturnFromCurrentFrame(cachedValue);
+        return;
     }
 
-    // We need to find the function that is being called
-    const ASTNode* fnNode = mSymTable->GetFunctionDecl(call);
-    const FunctionDecl* fDecl = dynamic_cast<const FunctionDecl*>(fnNode);
-    assert(fDecl != nullptr);
+    if (TierUpManager::GetInstance().TryCallCompiled(fDecl, callVals, cachedValue))
+    {
+        if (isMemoized)
+            fnCache.AddResult(fDecl, callVals, cachedValue);
+
+        ReturnFromCurrentFrame(cachedValue);
+        return;
+    }
+
+    // The arguments were evaluated in the current frame, so the new one must be prepared before it goes away
+    StackFrame frame = PrepareNewFrame(call, target, callVals);
+    if (isMemoized)
+        frame.AddPendingResult({ fDecl, callVals });
+
+    mCallStack.ReplaceCurrentFrame(std::move(frame));
+
+    // The callee runs at the same depth as the current function. This way, 
+    // deep tail recursion uses a constant amount of frames and node queues.
+    UnwindCurrentFrameNodes();
+    HandleCompoundStmt(fDecl->GetBody());
+}
 
+StackFrame Executor::PrepareNewFrame(const CallExpr* call, const CallTarget& target, const CallArgs& callVals)
+{
     // Initializing the function's parameters in the new stack frame
-    StackFrame frame;
-    const ParamVarDecls* pVDecls = fDecl->GetParametersDecl();
-    assert(pVDecls->GetParameters().size() == callVals.size());
+    StackFrame frame{ call };
+    assert(target.paramSyms.size() == callVals.size());
     for (size_t iArg = 0; iArg < callVals.size(); ++iArg)
+        frame.AddOrUpdateSymbolValue(target.paramSyms[iArg], callVals[iArg]);
+
+    return frame;
+}
+
+void Executor::ReturnFromCurrentFrame(const InterpretedValue& returnValue)
+{
+    // Popping the return node along with every scope opened by the function
+    UnwindCurrentFrameNodes();
+
+    // The memoized calls that led to this frame now know their result
+    FunctionCache& fnCache = FunctionCache::GetInstance();
+    for (const PendingResult& pending : mCallStack.GetCurrentFramePendingResults())
+        fnCache.AddResult(pending.fnDecl, pending.args, returnValue);
+
+    // If we can, we place the return value in the caller's stack frame.
+    // We can't do this when returning from the main function, since no function can call it.
+    const ASTNode* caller = mCallStack.GetCurrentFrameCaller();
+    mCallStack.ExitCurrentFrame();
+    if (!mCallStack.Empty() && caller != nullptr)
     {
-        const Symbol* argSym = GetSymbol(pVDecls->GetParameters()[iArg].get());
-        frame.AddOrUpdateSymbolValue(argSym, callVals[iArg]);
+        mCallStack.SetReturnValue(returnValue);
+        mCallStack.SetExprValue(caller, returnValue, mCallStack.GetCurrentFrameID());
     }
 
-    return frame;
+    if (caller == nullptr)
+    {
+        mResult = returnValue;
+    }
 }
 
+void Executor::UnwindCurrentFrameNodes()
+{
+    const size_t nodeDepth = mCallStack.GetCurrentFrameNodeDepth();
+    while (mNextNodesToRun.size() > nodeDepth)
+        mNextNodesToRun.pop();
+}
@@ -3,10 +3,11 @@
 
 // TODO: Comments
 
+#include "callsitecache.h"
 #include "callstack.h"
+#include "functioncache.h"
 
 #include <deque>
-#include <functional>
 #include <memory>
 #include <stack>
 #include <vector>
@@ -26,6 +27,8 @@ namespace Threading
 {
     namespace impl
     {
+        class CheckpointReader;
+        class CheckpointWriter;
         class InterpretedValue;
 
         class Executor
@@ -36,13 +39,48 @@ namespace Threading
                      const TosLang::FrontEnd::SymbolTable* symTab);
             Executor(const TosLang::FrontEnd::ASTNode* root,
                      const TosLang::FrontEnd::SymbolTable* symTab,
-                     CallStack&& stack,
-                     std::function<void(InterpretedValue)>&& callback);
+                     CallStack&& stack);
+
+            /*
+            * \fn           Reset
+            * \brief        Prepares the executor of a finished thread to run another function, keeping its storage
+            * \param root   Function run by the thread
+            * \param symTab Symbol table of the program
+            * \param stack  Call stack prepared by the spawning thread
+            */
+            void Reset(const TosLang::FrontEnd::ASTNode* root,
+                       const TosLang::FrontEnd::SymbolTable* symTab,
+                       CallStack&& stack);
 
         public:
             bool ExecuteOne();
 
+            /*
+            * \fn           Save
+            * \brief        Writes the state of the executor: the nodes left to run and the call stack
+            * \param writer Checkpoint being written
+            */
+            void Save(CheckpointWriter& writer) const;
+
+            /*
+            * \fn           Load
+            * \brief        Restores the state written by Save
+            * \param reader Checkpoint being read
+            * \param symTab Symbol table of the program
+            */
+            void Load(CheckpointReader& reader, const TosLang::FrontEnd::SymbolTable* symTab);
+
+            // Changes every time the state of the executor does
+            size_t GetVersion() const { return mVersion; }
+
+            // Value returned by the function the thread was spawned for, once it has returned
+            const InterpretedValue& GetResult() const { return mResult; }
+
+            // Frames on the call stack of the thread, the global frame included
+            size_t GetFrameCount() const { return mCallStack.GetFrameCount(); }
+
         private:  // Declarations
+            void HandleProgramDecl(const TosLang::FrontEnd::ASTNode* node);
             void HandleFunction(const TosLang::FrontEnd::ASTNode* node);
             void HandleVarDecl(const TosLang::FrontEnd::ASTNode* node);
 
@@ -60,6 +98,7 @@ namespace Threading
         private:  // Statements
             void HandleCompoundStmt(const TosLang::FrontEnd::ASTNode* node);
             void HandleIfStmt(const TosLang::FrontEnd::ASTNode* node);
+            void HandleJoinStmt(const TosLang::FrontEnd::ASTNode* node);
             void HandlePrintStmt(const TosLang::FrontEnd::ASTNode* node);
             void HandleReturnStmt(const TosLang::FrontEnd::ASTNode* node);
             void HandleScanStmt(const TosLang::FrontEnd::ASTNode* node);
@@ -69,14 +108,21 @@ namespace Threading
 
         private:
             void DispatchNode(const TosLang::FrontEnd::ASTNode* node);
+            bool EvaluateExprs(const std::vector<std::unique_ptr<TosLang::FrontEnd::ASTNode>>& exprs);  // False if some still have to be evaluated
+            std::vector<InterpretedValue> GetExprValues(const std::vector<std::unique_ptr<TosLang::FrontEnd::ASTNode>>& exprs);
+            CallArgs GetArgValues(const TosLang::FrontEnd::CallExpr* call);
             const TosLang::FrontEnd::Symbol* GetSymbol(const TosLang::FrontEnd::ASTNode* node) const;
-            StackFrame PrepareNewFrame(const TosLang::FrontEnd::CallExpr* call);
+            void HandleTailCall(const TosLang::FrontEnd::CallExpr* call);
+            StackFrame PrepareNewFrame(const TosLang::FrontEnd::CallExpr* call, const CallTarget& target, const CallArgs& callVals);
+            void ReturnFromCurrentFrame(const InterpretedValue& returnValue);
+            void UnwindCurrentFrameNodes();
 
         private:
             std::stack<std::deque<const TosLang::FrontEnd::ASTNode*>> mNextNodesToRun;
             const TosLang::FrontEnd::SymbolTable* mSymTable;
             CallStack mCallStack;
-            std::function<void(InterpretedValue)> mCallback;
+            InterpretedValue mResult;
+            size_t mVersion = 0;
         };
     }   // namespace impl
 }   // namespace Threading
@@ -0,0 +1,132 @@
+#include "functioncache.h"
+
+#include <functional>
+
+using namespace Threading::impl;
+using namespace TosLang::FrontEnd;
+
+// Big enough for the usual recursive functions while keeping a misbehaving program from eating all the memory
+static const size_t DEFAULT_MAX_ENTRIES_PER_FUNCTION = 1024;
+
+FunctionCache::FunctionCache()
+    : mEnabled{ true }, mMaxEntriesPerFunction{ DEFAULT_MAX_ENTRIES_PER_FUNCTION }, mHitCount{ 0 }, mMissCount{ 0 } { }
+
+FunctionCache& FunctionCache::GetInstance()
+{
+    static FunctionCache Instance;
+    return Instance;
+}
+
+void FunctionCache::Reset()
+{
+    mFunctions.clear();
+    mHitCount = 0;
+    mMissCount = 0;
+}
+
+void FunctionCache::RegisterFunction(const ASTNode* fnDecl)
+{
+    mFunctions[fnDecl];
+}
+
+bool FunctionCache::IsMemoized(const ASTNode* fnDecl) const
+{
+    return mEnabled && (mFunctions.find(fnDecl) != mFunctions.end());
+}
+
+bool FunctionCache::TryGetResult(const ASTNode* fnDecl, const CallArgs& args, InterpretedValue& result)
+{
+    auto fnIt = mFunctions.find(fnDecl);
+    if (!mEnabled || (fnIt == mFunctions.end()))
+        return false;
+
+    FunctionResults& fnResults = fnIt->second;
+    auto resIt = fnResults.results.find(args);
+    if (resIt == fnResults.results.end())
+    {
+        ++fnResults.missCount;
+        ++mMissCount;
+        return false;
+    }
+
+    ++fnResults.hitCount;
+    ++mHitCount;
+    result = resIt->second;
+    return true;
+}
+
+void FunctionCache::AddResult(const ASTNode* fnDecl, const CallArgs& args, const InterpretedValue& result)
+{
+    auto fnIt = mFunctions.find(fnDecl);
+    if (!mEnabled || (fnIt == mFunctions.end()) || (mMaxEntriesPerFunction == 0))
+        return;
+
+    FunctionResults& fnResults = fnIt->second;
+    if (!fnResults.results.emplace(args, result).second)
+        return;
+
+    fnResults.insertionOrder.push_back(args);
+    while (fnResults.insertionOrder.size() > mMaxEntriesPerFunction)
+    {
+        fnResults.results.erase(fnResults.insertionOrder.front());
+        fnResults.insertionOrder.pop_front();
+    }
+}
+
+void FunctionCache::SetMaxEntriesPerFunction(size_t maxEntries)
+{
+    mMaxEntriesPerFunction = maxEntries;
+
+    // Shrink the caches that are now too big
+    for (auto& fn : mFunctions)
+    {
+        FunctionResults& fnResults = fn.second;
+        while (fnResults.insertionOrder.size() > mMaxEntriesPerFunction)
+        {
+            fnResults.results.erase(fnResults.insertionOrder.front());
+            fnResults.insertionOrder.pop_front();
+        }
+    }
+}
+
+size_t FunctionCache::GetHitCount(const ASTNode* fnDecl) const
+{
+    auto fnIt = mFunctions.find(fnDecl);
+    return fnIt != mFunctions.end() ? fnIt->second.hitCount : 0;
+}
+
+size_t FunctionCache::GetMissCount(const ASTNode* fnDecl) const
+{
+    auto fnIt = mFunctions.find(fnDecl);
+    return fnIt != mFunctions.end() ? fnIt->second.missCount : 0;
+}
+
+size_t FunctionCache::CallArgsHasher::operator()(const CallArgs& args) const
+{
+    size_t seed = args.size();
+    for (const InterpretedValue& arg : args)
+    {
+        size_t argHash;
+        switch (arg.GetType())
+        {
+        case InterpretedValue::ValueType::BOOLEAN:
+            argHash = std::hash<bool>{}(arg.GetBoolVal());
+            break;
+        case InterpretedValue::ValueType::INTEGER:
+            argHash = std::hash<int>{}(arg.GetIntVal());
+            break;
+        case InterpretedValue::ValueType::STRING:
+            argHash = arg.GetStrVal().Hash();
+            break;
+        default:
+            // Arrays are told apart by the equality check. Hashing all of their elements on every call would cost
+            // about as much as the call itself.
+            argHash = static_cast<size_t>(arg.GetType());
+            break;
+        }
+
+        seed ^= argHash + 0x9e3779b9 + (seed << 6) + (seed >> 2);
+    }
+
+    return seed;
+}
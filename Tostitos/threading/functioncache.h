@@ -0,0 +1,129 @@
+#ifndef FUNCTION_CACHE_H__TOSTITOS
+#define FUNCTION_CACHE_H__TOSTITOS
+
+#include "interpretedvalue.h"
+
+#include <deque>
+#include <unordered_map>
+#include <vector>
+
+namespace TosLang
+{
+    namespace FrontEnd
+    {
+        class ASTNode;
+    }
+}
+
+namespace Threading
+{
+    namespace impl
+    {
+        using CallArgs = std::vector<InterpretedValue>;
+
+        /*
+        * \struct PendingResult
+        * \brief  Call to a memoized function whose result will be known once the function returns
+        */
+        struct PendingResult
+        {
+            const TosLang::FrontEnd::ASTNode* fnDecl;   /*!< Function being called */
+            CallArgs args;                              /*!< Values of the call's arguments */
+        };
+
+        /*
+        * \class FunctionCache
+        * \brief Results of the calls made to pure functions, keyed by the value of their arguments.
+        *        Only the functions registered with the cache (i.e. proven pure by the purity analysis)
+        *        are memoized. Each function gets its own bounded cache in which the oldest result is
+        *        evicted first. The cache is shared without any synchronization: only the AST walker uses it,
+        *        and the kernel never runs the walker on its worker pool (see Kernel::PrepareWorkers), so all
+        *        threads using the cache run on the same host thread.
+        */
+        class FunctionCache
+        {
+        public:
+            static FunctionCache& GetInstance();
+
+        public:
+            /*
+            * \fn           Reset
+            * \brief        Forgets every registered function along with their results and statistics
+            */
+            void Reset();
+
+            /*
+            * \fn           RegisterFunction
+            * \brief        Allow the results of a function to be cached
+            * \param fnDecl Declaration of a pure function
+            */
+            void RegisterFunction(const TosLang::FrontEnd::ASTNode* fnDecl);
+
+            /*
+            * \fn           IsMemoized
+            * \brief        Indicates if the calls to a function go through the cache
+            * \param fnDecl Function declaration
+            * \return       True if the cache is enabled and the function was registered, else false
+            */
+            bool IsMemoized(const TosLang::FrontEnd::ASTNode* fnDecl) const;
+
+            /*
+            * \fn           TryGetResult
+            * \brief        Looks for the result of a previous call with the same arguments
+            * \param fnDecl Function being called
+            * \param args   Values of the call's arguments
+            * \param result Cached result, if any
+            * \return       True on a cache hit, else false
+            */
+            bool TryGetResult(const TosLang::FrontEnd::ASTNode* fnDecl, const CallArgs& args, InterpretedValue& result);
+
+            /*
+            * \fn           AddResult
+            * \brief        Remembers the result of a call, evicting the oldest one if the function's cache is full
+            * \param fnDecl Function that was called
+            * \param args   Values of the call's arguments
+            * \param result Value returned by the call
+            */
+            void AddResult(const TosLang::FrontEnd::ASTNode* fnDecl, const CallArgs& args, const InterpretedValue& result);
+
+        public:
+            bool IsEnabled() const { return mEnabled; }
+            void SetEnabled(bool enabled) { mEnabled = enabled; }
+            size_t GetMaxEntriesPerFunction() const { return mMaxEntriesPerFunction; }
+            void SetMaxEntriesPerFunction(size_t maxEntries);
+
+            size_t GetHitCount() const { return mHitCount; }
+            size_t GetMissCount() const { return mMissCount; }
+            size_t GetHitCount(const TosLang::FrontEnd::ASTNode* fnDecl) const;
+            size_t GetMissCount(const TosLang::FrontEnd::ASTNode* fnDecl) const;
+
+        private:
+            FunctionCache();
+            FunctionCache(const FunctionCache&) = delete;
+            void operator=(const FunctionCache&) = delete;
+
+        private:
+            struct CallArgsHasher
+            {
+                size_t operator()(const CallArgs& args) const;
+            };
+
+            struct FunctionResults
+            {
+                std::unordered_map<CallArgs, InterpretedValue, CallArgsHasher> results;  /*!< Results keyed by arguments */
+                std::deque<CallArgs> insertionOrder;                                    /*!< Oldest result first */
+                size_t hitCount = 0;
+                size_t missCount = 0;
+            };
+
+        private:
+            bool mEnabled;                  /*!< Opt-out switch. When disabled, every call is executed */
+            size_t mMaxEntriesPerFunction;  /*!< Maximum number of results kept per function */
+            size_t mHitCount;
+            size_t mMissCount;
+            std::unordered_map<const TosLang::FrontEnd::ASTNode*, FunctionResults> mFunctions;
+        };
+    }   // namespace impl
+}   // namespace Threading
+
+#endif // FUNCTION_CACHE_H__TOSTITOS
@@ -0,0 +1,190 @@
+#include "globalstore.h"
+
+#include "checkpoint.h"
+
+#include "../../TosLang/AST/ast.h"
+#include "../../TosLang/AST/expressions.h"
+#include "../../TosLang/Sema/symboltable.h"
+
+#include <cassert>
+#include <tuple>
+#include <utility>
+
+using namespace Threading::impl;
+using namespace TosLang::Common;
+using namespace TosLang::FrontEnd;
+
+namespace
+{
+    // Each host thread runs the threads of one process at a time
+    thread_local GlobalStore* CurrentStore = nullptr;
+}
+
+GlobalStore::GlobalStore() : mSlots{}, mSlotCount{ 0 }, mVersion{ 0 }, mDeclSlots{}, mSymbolSlots{}, mUpdates{} { }
+
+GlobalStore& GlobalStore::GetCurrent()
+{
+    assert(CurrentStore != nullptr);
+    return *CurrentStore;
+}
+
+void GlobalStore::SetCurrent(GlobalStore* store)
+{
+    CurrentStore = store;
+}
+
+void GlobalStore::Reset(const ASTNode* root, const SymbolTable* symTab)
+{
+    mDeclSlots.clear();
+    mSymbolSlots.clear();
+    mUpdates.clear();
+    mSlotCount = 0;
+    mVersion = 0;
+
+    if (root != nullptr)
+    {
+        for (const auto& decl : root->GetChildrenNodes())
+        {
+            if (decl->GetKind() != ASTNode::NodeKind::VAR_DECL)
+                continue;
+
+            const Symbol* varSym;
+            bool symFound;
+            std::tie(symFound, varSym) = symTab->TryGetSymbol(decl.get());
+            if (symFound)
+                mSymbolSlots[varSym] = mSlotCount;
+
+            mDeclSlots[decl.get()] = mSlotCount++;
+        }
+
+        // Every variable has its slot by now, the functions can refer to the variables declared after them
+        FindUpdates(root, symTab);
+    }
+
+    mSlots.reset(new GlobalSlot[mSlotCount]);
+}
+
+bool GlobalStore::TryGetSlot(const ASTNode* varDecl, size_t& slot) const
+{
+    auto slotIt = mDeclSlots.find(varDecl);
+    if (slotIt == mDeclSlots.end())
+        return false;
+
+    slot = slotIt->second;
+    return true;
+}
+
+size_t GlobalStore::GetSlot(const Symbol* sym) const
+{
+    auto slotIt = mSymbolSlots.find(sym);
+    assert(slotIt != mSymbolSlots.end());
+    return slotIt->second;
+}
+
+InterpretedValue GlobalStore::Load(size_t slot) const
+{
+    assert(slot < mSlotCount);
+
+    SlotLock lock{ mSlots[slot] };
+    return mSlots[slot].value;
+}
+
+void GlobalStore::Store(size_t slot, const InterpretedValue& value)
+{
+    assert(slot < mSlotCount);
+
+    // The value is copied before taking the lock, which is then only held for a swap
+    InterpretedValue newValue{ value };
+    {
+        SlotLock lock{ mSlots[slot] };
+        std::swap(mSlots[slot].value, newValue);
+    }
+
+    mVersion.fetch_add(1, std::memory_order_relaxed);
+}
+
+const GlobalStore::GlobalUpdate* GlobalStore::FindUpdate(const ASTNode* assignment) const
+{
+    auto updateIt = mUpdates.find(assignment);
+    return (updateIt != mUpdates.end()) ? &updateIt->second : nullptr;
+}
+
+void GlobalStore::FindUpdates(const ASTNode* node, const SymbolTable* symTab)
+{
+    for (const auto& child : node->GetChildrenNodes())
+        FindUpdates(child.get(), symTab);
+
+    if (node->GetKind() != ASTNode::NodeKind::BINARY_EXPR)
+        return;
+
+    // We're looking for Var = Var op Operand or Var = Operand op Var, Var being a global variable
+    const BinaryOpExpr* assignment = static_cast<const BinaryOpExpr*>(node);
+    if ((assignment->GetOperation() != Operation::ASSIGNMENT)
+        || (assignment->GetLHS()->GetKind() != ASTNode::NodeKind::IDENTIFIER_EXPR)
+        || (assignment->GetRHS()->GetKind() != ASTNode::NodeKind::BINARY_EXPR))
+        return;
+
+    const ASTNode* varDecl = symTab->GetVarDecl(assignment->GetLHS());
+    auto slotIt = mDeclSlots.find(varDecl);
+    if (slotIt == mDeclSlots.end())
+        return;
+
+    const BinaryOpExpr* bExpr = static_cast<const BinaryOpExpr*>(assignment->GetRHS());
+    if (bExpr->GetOperation() == Operation::ASSIGNMENT)
+        return;
+
+    auto isVar = [varDecl, symTab](const Expr* expr)
+    {
+        return (expr->GetKind() == ASTNode::NodeKind::IDENTIFIER_EXPR) && (symTab->GetVarDecl(expr) == varDecl);
+    };
+
+    if (isVar(bExpr->GetLHS()) && IsUpdateOperand(bExpr->GetRHS(), varDecl, symTab))
+        mUpdates[assignment] = GlobalUpdate{ slotIt->second, bExpr->GetOperation(), bExpr->GetRHS(), true };
+    else if (isVar(bExpr->GetRHS()) && IsUpdateOperand(bExpr->GetLHS(), varDecl, symTab))
+        mUpdates[assignment] = GlobalUpdate{ slotIt->second, bExpr->GetOperation(), bExpr->GetLHS(), false };
+}
+
+bool GlobalStore::IsUpdateOperand(const ASTNode* expr, const ASTNode* varDecl, const SymbolTable* symTab) const
+{
+    switch (expr->GetKind())
+    {
+    case ASTNode::NodeKind::BINARY_EXPR:
+        if (static_cast<const BinaryOpExpr*>(expr)->GetOperation() == Operation::ASSIGNMENT)
+            return false;
+        break;
+    case ASTNode::NodeKind::CALL_EXPR:
+    case ASTNode::NodeKind::SPAWN_EXPR:
+        return false;
+    case ASTNode::NodeKind::IDENTIFIER_EXPR:
+        return symTab->GetVarDecl(expr) != varDecl;
+    default:
+        break;
+    }
+
+    for (const auto& child : expr->GetChildrenNodes())
+    {
+        if (!IsUpdateOperand(child.get(), varDecl, symTab))
+            return false;
+    }
+
+    return true;
+}
+
+void GlobalStore::Save(CheckpointWriter& writer) const
+{
+    writer.WriteUInt(mSlotCount);
+    for (size_t iSlot = 0; iSlot < mSlotCount; ++iSlot)
+        writer.WriteValue(Load(iSlot));
+}
+
+void GlobalStore::Load(CheckpointReader& reader)
+{
+    if (reader.ReadUInt() != mSlotCount)
+    {
+        reader.Fail();
+        return;
+    }
+
+    for (size_t iSlot = 0; (iSlot < mSlotCount) && !reader.HasFailed(); ++iSlot)
+        Store(iSlot, reader.ReadValue());
+}
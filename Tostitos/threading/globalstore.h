@@ -0,0 +1,227 @@
+#ifndef GLOBAL_STORE_H__TOSTITOS
+#define GLOBAL_STORE_H__TOSTITOS
+
+#include "interpretedvalue.h"
+
+#include "../../TosLang/Common/opcodes.h"
+
+#include <atomic>
+#include <cassert>
+#include <cstddef>
+#include <memory>
+#include <unordered_map>
+
+namespace TosLang
+{
+    namespace FrontEnd
+    {
+        class ASTNode;
+        class Expr;
+        class Symbol;
+        class SymbolTable;
+    }
+}
+
+namespace Threading
+{
+    namespace impl
+    {
+        class CheckpointReader;
+        class CheckpointWriter;
+
+        /*
+        * \class GlobalStore
+        * \brief Global variables of a process, shared by all of its threads. Each global variable gets
+        *        a slot when the program is loaded, in declaration order. A thread reading or writing a global
+        *        variable then goes straight to its slot, and every thread sees the writes of the others.
+        *        Spawning a thread doesn't copy anything. Each slot has its own spin lock, so accesses to different
+        *        variables never wait on each other and accesses to the same one stay whole even when threads run
+        *        in parallel. Since values are copied in and out of the slots, a lock is only held for a copy.
+        *
+        *        An assignment combining a global variable with a value, e.g. Count = Count + 1, is an update: the
+        *        value is evaluated first, then the variable is read, combined and written back under its lock, so that
+        *        threads updating the same variable in parallel don't lose each other's writes.
+        *
+        *        Each process has its own store. The executors go through the store of the process whose thread
+        *        the calling host thread is running (see GetCurrent), which the scheduler sets along with that thread.
+        */
+        class GlobalStore
+        {
+        public:
+            /*
+            * \struct GlobalUpdate
+            * \brief  Assignment of a binary operation between a global variable and an operand that doesn't read it
+            *         nor calls anything, back to that same variable
+            */
+            struct GlobalUpdate
+            {
+                size_t slot;                                /*!< Slot of the variable */
+                TosLang::Common::Operation op;              /*!< Operation combining the variable with the operand */
+                const TosLang::FrontEnd::Expr* operand;     /*!< Value the variable is combined with */
+                bool isVarLHS;                              /*!< Is the variable the left-hand side of the operation? */
+            };
+
+        public:
+            GlobalStore();
+            GlobalStore(const GlobalStore&) = delete;
+            void operator=(const GlobalStore&) = delete;
+
+        public:
+            // Store of the process being run or loaded by the calling host thread
+            static GlobalStore& GetCurrent();
+            static void SetCurrent(GlobalStore* store);
+
+        public:
+            /*
+            * \fn           Reset
+            * \brief        Assigns a slot to each global variable of a program. The variables have no value yet.
+            * \param root   Root of the program's AST
+            * \param symTab Symbol table of the program
+            */
+            void Reset(const TosLang::FrontEnd::ASTNode* root, const TosLang::FrontEnd::SymbolTable* symTab);
+
+            /*
+            * \fn           TryGetSlot
+            * \brief        Gets the slot of a global variable
+            * \param varDecl    Declaration of the variable
+            * \param slot   Slot of the variable
+            * \return       False if the declaration isn't the one of a global variable
+            */
+            bool TryGetSlot(const TosLang::FrontEnd::ASTNode* varDecl, size_t& slot) const;
+
+            /*
+            * \fn           GetSlot
+            * \brief        Gets the slot of a global variable
+            * \param sym    Symbol of the variable
+            * \return       Slot of the variable
+            */
+            size_t GetSlot(const TosLang::FrontEnd::Symbol* sym) const;
+
+            /*
+            * \fn           Load
+            * \brief        Reads a global variable
+            * \param slot   Slot of the variable
+            * \return       Value of the variable, of UNKNOWN type if it was never written
+            */
+            InterpretedValue Load(size_t slot) const;
+
+            /*
+            * \fn           Store
+            * \brief        Writes a global variable
+            * \param slot   Slot of the variable
+            * \param value  New value of the variable
+            */
+            void Store(size_t slot, const InterpretedValue& value);
+
+            /*
+            * \fn           FindUpdate
+            * \brief        Gets the update made by an assignment
+            * \param assignment    Assignment expression
+            * \return       Null if the assignment isn't the update of a global variable
+            */
+            const GlobalUpdate* FindUpdate(const TosLang::FrontEnd::ASTNode* assignment) const;
+
+            /*
+            * \fn           Update
+            * \brief        Reads, combines and writes back a global variable while holding its lock
+            * \param slot   Slot of the variable
+            * \param combine    Gives the new value of the variable from its current one. Only holds the lock
+            *               for as long as it runs, so it must neither read the store nor yield.
+            * \return       New value of the variable
+            */
+            template <typename Fn>
+            InterpretedValue Update(size_t slot, Fn&& combine)
+            {
+                assert(slot < mSlotCount);
+
+                InterpretedValue newValue;
+                {
+                    SlotLock lock{ mSlots[slot] };
+                    newValue = combine(mSlots[slot].value);
+                    mSlots[slot].value = newValue;
+                }
+
+                mVersion.fetch_add(1, std::memory_order_relaxed);
+                return newValue;
+            }
+
+            /*
+            * \fn           Save
+            * \brief        Writes the value of every global variable
+            * \param writer Checkpoint being written
+            */
+            void Save(CheckpointWriter& writer) const;
+
+            /*
+            * \fn           Load
+            * \brief        Restores the values written by Save
+            * \param reader Checkpoint being read
+            */
+            void Load(CheckpointReader& reader);
+
+        public:
+            size_t GetSize() const { return mSlotCount; }
+
+            // Changes every time a global variable is written
+            size_t GetVersion() const { return mVersion.load(std::memory_order_relaxed); }
+
+        private:
+            /*
+            * \struct GlobalSlot
+            * \brief  Value of a global variable along with the lock protecting it
+            */
+            struct GlobalSlot
+            {
+                mutable std::atomic_flag lock = ATOMIC_FLAG_INIT;
+                InterpretedValue value;
+            };
+
+            /*
+            * \class SlotLock
+            * \brief Holds the lock of a slot for as long as it lives
+            */
+            class SlotLock
+            {
+            public:
+                explicit SlotLock(const GlobalSlot& slot) : mSlot(slot) { while (mSlot.lock.test_and_set(std::memory_order_acquire)) { } }
+                ~SlotLock() { mSlot.lock.clear(std::memory_order_release); }
+
+                SlotLock(const SlotLock&) = delete;
+                void operator=(const SlotLock&) = delete;
+
+            private:
+                const GlobalSlot& mSlot;
+            };
+
+        private:
+            /*
+            * \fn           FindUpdates
+            * \brief        Finds the assignments updating a global variable
+            * \param node   Root of the subtree to look into
+            * \param symTab Symbol table of the program
+            */
+            void FindUpdates(const TosLang::FrontEnd::ASTNode* node, const TosLang::FrontEnd::SymbolTable* symTab);
+
+            /*
+            * \fn           IsUpdateOperand
+            * \brief        Checks that an expression can be evaluated before updating a global variable
+            * \param expr   Expression
+            * \param varDecl    Declaration of the updated variable
+            * \param symTab Symbol table of the program
+            * \return       True if the expression neither reads the variable nor calls or assigns anything
+            */
+            bool IsUpdateOperand(const TosLang::FrontEnd::ASTNode* expr, const TosLang::FrontEnd::ASTNode* varDecl,
+                                 const TosLang::FrontEnd::SymbolTable* symTab) const;
+
+        private:
+            std::unique_ptr<GlobalSlot[]> mSlots;                                       /*!< Value of each global variable */
+            size_t mSlotCount;                                                          /*!< Number of global variables */
+            std::atomic<size_t> mVersion;                                               /*!< Number of writes so far */
+            std::unordered_map<const TosLang::FrontEnd::ASTNode*, size_t> mDeclSlots;  /*!< Slot of each global variable declaration */
+            std::unordered_map<const TosLang::FrontEnd::Symbol*, size_t> mSymbolSlots; /*!< Slot of each global variable symbol */
+            std::unordered_map<const TosLang::FrontEnd::ASTNode*, GlobalUpdate> mUpdates;  /*!< Update made by each assignment updating a global variable */
+        };
+    }   // namespace impl
+}   // namespace Threading
+
+#endif // GLOBAL_STORE_H__TOSTITOS
@@ -0,0 +1,184 @@
+#include "inputbuffer.h"
+
+#include <climits>
+#include <cstring>
+
+#if defined(_MSC_VER)
+#include <io.h>
+#else
+#include <unistd.h>
+#endif
+
+using namespace Threading::impl;
+
+static bool IsTerminal(std::FILE* file)
+{
+#if defined(_MSC_VER)
+    return _isatty(_fileno(file)) != 0;
+#else
+    return isatty(fileno(file)) != 0;
+#endif
+}
+
+static bool IsWhitespace(char c)
+{
+    return (c == ' ') || (c == '\n') || (c == '\t') || (c == '\r') || (c == '\v') || (c == '\f');
+}
+
+InputBuffer::InputBuffer()
+    : mChunk(CHUNK_SIZE), mPos{ 0 }, mEnd{ 0 }, mSource{ stdin }, mOwnsSource{ false }, mIsInteractive{ IsTerminal(stdin) }, mMutex{} { }
+
+InputBuffer::~InputBuffer()
+{
+    CloseFile();
+}
+
+InputBuffer& InputBuffer::GetInstance()
+{
+    static InputBuffer Instance;
+    return Instance;
+}
+
+bool InputBuffer::OpenFile(const std::string& path)
+{
+    std::FILE* file = std::fopen(path.c_str(), "rb");
+    if (file == nullptr)
+        return false;
+
+    std::lock_guard<std::mutex> lock{ mMutex };
+    CloseFile();
+    mSource = file;
+    mOwnsSource = true;
+    mIsInteractive = false;
+    mPos = mEnd = 0;
+    return true;
+}
+
+void InputBuffer::UseStandardInput()
+{
+    std::lock_guard<std::mutex> lock{ mMutex };
+    CloseFile();
+    mSource = stdin;
+    mIsInteractive = IsTerminal(stdin);
+    mPos = mEnd = 0;
+}
+
+bool InputBuffer::ReadInt(int& val)
+{
+    val = 0;
+
+    std::string word;
+    if (!LockedReadWord(word))
+        return false;
+
+    size_t iChar = 0;
+    const bool isNegative = (word[0] == '-');
+    if (isNegative || (word[0] == '+'))
+        ++iChar;
+
+    if (iChar == word.size())
+        return false;
+
+    // Accumulating as a negative number since it can go one further than a positive one (INT_MIN)
+    long long result = 0;
+    for (; iChar < word.size(); ++iChar)
+    {
+        if ((word[iChar] < '0') || (word[iChar] > '9'))
+            return false;
+
+        result = result * 10 - (word[iChar] - '0');
+        if (result < INT_MIN)
+            return false;
+    }
+
+    if (!isNegative)
+    {
+        if (-result > INT_MAX)
+            return false;
+
+        result = -result;
+    }
+
+    val = static_cast<int>(result);
+    return true;
+}
+
+bool InputBuffer::ReadBool(bool& val)
+{
+    val = false;
+
+    std::string word;
+    if (!LockedReadWord(word))
+        return false;
+
+    if ((word == "1") || (word == "True"))
+        val = true;
+    else if ((word != "0") && (word != "False"))
+        return false;
+
+    return true;
+}
+
+bool InputBuffer::ReadString(std::string& val)
+{
+    val.clear();
+    return LockedReadWord(val);
+}
+
+void InputBuffer::CloseFile()
+{
+    if (mOwnsSource)
+        std::fclose(mSource);
+
+    mOwnsSource = false;
+}
+
+bool InputBuffer::Refill()
+{
+    mPos = 0;
+
+    // A line is all a terminal has to give, asking for a whole chunk would wait for more than what was typed
+    if (mIsInteractive)
+        mEnd = (std::fgets(mChunk.data(), static_cast<int>(mChunk.size()), mSource) != nullptr) ? std::strlen(mChunk.data()) : 0;
+    else
+        mEnd = std::fread(mChunk.data(), 1, mChunk.size(), mSource);
+
+    return mEnd != 0;
+}
+
+bool InputBuffer::LockedReadWord(std::string& word)
+{
+    std::lock_guard<std::mutex> lock{ mMutex };
+    return ReadWord(word);
+}
+
+bool InputBuffer::ReadWord(std::string& word)
+{
+    // Skipping the whitespace before the word, which may go on over multiple chunks
+    for (;;)
+    {
+        while ((mPos < mEnd) && IsWhitespace(mChunk[mPos]))
+            ++mPos;
+
+        if (mPos < mEnd)
+            break;
+
+        if (!Refill())
+            return false;
+    }
+
+    // Same for the word itself, most of the time it is copied from the chunk in one go
+    for (;;)
+    {
+        const size_t wordStart = mPos;
+        while ((mPos < mEnd) && !IsWhitespace(mChunk[mPos]))
+            ++mPos;
+
+        word.append(mChunk.data() + wordStart, mPos - wordStart);
+
+        if ((mPos < mEnd) || !Refill())
+            break;
+    }
+
+    return true;
+}
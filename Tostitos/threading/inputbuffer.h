@@ -0,0 +1,94 @@
+#ifndef INPUT_BUFFER_H__TOSTITOS
+#define INPUT_BUFFER_H__TOSTITOS
+
+#include <cstddef>
+#include <cstdio>
+#include <mutex>
+#include <string>
+#include <vector>
+
+namespace Threading
+{
+    namespace impl
+    {
+        /*
+        * \class InputBuffer
+        * \brief Input read by the scan statements of the running program. The input comes from the standard input
+        *        or from a file and is read in large chunks. The values are then parsed straight from the chunk,
+        *        without going through the locale-dependent stream extraction. When the standard input is a terminal,
+        *        it is read a line at a time instead so that the program doesn't wait for more than what was typed.
+        *        The input is shared by all threads, which can run on several host threads. Each read goes through
+        *        a lock, the values then go to the threads in the order they scan them.
+        */
+        class InputBuffer
+        {
+        public:
+            static const size_t CHUNK_SIZE = 64 * 1024;
+
+        public:
+            static InputBuffer& GetInstance();
+
+        public:
+            /*
+            * \fn           OpenFile
+            * \brief        Reads the input from a file instead of the standard input
+            * \param path   Path of the file
+            * \return       True if the file could be opened
+            */
+            bool OpenFile(const std::string& path);
+
+            /*
+            * \fn           UseStandardInput
+            * \brief        Reads the input from the standard input, which is the default
+            */
+            void UseStandardInput();
+
+            /*
+            * \fn           ReadInt
+            * \brief        Reads the next word of the input as an integer
+            * \param val    Integer read, 0 if the word isn't one
+            * \return       False if the input is over or the word isn't an integer
+            */
+            bool ReadInt(int& val);
+
+            /*
+            * \fn           ReadBool
+            * \brief        Reads the next word of the input as a boolean: 1, 0, True or False
+            * \param val    Boolean read, false if the word isn't one
+            * \return       False if the input is over or the word isn't a boolean
+            */
+            bool ReadBool(bool& val);
+
+            /*
+            * \fn           ReadString
+            * \brief        Reads the next word of the input, up to the following whitespace
+            * \param val    Word read, empty if the input is over
+            * \return       False if the input is over
+            */
+            bool ReadString(std::string& val);
+
+        private:
+            InputBuffer();
+            ~InputBuffer();
+            InputBuffer(const InputBuffer&) = delete;
+            void operator=(const InputBuffer&) = delete;
+
+        private:
+            void CloseFile();
+            bool Refill();
+            bool LockedReadWord(std::string& word);
+            bool ReadWord(std::string& word);
+
+        private:
+            std::vector<char> mChunk;   /*!< Input read but not parsed yet */
+            size_t mPos;                /*!< Position of the next character to parse in the chunk */
+            size_t mEnd;                /*!< End of the valid characters of the chunk */
+            std::FILE* mSource;         /*!< Where the input comes from */
+            bool mOwnsSource;           /*!< Indicates if the source is a file opened by the buffer */
+            bool mIsInteractive;        /*!< Indicates if the source is a terminal */
+            std::mutex mMutex;          /*!< Protects the whole buffer */
+        };
+    }   // namespace impl
+}   // namespace Threading
+
+#endif // INPUT_BUFFER_H__TOSTITOS
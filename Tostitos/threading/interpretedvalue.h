@@ -1,9 +1,13 @@
 #ifndef INTERPRETED_VALUE_H__TOSTITOS
 #define INTERPRETED_VALUE_H__TOSTITOS
 
+#include "boolarray.h"
+#include "stringpool.h"
+
 #include <cassert>
 #include <iterator>
 #include <memory>
+#include <new>
 #include <ostream>
 #include <string>
 #include <vector>
@@ -31,18 +35,26 @@ namespace Threading
 
         public:
             InterpretedValue() : mType{ ValueType::UNKNOWN }, mIsReady{ false } { }
-            explicit InterpretedValue(bool val) : mType{ ValueType::BOOLEAN }, boolVal{ new bool{ val } } { }
-            explicit InterpretedValue(int val) : mType{ ValueType::INTEGER }, intVal{ new int { val } } { }
-            explicit InterpretedValue(const std::string& val) : mType{ ValueType::STRING }, strVal{ new std::string{ val } } { }
+            // Scalars are stored inline, creating one (e.g. when indexing an array) doesn't allocate
+            explicit InterpretedValue(bool val) : mType{ ValueType::BOOLEAN }, mIsReady{ false }, boolVal{ val } { }
+            explicit InterpretedValue(int val) : mType{ ValueType::INTEGER }, mIsReady{ false }, intVal{ val } { }
+            explicit InterpretedValue(const InternedString& val) : mType{ ValueType::STRING }, mIsReady{ false }, strVal{ val } { }
+            explicit InterpretedValue(const std::string& val) : mType{ ValueType::STRING }, mIsReady{ false }, strVal{ StringPool::GetInstance().Intern(val) } { }
 
+            // Array values share their backing store. Copying one of them is only a reference count increment, 
+            // the elements themselves are copied the first time a write happens on a shared store (copy-on-write).
             explicit InterpretedValue(const std::vector<bool>& vals)
-                : mType{ ValueType::BOOLEAN_ARRAY }, boolArrayVal{ new std::vector<bool>{ vals } } { }
+                : mType{ ValueType::BOOLEAN_ARRAY }, mIsReady{ false }, boolArrayVal{ std::make_shared<BoolArray>(vals) } { }
+            explicit InterpretedValue(BoolArray&& vals)
+                : mType{ ValueType::BOOLEAN_ARRAY }, mIsReady{ false }, boolArrayVal{ std::make_shared<BoolArray>(std::move(vals)) } { }
             explicit InterpretedValue(const std::vector<int>& vals)
-                : mType{ ValueType::INTEGER_ARRAY }, intArrayVal{ new std::vector<int>{ vals } } { }
-            explicit InterpretedValue(const std::vector<std::string>& vals)
-                : mType{ ValueType::STRING_ARRAY }, strArrayVal{ new std::vector<std::string>{ vals } } { }
+                : mType{ ValueType::INTEGER_ARRAY }, mIsReady{ false }, intArrayVal{ std::make_shared<std::vector<int>>(vals) } { }
+            explicit InterpretedValue(std::vector<int>&& vals)
+                : mType{ ValueType::INTEGER_ARRAY }, mIsReady{ false }, intArrayVal{ std::make_shared<std::vector<int>>(std::move(vals)) } { }
+            explicit InterpretedValue(const std::vector<InternedString>& vals)
+                : mType{ ValueType::STRING_ARRAY }, mIsReady{ false }, strArrayVal{ std::make_shared<std::vector<InternedString>>(vals) } { }
 
-            InterpretedValue(const InterpretedValue& val) { AssignFrom(val); }
+            InterpretedValue(const InterpretedValue& val) : mType{ ValueType::UNKNOWN }, mIsReady{ false } { AssignFrom(val); }
 
             ~InterpretedValue() { Destroy(); }
 
@@ -72,22 +84,22 @@ namespace Threading
                 switch (val.mType)
                 {
                 case InterpretedValue::ValueType::BOOLEAN:
-                    stream << *val.boolVal;
+                    stream << val.boolVal;
                     break;
                 case InterpretedValue::ValueType::BOOLEAN_ARRAY:
-                    std::copy(val.boolArrayVal->begin(), val.boolArrayVal->end(), std::ostream_iterator<bool>(stream, ","));
+                    stream << *val.boolArrayVal;
                     break;
                 case InterpretedValue::ValueType::INTEGER:
-                    stream << *val.intVal;
+                    stream << val.intVal;
                     break;
                 case InterpretedValue::ValueType::INTEGER_ARRAY:
                     std::copy(val.intArrayVal->begin(), val.intArrayVal->end(), std::ostream_iterator<int>(stream, ","));
                     break;
                 case InterpretedValue::ValueType::STRING:
-                    stream << *val.strVal;
+                    stream << val.strVal;
                     break;
                 case InterpretedValue::ValueType::STRING_ARRAY:
-                    std::copy(val.strArrayVal->begin(), val.strArrayVal->end(), std::ostream_iterator<std::string>(stream, ","));
+                    std::copy(val.strArrayVal->begin(), val.strArrayVal->end(), std::ostream_iterator<InternedString>(stream, ","));
                     break;
                 default:
                     assert(false);  // Should never happen
@@ -96,12 +108,33 @@ namespace Threading
                 return stream;
             }
 
-            InterpretedValue operator[](int idx)
+            friend bool operator==(const InterpretedValue& lhs, const InterpretedValue& rhs)
+            {
+                if (lhs.mType != rhs.mType)
+                    return false;
+
+                // Arrays sharing the same store are equal without having to look at their elements.
+                // Strings are interned, so two of them holding the same text are the same instance.
+                switch (lhs.mType)
+                {
+                case ValueType::BOOLEAN:        return lhs.boolVal == rhs.boolVal;
+                case ValueType::BOOLEAN_ARRAY:  return (lhs.boolArrayVal == rhs.boolArrayVal) || (*lhs.boolArrayVal == *rhs.boolArrayVal);
+                case ValueType::INTEGER:        return lhs.intVal == rhs.intVal;
+                case ValueType::INTEGER_ARRAY:  return (lhs.intArrayVal == rhs.intArrayVal) || (*lhs.intArrayVal == *rhs.intArrayVal);
+                case ValueType::STRING:         return lhs.strVal == rhs.strVal;
+                case ValueType::STRING_ARRAY:   return (lhs.strArrayVal == rhs.strArrayVal) || (*lhs.strArrayVal == *rhs.strArrayVal);
+                default:                        return true;
+                }
+            }
+
+            friend bool operator!=(const InterpretedValue& lhs, const InterpretedValue& rhs) { return !(lhs == rhs); }
+
+            InterpretedValue operator[](int idx) const
             {
                 switch (mType)
                 {
                 case ValueType::BOOLEAN_ARRAY:
-                    return InterpretedValue{ (*boolArrayVal).at(idx) };
+                    return InterpretedValue{ boolArrayVal->Get(idx) };
                 case ValueType::INTEGER_ARRAY:
                     return InterpretedValue{ (*intArrayVal).at(idx) };
                 case ValueType::STRING_ARRAY:
@@ -116,90 +149,145 @@ namespace Threading
             ValueType GetType() const { return mType; }
             bool IsReady() const { return mIsReady; }
 
-            bool GetBoolVal() const { assert(mType == ValueType::BOOLEAN); return *boolVal; }
-            int GetIntVal() const { assert(mType == ValueType::INTEGER); return *intVal; }
-            const std::string& GetStrVal() const { assert(mType == ValueType::STRING); return *strVal; }
+            bool GetBoolVal() const { assert(mType == ValueType::BOOLEAN); return boolVal; }
+            int GetIntVal() const { assert(mType == ValueType::INTEGER); return intVal; }
+            const InternedString& GetStrVal() const { assert(mType == ValueType::STRING); return strVal; }
 
-            const std::vector<bool>& GetBoolArrayVal() const { assert(mType == ValueType::BOOLEAN_ARRAY); return *boolArrayVal; }
+            const BoolArray& GetBoolArrayVal() const { assert(mType == ValueType::BOOLEAN_ARRAY); return *boolArrayVal; }
             const std::vector<int>& GetIntArrayVal() const { assert(mType == ValueType::INTEGER_ARRAY); return *intArrayVal; }
-            const std::vector<std::string>& GetStrArrayVal() const { assert(mType == ValueType::STRING_ARRAY); return *strArrayVal; }
+            const std::vector<InternedString>& GetStrArrayVal() const { assert(mType == ValueType::STRING_ARRAY); return *strArrayVal; }
+
+            // Write access to an array. The backing store is detached from the other values sharing it beforehand.
+            BoolArray& GetMutableBoolArrayVal() { assert(mType == ValueType::BOOLEAN_ARRAY); Detach(boolArrayVal); return *boolArrayVal; }
+            std::vector<int>& GetMutableIntArrayVal() { assert(mType == ValueType::INTEGER_ARRAY); Detach(intArrayVal); return *intArrayVal; }
+            std::vector<InternedString>& GetMutableStrArrayVal() { assert(mType == ValueType::STRING_ARRAY); Detach(strArrayVal); return *strArrayVal; }
+
+            bool IsArray() const
+            {
+                return mType == ValueType::BOOLEAN_ARRAY 
+                    || mType == ValueType::INTEGER_ARRAY 
+                    || mType == ValueType::STRING_ARRAY;
+            }
+
+            bool IsSharingArray() const
+            {
+                switch (mType)
+                {
+                case ValueType::BOOLEAN_ARRAY:  return boolArrayVal.use_count() != 1;
+                case ValueType::INTEGER_ARRAY:  return intArrayVal.use_count() != 1;
+                case ValueType::STRING_ARRAY:   return strArrayVal.use_count() != 1;
+                default:                        return false;
+                }
+            }
 
         public:
             void SetReady() { mIsReady = true; }
 
+            void SetElement(int idx, const InterpretedValue& val)
+            {
+                switch (mType)
+                {
+                case ValueType::BOOLEAN_ARRAY:
+                    GetMutableBoolArrayVal().Set(idx, val.GetBoolVal());
+                    break;
+                case ValueType::INTEGER_ARRAY:
+                    GetMutableIntArrayVal().at(idx) = val.GetIntVal();
+                    break;
+                case ValueType::STRING_ARRAY:
+                    GetMutableStrArrayVal().at(idx) = val.GetStrVal();
+                    break;
+                default:
+                    assert(false);  // Should never happen
+                }
+            }
+
         private:
+            template <typename T>
+            static void Detach(std::shared_ptr<T>& store)
+            {
+                // Someone else is looking at the same elements. Writing to them would leak the 
+                // modification, so we must first get a copy of our own.
+                if (store.use_count() != 1)
+                    store = std::make_shared<T>(*store);
+            }
+
             void Destroy()
             {
+                // The members of the union are never implicitly destroyed, so it is 
+                // up to us to call the destructor of the currently active one
                 switch (mType)
                 {
-                case ValueType::BOOLEAN:
-                    boolVal.reset();
-                    break;
                 case ValueType::BOOLEAN_ARRAY:
-                    boolArrayVal.reset();
-                    break;
-                case ValueType::INTEGER:
-                    intVal.reset();
+                    boolArrayVal.~shared_ptr();
                     break;
                 case ValueType::INTEGER_ARRAY:
-                    intArrayVal.reset();
+                    intArrayVal.~shared_ptr();
                     break;
                 case ValueType::STRING:
-                    strVal.reset();
+                    strVal.~InternedString();
                     break;
                 case ValueType::STRING_ARRAY:
-                    strArrayVal.reset();
+                    strArrayVal.~shared_ptr();
                     break;
+                case ValueType::BOOLEAN:
+                case ValueType::INTEGER:
                 case ValueType::VOID:
+                case ValueType::UNKNOWN:
                     break;
                 default:
                     assert(false);  // Should never happen
                 }
+
+                mType = ValueType::UNKNOWN;
             }
 
             void AssignFrom(const InterpretedValue& val)
             {
+                // Scalars are deep copied while arrays only get another reference to the same store.
+                // Strings are immutable, copying one only copies a reference to its interned text.
                 switch (val.mType)
                 {
                 case ValueType::BOOLEAN:
-                    boolVal.reset(new bool{ *val.boolVal });
+                    boolVal = val.boolVal;
                     break;
                 case ValueType::BOOLEAN_ARRAY:
-                    boolArrayVal.reset(new std::vector<bool>{ *val.boolArrayVal });
+                    new (&boolArrayVal) std::shared_ptr<BoolArray>{ val.boolArrayVal };
                     break;
                 case ValueType::INTEGER:
-                    intVal.reset(new int{ *val.intVal });
+                    intVal = val.intVal;
                     break;
                 case ValueType::INTEGER_ARRAY:
-                    intArrayVal.reset(new std::vector<int>{ *val.intArrayVal });
+                    new (&intArrayVal) std::shared_ptr<std::vector<int>>{ val.intArrayVal };
                     break;
                 case ValueType::STRING:
-                    strVal.reset(new std::string{ *val.strVal });
+                    new (&strVal) InternedString{ val.strVal };
                     break;
                 case ValueType::STRING_ARRAY:
-                    strArrayVal.reset(new std::vector<std::string>{ *val.strArrayVal });
+                    new (&strArrayVal) std::shared_ptr<std::vector<InternedString>>{ val.strArrayVal };
                     break;
                 case ValueType::VOID:
+                case ValueType::UNKNOWN:
                     break;
                 default:
                     assert(false);  // Should never happen
                 }
 
                 mType = val.mType;
+                mIsReady = val.mIsReady;
             }
 
         private:
-            bool mIsReady;
             ValueType mType;
+            bool mIsReady;
             union
             {
-                std::unique_ptr<bool> boolVal;
-                std::unique_ptr<int> intVal;
-                std::unique_ptr<std::string> strVal;
+                bool boolVal;
+                int intVal;
+                InternedString strVal;
 
-                std::unique_ptr<std::vector<bool>> boolArrayVal;
-                std::unique_ptr<std::vector<int>> intArrayVal;
-                std::unique_ptr<std::vector<std::string>> strArrayVal;
+                std::shared_ptr<BoolArray> boolArrayVal;
+                std::shared_ptr<std::vector<int>> intArrayVal;
+                std::shared_ptr<std::vector<InternedString>> strArrayVal;
             };
         };
     }   // namespace impl
@@ -0,0 +1,26 @@
+#include "joinhandle.h"
+
+using namespace Threading;
+using namespace Threading::impl;
+
+Thread* JoinState::Complete(const InterpretedValue& result)
+{
+    mResult = result;
+
+    // Releasing the result along with the new state. Whoever registered before that is handed back.
+    const uintptr_t previousState = mState.exchange(DONE, std::memory_order_acq_rel);
+    assert(previousState != DONE);
+
+    return (previousState != RUNNING) ? reinterpret_cast<Thread*>(previousState) : nullptr;
+}
+
+bool JoinState::Wait(Thread* waiter)
+{
+    // Either the waiter gets registered before the thread is done, or it sees it done. Never both, never neither.
+    uintptr_t expectedState = RUNNING;
+    if (mState.compare_exchange_strong(expectedState, reinterpret_cast<uintptr_t>(waiter), std::memory_order_acq_rel))
+        return true;
+
+    assert(expectedState == DONE);
+    return false;
+}
@@ -0,0 +1,89 @@
+#ifndef JOIN_HANDLE_H__TOSTITOS
+#define JOIN_HANDLE_H__TOSTITOS
+
+#include "interpretedvalue.h"
+
+#include <atomic>
+#include <cassert>
+#include <cstdint>
+#include <memory>
+
+namespace Threading
+{
+    class Thread;
+
+    namespace impl
+    {
+        /*
+        * \class JoinState
+        * \brief Outcome of a spawned thread, shared by the thread and the handles to it. It outlives the thread,
+        *        whose storage is reused once it is done. The value returned by the thread is written before the
+        *        state says it is done, and the state is read with acquire, so a handle seeing the thread done on
+        *        any host thread also sees the value. At most one thread can wait on it at a time.
+        */
+        class JoinState
+        {
+        public:
+            JoinState() : mResult{ InterpretedValue::CreateVoidValue() }, mState{ RUNNING } { }
+
+            JoinState(const JoinState&) = delete;
+            void operator=(const JoinState&) = delete;
+
+        public:
+            /*
+            * \fn           Complete
+            * \brief        Says that the thread is done. Only called once, by the host thread that ran the thread last.
+            * \param result Value returned by the thread
+            * \return       Thread waiting on the state, which must be scheduled again, if any
+            */
+            Thread* Complete(const InterpretedValue& result);
+
+            /*
+            * \fn           Wait
+            * \brief        Registers a thread to be scheduled again once the thread is done
+            * \param waiter Thread waiting, which must not run until it is given back
+            * \return       False if the thread was already done, in which case the waiter can go on
+            */
+            bool Wait(Thread* waiter);
+
+            bool IsDone() const { return mState.load(std::memory_order_acquire) == DONE; }
+
+            // Only meaningful once done
+            const InterpretedValue& GetResult() const { return mResult; }
+
+        private:
+            static const uintptr_t RUNNING = 0;
+            static const uintptr_t DONE = 1;
+
+        private:
+            InterpretedValue mResult;
+            std::atomic<uintptr_t> mState;  /*!< RUNNING, DONE, or the address of the thread waiting for it to be done */
+        };
+    }
+
+    /*
+    * \class JoinHandle
+    * \brief Handle to a spawned thread, given by the kernel when the thread is created. It tells whether the thread
+    *        is done and what it returned, and lets another thread wait on that one thread alone (see Kernel::Join).
+    */
+    class JoinHandle
+    {
+    public:
+        JoinHandle() = default;
+        explicit JoinHandle(const std::shared_ptr<impl::JoinState>& state) : mState{ state } { }
+
+    public:
+        bool IsValid() const { return mState != nullptr; }
+        bool IsReady() const { return mState->IsDone(); }
+
+        // Only once ready
+        const impl::InterpretedValue& GetResult() const { assert(IsReady()); return mState->GetResult(); }
+
+    private:
+        friend class Thread;
+
+        std::shared_ptr<impl::JoinState> mState;
+    };
+}
+
+#endif // JOIN_HANDLE_H__TOSTITOS
@@ -0,0 +1,87 @@
+#include "outputbuffer.h"
+
+#include "interpretedvalue.h"
+
+#include <mutex>
+#include <sstream>
+
+using namespace Threading::impl;
+
+namespace
+{
+    // Shared by every buffer, a batch is written whole even when threads run on several host threads
+    std::mutex StreamMutex;
+}
+
+void OutputBuffer::PrintLine(const InterpretedValue& val)
+{
+    // The scalars are formatted directly in the buffer, the arrays go through their stream formatting
+    switch (val.GetType())
+    {
+    case InterpretedValue::ValueType::BOOLEAN:
+        mText += val.GetBoolVal() ? '1' : '0';
+        break;
+    case InterpretedValue::ValueType::INTEGER:
+        AppendInt(val.GetIntVal());
+        break;
+    case InterpretedValue::ValueType::STRING:
+        mText += val.GetStrVal().Get();
+        break;
+    default:
+    {
+        std::ostringstream sStream;
+        sStream << val;
+        mText += sStream.str();
+        break;
+    }
+    }
+
+    EndLine();
+}
+
+void OutputBuffer::PrintLine()
+{
+    EndLine();
+}
+
+void OutputBuffer::Flush()
+{
+    if (mText.empty() || (mStream == nullptr))
+        return;
+
+    {
+        std::lock_guard<std::mutex> lock{ StreamMutex };
+        mStream->write(mText.data(), static_cast<std::streamsize>(mText.size()));
+        mStream->flush();
+    }
+    mText.clear();
+}
+
+void OutputBuffer::AppendInt(int val)
+{
+    // Digits are produced from the least significant one, in a buffer large enough for INT_MIN
+    char digits[12];
+    char* digitsEnd = digits + sizeof(digits);
+    char* first = digitsEnd;
+
+    // Working on the unsigned value, negating INT_MIN as an int would overflow
+    unsigned absVal = val < 0 ? 0u - static_cast<unsigned>(val) : static_cast<unsigned>(val);
+    do
+    {
+        *--first = static_cast<char>('0' + (absVal % 10));
+        absVal /= 10;
+    } while (absVal != 0);
+
+    if (val < 0)
+        *--first = '-';
+
+    mText.append(first, digitsEnd);
+}
+
+void OutputBuffer::EndLine()
+{
+    mText += '\n';
+
+    if (mText.size() >= mFlushSize)
+        Flush();
+}
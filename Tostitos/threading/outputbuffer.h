@@ -0,0 +1,77 @@
+#ifndef OUTPUT_BUFFER_H__TOSTITOS
+#define OUTPUT_BUFFER_H__TOSTITOS
+
+#include <cstddef>
+#include <iostream>
+#include <string>
+
+namespace Threading
+{
+    namespace impl
+    {
+        class InterpretedValue;
+
+        /*
+        * \class OutputBuffer
+        * \brief Output of the print statements of a thread. The text is accumulated and written to the output stream
+        *        in batches, when the buffer grows past its flush size and whenever the thread stops running
+        *        (sleep, sync and exit). The output of the program is the text of each batch in the order the batches
+        *        are flushed, the batches of threads running on different host threads never being mixed together.
+        *        A thread's output is then always in order, and the text it printed before giving up the host thread
+        *        comes before the text printed by the threads running after it.
+        */
+        class OutputBuffer
+        {
+        public:
+            static const size_t DEFAULT_FLUSH_SIZE = 8192;
+
+        public:
+            /*
+            * \fn           OutputBuffer
+            * \brief        Ctor
+            * \param stream Stream the text is written to
+            */
+            explicit OutputBuffer(std::ostream& stream = std::cout) : mText{}, mFlushSize{ DEFAULT_FLUSH_SIZE }, mStream{ &stream } { }
+
+            ~OutputBuffer() { Flush(); }
+
+            OutputBuffer(const OutputBuffer&) = delete;
+            void operator=(const OutputBuffer&) = delete;
+
+        public:
+            /*
+            * \fn           PrintLine
+            * \brief        Appends a value to the output, followed by a newline
+            * \param val    Value to print
+            */
+            void PrintLine(const InterpretedValue& val);
+
+            /*
+            * \fn           PrintLine
+            * \brief        Appends a newline to the output
+            */
+            void PrintLine();
+
+            /*
+            * \fn           Flush
+            * \brief        Writes the text accumulated so far to the output stream
+            */
+            void Flush();
+
+        public:
+            size_t GetFlushSize() const { return mFlushSize; }
+            void SetFlushSize(size_t size) { mFlushSize = size; }
+
+        private:
+            void AppendInt(int val);
+            void EndLine();
+
+        private:
+            std::string mText;      /*!< Text not written yet */
+            size_t mFlushSize;      /*!< Size past which the text is written to the output stream */
+            std::ostream* mStream;  /*!< Stream the text is written to */
+        };
+    }   // namespace impl
+}   // namespace Threading
+
+#endif // OUTPUT_BUFFER_H__TOSTITOS
@@ -0,0 +1,185 @@
+#include "quickenedops.h"
+
+#include "../../TosLang/AST/declarations.h"
+
+#include <functional>
+
+using namespace Threading::impl;
+using namespace TosLang::Common;
+using namespace TosLang::FrontEnd;
+
+namespace
+{
+    struct LeftShift
+    {
+        int operator()(int lhs, int rhs) const { return lhs << rhs; }
+    };
+
+    struct RightShift
+    {
+        int operator()(int lhs, int rhs) const { return lhs >> rhs; }
+    };
+
+    template <typename Op>
+    InterpretedValue IntOp(const InterpretedValue& lhs, const InterpretedValue& rhs)
+    {
+        return InterpretedValue{ Op{}(lhs.GetIntVal(), rhs.GetIntVal()) };
+    }
+
+    template <typename Op>
+    InterpretedValue BoolOp(const InterpretedValue& lhs, const InterpretedValue& rhs)
+    {
+        return InterpretedValue{ Op{}(lhs.GetBoolVal(), rhs.GetBoolVal()) };
+    }
+
+    // Strings are interned, comparing two of them only compares their instance
+    template <typename Op>
+    InterpretedValue StrOp(const InterpretedValue& lhs, const InterpretedValue& rhs)
+    {
+        return InterpretedValue{ Op{}(lhs.GetStrVal(), rhs.GetStrVal()) };
+    }
+
+    struct ArrayAnd
+    {
+        BoolArray operator()(const BoolArray& lhs, const BoolArray& rhs) const { return lhs.And(rhs); }
+    };
+
+    struct ArrayOr
+    {
+        BoolArray operator()(const BoolArray& lhs, const BoolArray& rhs) const { return lhs.Or(rhs); }
+    };
+
+    template <typename Op>
+    InterpretedValue BoolArrayOp(const InterpretedValue& lhs, const InterpretedValue& rhs)
+    {
+        return InterpretedValue{ Op{}(lhs.GetBoolArrayVal(), rhs.GetBoolArrayVal()) };
+    }
+
+    BinaryOpHandler GetIntHandler(Operation op)
+    {
+        switch (op)
+        {
+        case Operation::AND_INT:        return &IntOp<std::bit_and<int>>;
+        case Operation::DIVIDE:         return &IntOp<std::divides<int>>;
+        case Operation::EQUAL:          return &IntOp<std::equal_to<int>>;
+        case Operation::GREATER_THAN:   return &IntOp<std::greater<int>>;
+        case Operation::LEFT_SHIFT:     return &IntOp<LeftShift>;
+        case Operation::LESS_THAN:      return &IntOp<std::less<int>>;
+        case Operation::MINUS:          return &IntOp<std::minus<int>>;
+        case Operation::MODULO:         return &IntOp<std::modulus<int>>;
+        case Operation::MULT:           return &IntOp<std::multiplies<int>>;
+        case Operation::OR_INT:         return &IntOp<std::bit_or<int>>;
+        case Operation::PLUS:           return &IntOp<std::plus<int>>;
+        case Operation::RIGHT_SHIFT:    return &IntOp<RightShift>;
+        default:                        return nullptr;
+        }
+    }
+
+    BinaryOpHandler GetBoolHandler(Operation op)
+    {
+        switch (op)
+        {
+        case Operation::AND_BOOL:       return &BoolOp<std::logical_and<bool>>;
+        case Operation::EQUAL:          return &BoolOp<std::equal_to<bool>>;
+        case Operation::OR_BOOL:        return &BoolOp<std::logical_or<bool>>;
+        default:                        return nullptr;
+        }
+    }
+
+    BinaryOpHandler GetStringHandler(Operation op)
+    {
+        switch (op)
+        {
+        case Operation::EQUAL:          return &StrOp<std::equal_to<InternedString>>;
+        default:                        return nullptr;
+        }
+    }
+
+    // The logical operations on boolean arrays are applied to whole words of elements at once
+    BinaryOpHandler GetBoolArrayHandler(Operation op)
+    {
+        switch (op)
+        {
+        case Operation::AND_BOOL:       return &BoolArrayOp<ArrayAnd>;
+        case Operation::OR_BOOL:        return &BoolArrayOp<ArrayOr>;
+        default:                        return nullptr;
+        }
+    }
+}
+
+namespace Threading
+{
+    namespace impl
+    {
+        InterpretedValue EvaluateBinaryOp(Operation op, const InterpretedValue& lhs, const InterpretedValue& rhs)
+        {
+            if (lhs.GetType() == InterpretedValue::ValueType::BOOLEAN_ARRAY)
+            {
+                BinaryOpHandler handler = GetBoolArrayHandler(op);
+                return (handler != nullptr) ? handler(lhs, rhs) : InterpretedValue{};
+            }
+
+            // Since type checking has been performed beforehand, we can assume that
+            // a certain operation only works with a certain type
+            switch (op)
+            {
+            case Operation::AND_BOOL:       return InterpretedValue{ lhs.GetBoolVal() && rhs.GetBoolVal() };
+            case Operation::AND_INT:        return InterpretedValue{ lhs.GetIntVal() & rhs.GetIntVal() };
+            case Operation::DIVIDE:         return InterpretedValue{ lhs.GetIntVal() / rhs.GetIntVal() };
+            case Operation::EQUAL:          return InterpretedValue{ lhs == rhs };  // Every type can be compared
+            case Operation::GREATER_THAN:   return InterpretedValue{ lhs.GetIntVal() > rhs.GetIntVal() };
+            case Operation::LEFT_SHIFT:     return InterpretedValue{ lhs.GetIntVal() << rhs.GetIntVal() };
+            case Operation::LESS_THAN:      return InterpretedValue{ lhs.GetIntVal() < rhs.GetIntVal() };
+            case Operation::MINUS:          return InterpretedValue{ lhs.GetIntVal() - rhs.GetIntVal() };
+            case Operation::MODULO:         return InterpretedValue{ lhs.GetIntVal() % rhs.GetIntVal() };
+            case Operation::MULT:           return InterpretedValue{ lhs.GetIntVal() * rhs.GetIntVal() };
+            //TODO: case Operation::NOT:    return InterpretedValue{ lhs.GetBoolVal() && rhs.GetBoolVal() };
+            case Operation::OR_BOOL:        return InterpretedValue{ lhs.GetBoolVal() || rhs.GetBoolVal() };
+            case Operation::OR_INT:         return InterpretedValue{ lhs.GetIntVal() | rhs.GetIntVal() };
+            case Operation::PLUS:           return InterpretedValue{ lhs.GetIntVal() + rhs.GetIntVal() };
+            case Operation::RIGHT_SHIFT:    return InterpretedValue{ lhs.GetIntVal() >> rhs.GetIntVal() };
+            default:                        return {};
+            }
+        }
+
+        BinaryOpHandler GetSpecializedHandler(Operation op, InterpretedValue::ValueType lhsType, InterpretedValue::ValueType rhsType)
+        {
+            if ((lhsType == InterpretedValue::ValueType::INTEGER) && (rhsType == InterpretedValue::ValueType::INTEGER))
+                return GetIntHandler(op);
+            else if ((lhsType == InterpretedValue::ValueType::BOOLEAN) && (rhsType == InterpretedValue::ValueType::BOOLEAN))
+                return GetBoolHandler(op);
+            else if ((lhsType == InterpretedValue::ValueType::BOOLEAN_ARRAY) && (rhsType == InterpretedValue::ValueType::BOOLEAN_ARRAY))
+                return GetBoolArrayHandler(op);
+            else if ((lhsType == InterpretedValue::ValueType::STRING) && (rhsType == InterpretedValue::ValueType::STRING))
+                return GetStringHandler(op);
+            else
+                return nullptr;
+        }
+    }
+}
+
+QuickenedOps& QuickenedOps::GetInstance()
+{
+    static QuickenedOps Instance;
+    return Instance;
+}
+
+const QuickenedBinaryOp* QuickenedOps::Find(const BinaryOpExpr* bExpr) const
+{
+    auto opIt = mQuickenedOps.find(bExpr);
+    return opIt != mQuickenedOps.end() ? &opIt->second : nullptr;
+}
+
+void QuickenedOps::Quicken(const BinaryOpExpr* bExpr, const InterpretedValue& lhs, const InterpretedValue& rhs)
+{
+    BinaryOpHandler handler = GetSpecializedHandler(bExpr->GetOperation(), lhs.GetType(), rhs.GetType());
+
+    // Nothing to specialize for. The expression will keep using the generic path.
+    if (handler == nullptr)
+    {
+        mQuickenedOps.erase(bExpr);
+        return;
+    }
+
+    mQuickenedOps[bExpr] = QuickenedBinaryOp{ handler, lhs.GetType(), rhs.GetType() };
+}
@@ -0,0 +1,119 @@
+#ifndef QUICKENED_OPS_H__TOSTITOS
+#define QUICKENED_OPS_H__TOSTITOS
+
+#include "interpretedvalue.h"
+
+#include "../../TosLang/Common/opcodes.h"
+
+#include <cstddef>
+#include <unordered_map>
+
+namespace TosLang
+{
+    namespace FrontEnd
+    {
+        class BinaryOpExpr;
+    }
+}
+
+namespace Threading
+{
+    namespace impl
+    {
+        using BinaryOpHandler = InterpretedValue(*)(const InterpretedValue& lhs, const InterpretedValue& rhs);
+
+        /*
+        * \struct QuickenedBinaryOp
+        * \brief  Handler specialized for the operation of a binary expression and the operand types it was first run with
+        */
+        struct QuickenedBinaryOp
+        {
+            BinaryOpHandler handler;                /*!< Evaluates the operation without looking at it nor at the operand types */
+            InterpretedValue::ValueType lhsType;    /*!< Type of the left operand the handler was specialized for */
+            InterpretedValue::ValueType rhsType;    /*!< Type of the right operand the handler was specialized for */
+
+            /*
+            * \fn       Guard
+            * \brief    Checks that the specialization assumptions still hold for the given operands
+            * \return   True if the handler can be used, else false
+            */
+            bool Guard(const InterpretedValue& lhs, const InterpretedValue& rhs) const
+            {
+                return (lhs.GetType() == lhsType) && (rhs.GetType() == rhsType);
+            }
+        };
+
+        /*
+        * \class QuickenedOps
+        * \brief Self-specializing binary expressions. The first time a binary expression is evaluated, it is
+        *        rewritten to a handler specialized for its operation and operand types (for example int+int).
+        *        The following evaluations directly call that handler as long as its guard holds. When it doesn't,
+        *        the executor goes back to the generic evaluation and the expression is specialized again.
+        *        The specializations stay valid as long as the same program image is loaded.
+        *        Rewriting an expression isn't synchronized with the threads evaluating it: this is only safe because
+        *        the AST walker, the only user, is kept off the worker pool (see Kernel::PrepareWorkers).
+        */
+        class QuickenedOps
+        {
+        public:
+            static QuickenedOps& GetInstance();
+
+        public:
+            /*
+            * \fn           Find
+            * \brief        Gets the specialized handler of a binary expression
+            * \param bExpr  Binary expression
+            * \return       Specialized handler, or nullptr if the expression wasn't quickened
+            */
+            const QuickenedBinaryOp* Find(const TosLang::FrontEnd::BinaryOpExpr* bExpr) const;
+
+            /*
+            * \fn           Quicken
+            * \brief        Specializes a binary expression for the types of the given operands. Operations that
+            *               have side effects or no specialized version keep going through the generic path.
+            * \param bExpr  Binary expression
+            * \param lhs    Value of the left operand
+            * \param rhs    Value of the right operand
+            */
+            void Quicken(const TosLang::FrontEnd::BinaryOpExpr* bExpr, const InterpretedValue& lhs, const InterpretedValue& rhs);
+
+            /*
+            * \fn           Invalidate
+            * \brief        Forgets every specialization. Must be called when a new program image is loaded.
+            */
+            void Invalidate() { mQuickenedOps.clear(); }
+
+            size_t GetSize() const { return mQuickenedOps.size(); }
+
+        private:
+            QuickenedOps() = default;
+            QuickenedOps(const QuickenedOps&) = delete;
+            void operator=(const QuickenedOps&) = delete;
+
+        private:
+            std::unordered_map<const TosLang::FrontEnd::BinaryOpExpr*, QuickenedBinaryOp> mQuickenedOps;
+        };
+
+        /*
+        * \fn           EvaluateBinaryOp
+        * \brief        Generic evaluation of a side-effect free binary operation
+        * \param op     Operation to apply
+        * \param lhs    Value of the left operand
+        * \param rhs    Value of the right operand
+        * \return       Result of the operation
+        */
+        InterpretedValue EvaluateBinaryOp(TosLang::Common::Operation op, const InterpretedValue& lhs, const InterpretedValue& rhs);
+
+        /*
+        * \fn           GetSpecializedHandler
+        * \brief        Gets the handler specialized for an operation on operands of the given types
+        * \param op     Operation to apply
+        * \param lhsType Type of the left operand
+        * \param rhsType Type of the right operand
+        * \return       Specialized handler, or nullptr if the operation has no specialized version for those types
+        */
+        BinaryOpHandler GetSpecializedHandler(TosLang::Common::Operation op, InterpretedValue::ValueType lhsType, InterpretedValue::ValueType rhsType);
+    }   // namespace impl
+}   // namespace Threading
+
+#endif // QUICKENED_OPS_H__TOSTITOS
@@ -0,0 +1,39 @@
+#include "sleepclock.h"
+
+using namespace Threading;
+
+SleepClock& SleepClock::GetInstance()
+{
+    static SleepClock Instance;
+    return Instance;
+}
+
+SleepClock::SleepClock() : mIsVirtual{ false }, mVirtualTime{ 0 } { }
+
+SleepClock::Clock::time_point SleepClock::Now() const
+{
+    if (!mIsVirtual.load(std::memory_order_relaxed))
+        return Clock::now();
+
+    return Clock::time_point{ Clock::duration{ mVirtualTime.load(std::memory_order_relaxed) } };
+}
+
+void SleepClock::UseVirtualTime(bool isVirtual)
+{
+    mIsVirtual.store(isVirtual, std::memory_order_relaxed);
+    mVirtualTime.store(0, std::memory_order_relaxed);
+}
+
+void SleepClock::AdvanceTo(Clock::time_point time)
+{
+    if (!mIsVirtual.load(std::memory_order_relaxed))
+        return;
+
+    const Clock::rep ticks = time.time_since_epoch().count();
+    Clock::rep currentTicks = mVirtualTime.load(std::memory_order_relaxed);
+    while (currentTicks < ticks)
+    {
+        if (mVirtualTime.compare_exchange_weak(currentTicks, ticks, std::memory_order_relaxed))
+            break;
+    }
+}
@@ -0,0 +1,59 @@
+#ifndef SLEEP_CLOCK_H__TOSTITOS
+#define SLEEP_CLOCK_H__TOSTITOS
+
+#include <atomic>
+#include <chrono>
+
+namespace Threading
+{
+    /*
+    * \class SleepClock
+    * \brief Clock the sleeping threads wake up by. It is either the host's clock, or a virtual clock that
+    *        stands still while threads run and only moves when the scheduler has nothing left but sleepers, at
+    *        which point it jumps straight to the next wake-up. With the virtual clock, a program full of sleeps
+    *        runs as fast as its computations allow, and when each thread wakes up doesn't depend on how fast
+    *        the host is, so the threads always interleave the same way.
+    */
+    class SleepClock
+    {
+    public:
+        using Clock = std::chrono::high_resolution_clock;
+
+    public:
+        static SleepClock& GetInstance();
+
+    public:
+        /*
+        * \fn           Now
+        * \brief        Gets the current time, real or virtual
+        * \return       Current time
+        */
+        Clock::time_point Now() const;
+
+        /*
+        * \fn           UseVirtualTime
+        * \brief        Picks the clock and sets the virtual time back to its start
+        * \param isVirtual  Use the virtual clock instead of the host's?
+        */
+        void UseVirtualTime(bool isVirtual);
+        bool IsVirtual() const { return mIsVirtual.load(std::memory_order_relaxed); }
+
+        /*
+        * \fn           AdvanceTo
+        * \brief        Moves the virtual time forward, never backward. Does nothing for the host's clock.
+        * \param time   New time
+        */
+        void AdvanceTo(Clock::time_point time);
+
+    private:
+        SleepClock();
+        SleepClock(const SleepClock&) = delete;
+        void operator=(const SleepClock&) = delete;
+
+    private:
+        std::atomic<bool> mIsVirtual;
+        std::atomic<Clock::rep> mVirtualTime;   /*!< Ticks since the start of the virtual time */
+    };
+}
+
+#endif // SLEEP_CLOCK_H__TOSTITOS
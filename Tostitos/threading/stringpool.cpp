@@ -0,0 +1,57 @@
+#include "stringpool.h"
+
+#include "../../TosLang/AST/ast.h"
+
+using namespace Threading::impl;
+using namespace TosLang::FrontEnd;
+
+InternedString::InternedString() : InternedString{ StringPool::GetInstance().Intern("") } { }
+
+StringPool::StringPool() : mMutex{}, mStrings{}, mLiterals{} { }
+
+StringPool& StringPool::GetInstance()
+{
+    static StringPool Instance;
+    return Instance;
+}
+
+void StringPool::Reset()
+{
+    std::lock_guard<std::mutex> lock{ mMutex };
+    mStrings.clear();
+    mLiterals.clear();
+}
+
+InternedString StringPool::Intern(const std::string& str)
+{
+    std::lock_guard<std::mutex> lock{ mMutex };
+
+    auto strIt = mStrings.find(str);
+    if (strIt != mStrings.end())
+        return strIt->second;
+
+    InternedString interned{ std::make_shared<const std::string>(str) };
+    mStrings.emplace(str, interned);
+    return interned;
+}
+
+void StringPool::InternLiterals(const ASTNode* root)
+{
+    if (root == nullptr)
+        return;
+
+    if (root->GetKind() == ASTNode::NodeKind::STRING_EXPR)
+        mLiterals.emplace(root, Intern(root->GetName()));
+
+    for (const auto& child : root->GetChildrenNodes())
+        InternLiterals(child.get());
+}
+
+const InternedString& StringPool::GetLiteral(const ASTNode* strExpr)
+{
+    auto litIt = mLiterals.find(strExpr);
+    if (litIt != mLiterals.end())
+        return litIt->second;
+
+    return mLiterals.emplace(strExpr, Intern(strExpr->GetName())).first->second;
+}
@@ -0,0 +1,113 @@
+#ifndef STRING_POOL_H__TOSTITOS
+#define STRING_POOL_H__TOSTITOS
+
+#include <functional>
+#include <memory>
+#include <mutex>
+#include <ostream>
+#include <string>
+#include <unordered_map>
+
+namespace TosLang
+{
+    namespace FrontEnd
+    {
+        class ASTNode;
+    }
+}
+
+namespace Threading
+{
+    namespace impl
+    {
+        /*
+        * \class InternedString
+        * \brief Immutable string handed out by the string pool. Since the pool keeps a single instance of each text,
+        *        copying an interned string or comparing two of them only deals with a pointer. The text is reference
+        *        counted so that it outlives the pool if values still hold it when the pool is reset.
+        */
+        class InternedString
+        {
+        public:
+            /*
+            * \fn           InternedString
+            * \brief        Ctor. The string is empty.
+            */
+            InternedString();
+
+        public:
+            friend bool operator==(const InternedString& lhs, const InternedString& rhs) { return lhs.mStr == rhs.mStr; }
+            friend bool operator!=(const InternedString& lhs, const InternedString& rhs) { return lhs.mStr != rhs.mStr; }
+            friend std::ostream& operator<<(std::ostream& stream, const InternedString& str) { return stream << *str.mStr; }
+
+        public:
+            const std::string& Get() const { return *mStr; }
+            size_t Hash() const { return std::hash<const std::string*>{}(mStr.get()); }
+
+        private:
+            friend class StringPool;
+            explicit InternedString(std::shared_ptr<const std::string>&& str) : mStr{ std::move(str) } { }
+
+        private:
+            std::shared_ptr<const std::string> mStr;
+        };
+
+        /*
+        * \class StringPool
+        * \brief Interned strings of the running program. The string literals are interned once when the program is
+        *        loaded, the strings made at runtime (e.g. read by a scan) when they are created. The kernel can run
+        *        threads on several host threads, so interning a string goes through a lock. Getting a literal
+        *        doesn't, the literals are all interned before the program runs.
+        */
+        class StringPool
+        {
+        public:
+            static StringPool& GetInstance();
+
+        public:
+            /*
+            * \fn           Reset
+            * \brief        Forgets every interned string and literal
+            */
+            void Reset();
+
+            /*
+            * \fn           Intern
+            * \brief        Gets the interned instance of a text, creating it the first time the text is seen
+            * \param str    Text to intern
+            * \return       Interned string
+            */
+            InternedString Intern(const std::string& str);
+
+            /*
+            * \fn           InternLiterals
+            * \brief        Interns every string literal of a program
+            * \param root   Root of the program's AST
+            */
+            void InternLiterals(const TosLang::FrontEnd::ASTNode* root);
+
+            /*
+            * \fn           GetLiteral
+            * \brief        Gets the interned value of a string literal, interning it if the program's literals weren't
+            * \param strExpr    String expression node
+            * \return       Interned string
+            */
+            const InternedString& GetLiteral(const TosLang::FrontEnd::ASTNode* strExpr);
+
+        public:
+            size_t GetSize() const { return mStrings.size(); }
+
+        private:
+            StringPool();
+            StringPool(const StringPool&) = delete;
+            void operator=(const StringPool&) = delete;
+
+        private:
+            std::mutex mMutex;                                                                  /*!< Protects the instances */
+            std::unordered_map<std::string, InternedString> mStrings;                           /*!< Instance of each text */
+            std::unordered_map<const TosLang::FrontEnd::ASTNode*, InternedString> mLiterals;    /*!< Value of each string literal */
+        };
+    }   // namespace impl
+}   // namespace Threading
+
+#endif // STRING_POOL_H__TOSTITOS
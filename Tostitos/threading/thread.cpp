@@ -1,57 +1,460 @@
 #include "thread.h"
 
+#include "checkpoint.h"
+#include "closureexecutor.h"
 #include "executor.h"
+#include "globalstore.h"
+#include "sleepclock.h"
+
+#include "../kernel/process.h"
+
+#ifdef USE_COROUTINES
+#include "coroutineexecutor.h"
+#endif
+
+#include <algorithm>
+#include <cassert>
+#include <iostream>
+#include <stdexcept>
+#include <utility>
 
 using namespace Threading;
 using namespace Threading::impl;
 
 namespace chr = std::chrono;
 
+namespace
+{
+    // Each host thread running TosLang threads has its own current thread
+    thread_local Thread* CurrentThread = nullptr;
+
+    // Set in the sync state of a thread blocked on its children, the rest of the bits count the children
+    const size_t BLOCKED_FLAG = static_cast<size_t>(1) << (sizeof(size_t) * 8 - 1);
+}
+
 Thread::Thread(Executor&& exec) 
-    : mFinished{ false }, mWaitForChildren{ false }, mTimeToWakeup{ 0 }, 
-      mTimePoint{ }, mExecutor{ std::make_unique<Executor>(std::move(exec)) }, mChildren{ } { }
+    : mFinished{ false }, mWaitForChildren{ false }, mIsSleeping{ false }, 
+      mWakeUpTime{ }, mNestedStepCount{ 0 }, mExecutor{ std::make_unique<Executor>(std::move(exec)) }, mClosureExecutor{ }, mParent{ nullptr }, mSyncState{ 0 },
+      mJoinState{ std::make_shared<JoinState>() }, mJoinedState{ }, mChildHandles{ }, mOutput{ }, mProcess{ nullptr },
+      mMetrics{ }, mWaitKind{ WaitKind::READY }, mWaitStart{ Clock::now() }, mReleaseTime{ } { }
+
+Thread::Thread(ClosureExecutor&& exec)
+    : mFinished{ false }, mWaitForChildren{ false }, mIsSleeping{ false },
+      mWakeUpTime{ }, mNestedStepCount{ 0 }, mExecutor{ }, mClosureExecutor{ std::make_unique<ClosureExecutor>(std::move(exec)) }, mParent{ nullptr }, mSyncState{ 0 },
+      mJoinState{ std::make_shared<JoinState>() }, mJoinedState{ }, mChildHandles{ }, mOutput{ }, mProcess{ nullptr },
+      mMetrics{ }, mWaitKind{ WaitKind::READY }, mWaitStart{ Clock::now() }, mReleaseTime{ } { }
+
+#ifdef USE_COROUTINES
+Thread::Thread(CoroutineExecutor&& exec)
+    : mFinished{ false }, mWaitForChildren{ false }, mIsSleeping{ false },
+      mWakeUpTime{ }, mNestedStepCount{ 0 }, mExecutor{ }, mClosureExecutor{ }, mCoroutineExecutor{ std::make_unique<CoroutineExecutor>(std::move(exec)) }, mParent{ nullptr }, mSyncState{ 0 },
+      mJoinState{ std::make_shared<JoinState>() }, mJoinedState{ }, mChildHandles{ }, mOutput{ }, mProcess{ nullptr },
+      mMetrics{ }, mWaitKind{ WaitKind::READY }, mWaitStart{ Clock::now() }, mReleaseTime{ } { }
+#endif
 
 Thread::~Thread() = default;
 
+void Thread::Reset(const TosLang::FrontEnd::ASTNode* root, const TosLang::FrontEnd::SymbolTable* symTab,
+                   CallStack&& stack)
+{
+    ResetSchedulingState();
+
+    if (mExecutor == nullptr)
+        mExecutor = std::make_unique<Executor>();
+
+    mExecutor->Reset(root, symTab, std::move(stack));
+    mClosureExecutor.reset();
+#ifdef USE_COROUTINES
+    mCoroutineExecutor.reset();
+#endif
+}
+
+void Thread::Reset(const CompiledFunction* fn, std::vector<InterpretedValue>&& args)
+{
+    ResetSchedulingState();
+
+    if (mClosureExecutor != nullptr)
+        mClosureExecutor->Reset(fn, std::move(args));
+    else
+        mClosureExecutor = std::make_unique<ClosureExecutor>(fn, std::move(args));
+
+    mExecutor.reset();
+#ifdef USE_COROUTINES
+    mCoroutineExecutor.reset();
+#endif
+}
+
+#ifdef USE_COROUTINES
+void Thread::Reset(const CoroutineFunction* fn, std::vector<InterpretedValue>&& args)
+{
+    ResetSchedulingState();
+
+    if (mCoroutineExecutor != nullptr)
+        mCoroutineExecutor->Reset(fn, std::move(args));
+    else
+        mCoroutineExecutor = std::make_unique<CoroutineExecutor>(fn, std::move(args));
+
+    mExecutor.reset();
+    mClosureExecutor.reset();
+}
+#endif
+
+Thread* Thread::GetCurrent()
+{
+    return CurrentThread;
+}
+
+void Thread::SetCurrent(Thread* thread)
+{
+    CurrentThread = thread;
+
+    // The thread sees the global variables of its own process
+    GlobalStore::SetCurrent(((thread != nullptr) && (thread->mProcess != nullptr)) ? &thread->mProcess->GetGlobals() : nullptr);
+}
+
 void Thread::ExecuteOne()
 {
-    if (!mExecutor->ExecuteOne())
+#ifdef USE_COROUTINES
+    if (mCoroutineExecutor != nullptr)
+    {
+        ExecuteCoroutine(1);
+        return;
+    }
+#endif
+
+    const bool executed = (mClosureExecutor != nullptr) ? mClosureExecutor->ExecuteOne() : mExecutor->ExecuteOne();
+    if (!executed)
+    {
+        mFinished = true;
+        mOutput.Flush();
+    }
+}
+
+size_t Thread::Execute(size_t quantum)
+{
+    const Clock::time_point turnStart = Clock::now();
+    AccountWait(turnStart);
+
+    size_t stepCount = 0;
+    if ((mProcess != nullptr) && mProcess->IsStopped())
     {
+        // The process used up its steps, its threads finish as soon as they get a turn
         mFinished = true;
+        mOutput.Flush();
     }
+    else
+    {
+        // An index outside of its array is a runtime error, which only ends the thread running into it
+        try
+        {
+#ifdef USE_COROUTINES
+            if (mCoroutineExecutor != nullptr)
+                stepCount = ExecuteCoroutine(quantum);
+            else
+#endif
+            {
+                // Sleeping and syncing only raise a flag, the flags are enough to stop the batch without reading the clock
+                while ((stepCount + mNestedStepCount < quantum) && !mFinished && !mIsSleeping && !mWaitForChildren)
+                {
+                    ExecuteOne();
+                    ++stepCount;
+                }
+            }
+        }
+        catch (const std::out_of_range&)
+        {
+            mOutput.Flush();
+            std::cerr << "RUNTIME ERROR: Index out of bounds" << std::endl;
+            mFinished = true;
+        }
+        catch (const ThreadStopped&)
+        {
+            // The quota ran out within a call, charging the steps below stops the whole process
+            mOutput.Flush();
+            mFinished = true;
+        }
+    }
+
+    stepCount += std::exchange(mNestedStepCount, 0);
+    if (mProcess != nullptr)
+        mProcess->ChargeSteps(stepCount);
+
+    const Clock::time_point turnEnd = Clock::now();
+    mMetrics.cpuTime += turnEnd - turnStart;
+    mMetrics.stepCount += stepCount;
+    ++mMetrics.switchCount;
+
+    mWaitKind = mIsSleeping ? WaitKind::SLEEPING : (mWaitForChildren ? WaitKind::BLOCKED : WaitKind::READY);
+    mWaitStart = turnEnd;
+
+    return stepCount;
 }
 
-bool Thread::IsWaitingForChildren()
+#ifdef USE_COROUTINES
+size_t Thread::ExecuteCoroutine(size_t quantum)
 {
-	if (mWaitForChildren)
-		mWaitForChildren = !mChildren.empty();
+    // A coroutine runs until it suspends itself: at a sleep, at a sync or once its quantum is used up
+    const size_t stepCount = mCoroutineExecutor->Execute(quantum);
+    if (mCoroutineExecutor->HasFinished())
+    {
+        mFinished = true;
+        mOutput.Flush();
+    }
 
-	return mWaitForChildren;
+    return stepCount;
 }
+#endif
 
-bool Thread::IsSleeping()
+void Thread::AccountWait(Clock::time_point now)
 {
-	if (chr::duration_cast<chr::seconds>(chr::high_resolution_clock::now() - mTimePoint).count() > mTimeToWakeup)
-	{
-		mTimeToWakeup = 0;
-		return false;
-	}
-	return true;
+    // The time since the last turn is split in two: waiting on a sleep or a sync, then waiting for a turn
+    Clock::time_point readyTime = mWaitStart;
+    if (mWaitKind != WaitKind::READY)
+    {
+        readyTime = std::max(mWaitStart, std::min(mReleaseTime, now));
+        if (mWaitKind == WaitKind::SLEEPING)
+            mMetrics.sleepTime += readyTime - mWaitStart;
+        else
+            mMetrics.blockedTime += readyTime - mWaitStart;
+    }
+
+    mMetrics.lastReadyLatency = now - readyTime;
+    mMetrics.readyTime += mMetrics.lastReadyLatency;
 }
 
-Thread* Thread::Fork(Executor&& exec)
+bool Thread::IsSleeping()
 {
-    mChildren.emplace_back(std::make_unique<Thread>(std::move(exec)));
-    return mChildren.back().get();
+    // Only a sleeping thread looks at the clock, this is checked before every statement
+    if (mIsSleeping && (SleepClock::GetInstance().Now() >= mWakeUpTime))
+    {
+        mIsSleeping = false;
+
+        // A virtual wake-up time doesn't say when the thread woke up for real, it is when it was found awake
+        mReleaseTime = SleepClock::GetInstance().IsVirtual() ? Clock::now() : mWakeUpTime;
+    }
+
+    return mIsSleeping;
 }
 
 void Thread::Sleep(size_t time)
 {
-	mTimeToWakeup = time;
-	mTimePoint = std::chrono::high_resolution_clock::now();
+    mIsSleeping = true;
+    mWakeUpTime = SleepClock::GetInstance().Now() + chr::seconds(time);
+
+    // Other threads run in the meantime, what was printed so far must come before what they print
+    mOutput.Flush();
 }
 
 void Thread::Barrier()
 {
-	mWaitForChildren = true;
+    // Nothing to wait for, the thread doesn't even have to stop
+    if (mSyncState.load(std::memory_order_acquire) == 0)
+        return;
+
+    mWaitForChildren = true;
+    mOutput.Flush();
+}
+
+void Thread::AttachToParent(Thread* parent)
+{
+    mParent = parent;
+    mParent->mSyncState.fetch_add(1, std::memory_order_relaxed);
+}
+
+bool Thread::Block()
+{
+    if (mJoinedState != nullptr)
+    {
+        if (mJoinedState->Wait(this))
+            return true;
+
+        // The joined thread was done before the wait was registered
+        mJoinedState.reset();
+        mWaitForChildren = false;
+        mWaitKind = WaitKind::READY;
+        return false;
+    }
+
+    // Children finished since the sync started can't see the flag yet, the count tells whether they are all done.
+    // Once the flag is set, the last child to finish is the one that gives the thread back to the scheduler.
+    const size_t childCount = mSyncState.fetch_add(BLOCKED_FLAG, std::memory_order_acq_rel);
+    if (childCount != 0)
+        return true;
+
+    mSyncState.fetch_sub(BLOCKED_FLAG, std::memory_order_relaxed);
+    mWaitForChildren = false;
+    mWaitKind = WaitKind::READY;
+    return false;
+}
+
+Thread* Thread::ReleaseParent()
+{
+    Thread* parent = mParent;
+    mParent = nullptr;
+    if (parent == nullptr)
+        return nullptr;
+
+    // Only the last child of a blocked parent sees the flag with a count of one, the parent is released exactly once
+    if (parent->mSyncState.fetch_sub(1, std::memory_order_acq_rel) != (BLOCKED_FLAG + 1))
+        return nullptr;
+
+    parent->mSyncState.store(0, std::memory_order_relaxed);
+    parent->mWaitForChildren = false;
+    parent->mReleaseTime = Clock::now();
+    return parent;
+}
+
+int Thread::KeepChildHandle(const JoinHandle& handle)
+{
+    mChildHandles.push_back(handle);
+    return static_cast<int>(mChildHandles.size() - 1);
+}
+
+void Thread::Join(int handleID)
+{
+    // The handles aren't saved in checkpoints, waiting for every child is always enough
+    if ((handleID < 0) || (static_cast<size_t>(handleID) >= mChildHandles.size()))
+    {
+        Barrier();
+        return;
+    }
+
+    const JoinHandle& handle = mChildHandles[handleID];
+    assert(handle.IsValid() && (handle.mState != mJoinState));
+
+    // Nothing to wait for, the thread doesn't even have to stop
+    if (handle.IsReady())
+        return;
+
+    mJoinedState = handle.mState;
+    mWaitForChildren = true;
+    mOutput.Flush();
+}
+
+Thread* Thread::CompleteJoin()
+{
+    Thread* joiner = mJoinState->Complete(GetResult());
+    if (joiner == nullptr)
+        return nullptr;
+
+    joiner->mJoinedState.reset();
+    joiner->mWaitForChildren = false;
+    joiner->mReleaseTime = Clock::now();
+    return joiner;
+}
+
+const InterpretedValue& Thread::GetResult() const
+{
+#ifdef USE_COROUTINES
+    if (mCoroutineExecutor != nullptr)
+        return mCoroutineExecutor->GetResult();
+#endif
+
+    return (mClosureExecutor != nullptr) ? mClosureExecutor->GetResult() : mExecutor->GetResult();
+}
+
+void Thread::CountNestedSteps(size_t stepCount)
+{
+    mNestedStepCount += stepCount;
+    if ((mProcess != nullptr) && mProcess->IsOverQuota(mNestedStepCount))
+        throw ThreadStopped{};
+}
+
+void Thread::ResetSchedulingState()
+{
+    // Only a thread that is done with everything, children included, can be reused
+    assert(mFinished && (mParent == nullptr));
+    assert(mSyncState.load(std::memory_order_relaxed) == 0);
+
+    mFinished = false;
+    mWaitForChildren = false;
+    mIsSleeping = false;
+
+    // The handles to what the thread ran before keep the previous outcome
+    mJoinState = std::make_shared<JoinState>();
+    mChildHandles.clear();
+
+    mMetrics = {};
+    mWaitKind = WaitKind::READY;
+    mWaitStart = Clock::now();
+}
+
+void Thread::SaveSchedulingState(CheckpointWriter& writer) const
+{
+    writer.WriteBool(mWaitForChildren);
+
+    // Only the time left to sleep makes sense once restored, the clock of the restoring process is another one
+    const Clock::time_point now = SleepClock::GetInstance().Now();
+    const bool isSleeping = mIsSleeping && (now < mWakeUpTime);
+    writer.WriteBool(isSleeping);
+    writer.WriteUInt(isSleeping ? static_cast<uint64_t>(chr::duration_cast<chr::milliseconds>(mWakeUpTime - now).count()) : 0);
+}
+
+void Thread::SaveExecutionState(CheckpointWriter& writer) const
+{
+#ifdef USE_COROUTINES
+    // The state of a coroutine is in frames laid out by the compiler, the kernel doesn't checkpoint such threads
+    assert(mCoroutineExecutor == nullptr);
+#endif
+
+    writer.WriteBool(mClosureExecutor != nullptr);
+    if (mClosureExecutor != nullptr)
+        mClosureExecutor->Save(writer);
+    else
+        mExecutor->Save(writer);
+}
+
+size_t Thread::GetVersion() const
+{
+#ifdef USE_COROUTINES
+    if (mCoroutineExecutor != nullptr)
+        return mCoroutineExecutor->GetVersion();
+#endif
+
+    return (mClosureExecutor != nullptr) ? mClosureExecutor->GetVersion() : mExecutor->GetVersion();
+}
+
+std::unique_ptr<Thread> Thread::Restore(CheckpointReader& reader, const TosLang::FrontEnd::SymbolTable* symTab, const CompiledProgram* program)
+{
+    const bool waitForChildren = reader.ReadBool();
+    const bool isSleeping = reader.ReadBool();
+    const uint64_t msToWakeUp = reader.ReadUInt();
+
+    std::unique_ptr<Thread> thread;
+    if (reader.ReadBool())
+    {
+        // The thread ran compiled closures, the program must have been compiled again
+        if (program == nullptr)
+        {
+            reader.Fail();
+            return nullptr;
+        }
+
+        ClosureExecutor exec{ program };
+        exec.Load(reader, program);
+        thread = std::make_unique<Thread>(std::move(exec));
+    }
+    else
+    {
+        Executor exec;
+        exec.Load(reader, symTab);
+        thread = std::make_unique<Thread>(std::move(exec));
+    }
+
+    if (reader.HasFailed())
+        return nullptr;
+
+    // A join isn't saved, the handles don't survive the process. A thread that was joining waits on a sync instead.
+    thread->mWaitForChildren = waitForChildren;
+    if (waitForChildren)
+        thread->mWaitKind = WaitKind::BLOCKED;
+
+    if (isSleeping)
+    {
+        thread->mIsSleeping = true;
+        thread->mWakeUpTime = SleepClock::GetInstance().Now() + chr::milliseconds(msToWakeUp);
+        thread->mWaitKind = WaitKind::SLEEPING;
+    }
+
+    return thread;
 }
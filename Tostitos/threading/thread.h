@@ -3,42 +3,174 @@
 
 // TODO: Comments
 
+#include "joinhandle.h"
+#include "outputbuffer.h"
+#include "threadmetrics.h"
+
+#include <atomic>
 #include <chrono>
 #include <memory>
 #include <string>
 #include <vector>
 
+namespace TosLang
+{
+    namespace FrontEnd
+    {
+        class ASTNode;
+        class SymbolTable;
+    }
+}
+
+namespace KernelSpace
+{
+    class Process;
+}
+
 namespace Threading
 {
     namespace impl
     {
+        class CallStack;
+        class CheckpointReader;
+        class CheckpointWriter;
+        class ClosureExecutor;
+        class CompiledFunction;
+        class CompiledProgram;
         class Executor;
+        class InterpretedValue;
+#ifdef USE_COROUTINES
+        class CoroutineExecutor;
+        struct CoroutineFunction;
+#endif
     }
 
+    /*
+    * \struct ThreadStopped
+    * \brief  Thrown by a step that doesn't give the processor back on its own (a call run to completion) once the
+    *         process of the thread used up its steps. It unwinds the step, then the thread finishes.
+    */
+    struct ThreadStopped { };
+
 	class Thread
 	{
+    public:
+        using Clock = std::chrono::high_resolution_clock;
+
 	public:
 		explicit Thread(impl::Executor&& exec);
+		explicit Thread(impl::ClosureExecutor&& exec);
+#ifdef USE_COROUTINES
+        explicit Thread(impl::CoroutineExecutor&& exec);
+#endif
         ~Thread();
 
+        // A finished thread can be given another function to run, it keeps the storage of its executor and output
+        void Reset(const TosLang::FrontEnd::ASTNode* root, const TosLang::FrontEnd::SymbolTable* symTab,
+                   impl::CallStack&& stack);
+        void Reset(const impl::CompiledFunction* fn, std::vector<impl::InterpretedValue>&& args);
+#ifdef USE_COROUTINES
+        void Reset(const impl::CoroutineFunction* fn, std::vector<impl::InterpretedValue>&& args);
+#endif
+
         void ExecuteOne();
+        size_t Execute(size_t quantum);     // Runs until the quantum is used up or the thread stops, returns the steps taken
+
+        // Counts the statements run within a single step by a call that runs to completion. They count toward the
+        // quantum and the step quota like the thread's own steps. Throws ThreadStopped once the quota is used up.
+        void CountNestedSteps(size_t stepCount);
+
 		bool HasFinished() const { return mFinished; }
-		bool IsWaitingForChildren();
+		bool IsWaitingForChildren() const { return mWaitForChildren; }
 		bool IsSleeping();
+        Clock::time_point GetWakeUpTime() const { return mWakeUpTime; }
         
-		Thread* Fork(impl::Executor&& exec);
 		void Sleep(size_t Time);
 		void Barrier();
+
+        // A sync waits for the children that haven't finished yet. Instead of polling them, the parent keeps a count of
+        // its outstanding children and the last one to finish hands it back to the scheduler.
+        void AttachToParent(Thread* parent);
+        Thread* GetParent() const { return mParent; }
+        bool Block();                   // False if the children are all done already, the thread can go on
+        Thread* ReleaseParent();        // Called once finished, returns the parent if it must be scheduled again
+
+        // A join waits for one child alone. The thread keeps the handles of its children, a spawn gives the program the
+        // index of the new one. It blocks like a sync does (see IsWaitingForChildren) and the joined thread hands the
+        // waiting one back to the scheduler once done.
+        JoinHandle GetJoinHandle() const { return JoinHandle{ mJoinState }; }
+        int KeepChildHandle(const JoinHandle& handle);     // Returns the index of the handle
+        void Join(int handleID);        // Waits for all the children if the handle isn't known (e.g. restored from a checkpoint)
+        Thread* CompleteJoin();         // Called once finished, returns the thread joining this one if it must be scheduled again
+
+        impl::OutputBuffer& GetOutput() { return mOutput; }
+
+        // Process the thread belongs to, it runs the process' program and sees its global variables
+        KernelSpace::Process* GetProcess() const { return mProcess; }
+        void SetProcess(KernelSpace::Process* process) { mProcess = process; }
+
+        // Only consistent when read by the host thread running the thread, or while no thread runs
+        const ThreadMetrics& GetMetrics() const { return mMetrics; }
+        void SetThreadID(size_t id) { mMetrics.threadID = id; }
+
+        // Thread being run by the calling host thread, if any
+        static Thread* GetCurrent();
+        static void SetCurrent(Thread* thread);
+
+        // The scheduling state (sleep, sync) is small and changes with time, it is saved apart 
+        // from the execution state which only changes when the thread runs (see GetVersion).
+        void SaveSchedulingState(impl::CheckpointWriter& writer) const;
+        void SaveExecutionState(impl::CheckpointWriter& writer) const;
+        size_t GetVersion() const;
+
+        static std::unique_ptr<Thread> Restore(impl::CheckpointReader& reader,
+                                               const TosLang::FrontEnd::SymbolTable* symTab,
+                                               const impl::CompiledProgram* program);
         
+    private:
+        // What the thread was waiting on since the end of its last turn
+        enum class WaitKind
+        {
+            READY,
+            SLEEPING,
+            BLOCKED,
+        };
+
+    private:
+        void AccountWait(Clock::time_point now);
+#ifdef USE_COROUTINES
+        size_t ExecuteCoroutine(size_t quantum);
+#endif
+        void ResetSchedulingState();
+        const impl::InterpretedValue& GetResult() const;
+
     private:
         bool mFinished;
         bool mWaitForChildren;
-        size_t mTimeToWakeup;
-        std::chrono::high_resolution_clock::time_point mTimePoint;
+        bool mIsSleeping;
+        Clock::time_point mWakeUpTime;             // Time of the sleep clock
+        size_t mNestedStepCount;                    // Statements run within the current step (see CountNestedSteps)
 
         std::unique_ptr<impl::Executor> mExecutor;
+        std::unique_ptr<impl::ClosureExecutor> mClosureExecutor;
+#ifdef USE_COROUTINES
+        std::unique_ptr<impl::CoroutineExecutor> mCoroutineExecutor;
+#endif
+
+        Thread* mParent;                            // Thread that spawned this one, until this one finishes
+        std::atomic<size_t> mSyncState;             // Number of outstanding children, plus a flag when blocked on them
+
+        std::shared_ptr<impl::JoinState> mJoinState;    // Outcome of this thread, shared with its join handles
+        std::shared_ptr<impl::JoinState> mJoinedState;  // Outcome of the thread this one is joining, if any
+        std::vector<JoinHandle> mChildHandles;          // Handles of the threads it spawned, indexed by the program's handles
+
+        impl::OutputBuffer mOutput;
+        KernelSpace::Process* mProcess;
 
-        std::vector<std::unique_ptr<Thread>> mChildren;
+        ThreadMetrics mMetrics;
+        WaitKind mWaitKind;
+        Clock::time_point mWaitStart;               // End of the last turn
+        Clock::time_point mReleaseTime;             // When the sleep ended or the last child released the thread from its sync
 	};
 }
 
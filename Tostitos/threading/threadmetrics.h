@@ -0,0 +1,40 @@
+#ifndef THREAD_METRICS_H__TOSTITOS
+#define THREAD_METRICS_H__TOSTITOS
+
+#include <chrono>
+#include <cstddef>
+#include <cstdint>
+
+namespace Threading
+{
+    /*
+    * \struct ThreadMetrics
+    * \brief  What a thread did and where its time went. A thread is always either running, waiting in a ready
+    *         queue, sleeping or blocked on a sync, so the four times add up to the thread's lifetime.
+    */
+    struct ThreadMetrics
+    {
+        using Duration = std::chrono::high_resolution_clock::duration;
+
+        size_t threadID = 0;            /*!< Number of the thread, in the order the threads were created */
+        Duration cpuTime{};             /*!< Time spent executing */
+        uint64_t stepCount = 0;         /*!< Nodes (AST walker) or statements (closures) executed */
+        uint64_t switchCount = 0;       /*!< Number of times the thread was given the processor */
+        Duration readyTime{};           /*!< Time spent waiting for a turn while able to run */
+        Duration sleepTime{};           /*!< Time spent sleeping */
+        Duration blockedTime{};         /*!< Time spent waiting on children in a sync */
+        Duration lastReadyLatency{};    /*!< Wait before the last turn, between being able to run and running */
+
+        void Add(const ThreadMetrics& other)
+        {
+            cpuTime += other.cpuTime;
+            stepCount += other.stepCount;
+            switchCount += other.switchCount;
+            readyTime += other.readyTime;
+            sleepTime += other.sleepTime;
+            blockedTime += other.blockedTime;
+        }
+    };
+}
+
+#endif // THREAD_METRICS_H__TOSTITOS
@@ -1,5 +1,6 @@
 #include "threadutil.h"
 
+#include "closureexecutor.h"
 #include "executor.h"
 #include "thread.h"
 
@@ -15,24 +16,23 @@ using namespace TosLang::FrontEnd;
 
 namespace Threading
 {
-    void CreateThread(const ASTNode* root, const SymbolTable* symTab, std::function<void(InterpretedValue)>&& callback)
-    {
-        // Create a call stack for the main thread then push the (empty for now) global 
-        // frame onto it. This frame will contains all global scope level informations 
-        // that are available to all the functions in the program. This make it the only
-        // frame that can be accessed by any other.
-        CallStack cStack;
-        cStack.PushFrame({});
-    
-        // Create the execution agent
-        Executor exec{ root, symTab, std::move(cStack), std::move(callback) };
-    
-        // Create the thread on which the execution agent will run
-        auto thread = std::make_unique<Thread>(std::move(exec));
-    
-        // Give the thread to the kernel so it can be executed
-        Kernel::GetInstance().AddThread(std::move(thread));
+    int CreateThread(const ASTNode* root, const SymbolTable* symTab, CallStack&& stack)
+    {
+        // The kernel runs the function on a new thread, the call stack was already prepared by the spawning thread
+        return Kernel::GetInstance().SpawnThread(root, symTab, std::move(stack));
+    }
+
+    int CreateThread(const CompiledFunction* fn, std::vector<InterpretedValue>&& args)
+    {
+        return Kernel::GetInstance().SpawnThread(fn, std::move(args));
+    }
+
+#ifdef USE_COROUTINES
+    int CreateThread(const CoroutineFunction* fn, std::vector<InterpretedValue>&& args)
+    {
+        return Kernel::GetInstance().SpawnThread(fn, std::move(args));
     }
+#endif
         
     void CurrentThreadSleepFor(size_t nbSecs)
     {
@@ -43,4 +43,22 @@ namespace Threading
     {
         Kernel::GetInstance().Sync();
     }
+
+    void CurrentThreadJoin(int handleID)
+    {
+        Kernel::GetInstance().Join(handleID);
+    }
+
+    void CurrentThreadCountSteps(size_t stepCount)
+    {
+        // An executor can also run on its own, outside of any thread
+        Thread* thread = Thread::GetCurrent();
+        if (thread != nullptr)
+            thread->CountNestedSteps(stepCount);
+    }
+
+    OutputBuffer& CurrentThreadOutput()
+    {
+        return Kernel::GetInstance().GetCurrentThreadOutput();
+    }
 }
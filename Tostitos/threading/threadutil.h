@@ -1,7 +1,7 @@
 #ifndef THREAD_UTIL_H__TOSTITOS
 #define THREAD_UTIL_H__TOSTITOS
 
-#include <functional>
+#include <vector>
 
 #if defined(__unix__) || defined(__APPLE__)
 #include <cstddef>
@@ -22,14 +22,28 @@ namespace Threading
 {
     namespace impl
     {
+        class CallStack;
+        class CompiledFunction;
         class InterpretedValue;
+#ifdef USE_COROUTINES
+        struct CoroutineFunction;
+#endif
+        class OutputBuffer;
     }
 
-    void CreateThread(const TosLang::FrontEnd::ASTNode* root,
-                      const TosLang::FrontEnd::SymbolTable* symTab,
-                      std::function<void(impl::InterpretedValue)>&& fn);
+    // Returns the handle of the new thread, only the spawning thread can join it
+    int CreateThread(const TosLang::FrontEnd::ASTNode* root,
+                     const TosLang::FrontEnd::SymbolTable* symTab,
+                     impl::CallStack&& stack);
+    int CreateThread(const impl::CompiledFunction* fn, std::vector<impl::InterpretedValue>&& args);
+#ifdef USE_COROUTINES
+    int CreateThread(const impl::CoroutineFunction* fn, std::vector<impl::InterpretedValue>&& args);
+#endif
     void CurrentThreadSleepFor(size_t nbSecs);
     void CurrentThreadSync();
+    void CurrentThreadJoin(int handleID);
+    void CurrentThreadCountSteps(size_t stepCount);
+    impl::OutputBuffer& CurrentThreadOutput();
 }
 
 #endif // THREAD_UTIL_H__TOSTITOS
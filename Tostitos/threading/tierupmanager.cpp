@@ -0,0 +1,243 @@
+#include "tierupmanager.h"
+
+#include "../../TosLang/AST/declarations.h"
+#include "../../TosLang/Sema/purityanalysis.h"
+#include "../../TosLang/Sema/symboltable.h"
+#include "../../TosLang/SSA/cfgbuilder.h"
+
+#include <algorithm>
+#include <cassert>
+#include <chrono>
+#include <unordered_set>
+
+using namespace Threading::impl;
+using namespace TosLang::FrontEnd;
+
+// High enough for the code run only a few times to stay in the executor, where it starts right away
+static const size_t DEFAULT_HOTNESS_THRESHOLD = 500;
+
+static bool IsScalarType(const TosLang::Common::Type type)
+{
+    return (type == TosLang::Common::Type::BOOL) || (type == TosLang::Common::Type::NUMBER);
+}
+
+// Gathers the functions called and the loops found in a subtree.
+// Returns false if the subtree uses something other than booleans and integers.
+static bool CollectScalarCode(const ASTNode* node, const SymbolTable* symTab, std::vector<const ASTNode*>& callees, std::vector<const ASTNode*>& loops)
+{
+    if (node == nullptr)
+        return true;
+
+    switch (node->GetKind())
+    {
+    case ASTNode::NodeKind::ARRAY_EXPR:
+    case ASTNode::NodeKind::INDEX_EXPR:
+    case ASTNode::NodeKind::STRING_EXPR:
+        return false;
+    case ASTNode::NodeKind::VAR_DECL:
+        if (!IsScalarType(static_cast<const VarDecl*>(node)->GetVarType()))
+            return false;
+        break;
+    case ASTNode::NodeKind::CALL_EXPR:
+        callees.push_back(symTab->GetFunctionDecl(node));
+        break;
+    case ASTNode::NodeKind::WHILE_STMT:
+        loops.push_back(node);
+        break;
+    default:
+        break;
+    }
+
+    for (const auto& child : node->GetChildrenNodes())
+    {
+        if (!CollectScalarCode(child.get(), symTab, callees, loops))
+            return false;
+    }
+
+    return true;
+}
+
+TierUpManager::TierUpManager()
+    : mEnabled{ true }, mHotnessThreshold{ DEFAULT_HOTNESS_THRESHOLD }, mCompiledCallCount{ 0 }, mFunctions{}, mLoopOwners{} { }
+
+TierUpManager& TierUpManager::GetInstance()
+{
+    static TierUpManager Instance;
+    return Instance;
+}
+
+void TierUpManager::Reset()
+{
+    // Destroying the future of a compilation launched asynchronously waits for it to be done
+    mFunctions.clear();
+    mLoopOwners.clear();
+    mCompiledCallCount = 0;
+}
+
+void TierUpManager::RegisterCandidates(const ASTNode* root, const std::shared_ptr<SymbolTable>& symTab, const PurityAnalysis& purity)
+{
+    std::unordered_map<const ASTNode*, std::vector<const ASTNode*>> fnLoops;
+    for (const auto& decl : root->GetChildrenNodes())
+    {
+        if ((decl->GetKind() != ASTNode::NodeKind::FUNCTION_DECL) || !purity.IsPure(decl.get()))
+            continue;
+
+        const FunctionDecl* fDecl = static_cast<const FunctionDecl*>(decl.get());
+        if (!IsScalarType(fDecl->GetReturnType()))
+            continue;
+
+        bool isCandidate = true;
+        for (const auto& param : fDecl->GetParametersDecl()->GetParameters())
+            isCandidate &= IsScalarType(static_cast<const VarDecl*>(param.get())->GetVarType());
+
+        std::vector<const ASTNode*> callees;
+        std::vector<const ASTNode*> loops;
+        if (isCandidate && CollectScalarCode(fDecl->GetBody(), symTab.get(), callees, loops))
+        {
+            HotFunction& fn = mFunctions[fDecl];
+            fn.callees = std::move(callees);
+            fn.symTab = symTab;
+            fnLoops[fDecl] = std::move(loops);
+        }
+    }
+
+    // A function can only be compiled along with the functions it calls, so those must be candidates too
+    bool changed = true;
+    while (changed)
+    {
+        changed = false;
+        for (auto fnIt = mFunctions.begin(); fnIt != mFunctions.end();)
+        {
+            const auto& callees = fnIt->second.callees;
+            const bool callsNonCandidate = std::any_of(callees.begin(), callees.end(),
+                                                       [this](const ASTNode* callee) { return mFunctions.find(callee) == mFunctions.end(); });
+            if (callsNonCandidate)
+            {
+                fnIt = mFunctions.erase(fnIt);
+                changed = true;
+            }
+            else
+            {
+                ++fnIt;
+            }
+        }
+    }
+
+    for (const auto& loops : fnLoops)
+    {
+        if (mFunctions.find(loops.first) == mFunctions.end())
+            continue;
+
+        for (const ASTNode* loop : loops.second)
+            mLoopOwners[loop] = loops.first;
+    }
+}
+
+bool TierUpManager::TryCallCompiled(const ASTNode* fnDecl, const CallArgs& args, InterpretedValue& result)
+{
+    if (!mEnabled)
+        return false;
+
+    auto fnIt = mFunctions.find(fnDecl);
+    if (fnIt == mFunctions.end())
+        return false;
+
+    HotFunction& fn = fnIt->second;
+    if (fn.code == nullptr)
+    {
+        IncreaseHotness(fnDecl, fn);
+        if (fn.code == nullptr)
+            return false;
+    }
+
+    // Booleans are 0 or 1 in the SSA interpreter's registers
+    std::vector<int> intArgs;
+    intArgs.reserve(args.size());
+    for (const InterpretedValue& arg : args)
+    {
+        assert((arg.GetType() == InterpretedValue::ValueType::INTEGER) || (arg.GetType() == InterpretedValue::ValueType::BOOLEAN));
+        intArgs.push_back(arg.GetType() == InterpretedValue::ValueType::BOOLEAN ? arg.GetBoolVal() : arg.GetIntVal());
+    }
+
+    const FunctionDecl* fDecl = static_cast<const FunctionDecl*>(fnDecl);
+    const int returnValue = fn.code->interpreter.Call(fDecl->GetFunctionName(), intArgs);
+    if (fDecl->GetReturnType() == TosLang::Common::Type::BOOL)
+        result = InterpretedValue{ returnValue != 0 };
+    else
+        result = InterpretedValue{ returnValue };
+
+    ++mCompiledCallCount;
+    return true;
+}
+
+void TierUpManager::RecordBackEdge(const ASTNode* loop)
+{
+    if (!mEnabled)
+        return;
+
+    auto ownerIt = mLoopOwners.find(loop);
+    if (ownerIt == mLoopOwners.end())
+        return;
+
+    HotFunction& fn = mFunctions.at(ownerIt->second);
+    if (fn.code == nullptr)
+        IncreaseHotness(ownerIt->second, fn);
+}
+
+bool TierUpManager::IsCompiled(const ASTNode* fnDecl)
+{
+    auto fnIt = mFunctions.find(fnDecl);
+    if (fnIt == mFunctions.end())
+        return false;
+
+    PollCompilation(fnIt->second);
+    return fnIt->second.code != nullptr;
+}
+
+void TierUpManager::IncreaseHotness(const ASTNode* fnDecl, HotFunction& fn)
+{
+    ++fn.hotness;
+
+    if (fn.compilation.valid())
+        PollCompilation(fn);
+    else if (!fn.compilationFailed && (fn.hotness >= mHotnessThreshold))
+        StartCompilation(fnDecl, fn);
+}
+
+void TierUpManager::StartCompilation(const ASTNode* fnDecl, HotFunction& fn)
+{
+    // The compiled code is self-contained: it holds the function and everything it calls, directly or not
+    std::vector<const ASTNode*> fnDecls{ fnDecl };
+    std::unordered_set<const ASTNode*> visited{ fnDecl };
+    for (size_t iFn = 0; iFn < fnDecls.size(); ++iFn)
+    {
+        for (const ASTNode* callee : mFunctions.at(fnDecls[iFn]).callees)
+        {
+            if (visited.insert(callee).second)
+                fnDecls.push_back(callee);
+        }
+    }
+
+    // The AST and the symbol table are only read while the executor keeps going
+    std::shared_ptr<SymbolTable> symTab = fn.symTab;
+    fn.compilation = std::async(std::launch::async, [fnDecls, symTab]()
+    {
+        std::unique_ptr<CompiledCode> code = std::make_unique<CompiledCode>();
+
+        TosLang::BackEnd::CFGBuilder cfgBuilder;
+        code->module = cfgBuilder.Run(fnDecls, symTab);
+        if (!code->interpreter.Load(*code->module))
+            return std::unique_ptr<CompiledCode>{};
+
+        return code;
+    });
+}
+
+void TierUpManager::PollCompilation(HotFunction& fn)
+{
+    if (!fn.compilation.valid() || (fn.compilation.wait_for(std::chrono::seconds{ 0 }) != std::future_status::ready))
+        return;
+
+    fn.code = fn.compilation.get();
+    fn.compilationFailed = (fn.code == nullptr);
+}
@@ -0,0 +1,136 @@
+#ifndef TIER_UP_MANAGER_H__TOSTITOS
+#define TIER_UP_MANAGER_H__TOSTITOS
+
+#include "functioncache.h"
+
+#include "../../TosLang/SSA/ssainterpreter.h"
+
+#include <future>
+#include <memory>
+#include <unordered_map>
+#include <vector>
+
+namespace TosLang
+{
+    namespace FrontEnd
+    {
+        class ASTNode;
+        class PurityAnalysis;
+        class SymbolTable;
+    }
+}
+
+namespace Threading
+{
+    namespace impl
+    {
+        /*
+        * \struct CompiledCode
+        * \brief  Hot function along with the functions it calls, lowered to SSA form and ready to be executed
+        */
+        struct CompiledCode
+        {
+            std::unique_ptr<TosLang::BackEnd::SSAModule> module;    /*!< CFGs of the functions */
+            TosLang::BackEnd::SSAInterpreter interpreter;           /*!< Executes the module */
+        };
+
+        /*
+        * \class TierUpManager
+        * \brief Counts the invocations and the loop back-edges of the functions run by the executor. Once a function
+        *        crosses the hotness threshold, it is compiled to SSA form on a background thread while the executor
+        *        keeps walking its AST. The calls made after the compilation is done run the compiled code to completion.
+        *        Only the pure functions dealing with booleans and integers are candidates: they can't yield to another
+        *        thread, and their arguments and return value fit in the SSA interpreter's registers.
+        *        There's no on-stack replacement: a function spinning in a hot loop only gets faster on its next call.
+        *        Apart from the hand-off of the compiled code, the counters and candidates aren't synchronized: the
+        *        executor feeding them only ever runs on one host thread (see Kernel::PrepareWorkers).
+        */
+        class TierUpManager
+        {
+        public:
+            static TierUpManager& GetInstance();
+
+        public:
+            /*
+            * \fn           Reset
+            * \brief        Forgets every candidate function along with their counters and compiled code.
+            *               Compilations still running are waited for since they use the previous program's AST.
+            */
+            void Reset();
+
+            /*
+            * \fn           RegisterCandidates
+            * \brief        Finds the functions of a program that can be compiled, along with those of the programs already registered
+            * \param root   Root of the program's AST. It must outlive the manager or the next reset.
+            * \param symTab Symbol table associated with the given AST
+            * \param purity Purity analysis already run on the program
+            */
+            void RegisterCandidates(const TosLang::FrontEnd::ASTNode* root,
+                                    const std::shared_ptr<TosLang::FrontEnd::SymbolTable>& symTab,
+                                    const TosLang::FrontEnd::PurityAnalysis& purity);
+
+            /*
+            * \fn           TryCallCompiled
+            * \brief        Counts an invocation of a function. If the function has been compiled, it is called.
+            * \param fnDecl Function being called
+            * \param args   Values of the call's arguments
+            * \param result Value returned by the compiled function, if it was called
+            * \return       True if the compiled function was called, else false
+            */
+            bool TryCallCompiled(const TosLang::FrontEnd::ASTNode* fnDecl, const CallArgs& args, InterpretedValue& result);
+
+            /*
+            * \fn           RecordBackEdge
+            * \brief        Counts an iteration of a loop towards the hotness of the function containing it
+            * \param loop   While statement about to run its body again
+            */
+            void RecordBackEdge(const TosLang::FrontEnd::ASTNode* loop);
+
+            /*
+            * \fn           IsCompiled
+            * \brief        Indicates if the calls to a function now run its compiled code
+            * \param fnDecl Function declaration
+            * \return       True if the function's compilation is done, else false
+            */
+            bool IsCompiled(const TosLang::FrontEnd::ASTNode* fnDecl);
+
+        public:
+            bool IsEnabled() const { return mEnabled; }
+            void SetEnabled(bool enabled) { mEnabled = enabled; }
+            size_t GetHotnessThreshold() const { return mHotnessThreshold; }
+            void SetHotnessThreshold(size_t threshold) { mHotnessThreshold = threshold; }
+
+            size_t GetCompiledCallCount() const { return mCompiledCallCount; }
+
+        private:
+            TierUpManager();
+            TierUpManager(const TierUpManager&) = delete;
+            void operator=(const TierUpManager&) = delete;
+
+        private:
+            struct HotFunction
+            {
+                std::vector<const TosLang::FrontEnd::ASTNode*> callees;     /*!< Functions called directly */
+                std::shared_ptr<TosLang::FrontEnd::SymbolTable> symTab;     /*!< Symbol table of the function's program */
+                size_t hotness = 0;                                         /*!< Invocations and back-edges so far */
+                std::future<std::unique_ptr<CompiledCode>> compilation;    /*!< Compilation in progress, if any */
+                std::unique_ptr<CompiledCode> code;                         /*!< Compiled code, once it is ready */
+                bool compilationFailed = false;
+            };
+
+        private:
+            void IncreaseHotness(const TosLang::FrontEnd::ASTNode* fnDecl, HotFunction& fn);
+            void StartCompilation(const TosLang::FrontEnd::ASTNode* fnDecl, HotFunction& fn);
+            void PollCompilation(HotFunction& fn);
+
+        private:
+            bool mEnabled;                  /*!< Opt-out switch. When disabled, nothing is counted nor compiled */
+            size_t mHotnessThreshold;       /*!< Invocations and back-edges a function needs before being compiled */
+            size_t mCompiledCallCount;      /*!< Calls that ran compiled code */
+            std::unordered_map<const TosLang::FrontEnd::ASTNode*, HotFunction> mFunctions;
+            std::unordered_map<const TosLang::FrontEnd::ASTNode*, const TosLang::FrontEnd::ASTNode*> mLoopOwners;  /*!< Function containing each loop */
+        };
+    }   // namespace impl
+}   // namespace Threading
+
+#endif // TIER_UP_MANAGER_H__TOSTITOS
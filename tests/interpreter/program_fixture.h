@@ -0,0 +1,99 @@
+#ifndef PROGRAM_FIXTURE_H__TOSTITOS
+#define PROGRAM_FIXTURE_H__TOSTITOS
+
+#include <boost/test/unit_test.hpp>
+
+#include <fstream>
+#include <iostream>
+#include <regex>
+#include <sstream>
+#include <string>
+#include <vector>
+
+/*
+* \struct ProgramFixture
+* \brief  Fixture used to run whole TosLang programs and compare what they print with the
+*         '// EXPECTED: ' lines they hold, the same way the interpreter test runner does
+*/
+struct ProgramFixture
+{
+    /*
+    * \fn    ProgramFixture
+    * \brief Constructor. Redirect stdout to its internal buffer to capture what the programs print
+    */
+    ProgramFixture()
+    {
+        oldBuffer = std::cout.rdbuf();
+        std::cout.rdbuf(buffer.rdbuf());
+    }
+
+    /*
+    * \fn    ~ProgramFixture
+    * \brief Destructor. Put stdout back in its original state
+    */
+    ~ProgramFixture()
+    {
+        std::cout.rdbuf(oldBuffer);
+    }
+
+    /*
+    * \fn               GetExpectedOutput
+    * \brief            Get the lines a program is expected to print
+    * \param filename   Name of a file containing a TosLang program
+    * \return           Expected lines, in order
+    */
+    std::vector<std::string> GetExpectedOutput(const std::string& filename)
+    {
+        std::ifstream programStream(filename);
+        BOOST_REQUIRE(programStream.is_open());
+
+        const std::regex expectedRegex{ "EXPECTED: (.*)" };
+        std::vector<std::string> expectedLines;
+        std::string line;
+        std::smatch match;
+        while (std::getline(programStream, line))
+        {
+            if (std::regex_search(line, match, expectedRegex))
+                expectedLines.push_back(match[1]);
+        }
+
+        return expectedLines;
+    }
+
+    /*
+    * \fn    GetOutput
+    * \brief Get the lines printed since the last call
+    * \return Printed lines
+    */
+    std::vector<std::string> GetOutput()
+    {
+        std::cout.flush();
+
+        std::vector<std::string> lines;
+        std::string line;
+        while (std::getline(buffer, line))
+            lines.push_back(line);
+
+        buffer.str("");
+        buffer.clear();
+        return lines;
+    }
+
+    /*
+    * \fn               CheckOutput
+    * \brief            Checks that what was printed matches the expected lines of a program
+    * \param filename   Name of a file containing a TosLang program
+    */
+    void CheckOutput(const std::string& filename)
+    {
+        const std::vector<std::string> expectedLines = GetExpectedOutput(filename);
+        const std::vector<std::string> lines = GetOutput();
+        BOOST_REQUIRE(!expectedLines.empty());
+        BOOST_CHECK_EQUAL_COLLECTIONS(lines.begin(), lines.end(), expectedLines.begin(), expectedLines.end());
+    }
+
+    std::stringstream buffer;       /*!< Buffer in which the programs print during testing */
+    std::streambuf* oldBuffer;      /*!< Original stdout buffer */
+};
+
+#endif // PROGRAM_FIXTURE_H__TOSTITOS
@@ -0,0 +1,40 @@
+#ifdef STAND_ALONE
+#   define BOOST_TEST_MODULE Main
+#else
+#ifndef _WIN32
+#   define BOOST_TEST_MODULE SSAProgramTests
+#endif
+#endif
+
+#include <boost/test/unit_test.hpp>
+
+#include "program_fixture.h"
+
+#include "Execution/interpreter.h"
+
+BOOST_FIXTURE_TEST_SUITE( SSAProgramTestSuite, ProgramFixture )
+
+BOOST_AUTO_TEST_CASE( FibProgram )
+{
+    // Both functions are lowered, fibRec adding up the results of two calls
+    Execution::Interpreter interpreter;
+    BOOST_REQUIRE(interpreter.RunSSA("../programs/fib.tos"));
+    CheckOutput("../programs/fib.tos");
+}
+
+BOOST_AUTO_TEST_CASE( GCDProgram )
+{
+    Execution::Interpreter interpreter;
+    BOOST_REQUIRE(interpreter.RunSSA("../programs/gcd.tos"));
+    CheckOutput("../programs/gcd.tos");
+}
+
+BOOST_AUTO_TEST_CASE( HelloWorldProgram )
+{
+    // The string literal is carried by the print instruction
+    Execution::Interpreter interpreter;
+    BOOST_REQUIRE(interpreter.RunSSA("../programs/hello_world.tos"));
+    CheckOutput("../programs/hello_world.tos");
+}
+
+BOOST_AUTO_TEST_SUITE_END()
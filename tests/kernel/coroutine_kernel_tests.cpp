@@ -0,0 +1,86 @@
+#ifdef STAND_ALONE
+#   define BOOST_TEST_MODULE Main
+#else
+#ifndef _WIN32
+#   define BOOST_TEST_MODULE CoroutineKernelTests
+#endif
+#endif
+
+// The coroutine tier is only there when the kernel is built with it
+#ifdef USE_COROUTINES
+
+#include <boost/test/unit_test.hpp>
+
+#include "kernel_fixture.h"
+
+#include "threading/sleepclock.h"
+
+#include <chrono>
+
+using namespace Threading;
+
+BOOST_FIXTURE_TEST_SUITE( CoroutineKernelTestSuite, KernelFixture )
+
+BOOST_AUTO_TEST_CASE( SyncWaitsForChildrenInCoroutines )
+{
+    kernel.SetExecutionTier(Kernel::ExecutionTier::COROUTINES);
+    BOOST_REQUIRE(kernel.RunProgram("../kernel/programs/spawn_sync.tos"));
+    CheckOutput("../kernel/programs/spawn_sync.tos");
+}
+
+BOOST_AUTO_TEST_CASE( VirtualSleepInCoroutines )
+{
+    kernel.SetVirtualTime(true);
+    kernel.SetExecutionTier(Kernel::ExecutionTier::COROUTINES);
+
+    // The coroutines suspend at every sleep, only the virtual clock sees the 30 seconds go by
+    const auto start = std::chrono::steady_clock::now();
+    BOOST_REQUIRE(kernel.RunProgram("../kernel/programs/virtual_sleep.tos"));
+    BOOST_REQUIRE(std::chrono::steady_clock::now() - start < std::chrono::seconds(10));
+    CheckOutput("../kernel/programs/virtual_sleep.tos");
+    BOOST_REQUIRE(SleepClock::GetInstance().Now() == SleepClock::Clock::time_point{ std::chrono::seconds(30) });
+}
+
+BOOST_AUTO_TEST_CASE( JoinWaitsForOneChildInCoroutines )
+{
+    kernel.SetVirtualTime(true);
+    kernel.SetExecutionTier(Kernel::ExecutionTier::COROUTINES);
+
+    // The coroutine of the main thread suspends at each join, the slow child keeps sleeping past the first one
+    BOOST_REQUIRE(kernel.RunProgram("../kernel/programs/join.tos"));
+    CheckOutput("../kernel/programs/join.tos");
+    BOOST_REQUIRE(SleepClock::GetInstance().Now() == SleepClock::Clock::time_point{ std::chrono::seconds(5) });
+}
+
+BOOST_AUTO_TEST_CASE( IndexOutOfBoundsEndsThreadInCoroutines )
+{
+    // The error goes up through the coroutine frames of the thread, its parent goes on after the sync
+    kernel.SetExecutionTier(Kernel::ExecutionTier::COROUTINES);
+    BOOST_REQUIRE(kernel.RunProgram("../kernel/programs/index_out_of_bounds.tos"));
+    CheckOutput("../kernel/programs/index_out_of_bounds.tos");
+    BOOST_REQUIRE(errorBuffer.str().find("RUNTIME ERROR: Index out of bounds") != std::string::npos);
+}
+
+BOOST_AUTO_TEST_CASE( StepQuotaStopsLoopInHelperInCoroutines )
+{
+    // The functions that can't yield run as plain calls, their statements count toward the quota all the same
+    CheckStepQuota("../kernel/programs/step_quota_helper.tos", Kernel::ExecutionTier::COROUTINES);
+    ResetKernel();
+    CheckStepQuota("../kernel/programs/step_quota_nested_call.tos", Kernel::ExecutionTier::COROUTINES);
+}
+
+BOOST_AUTO_TEST_CASE( StepQuotaStopsProcessInCoroutines )
+{
+    CheckStepQuota("../kernel/programs/step_quota.tos", Kernel::ExecutionTier::COROUTINES);
+}
+
+BOOST_AUTO_TEST_CASE( StoppedProcessLeavesOthersRunningInCoroutines )
+{
+    CheckStoppedProcess("../kernel/programs/step_quota.tos", Kernel::ExecutionTier::COROUTINES);
+    ResetKernel();
+    CheckStoppedProcess("../kernel/programs/step_quota_helper.tos", Kernel::ExecutionTier::COROUTINES);
+}
+
+BOOST_AUTO_TEST_SUITE_END()
+
+#endif // USE_COROUTINES
@@ -0,0 +1,114 @@
+#ifndef KERNEL_FIXTURE_H__TOSTITOS
+#define KERNEL_FIXTURE_H__TOSTITOS
+
+#include "../interpreter/program_fixture.h"
+
+#include "kernel/kernel.h"
+#include "threading/outputbuffer.h"
+
+#include <algorithm>
+#include <iostream>
+#include <iterator>
+#include <sstream>
+#include <string>
+#include <vector>
+
+using namespace KernelSpace;
+
+/*
+* \struct KernelFixture
+* \brief  Fixture used to run TosLang programs in the kernel. The kernel is shared by every test,
+*         each of them starts from its default settings.
+*/
+struct KernelFixture : ProgramFixture
+{
+    /*
+    * \fn    KernelFixture
+    * \brief Constructor. Puts the kernel back to its default settings and redirects stderr to an internal buffer.
+    */
+    KernelFixture() : kernel(Kernel::GetInstance())
+    {
+        ResetKernel();
+
+        oldErrorBuffer = std::cerr.rdbuf();
+        std::cerr.rdbuf(errorBuffer.rdbuf());
+    }
+
+    /*
+    * \fn    ~KernelFixture
+    * \brief Destructor. Put stderr back in its original state and the kernel to its default settings.
+    */
+    ~KernelFixture()
+    {
+        std::cerr.rdbuf(oldErrorBuffer);
+        ResetKernel();
+    }
+
+    /*
+    * \fn    ResetKernel
+    * \brief Puts the kernel back to its default settings
+    */
+    void ResetKernel()
+    {
+        kernel.SetExecutionTier(Kernel::ExecutionTier::AST_WALKER);
+        kernel.SetWorkerCount(1);
+        kernel.SetQuantum(Kernel::DEFAULT_QUANTUM);
+        kernel.SetVirtualTime(false);
+        kernel.SetCheckpointing("", 0);
+        kernel.SetOutputFlushSize(Threading::impl::OutputBuffer::DEFAULT_FLUSH_SIZE);
+    }
+
+    /*
+    * \fn                   CheckStepQuota
+    * \brief                Runs a program that never ends with a step quota, which must stop it
+    * \param programName    Program to run
+    * \param tier           Tier the program runs in
+    */
+    void CheckStepQuota(const std::string& programName, Kernel::ExecutionTier tier)
+    {
+        ProcessQuotas quotas;
+        quotas.maxSteps = 1000;
+
+        kernel.SetExecutionTier(tier);
+        const Process* process = kernel.LoadProcess(programName, quotas);
+        BOOST_REQUIRE(process != nullptr);
+        kernel.RunProcesses();
+
+        CheckOutput(programName);
+        BOOST_REQUIRE(process->IsStopped());
+        BOOST_REQUIRE(process->GetStepCount() >= quotas.maxSteps);
+    }
+
+    /*
+    * \fn                   CheckStoppedProcess
+    * \brief                Runs a program that never ends with a step quota next to one that ends, which must run
+    *                       to the end regardless. The stopped program only prints 1 before it loops.
+    * \param programName    Program to stop
+    * \param tier           Tier the programs run in
+    */
+    void CheckStoppedProcess(const std::string& programName, Kernel::ExecutionTier tier)
+    {
+        ProcessQuotas quotas;
+        quotas.maxSteps = 1000;
+
+        kernel.SetExecutionTier(tier);
+        BOOST_REQUIRE(kernel.LoadProcess(programName, quotas) != nullptr);
+        BOOST_REQUIRE(kernel.LoadProcess("../kernel/programs/hello_kernel.tos") != nullptr);
+        kernel.RunProcesses();
+
+        // The processes' output is interleaved, each of them printed all of its lines in order
+        const std::vector<std::string> lines = GetOutput();
+        std::vector<std::string> helloLines;
+        std::copy_if(lines.begin(), lines.end(), std::back_inserter(helloLines), [](const std::string& line) { return line != "1"; });
+
+        const std::vector<std::string> expectedLines = GetExpectedOutput("../kernel/programs/hello_kernel.tos");
+        BOOST_REQUIRE_EQUAL(lines.size(), expectedLines.size() + 1);
+        BOOST_CHECK_EQUAL_COLLECTIONS(helloLines.begin(), helloLines.end(), expectedLines.begin(), expectedLines.end());
+    }
+
+    Kernel& kernel;                         /*!< Kernel running the programs */
+    std::stringstream errorBuffer;          /*!< Buffer in which to put error messages during testing */
+    std::streambuf* oldErrorBuffer;         /*!< Original stderr buffer */
+};
+
+#endif // KERNEL_FIXTURE_H__TOSTITOS
@@ -0,0 +1,234 @@
+#ifdef STAND_ALONE
+#   define BOOST_TEST_MODULE Main
+#else
+#ifndef _WIN32
+#   define BOOST_TEST_MODULE KernelTests
+#endif
+#endif
+
+#include <boost/test/unit_test.hpp>
+
+#include "kernel_fixture.h"
+
+#include "threading/sleepclock.h"
+
+#include <algorithm>
+#include <chrono>
+#include <cstdio>
+#include <string>
+#include <vector>
+
+using namespace Threading;
+
+/*
+* \fn               CheckResumedRun
+* \brief            Stops a program with its step quota while it is checkpointed, then resumes it from its last checkpoint
+* \param fixture    Test fixture holding the kernel
+* \param tier       Tier the program runs in
+*/
+void CheckResumedRun(KernelFixture& fixture, Kernel::ExecutionTier tier)
+{
+    const std::string programName = "../kernel/programs/checkpoint.tos";
+    const std::string checkpointName = "kernel_tests.ckpt";
+    const std::vector<std::string> expectedLines = fixture.GetExpectedOutput(programName);
+
+    ProcessQuotas quotas;
+    quotas.maxSteps = 25;
+
+    fixture.kernel.SetExecutionTier(tier);
+    fixture.kernel.SetCheckpointing(checkpointName, 10);
+    BOOST_REQUIRE(fixture.kernel.LoadProcess(programName, quotas) != nullptr);
+    fixture.kernel.RunProcesses();
+
+    // The program was stopped before it was done, it printed the beginning of its output at most
+    const std::vector<std::string> stoppedLines = fixture.GetOutput();
+    BOOST_REQUIRE(stoppedLines.size() < expectedLines.size());
+    BOOST_REQUIRE(std::equal(stoppedLines.begin(), stoppedLines.end(), expectedLines.begin()));
+
+    // Its checkpoint is still there. What was printed after it is printed again, then the rest.
+    fixture.kernel.SetCheckpointing("", 0);
+    BOOST_REQUIRE(fixture.kernel.ResumeProgram(programName, checkpointName));
+    std::remove(checkpointName.c_str());
+
+    const std::vector<std::string> resumedLines = fixture.GetOutput();
+    BOOST_REQUIRE(!resumedLines.empty());
+    BOOST_REQUIRE(stoppedLines.size() + resumedLines.size() >= expectedLines.size());
+    BOOST_REQUIRE(std::equal(resumedLines.rbegin(), resumedLines.rend(), expectedLines.rbegin()));
+}
+
+BOOST_FIXTURE_TEST_SUITE( KernelTestSuite, KernelFixture )
+
+BOOST_AUTO_TEST_CASE( ProgramIsRun )
+{
+    BOOST_REQUIRE(kernel.RunProgram("../kernel/programs/hello_kernel.tos"));
+    CheckOutput("../kernel/programs/hello_kernel.tos");
+}
+
+BOOST_AUTO_TEST_CASE( ProgramWithErrorsIsNotLoaded )
+{
+    const std::string programName = "../kernel/programs/type_error.tos";
+    BOOST_REQUIRE(kernel.LoadProcess(programName) == nullptr);
+    BOOST_REQUIRE(!kernel.RunProgram(programName));
+    BOOST_REQUIRE(GetOutput().empty());
+
+    // The type checker and the kernel both say why
+    const std::string errors = errorBuffer.str();
+    BOOST_REQUIRE(errors.find("Couldn't load " + programName + ", it has semantic errors") != std::string::npos);
+
+    // The kernel can still run the next program
+    BOOST_REQUIRE(kernel.RunProgram("../kernel/programs/hello_kernel.tos"));
+    CheckOutput("../kernel/programs/hello_kernel.tos");
+}
+
+BOOST_AUTO_TEST_CASE( SyncWaitsForChildren )
+{
+    BOOST_REQUIRE(kernel.RunProgram("../kernel/programs/spawn_sync.tos"));
+    CheckOutput("../kernel/programs/spawn_sync.tos");
+}
+
+BOOST_AUTO_TEST_CASE( SyncWaitsForChildrenInClosures )
+{
+    kernel.SetExecutionTier(Kernel::ExecutionTier::CLOSURES);
+    BOOST_REQUIRE(kernel.RunProgram("../kernel/programs/spawn_sync.tos"));
+    CheckOutput("../kernel/programs/spawn_sync.tos");
+}
+
+BOOST_AUTO_TEST_CASE( SyncWaitsForChildrenOnWorkers )
+{
+    // The children run on other host threads, the barrier is all that keeps the output in order.
+    // Only compiled programs are run by the worker pool.
+    kernel.SetWorkerCount(4);
+    kernel.SetExecutionTier(Kernel::ExecutionTier::CLOSURES);
+    BOOST_REQUIRE(kernel.RunProgram("../kernel/programs/spawn_sync.tos"));
+    CheckOutput("../kernel/programs/spawn_sync.tos");
+}
+
+BOOST_AUTO_TEST_CASE( GlobalUpdateIsAtomicOnWorkers )
+{
+    // The threads run on different host threads and keep adding to the same variable.
+    // Only compiled programs are run by the worker pool.
+    kernel.SetWorkerCount(4);
+    kernel.SetExecutionTier(Kernel::ExecutionTier::CLOSURES);
+    BOOST_REQUIRE(kernel.RunProgram("../kernel/programs/global_update.tos"));
+    CheckOutput("../kernel/programs/global_update.tos");
+}
+
+BOOST_AUTO_TEST_CASE( IndexOutOfBoundsEndsThread )
+{
+    // The thread reading past the end of the array is the only one to stop, its parent goes on after the sync
+    BOOST_REQUIRE(kernel.RunProgram("../kernel/programs/index_out_of_bounds.tos"));
+    CheckOutput("../kernel/programs/index_out_of_bounds.tos");
+    BOOST_REQUIRE(errorBuffer.str().find("RUNTIME ERROR: Index out of bounds") != std::string::npos);
+}
+
+BOOST_AUTO_TEST_CASE( IndexOutOfBoundsEndsThreadInClosures )
+{
+    kernel.SetExecutionTier(Kernel::ExecutionTier::CLOSURES);
+    BOOST_REQUIRE(kernel.RunProgram("../kernel/programs/index_out_of_bounds.tos"));
+    CheckOutput("../kernel/programs/index_out_of_bounds.tos");
+    BOOST_REQUIRE(errorBuffer.str().find("RUNTIME ERROR: Index out of bounds") != std::string::npos);
+}
+
+BOOST_AUTO_TEST_CASE( VirtualSleepDoesNotWait )
+{
+    kernel.SetVirtualTime(true);
+
+    // The program sleeps for 30 seconds, which only the virtual clock sees go by
+    const auto start = std::chrono::steady_clock::now();
+    BOOST_REQUIRE(kernel.RunProgram("../kernel/programs/virtual_sleep.tos"));
+    BOOST_REQUIRE(std::chrono::steady_clock::now() - start < std::chrono::seconds(10));
+    CheckOutput("../kernel/programs/virtual_sleep.tos");
+
+    const SleepClock& clock = SleepClock::GetInstance();
+    BOOST_REQUIRE(clock.IsVirtual());
+    BOOST_REQUIRE(clock.Now() == SleepClock::Clock::time_point{ std::chrono::seconds(30) });
+}
+
+BOOST_AUTO_TEST_CASE( VirtualSleepInClosures )
+{
+    kernel.SetVirtualTime(true);
+    kernel.SetExecutionTier(Kernel::ExecutionTier::CLOSURES);
+    BOOST_REQUIRE(kernel.RunProgram("../kernel/programs/virtual_sleep.tos"));
+    CheckOutput("../kernel/programs/virtual_sleep.tos");
+}
+
+BOOST_AUTO_TEST_CASE( JoinWaitsForOneChild )
+{
+    kernel.SetVirtualTime(true);
+
+    // The main thread goes on after joining the fast child, the slow one still sleeps
+    BOOST_REQUIRE(kernel.RunProgram("../kernel/programs/join.tos"));
+    CheckOutput("../kernel/programs/join.tos");
+    BOOST_REQUIRE(SleepClock::GetInstance().Now() == SleepClock::Clock::time_point{ std::chrono::seconds(5) });
+}
+
+BOOST_AUTO_TEST_CASE( JoinWaitsForOneChildInClosures )
+{
+    kernel.SetVirtualTime(true);
+    kernel.SetExecutionTier(Kernel::ExecutionTier::CLOSURES);
+    BOOST_REQUIRE(kernel.RunProgram("../kernel/programs/join.tos"));
+    CheckOutput("../kernel/programs/join.tos");
+    BOOST_REQUIRE(SleepClock::GetInstance().Now() == SleepClock::Clock::time_point{ std::chrono::seconds(5) });
+}
+
+BOOST_AUTO_TEST_CASE( StoppedProgramIsResumed )
+{
+    CheckResumedRun(*this, Kernel::ExecutionTier::AST_WALKER);
+}
+
+BOOST_AUTO_TEST_CASE( StoppedProgramIsResumedInClosures )
+{
+    CheckResumedRun(*this, Kernel::ExecutionTier::CLOSURES);
+}
+
+BOOST_AUTO_TEST_CASE( ThreadQuotaLimitsRunningThreads )
+{
+    const std::string programName = "../kernel/programs/thread_quota.tos";
+    kernel.SetVirtualTime(true);
+
+    // Without a quota, the four workers sleep at the same time
+    BOOST_REQUIRE(kernel.RunProgram(programName));
+    CheckOutput(programName);
+    BOOST_REQUIRE(SleepClock::GetInstance().Now() == SleepClock::Clock::time_point{ std::chrono::seconds(10) });
+
+    // With it, the last two wait for the first two to be done before they can go to sleep
+    ProcessQuotas quotas;
+    quotas.maxThreads = 2;
+    BOOST_REQUIRE(kernel.LoadProcess(programName, quotas) != nullptr);
+    kernel.RunProcesses();
+    CheckOutput(programName);
+    BOOST_REQUIRE(SleepClock::GetInstance().Now() == SleepClock::Clock::time_point{ std::chrono::seconds(20) });
+}
+
+BOOST_AUTO_TEST_CASE( StepQuotaStopsProcess )
+{
+    CheckStepQuota("../kernel/programs/step_quota.tos", Kernel::ExecutionTier::AST_WALKER);
+}
+
+BOOST_AUTO_TEST_CASE( StepQuotaStopsLoopInHelperInClosures )
+{
+    // The called functions run one statement at a time on the thread's stack, or to completion when the call is
+    // within an expression. Their statements count toward the quota either way.
+    CheckStepQuota("../kernel/programs/step_quota_helper.tos", Kernel::ExecutionTier::CLOSURES);
+    ResetKernel();
+    CheckStepQuota("../kernel/programs/step_quota_nested_call.tos", Kernel::ExecutionTier::CLOSURES);
+}
+
+BOOST_AUTO_TEST_CASE( StepQuotaStopsProcessInClosures )
+{
+    CheckStepQuota("../kernel/programs/step_quota.tos", Kernel::ExecutionTier::CLOSURES);
+}
+
+BOOST_AUTO_TEST_CASE( StoppedProcessLeavesOthersRunning )
+{
+    CheckStoppedProcess("../kernel/programs/step_quota.tos", Kernel::ExecutionTier::AST_WALKER);
+}
+
+BOOST_AUTO_TEST_CASE( StoppedProcessLeavesOthersRunningInClosures )
+{
+    CheckStoppedProcess("../kernel/programs/step_quota.tos", Kernel::ExecutionTier::CLOSURES);
+    ResetKernel();
+    CheckStoppedProcess("../kernel/programs/step_quota_helper.tos", Kernel::ExecutionTier::CLOSURES);
+}
+
+BOOST_AUTO_TEST_SUITE_END()
@@ -121,6 +121,27 @@ BOOST_AUTO_TEST_CASE( ParseArrayInitStringTest )
     BOOST_REQUIRE(arrayElems[1]->GetKind() == ASTNode::NodeKind::STRING_EXPR);
 }
 
+BOOST_AUTO_TEST_CASE( ParseArrayIndexTest )
+{
+    auto& cNodes = GetProgramAST("../sources/array/array_index.tos");
+    BOOST_REQUIRE_EQUAL(cNodes.size(), 3);
+
+    BOOST_REQUIRE(cNodes[2]->GetKind() == ASTNode::NodeKind::VAR_DECL);
+    const VarDecl* vDecl = static_cast<const VarDecl*>(cNodes[2].get());
+    BOOST_REQUIRE(vDecl != nullptr);
+    BOOST_REQUIRE_EQUAL(vDecl->GetVarName(), "MyElemVar");
+
+    BOOST_REQUIRE(vDecl->GetInitExpr()->GetKind() == ASTNode::NodeKind::INDEX_EXPR);
+    const IndexedExpr* iExpr = static_cast<const IndexedExpr*>(vDecl->GetInitExpr());
+    BOOST_REQUIRE(iExpr != nullptr);
+    BOOST_REQUIRE_EQUAL(iExpr->GetName(), "MyIntArrayVar");
+    BOOST_REQUIRE(iExpr->GetIdentifier()->GetKind() == ASTNode::NodeKind::IDENTIFIER_EXPR);
+    BOOST_REQUIRE(iExpr->GetIndex()->GetKind() == ASTNode::NodeKind::IDENTIFIER_EXPR);
+    BOOST_REQUIRE_EQUAL(iExpr->GetIndex()->GetName(), "MyIndexVar");
+
+    BOOST_REQUIRE(GetErrorMessages().empty());
+}
+
 //////////////////// ERROR USE CASES ////////////////////
 
 BOOST_AUTO_TEST_CASE( ParseBadArrayDeclTest )
@@ -0,0 +1,65 @@
+#ifdef STAND_ALONE
+#   define BOOST_TEST_MODULE Main
+#else
+#ifndef _WIN32
+#   define BOOST_TEST_MODULE PurityAnalysisTests
+#endif
+#endif
+
+#include <boost/test/unit_test.hpp>
+
+#include "toslang_sema_fixture.h"
+
+#include "AST/declarations.h"
+#include "Sema/purityanalysis.h"
+
+BOOST_FIXTURE_TEST_SUITE( SemaTestSuite, TosLangSemaFixture )
+
+BOOST_AUTO_TEST_CASE( PureRecursiveFunction )
+{
+    auto symTable = std::make_shared<SymbolTable>();
+    BOOST_REQUIRE_EQUAL(GetProgramSymbolTable("../asts/purity/pure_recursive_fn.ast", symTable), 0);
+    BOOST_REQUIRE_EQUAL(tChecker.Run(programAST, symTable), 0);
+
+    PurityAnalysis analysis;
+    BOOST_REQUIRE_EQUAL(analysis.Run(programAST, symTable), 2);
+
+    auto& cNodes = programAST->GetChildrenNodes();
+    BOOST_REQUIRE_EQUAL(cNodes.size(), 2);
+    BOOST_REQUIRE(analysis.IsPure(cNodes[0].get()));    // gcd
+    BOOST_REQUIRE(analysis.IsPure(cNodes[1].get()));    // main
+}
+
+BOOST_AUTO_TEST_CASE( ImpureIOFunction )
+{
+    auto symTable = std::make_shared<SymbolTable>();
+    BOOST_REQUIRE_EQUAL(GetProgramSymbolTable("../asts/purity/impure_io_fn.ast", symTable), 0);
+    BOOST_REQUIRE_EQUAL(tChecker.Run(programAST, symTable), 0);
+
+    PurityAnalysis analysis;
+    BOOST_REQUIRE_EQUAL(analysis.Run(programAST, symTable), 0);
+
+    // Calling a function printing something makes the caller impure as well
+    auto& cNodes = programAST->GetChildrenNodes();
+    BOOST_REQUIRE_EQUAL(cNodes.size(), 3);
+    BOOST_REQUIRE(!analysis.IsPure(cNodes[0].get()));   // log
+    BOOST_REQUIRE(!analysis.IsPure(cNodes[1].get()));   // square
+    BOOST_REQUIRE(!analysis.IsPure(cNodes[2].get()));   // main
+}
+
+BOOST_AUTO_TEST_CASE( ImpureGlobalFunction )
+{
+    auto symTable = std::make_shared<SymbolTable>();
+    BOOST_REQUIRE_EQUAL(GetProgramSymbolTable("../asts/purity/impure_global_fn.ast", symTable), 0);
+    BOOST_REQUIRE_EQUAL(tChecker.Run(programAST, symTable), 0);
+
+    PurityAnalysis analysis;
+    BOOST_REQUIRE_EQUAL(analysis.Run(programAST, symTable), 0);
+
+    auto& cNodes = programAST->GetChildrenNodes();
+    BOOST_REQUIRE_EQUAL(cNodes.size(), 4);
+    BOOST_REQUIRE(!analysis.IsPure(cNodes[1].get()));   // readGlobal
+    BOOST_REQUIRE(!analysis.IsPure(cNodes[2].get()));   // writeGlobal
+}
+
+BOOST_AUTO_TEST_SUITE_END()
@@ -0,0 +1,93 @@
+#ifdef STAND_ALONE
+#   define BOOST_TEST_MODULE Main
+#else
+#ifndef _WIN32
+#   define BOOST_TEST_MODULE SSAInterpreterTests
+#endif
+#endif
+
+#include <boost/test/unit_test.hpp>
+
+#include "toslang_sema_fixture.h"
+
+#include "SSA/cfgbuilder.h"
+#include "SSA/ssainterpreter.h"
+
+using namespace TosLang::BackEnd;
+
+/*
+* \fn               BuildSSAModule
+* \brief            Type checks a TosLang program and lowers it to its SSA form
+* \param fixture    Test fixture holding the program's AST
+* \param filename   Name of a file containing a TosLang AST
+* \return           SSA form of the program
+*/
+std::unique_ptr<SSAModule> BuildSSAModule(TosLangSemaFixture& fixture, const std::string& filename)
+{
+    auto symTable = std::make_shared<SymbolTable>();
+    BOOST_REQUIRE_EQUAL(fixture.GetProgramSymbolTable(filename, symTable), 0);
+    BOOST_REQUIRE_EQUAL(fixture.tChecker.Run(fixture.programAST, symTable), 0);
+
+    CFGBuilder builder;
+    auto module = builder.Run(fixture.programAST, symTable);
+    BOOST_REQUIRE(module != nullptr);
+
+    return module;
+}
+
+BOOST_FIXTURE_TEST_SUITE( SSATestSuite, TosLangSemaFixture )
+
+BOOST_AUTO_TEST_CASE( RecursiveFunction )
+{
+    auto module = BuildSSAModule(*this, "../asts/ssa/recursive_fn.ast");
+
+    SSAInterpreter interpreter;
+    BOOST_REQUIRE(interpreter.Load(*module));
+    BOOST_REQUIRE_EQUAL(interpreter.Call("gcd", { 84, 36 }), 12);
+    BOOST_REQUIRE_EQUAL(interpreter.Call("gcd", { 7, 7 }), 7);
+}
+
+BOOST_AUTO_TEST_CASE( DeepTailRecursion )
+{
+    auto module = BuildSSAModule(*this, "../asts/ssa/recursive_fn.ast");
+
+    // gcd calls itself 999999 times, each call taking the place of the previous one
+    SSAInterpreter interpreter;
+    BOOST_REQUIRE(interpreter.Load(*module));
+    BOOST_REQUIRE_EQUAL(interpreter.Call("gcd", { 1000000, 1 }), 1);
+}
+
+BOOST_AUTO_TEST_CASE( LoopFunction )
+{
+    auto module = BuildSSAModule(*this, "../asts/ssa/loop_fn.ast");
+
+    SSAInterpreter interpreter;
+    BOOST_REQUIRE(interpreter.Load(*module));
+    BOOST_REQUIRE_EQUAL(interpreter.Call("fib", { 2 }), 1);
+    BOOST_REQUIRE_EQUAL(interpreter.Call("fib", { 10 }), 55);
+}
+
+BOOST_AUTO_TEST_CASE( SwapInLoop )
+{
+    auto module = BuildSSAModule(*this, "../asts/ssa/swap_loop_fn.ast");
+
+    // The PHIs of the loop header use each other's values, they must be resolved all at once
+    SSAInterpreter interpreter;
+    BOOST_REQUIRE(interpreter.Load(*module));
+    BOOST_REQUIRE_EQUAL(interpreter.Call("swap", { 1 }), -1);
+    BOOST_REQUIRE_EQUAL(interpreter.Call("swap", { 2 }), 1);
+    BOOST_REQUIRE_EQUAL(interpreter.Call("swap", { 3 }), -1);
+}
+
+BOOST_AUTO_TEST_CASE( PrintInMain )
+{
+    auto module = BuildSSAModule(*this, "../asts/ssa/print_fn.ast");
+
+    std::stringstream output;
+    SSAInterpreter interpreter{ output };
+    BOOST_REQUIRE(interpreter.Load(*module));
+    BOOST_REQUIRE_EQUAL(interpreter.Call("main", {}), 0);
+    BOOST_REQUIRE_EQUAL(output.str(), "49\n1\n");
+}
+
+BOOST_AUTO_TEST_SUITE_END()
@@ -44,6 +44,18 @@ BOOST_AUTO_TEST_CASE( CallNoArgTypeCheck )
     BOOST_REQUIRE_EQUAL(errorCount, 0);
 }
 
+BOOST_AUTO_TEST_CASE( CallIntrinsicTypeCheck )
+{
+    size_t errorCount = GetTypeErrors("../asts/call/call_intrinsic.ast");
+    BOOST_REQUIRE_EQUAL(errorCount, 0);
+}
+
+BOOST_AUTO_TEST_CASE( CallBinOpOperandTypeCheck )
+{
+    size_t errorCount = GetTypeErrors("../asts/call/call_binop_operand.ast");
+    BOOST_REQUIRE_EQUAL(errorCount, 0);
+}
+
 //////////////////// ERROR USE CASES ////////////////////
 
 BOOST_AUTO_TEST_CASE( BadCallBinOpArgTypeCheck )
@@ -57,6 +69,17 @@ BOOST_AUTO_TEST_CASE( BadCallBinOpArgTypeCheck )
     BOOST_REQUIRE_EQUAL(messages[0], "CALL ERROR: No function matches these arguments types at line 9, column 14");
 }
 
+BOOST_AUTO_TEST_CASE( BadCallBinOpOperandTypeCheck )
+{
+    size_t errorCount = GetTypeErrors("../asts/call/bad_call_binop_operand.ast");
+    BOOST_REQUIRE_EQUAL(errorCount, 1);
+
+    // Check if the correct error message got printed
+    std::vector<std::string> messages{ GetErrorMessages() };
+    BOOST_REQUIRE_EQUAL(messages.size(), 1);
+    BOOST_REQUIRE_EQUAL(messages[0], "CALL ERROR: No function matches the expected return type at line 7, column 33");
+}
+
 BOOST_AUTO_TEST_CASE( BadCallCallArgTypeCheck )
 {
     size_t errorCount = GetTypeErrors("../asts/call/bad_call_one_arg_call.ast");
@@ -101,4 +124,15 @@ BOOST_AUTO_TEST_CASE( BadCallNoArgTypeCheck )
     BOOST_REQUIRE_EQUAL(messages[0], "CALL ERROR: Trying to call a function with the wrong number of arguments at line 6, column 8");
 }
 
+BOOST_AUTO_TEST_CASE( BadCallIntrinsicTypeCheck )
+{
+    size_t errorCount = GetTypeErrors("../asts/call/bad_call_intrinsic.ast");
+    BOOST_REQUIRE_EQUAL(errorCount, 1);
+
+    // Check if the correct error message got printed
+    std::vector<std::string> messages{ GetErrorMessages() };
+    BOOST_REQUIRE_EQUAL(messages.size(), 1);
+    BOOST_REQUIRE_EQUAL(messages[0], "CALL ERROR: No function matches these arguments types at line 4, column 21");
+}
+
 BOOST_AUTO_TEST_SUITE_END()
\ No newline at end of file
@@ -0,0 +1,56 @@
+#ifdef STAND_ALONE
+#   define BOOST_TEST_MODULE Main
+#else
+#ifndef _WIN32
+#   define BOOST_TEST_MODULE ClosureCompilerTests
+#endif
+#endif
+
+#include <boost/test/unit_test.hpp>
+
+#include "executor_fixture.h"
+
+BOOST_FIXTURE_TEST_SUITE( ClosureCompilerTestSuite, ExecutorFixture )
+
+BOOST_AUTO_TEST_CASE( CommentIsSkipped )
+{
+    // The program starts with a comment, which leaves an empty declaration in the global scope
+    LoadProgram("../threading/programs/tail_call.tos");
+    BOOST_REQUIRE(programAST->GetChildrenNodes().front()->GetKind() == ASTNode::NodeKind::ERROR);
+
+    std::unique_ptr<CompiledProgram> program = CompileProgram();
+    BOOST_REQUIRE(program != nullptr);
+    BOOST_REQUIRE(program->GetMainFunction() != nullptr);
+    BOOST_REQUIRE(program->GetGlobalInit()->stmts.empty());
+}
+
+BOOST_AUTO_TEST_CASE( TailCallRunsInConstantSpace )
+{
+    LoadProgram("../threading/programs/tail_call.tos");
+
+    std::unique_ptr<CompiledProgram> program = CompileProgram();
+    BOOST_REQUIRE(program != nullptr);
+
+    // Nesting the 100000 calls on the host stack would overflow it
+    const CompiledFunction* mainFn = program->GetMainFunction();
+    BOOST_REQUIRE(!mainFn->mayYield);
+
+    InterpretedValue result = mainFn->Invoke({});
+    BOOST_REQUIRE(result.GetType() == InterpretedValue::ValueType::INTEGER);
+    BOOST_REQUIRE_EQUAL(result.GetIntVal(), 100000);
+}
+
+BOOST_AUTO_TEST_CASE( EqualityMatchesOperandTypes )
+{
+    LoadProgram("../threading/programs/typed_equality.tos");
+
+    std::unique_ptr<CompiledProgram> program = CompileProgram();
+    BOOST_REQUIRE(program != nullptr);
+
+    // Strings and booleans coming from variables and literals are each compared with their own handler
+    InterpretedValue result = program->GetMainFunction()->Invoke({});
+    BOOST_REQUIRE(result.GetType() == InterpretedValue::ValueType::INTEGER);
+    BOOST_REQUIRE_EQUAL(result.GetIntVal(), 111);
+}
+
+BOOST_AUTO_TEST_SUITE_END()
@@ -0,0 +1,163 @@
+#ifndef EXECUTOR_FIXTURE_H__TOSTITOS
+#define EXECUTOR_FIXTURE_H__TOSTITOS
+
+#include "AST/ast.h"
+#include "AST/declarations.h"
+#include "AST/expressions.h"
+#include "AST/statements.h"
+#include "Execution/compiler.h"
+#include "Sema/purityanalysis.h"
+#include "Sema/symboltable.h"
+
+#include "threading/callsitecache.h"
+#include "threading/closurecompiler.h"
+#include "threading/executor.h"
+#include "threading/functioncache.h"
+#include "threading/globalstore.h"
+#include "threading/interpretedvalue.h"
+#include "threading/quickenedops.h"
+#include "threading/stringpool.h"
+#include "threading/tierupmanager.h"
+
+#include <boost/test/unit_test.hpp>
+
+#include <algorithm>
+#include <memory>
+#include <string>
+
+using namespace Threading::impl;
+using namespace TosLang::FrontEnd;
+
+/*
+* \struct ExecutorFixture
+* \brief  Fixture used to run a TosLang program with the AST walker, outside of the kernel.
+*         The program runs on a single thread: it can't spawn, sync or print.
+*/
+struct ExecutorFixture
+{
+    /*
+    * \fn    ExecutorFixture
+    * \brief Constructor. Starts from the same clean slate as a program loaded by the kernel.
+    */
+    ExecutorFixture() : maxFrameCount{ 0 }
+    {
+        TierUpManager::GetInstance().Reset();
+        CallSiteCache::GetInstance().Invalidate();
+        QuickenedOps::GetInstance().Invalidate();
+        FunctionCache::GetInstance().Reset();
+        StringPool::GetInstance().Reset();
+    }
+
+    /*
+    * \fn    ~ExecutorFixture
+    * \brief Destructor. Forgets the program before its AST goes away.
+    */
+    ~ExecutorFixture()
+    {
+        TierUpManager::GetInstance().Reset();
+        GlobalStore::SetCurrent(nullptr);
+    }
+
+    /*
+    * \fn               LoadProgram
+    * \brief            Parse and check a TosLang program, then give its global variables a slot
+    * \param filename   Name of a file containing a TosLang program
+    */
+    void LoadProgram(const std::string& filename)
+    {
+        programAST = compiler.ParseProgram(filename);
+        BOOST_REQUIRE(programAST != nullptr);
+
+        symTable = compiler.GetSymbolTable(programAST);
+        BOOST_REQUIRE(symTable != nullptr);
+
+        StringPool::GetInstance().InternLiterals(programAST.get());
+
+        globals.Reset(programAST.get(), symTable.get());
+        GlobalStore::SetCurrent(&globals);
+    }
+
+    /*
+    * \fn    AnalyzePurity
+    * \brief Find the pure functions of the program. Those returning something are memoized, like the kernel does.
+    */
+    void AnalyzePurity()
+    {
+        purityAnalysis.Run(programAST, symTable);
+
+        for (const auto& decl : programAST->GetChildrenNodes())
+        {
+            if ((decl->GetKind() == ASTNode::NodeKind::FUNCTION_DECL)
+                && (static_cast<const FunctionDecl*>(decl.get())->GetReturnType() != TosLang::Common::Type::VOID)
+                && purityAnalysis.IsPure(decl.get()))
+            {
+                FunctionCache::GetInstance().RegisterFunction(decl.get());
+            }
+        }
+    }
+
+    /*
+    * \fn    RegisterTierUpCandidates
+    * \brief Let the pure functions of the program be compiled once they get hot, like the kernel does
+    */
+    void RegisterTierUpCandidates()
+    {
+        purityAnalysis.Run(programAST, symTable);
+        TierUpManager::GetInstance().RegisterCandidates(programAST.get(), symTable, purityAnalysis);
+    }
+
+    /*
+    * \fn           GetFunction
+    * \brief        Get the declaration of one of the program's functions
+    * \param fnName Name of the function
+    * \return       Function declaration
+    */
+    const ASTNode* GetFunction(const std::string& fnName) const
+    {
+        for (const auto& decl : programAST->GetChildrenNodes())
+        {
+            if ((decl->GetKind() == ASTNode::NodeKind::FUNCTION_DECL)
+                && (static_cast<const FunctionDecl*>(decl.get())->GetFunctionName() == fnName))
+            {
+                return decl.get();
+            }
+        }
+
+        BOOST_FAIL("No function named " + fnName);
+        return nullptr;
+    }
+
+    /*
+    * \fn       CompileProgram
+    * \brief    Compile the program to closures
+    * \return   Compiled program, or nullptr if the closure tier doesn't handle it
+    */
+    std::unique_ptr<CompiledProgram> CompileProgram()
+    {
+        ClosureCompiler closureCompiler;
+        return closureCompiler.Compile(programAST.get(), symTable.get());
+    }
+
+    /*
+    * \fn       RunProgram
+    * \brief    Walk the program's AST until its main function returns
+    * \return   Value returned by the main function
+    */
+    InterpretedValue RunProgram()
+    {
+        Executor executor{ programAST.get(), symTable.get() };
+        while (executor.ExecuteOne())
+            maxFrameCount = std::max(maxFrameCount, executor.GetFrameCount());
+
+        return executor.GetResult();
+    }
+
+    std::unique_ptr<ASTNode> programAST;    /*!< Program abstract syntax tree */
+    std::shared_ptr<SymbolTable> symTable;  /*!< Symbols of the program */
+    Execution::Compiler compiler;           /*!< Parses and checks the programs */
+    GlobalStore globals;                    /*!< Global variables of the program */
+    PurityAnalysis purityAnalysis;          /*!< Pure functions of the program */
+    size_t maxFrameCount;                   /*!< Deepest the call stack got while running the program */
+};
+
+#endif // EXECUTOR_FIXTURE_H__TOSTITOS
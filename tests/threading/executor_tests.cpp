@@ -0,0 +1,133 @@
+#ifdef STAND_ALONE
+#   define BOOST_TEST_MODULE Main
+#else
+#ifndef _WIN32
+#   define BOOST_TEST_MODULE ExecutorTests
+#endif
+#endif
+
+#include <boost/test/unit_test.hpp>
+
+#include "executor_fixture.h"
+
+#include <chrono>
+#include <thread>
+
+BOOST_FIXTURE_TEST_SUITE( ExecutorTestSuite, ExecutorFixture )
+
+BOOST_AUTO_TEST_CASE( TailCallReusesFrame )
+{
+    LoadProgram("../threading/programs/tail_call.tos");
+
+    InterpretedValue result = RunProgram();
+    BOOST_REQUIRE(result.GetType() == InterpretedValue::ValueType::INTEGER);
+    BOOST_REQUIRE_EQUAL(result.GetIntVal(), 100000);
+
+    // The global frame and main's, which each call to count took over in turn
+    BOOST_REQUIRE_EQUAL(maxFrameCount, 2);
+}
+
+BOOST_AUTO_TEST_CASE( NonTailCallPushesFrame )
+{
+    LoadProgram("../threading/programs/non_tail_call.tos");
+
+    InterpretedValue result = RunProgram();
+    BOOST_REQUIRE(result.GetType() == InterpretedValue::ValueType::INTEGER);
+    BOOST_REQUIRE_EQUAL(result.GetIntVal(), 500500);
+
+    // The global frame and one for each of the 1001 calls to sum, the first one taking over main's
+    BOOST_REQUIRE_EQUAL(maxFrameCount, 1002);
+}
+
+BOOST_AUTO_TEST_CASE( PureCallIsMemoized )
+{
+    LoadProgram("../threading/programs/memoized_call.tos");
+    AnalyzePurity();
+
+    InterpretedValue result = RunProgram();
+    BOOST_REQUIRE(result.GetType() == InterpretedValue::ValueType::INTEGER);
+    BOOST_REQUIRE_EQUAL(result.GetIntVal(), 75025);
+
+    // fib(25) down to fib(0) are each computed once, fib(i - 2) was always computed by fib(i - 1) before, fib(0) aside
+    const FunctionCache& fnCache = FunctionCache::GetInstance();
+    const ASTNode* fibDecl = GetFunction("fib");
+    BOOST_REQUIRE_EQUAL(fnCache.GetMissCount(fibDecl), 26);
+    BOOST_REQUIRE_EQUAL(fnCache.GetHitCount(fibDecl), 23);
+}
+
+BOOST_AUTO_TEST_CASE( MemoizedTailCallReusesFrame )
+{
+    LoadProgram("../threading/programs/tail_call.tos");
+    AnalyzePurity();
+
+    InterpretedValue result = RunProgram();
+    BOOST_REQUIRE_EQUAL(result.GetIntVal(), 100000);
+    BOOST_REQUIRE_EQUAL(maxFrameCount, 2);
+
+    // Each call waited for the result of the last one, which they all got once it returned
+    BOOST_REQUIRE_EQUAL(FunctionCache::GetInstance().GetMissCount(GetFunction("count")), 100001);
+}
+
+BOOST_AUTO_TEST_CASE( CallSiteIsResolvedOnce )
+{
+    LoadProgram("../threading/programs/non_tail_call.tos");
+
+    InterpretedValue result = RunProgram();
+    BOOST_REQUIRE_EQUAL(result.GetIntVal(), 500500);
+
+    // main calls sum, which calls sum and add: the 2002 calls went through three call sites, each resolved once
+    BOOST_REQUIRE_EQUAL(CallSiteCache::GetInstance().GetSize(), 3);
+}
+
+BOOST_AUTO_TEST_CASE( BinaryExprIsQuickened )
+{
+    LoadProgram("../threading/programs/tail_call.tos");
+
+    InterpretedValue result = RunProgram();
+    BOOST_REQUIRE_EQUAL(result.GetIntVal(), 100000);
+
+    // n == 0, n - 1 and acc + 1 were all specialized for integers
+    BOOST_REQUIRE_EQUAL(QuickenedOps::GetInstance().GetSize(), 3);
+}
+
+BOOST_AUTO_TEST_CASE( StringEqualityIsQuickened )
+{
+    LoadProgram("../threading/programs/string_equality.tos");
+
+    InterpretedValue result = RunProgram();
+    BOOST_REQUIRE(result.GetType() == InterpretedValue::ValueType::INTEGER);
+    BOOST_REQUIRE_EQUAL(result.GetIntVal(), 10);
+
+    // a == b was specialized for strings, whose guard held whether they were equal or not
+    const FunctionDecl* sameDecl = static_cast<const FunctionDecl*>(GetFunction("same"));
+    const ReturnStmt* rStmt = static_cast<const ReturnStmt*>(sameDecl->GetBody()->GetStatements().front().get());
+    const QuickenedBinaryOp* quickened = QuickenedOps::GetInstance().Find(static_cast<const BinaryOpExpr*>(rStmt->GetReturnExpr()));
+    BOOST_REQUIRE(quickened != nullptr);
+    BOOST_REQUIRE(quickened->lhsType == InterpretedValue::ValueType::STRING);
+    BOOST_REQUIRE(quickened->rhsType == InterpretedValue::ValueType::STRING);
+}
+
+BOOST_AUTO_TEST_CASE( HotFunctionIsCompiled )
+{
+    LoadProgram("../threading/programs/hot_function.tos");
+    RegisterTierUpCandidates();
+
+    InterpretedValue result = RunProgram();
+    BOOST_REQUIRE_EQUAL(result.GetIntVal(), 332833500);
+
+    // square got hot after a few hundred calls. Its compilation runs in the background, it may not be done yet.
+    TierUpManager& tierUp = TierUpManager::GetInstance();
+    const ASTNode* squareDecl = GetFunction("square");
+    for (int i = 0; (i < 100) && !tierUp.IsCompiled(squareDecl); ++i)
+        std::this_thread::sleep_for(std::chrono::milliseconds(100));
+
+    BOOST_REQUIRE(tierUp.IsCompiled(squareDecl));
+
+    // Running the program again calls the compiled code, which gives the same result
+    const size_t compiledCallCount = tierUp.GetCompiledCallCount();
+    result = RunProgram();
+    BOOST_REQUIRE_EQUAL(result.GetIntVal(), 332833500);
+    BOOST_REQUIRE(tierUp.GetCompiledCallCount() > compiledCallCount);
+}
+
+BOOST_AUTO_TEST_SUITE_END()